@@ -25,6 +25,7 @@
 #include "common/textconsole.h"
 
 #include "audio/mixer_intern.h"
+#include "audio/mixer_kernels.h"
 #include "audio/rate.h"
 #include "audio/audiostream.h"
 #include "audio/timestamp.h"
@@ -42,7 +43,8 @@ namespace Audio {
  */
 class Channel {
 public:
-	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent);
+	Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream, DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+	        RateConverterType converterType = kRateConverterLinear);
 	~Channel();
 
 	/**
@@ -52,9 +54,12 @@ public:
 	 * @param len  number of sample *pairs*. So a value of
 	 *             10 means that the buffer contains twice 10 sample, each
 	 *             16 bits, for a total of 40 bytes.
+	 * @param scratch optional stereo buffer of at least @p len sample pairs.
+	 *             If given, the channel is resampled into it at full volume
+	 *             and the volume is applied by the vectorized mixer kernels.
 	 * @return number of sample pairs processed (which can still be silence!)
 	 */
-	int mix(int16 *data, uint len);
+	int mix(int16 *data, uint len, int16 *scratch = nullptr);
 
 	/**
 	 * Queries whether the channel is still playing or not.
@@ -135,10 +140,20 @@ public:
 	void resetRate();
 
 	/**
-	 * Notifies the channel that the global sound type
-	 * volume settings changed.
+	 * Get the native sample rate of the channel's AudioStream.
 	 */
-	void notifyGlobalVolChange() { updateChannelVolumes(); }
+	uint32 getStreamRate() const { return _stream->getRate(); }
+
+	/**
+	 * Sets the volume of the channel's sound type. The channel keeps a copy,
+	 * so that the mixing thread never reads the mixer's settings.
+	 */
+	void setSoundTypeVolume(int volume) { _soundTypeVolume = volume; updateChannelVolumes(); }
+
+	/**
+	 * Sets whether the channel's sound type is muted.
+	 */
+	void setSoundTypeMute(bool mute) { _soundTypeMute = mute; updateChannelVolumes(); }
 
 	/**
 	 * Queries how long the channel has been playing.
@@ -176,6 +191,9 @@ private:
 
 	byte _volume;
 	int8 _balance;
+	bool _reverseStereo;
+	int _soundTypeVolume;
+	bool _soundTypeMute;
 
 	void updateChannelVolumes();
 	st_volume_t _volL, _volR;
@@ -197,17 +215,25 @@ private:
 #pragma mark -
 
 MixerImpl::MixerImpl(uint sampleRate, bool stereo, uint outBufSize)
-	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _handleSeed(0), _soundTypeSettings() {
+	: _mutex(), _sampleRate(sampleRate), _stereo(stereo), _outBufSize(outBufSize), _mixerReady(false), _lockFree(false), _rateConverterType(kRateConverterLinear), _handleSeed(0), _soundTypeSettings(),
+	  _mixBuffer(nullptr), _mixBufferSize(0) {
 
 	assert(sampleRate > 0);
 
-	for (int i = 0; i != NUM_CHANNELS; i++)
+	for (int i = 0; i != NUM_CHANNELS; i++) {
 		_channels[i] = nullptr;
+		_channelState[i].handle.storeRelaxed(kFreeSlot);
+	}
 }
 
 MixerImpl::~MixerImpl() {
+	// Take ownership of channels which are still waiting to be inserted
+	processCommands();
+
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		delete _channels[i];
+
+	free(_mixBuffer);
 }
 
 void MixerImpl::setReady(bool ready) {
@@ -216,6 +242,118 @@ void MixerImpl::setReady(bool ready) {
 	_mixerReady = ready;
 }
 
+void MixerImpl::setLockFreeControl(bool enable) {
+	Common::StackLock lock(_mutex);
+
+	assert(!_mixerReady);
+	_lockFree = enable;
+}
+
+void MixerImpl::setRateConverterType(RateConverterType type) {
+	Common::StackLock lock(_mutex);
+
+	_rateConverterType = type;
+}
+
+Channel *MixerImpl::findChannel(uint32 handle) const {
+	const int index = handle % NUM_CHANNELS;
+	if (!_channels[index] || _channels[index]->getHandle()._val != handle)
+		return nullptr;
+	return _channels[index];
+}
+
+void MixerImpl::publishChannel(int index, Channel *chan) {
+	ChannelState &state = _channelState[index];
+	state.id.store(chan->getId());
+	state.type.store(chan->getType());
+	state.volume.store(chan->getVolume());
+	state.balance.store(chan->getBalance());
+	state.rate.store(chan->getRate());
+	state.nativeRate.store(chan->getStreamRate());
+	state.handle.store(chan->getHandle()._val);
+}
+
+void MixerImpl::deleteChannel(int index) {
+	delete _channels[index];
+	_channels[index] = nullptr;
+	_channelState[index].handle.store(kFreeSlot);
+}
+
+void MixerImpl::postCommand(const ChannelCommand &cmd) {
+	if (_commands.push(cmd))
+		return;
+
+	// The mixing thread is lagging behind, apply the command ourselves
+	Common::StackLock lock(_mutex);
+	processCommands();
+	applyCommand(cmd);
+}
+
+void MixerImpl::processCommands() {
+	ChannelCommand cmd;
+	while (_commands.pop(cmd))
+		applyCommand(cmd);
+}
+
+void MixerImpl::applyCommand(const ChannelCommand &cmd) {
+	Channel *chan;
+
+	switch (cmd.type) {
+	case ChannelCommand::kInsert:
+		assert(_channels[cmd.value] == nullptr);
+		_channels[cmd.value] = cmd.channel;
+		break;
+	case ChannelCommand::kSetVolume:
+		if ((chan = findChannel(cmd.handle)) != nullptr)
+			chan->setVolume(cmd.value);
+		break;
+	case ChannelCommand::kSetBalance:
+		if ((chan = findChannel(cmd.handle)) != nullptr)
+			chan->setBalance(cmd.value);
+		break;
+	case ChannelCommand::kSetRate:
+		if ((chan = findChannel(cmd.handle)) != nullptr)
+			chan->setRate(cmd.value);
+		break;
+	case ChannelCommand::kResetRate:
+		if ((chan = findChannel(cmd.handle)) != nullptr)
+			chan->resetRate();
+		break;
+	case ChannelCommand::kPause:
+		if ((chan = findChannel(cmd.handle)) != nullptr)
+			chan->pause(cmd.value != 0);
+		break;
+	case ChannelCommand::kPauseAll:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != nullptr)
+				_channels[i]->pause(cmd.value != 0);
+		}
+		break;
+	case ChannelCommand::kPauseID:
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			if (_channels[i] != nullptr && _channels[i]->getId() == (int)cmd.handle) {
+				_channels[i]->pause(cmd.value != 0);
+				break;
+			}
+		}
+		break;
+	case ChannelCommand::kGlobalVolume:
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == (SoundType)cmd.handle)
+				_channels[i]->setSoundTypeVolume(cmd.value);
+		}
+		break;
+	case ChannelCommand::kGlobalMute:
+		for (int i = 0; i != NUM_CHANNELS; ++i) {
+			if (_channels[i] && _channels[i]->getType() == (SoundType)cmd.handle)
+				_channels[i]->setSoundTypeMute(cmd.value != 0);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
 uint MixerImpl::getOutputRate() const {
 	return _sampleRate;
 }
@@ -242,13 +380,13 @@ void MixerImpl::insertChannel(SoundHandle *handle, Channel *chan) {
 		return;
 	}
 
-	_channels[index] = chan;
-
 	SoundHandle chanHandle;
-	chanHandle._val = index + (_handleSeed * NUM_CHANNELS);
+	chanHandle._val = index + (_handleSeed.fetchAdd(1) * NUM_CHANNELS);
 
 	chan->setHandle(chanHandle);
-	_handleSeed++;
+	_channels[index] = chan;
+	publishChannel(index, chan);
+
 	if (handle)
 		*handle = chanHandle;
 }
@@ -261,6 +399,11 @@ void MixerImpl::playStream(
 			DisposeAfterUse::Flag autofreeStream,
 			bool permanent,
 			bool reverseStereo) {
+	if (_lockFree) {
+		playStreamLockFree(type, handle, stream, id, volume, balance, autofreeStream, permanent, reverseStereo);
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	if (stream == nullptr) {
@@ -292,12 +435,71 @@ void MixerImpl::playStream(
 #endif
 
 	// Create the channel
-	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent);
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterType);
 	chan->setVolume(volume);
 	chan->setBalance(balance);
 	insertChannel(handle, chan);
 }
 
+void MixerImpl::playStreamLockFree(
+			SoundType type,
+			SoundHandle *handle,
+			AudioStream *stream,
+			int id, byte volume, int8 balance,
+			DisposeAfterUse::Flag autofreeStream,
+			bool permanent,
+			bool reverseStereo) {
+	if (stream == nullptr) {
+		warning("stream is 0");
+		return;
+	}
+
+	assert(_mixerReady);
+
+	// Prevent duplicate sounds. See playStream() for the caveats.
+	if (id != -1 && isSoundIDActive(id)) {
+		if (autofreeStream == DisposeAfterUse::YES)
+			delete stream;
+		return;
+	}
+
+#ifdef AUDIO_REVERSE_STEREO
+	reverseStereo = !reverseStereo;
+#endif
+
+	// Create the channel outside of the mixing thread
+	Channel *chan = new Channel(this, type, stream, autofreeStream, reverseStereo, id, permanent, _rateConverterType);
+	chan->setVolume(volume);
+	chan->setBalance(balance);
+
+	// Claim a free slot. The slot stays invisible to queries until its
+	// state has been filled in.
+	int index = -1;
+	for (int i = 0; i != NUM_CHANNELS; i++) {
+		uint32 expected = kFreeSlot;
+		if (_channelState[i].handle.compareExchange(expected, kClaimedSlot)) {
+			index = i;
+			break;
+		}
+	}
+	if (index == -1) {
+		warning("MixerImpl::out of mixer slots");
+		delete chan;
+		return;
+	}
+
+	SoundHandle chanHandle;
+	chanHandle._val = index + (_handleSeed.fetchAdd(1) * NUM_CHANNELS);
+	chan->setHandle(chanHandle);
+
+	// The mixing thread installs the channel itself
+	publishChannel(index, chan);
+	postCommand(ChannelCommand(ChannelCommand::kInsert, chanHandle._val, index, chan));
+
+	if (handle)
+		*handle = chanHandle;
+}
+
 int MixerImpl::mixCallback(byte *samples, uint len) {
 	assert(samples);
 
@@ -308,6 +510,8 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	// Since the mixer callback has been called, the mixer must be ready...
 	_mixerReady = true;
 
+	processCommands();
+
 	//  zero the buf
 	memset(buf, 0, len);
 
@@ -320,15 +524,28 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 		len >>= 1;
 	}
 
+	// In lock-free mode, channels are resampled into a scratch buffer and
+	// the volume is applied by the vectorized kernels
+	int16 *scratch = nullptr;
+#ifndef OUTPUT_UNSIGNED_AUDIO
+	if (_lockFree && _stereo) {
+		if (_mixBufferSize < len) {
+			free(_mixBuffer);
+			_mixBuffer = (int16 *)malloc(len * 2 * sizeof(int16));
+			_mixBufferSize = len;
+		}
+		scratch = _mixBuffer;
+	}
+#endif
+
 	// mix all channels
 	int res = 0, tmp;
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i]) {
 			if (_channels[i]->isFinished()) {
-				delete _channels[i];
-				_channels[i] = nullptr;
+				deleteChannel(i);
 			} else if (!_channels[i]->isPaused()) {
-				tmp = _channels[i]->mix(buf, len);
+				tmp = _channels[i]->mix(buf, len, scratch);
 
 				if (tmp > res)
 					res = tmp;
@@ -338,45 +555,58 @@ int MixerImpl::mixCallback(byte *samples, uint len) {
 	return res;
 }
 
+// Stopping a channel always takes the mutex, as callers may free the
+// stream as soon as these return.
+
 void MixerImpl::stopAll() {
 	Common::StackLock lock(_mutex);
+	processCommands();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && !_channels[i]->isPermanent()) {
-			delete _channels[i];
-			_channels[i] = nullptr;
+			deleteChannel(i);
 		}
 	}
 }
 
 void MixerImpl::stopID(int id) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
-			delete _channels[i];
-			_channels[i] = nullptr;
+			deleteChannel(i);
 		}
 	}
 }
 
 void MixerImpl::stopHandle(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 
 	// Simply ignore stop requests for handles of sounds that already terminated
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return;
 
-	delete _channels[index];
-	_channels[index] = nullptr;
+	deleteChannel(index);
 }
 
 void MixerImpl::muteSoundType(SoundType type, bool mute) {
 	assert(0 <= (int)type && (int)type < ARRAYSIZE(_soundTypeSettings));
+
+	// In lock-free mode the settings belong to the calling thread, the
+	// channels get their own copy through the command queue
+	if (_lockFree) {
+		_soundTypeSettings[type].mute = mute;
+		postCommand(ChannelCommand(ChannelCommand::kGlobalMute, type, mute));
+		return;
+	}
+
+	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].mute = mute;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			_channels[i]->setSoundTypeMute(mute);
 	}
 }
 
@@ -385,7 +615,21 @@ bool MixerImpl::isSoundTypeMuted(SoundType type) const {
 	return _soundTypeSettings[type].mute;
 }
 
+bool MixerImpl::ownsSlot(SoundHandle handle) const {
+	if (handle._val == kFreeSlot || handle._val == kClaimedSlot)
+		return false;
+	return _channelState[handle._val % NUM_CHANNELS].handle.load() == handle._val;
+}
+
 void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
+	if (_lockFree) {
+		if (!ownsSlot(handle))
+			return;
+		_channelState[handle._val % NUM_CHANNELS].volume.store(volume);
+		postCommand(ChannelCommand(ChannelCommand::kSetVolume, handle._val, volume));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -396,6 +640,9 @@ void MixerImpl::setChannelVolume(SoundHandle handle, byte volume) {
 }
 
 byte MixerImpl::getChannelVolume(SoundHandle handle) {
+	if (_lockFree)
+		return ownsSlot(handle) ? _channelState[handle._val % NUM_CHANNELS].volume.load() : 0;
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -404,6 +651,14 @@ byte MixerImpl::getChannelVolume(SoundHandle handle) {
 }
 
 void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
+	if (_lockFree) {
+		if (!ownsSlot(handle))
+			return;
+		_channelState[handle._val % NUM_CHANNELS].balance.store(balance);
+		postCommand(ChannelCommand(ChannelCommand::kSetBalance, handle._val, balance));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -414,6 +669,9 @@ void MixerImpl::setChannelBalance(SoundHandle handle, int8 balance) {
 }
 
 int8 MixerImpl::getChannelBalance(SoundHandle handle) {
+	if (_lockFree)
+		return ownsSlot(handle) ? _channelState[handle._val % NUM_CHANNELS].balance.load() : 0;
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -422,6 +680,14 @@ int8 MixerImpl::getChannelBalance(SoundHandle handle) {
 }
 
 void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
+	if (_lockFree) {
+		if (!ownsSlot(handle))
+			return;
+		_channelState[handle._val % NUM_CHANNELS].rate.store(rate);
+		postCommand(ChannelCommand(ChannelCommand::kSetRate, handle._val, rate));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -432,6 +698,9 @@ void MixerImpl::setChannelRate(SoundHandle handle, uint32 rate) {
 }
 
 uint32 MixerImpl::getChannelRate(SoundHandle handle) {
+	if (_lockFree)
+		return ownsSlot(handle) ? _channelState[handle._val % NUM_CHANNELS].rate.load() : 0;
+
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
 		return 0;
@@ -440,6 +709,15 @@ uint32 MixerImpl::getChannelRate(SoundHandle handle) {
 }
 
 void MixerImpl::resetChannelRate(SoundHandle handle) {
+	if (_lockFree) {
+		if (!ownsSlot(handle))
+			return;
+		ChannelState &state = _channelState[handle._val % NUM_CHANNELS];
+		state.rate.store(state.nativeRate.load());
+		postCommand(ChannelCommand(ChannelCommand::kResetRate, handle._val, 0));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	const int index = handle._val % NUM_CHANNELS;
@@ -455,6 +733,7 @@ uint32 MixerImpl::getSoundElapsedTime(SoundHandle handle) {
 
 Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -465,6 +744,7 @@ Timestamp MixerImpl::getElapsedTime(SoundHandle handle) {
 
 void MixerImpl::loopChannel(SoundHandle handle) {
 	Common::StackLock lock(_mutex);
+	processCommands();
 
 	const int index = handle._val % NUM_CHANNELS;
 	if (!_channels[index] || _channels[index]->getHandle()._val != handle._val)
@@ -474,6 +754,11 @@ void MixerImpl::loopChannel(SoundHandle handle) {
 }
 
 void MixerImpl::pauseAll(bool paused) {
+	if (_lockFree) {
+		postCommand(ChannelCommand(ChannelCommand::kPauseAll, 0, paused));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr) {
@@ -483,6 +768,11 @@ void MixerImpl::pauseAll(bool paused) {
 }
 
 void MixerImpl::pauseID(int id, bool paused) {
+	if (_lockFree) {
+		postCommand(ChannelCommand(ChannelCommand::kPauseID, (uint32)id, paused));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++) {
 		if (_channels[i] != nullptr && _channels[i]->getId() == id) {
@@ -493,6 +783,12 @@ void MixerImpl::pauseID(int id, bool paused) {
 }
 
 void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
+	if (_lockFree) {
+		if (ownsSlot(handle))
+			postCommand(ChannelCommand(ChannelCommand::kPause, handle._val, paused));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 
 	// Simply ignore (un)pause requests for sounds that already terminated
@@ -504,6 +800,18 @@ void MixerImpl::pauseHandle(SoundHandle handle, bool paused) {
 }
 
 bool MixerImpl::isSoundIDActive(int id) {
+	if (_lockFree) {
+#ifdef ENABLE_EVENTRECORDER
+		g_eventRec.updateSubsystems();
+#endif
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			const uint32 slot = _channelState[i].handle.load();
+			if (slot != kFreeSlot && slot != kClaimedSlot && _channelState[i].id.load() == id)
+				return true;
+		}
+		return false;
+	}
+
 	Common::StackLock lock(_mutex);
 
 #ifdef ENABLE_EVENTRECORDER
@@ -517,6 +825,9 @@ bool MixerImpl::isSoundIDActive(int id) {
 }
 
 int MixerImpl::getSoundID(SoundHandle handle) {
+	if (_lockFree)
+		return ownsSlot(handle) ? _channelState[handle._val % NUM_CHANNELS].id.load() : 0;
+
 	Common::StackLock lock(_mutex);
 	const int index = handle._val % NUM_CHANNELS;
 	if (_channels[index] && _channels[index]->getHandle()._val == handle._val)
@@ -525,6 +836,13 @@ int MixerImpl::getSoundID(SoundHandle handle) {
 }
 
 bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
+	if (_lockFree) {
+#ifdef ENABLE_EVENTRECORDER
+		g_eventRec.updateSubsystems();
+#endif
+		return ownsSlot(handle);
+	}
+
 	Common::StackLock lock(_mutex);
 
 #ifdef ENABLE_EVENTRECORDER
@@ -536,6 +854,15 @@ bool MixerImpl::isSoundHandleActive(SoundHandle handle) {
 }
 
 bool MixerImpl::hasActiveChannelOfType(SoundType type) {
+	if (_lockFree) {
+		for (int i = 0; i != NUM_CHANNELS; i++) {
+			const uint32 slot = _channelState[i].handle.load();
+			if (slot != kFreeSlot && slot != kClaimedSlot && _channelState[i].type.load() == type)
+				return true;
+		}
+		return false;
+	}
+
 	Common::StackLock lock(_mutex);
 	for (int i = 0; i != NUM_CHANNELS; i++)
 		if (_channels[i] && _channels[i]->getType() == type)
@@ -552,12 +879,19 @@ void MixerImpl::setVolumeForSoundType(SoundType type, int volume) {
 	// TODO: Maybe we should do logarithmic (not linear) volume
 	// scaling? See also Player_V2::setMasterVolume
 
+	// The mixing thread only sees the volume carried by the command
+	if (_lockFree) {
+		_soundTypeSettings[type].volume = volume;
+		postCommand(ChannelCommand(ChannelCommand::kGlobalVolume, type, volume));
+		return;
+	}
+
 	Common::StackLock lock(_mutex);
 	_soundTypeSettings[type].volume = volume;
 
 	for (int i = 0; i != NUM_CHANNELS; ++i) {
 		if (_channels[i] && _channels[i]->getType() == type)
-			_channels[i]->notifyGlobalVolChange();
+			_channels[i]->setSoundTypeVolume(volume);
 	}
 }
 
@@ -573,16 +907,20 @@ int MixerImpl::getVolumeForSoundType(SoundType type) const {
 #pragma mark -
 
 Channel::Channel(Mixer *mixer, Mixer::SoundType type, AudioStream *stream,
-				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent)
+				 DisposeAfterUse::Flag autofreeStream, bool reverseStereo, int id, bool permanent,
+				 RateConverterType converterType)
 	: _type(type), _mixer(mixer), _id(id), _permanent(permanent), _volume(Mixer::kMaxChannelVolume),
-	  _balance(0), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
+	  _balance(0), _reverseStereo(false), _soundTypeVolume(mixer->getVolumeForSoundType(type)), _soundTypeMute(mixer->isSoundTypeMuted(type)), _pauseLevel(0), _samplesConsumed(0), _samplesDecoded(0), _mixerTimeStamp(0),
 	  _pauseStartTime(0), _pauseTime(0), _converter(nullptr), _volL(0), _volR(0),
 	  _stream(stream, autofreeStream) {
 	assert(mixer);
 	assert(stream);
 
 	// Get a rate converter instance
-	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo);
+	_converter = makeRateConverter(_stream->getRate(), mixer->getOutputRate(), _stream->isStereo(), mixer->getOutputStereo(), reverseStereo, converterType);
+
+	// The converter only swaps the sides for stereo input
+	_reverseStereo = reverseStereo && _stream->isStereo() && mixer->getOutputStereo();
 }
 
 Channel::~Channel() {
@@ -634,8 +972,8 @@ void Channel::updateChannelVolumes() {
 	// volume is in the range 0 - kMaxMixerVolume.
 	// Hence, the vol_l/vol_r values will be in that range, too
 
-	if (!_mixer->isSoundTypeMuted(_type)) {
-		int vol = _mixer->getVolumeForSoundType(_type) * _volume;
+	if (!_soundTypeMute) {
+		int vol = _soundTypeVolume * _volume;
 
 		if (_balance == 0) {
 			_volL = vol / Mixer::kMaxChannelVolume;
@@ -707,7 +1045,7 @@ void Channel::loop() {
 	}
 }
 
-int Channel::mix(int16 *data, uint len) {
+int Channel::mix(int16 *data, uint len, int16 *scratch) {
 	assert(_stream);
 	assert(_converter);
 
@@ -716,7 +1054,22 @@ int Channel::mix(int16 *data, uint len) {
 		_samplesConsumed = _samplesDecoded;
 		_mixerTimeStamp = g_system->getMillis(true);
 		_pauseTime = 0;
-		res = _converter->convert(*_stream, data, len, _volL, _volR);
+		if (scratch) {
+			// Resample at full volume, which leaves the samples untouched,
+			// and let the kernels scale and accumulate them. The converter
+			// has already swapped the sides if requested, so the volumes
+			// have to follow.
+			memset(scratch, 0, len * 2 * sizeof(int16));
+			res = _converter->convert(*_stream, scratch, len, Mixer::kMaxMixerVolume, Mixer::kMaxMixerVolume);
+			if (res > 0 && (_volL || _volR)) {
+				if (_reverseStereo)
+					MixerKernels::mixStereo(data, scratch, res, _volR, _volL);
+				else
+					MixerKernels::mixStereo(data, scratch, res, _volL, _volR);
+			}
+		} else {
+			res = _converter->convert(*_stream, data, len, _volL, _volR);
+		}
 		_samplesDecoded += res;
 	}
 
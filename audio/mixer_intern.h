@@ -23,8 +23,11 @@
 #define AUDIO_MIXER_INTERN_H
 
 #include "common/scummsys.h"
+#include "common/atomic.h"
+#include "common/lockfree-queue.h"
 #include "common/mutex.h"
 #include "audio/mixer.h"
+#include "audio/rate.h"
 
 namespace Audio {
 
@@ -49,6 +52,15 @@ namespace Audio {
  * 4) Change the mixer into ready mode via setReady(true).
  * 5) Start audio processing (e.g. by resuming the audio thread, if applicable).
  *
+ * Backends may also enable lock-free channel control via
+ * setLockFreeControl() before setReady(). In that mode, channel volume,
+ * balance, rate and pause requests as well as new channels are handed to
+ * the mixing thread through a lock-free command queue, queries are answered
+ * from per-channel state published by the mixer, and the volume scaling is
+ * done by the vectorized MixerKernels. Requests which must not return before
+ * the mixing thread has let go of a stream (stopping channels, looping and
+ * elapsed time queries) still take the mutex.
+ *
  * In the future, we might make it possible for backends to provide
  * (partial) alternative implementations of the mixer, e.g. to make
  * better use of native sound mixing support on low-end devices.
@@ -58,7 +70,8 @@ namespace Audio {
 class MixerImpl : public Mixer {
 private:
 	enum {
-		NUM_CHANNELS = 32
+		NUM_CHANNELS = 32,
+		COMMAND_QUEUE_SIZE = 256
 	};
 
 	Common::Mutex _mutex;
@@ -67,7 +80,9 @@ private:
 	const bool _stereo;
 	const uint _outBufSize;
 	bool _mixerReady;
-	uint32 _handleSeed;
+	bool _lockFree;
+	RateConverterType _rateConverterType;
+	Common::Atomic<uint32> _handleSeed;
 
 	struct SoundTypeSettings {
 		SoundTypeSettings() : mute(false), volume(kMaxMixerVolume) {}
@@ -79,6 +94,54 @@ private:
 	SoundTypeSettings _soundTypeSettings[4];
 	Channel *_channels[NUM_CHANNELS];
 
+	/**
+	 * Channel state published for lock-free queries. A slot is owned by
+	 * the handle stored in it; kFreeSlot marks a slot which may be claimed
+	 * by playStream().
+	 */
+	struct ChannelState {
+		Common::Atomic<uint32> handle;
+		Common::Atomic<int32> id;
+		Common::Atomic<int32> type;
+		Common::Atomic<int32> volume;
+		Common::Atomic<int32> balance;
+		Common::Atomic<uint32> rate;
+		Common::Atomic<uint32> nativeRate;
+	};
+
+	static const uint32 kFreeSlot = 0xFFFFFFFF;
+	static const uint32 kClaimedSlot = 0xFFFFFFFE;
+
+	ChannelState _channelState[NUM_CHANNELS];
+
+	struct ChannelCommand {
+		enum Type {
+			kInsert,
+			kSetVolume,
+			kSetBalance,
+			kSetRate,
+			kResetRate,
+			kPause,
+			kPauseAll,
+			kPauseID,
+			kGlobalVolume,
+			kGlobalMute
+		};
+
+		ChannelCommand() : type(kInsert), handle(0), value(0), channel(nullptr) {}
+		ChannelCommand(Type t, uint32 h, int32 v, Channel *c = nullptr) : type(t), handle(h), value(v), channel(c) {}
+
+		Type type;
+		uint32 handle;
+		int32 value;
+		Channel *channel;
+	};
+
+	Common::LockFreeQueue<ChannelCommand, COMMAND_QUEUE_SIZE> _commands;
+
+	/** Scratch buffer the channels are resampled into before the volume kernels run. */
+	int16 *_mixBuffer;
+	uint _mixBufferSize;
 
 public:
 
@@ -139,6 +202,30 @@ public:
 protected:
 	void insertChannel(SoundHandle *handle, Channel *chan);
 
+	void playStreamLockFree(
+		SoundType type,
+		SoundHandle *handle,
+		AudioStream *input,
+		int id, byte volume, int8 balance,
+		DisposeAfterUse::Flag autofreeStream,
+		bool permanent,
+		bool reverseStereo);
+
+	/** Whether @p handle currently owns its channel slot, as seen by lock-free queries. */
+	bool ownsSlot(SoundHandle handle) const;
+	Channel *findChannel(uint32 handle) const;
+	void deleteChannel(int index);
+	void publishChannel(int index, Channel *chan);
+
+	/**
+	 * Queue a channel command for the mixing thread. If the queue is full,
+	 * the command is applied directly under the mixer mutex.
+	 */
+	void postCommand(const ChannelCommand &cmd);
+	void applyCommand(const ChannelCommand &cmd);
+	/** Apply all pending channel commands. Must be called with the mutex held. */
+	void processCommands();
+
 public:
 	/**
 	 * The mixer callback function, to be called at regular intervals by
@@ -157,6 +244,27 @@ public:
 	 * their audio system has been completed.
 	 */
 	void setReady(bool ready);
+
+	/**
+	 * Enable or disable lock-free channel control and the vectorized
+	 * mixing path. Must be called before the mixer is set ready.
+	 */
+	void setLockFreeControl(bool enable);
+
+	/**
+	 * Query whether lock-free channel control is enabled.
+	 */
+	bool isLockFreeControl() const { return _lockFree; }
+
+	/**
+	 * Select the resampling algorithm used for channels started from now on.
+	 */
+	void setRateConverterType(RateConverterType type);
+
+	/**
+	 * Query the resampling algorithm used for new channels.
+	 */
+	RateConverterType getRateConverterType() const { return _rateConverterType; }
 };
 
 /** @} */
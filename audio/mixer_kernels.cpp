@@ -0,0 +1,72 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/system.h"
+
+#include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
+#include "audio/rate.h"
+
+namespace Audio {
+
+MixerKernels::MixStereoFunc MixerKernels::_mixStereoFunc = nullptr;
+MixerKernels::DotProductFunc MixerKernels::_dotProductFunc = nullptr;
+
+void MixerKernels::mixStereoGeneric(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR) {
+	for (uint i = 0; i < numPairs; ++i) {
+		clampedAdd(dst[0], (src[0] * (int)volL) / Mixer::kMaxMixerVolume);
+		clampedAdd(dst[1], (src[1] * (int)volR) / Mixer::kMaxMixerVolume);
+		dst += 2;
+		src += 2;
+	}
+}
+
+int32 MixerKernels::dotProductGeneric(const int16 *samples, const int16 *coeffs, uint count) {
+	int32 sum = 0;
+	for (uint i = 0; i < count; ++i)
+		sum += samples[i] * coeffs[i];
+	return sum;
+}
+
+void MixerKernels::selectImplementation() {
+	_mixStereoFunc = mixStereoGeneric;
+	_dotProductFunc = dotProductGeneric;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) {
+		_mixStereoFunc = mixStereoNEON;
+		_dotProductFunc = dotProductNEON;
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) {
+		_mixStereoFunc = mixStereoSSE2;
+		_dotProductFunc = dotProductSSE2;
+	}
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) {
+		_mixStereoFunc = mixStereoAVX2;
+		_dotProductFunc = dotProductAVX2;
+	}
+#endif
+}
+
+} // End of namespace Audio
@@ -0,0 +1,105 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIO_MIXER_KERNELS_H
+#define AUDIO_MIXER_KERNELS_H
+
+#include "common/scummsys.h"
+
+class MixerTestSuite;
+class RateConverterTestSuite;
+
+namespace Audio {
+
+/**
+ * Vectorized inner loops used by the mixer and the rate converters.
+ *
+ * The mixing kernel adds a block of interleaved stereo samples, scaled by a
+ * per-side volume in the range 0 - Mixer::kMaxMixerVolume, into the mix
+ * buffer with saturation. The result is bit-exact with the scalar code in
+ * RateConverter, i.e. the scaled sample is truncated towards zero before
+ * being added.
+ *
+ * The dot product kernel is the FIR filter loop of the polyphase resampler.
+ */
+class MixerKernels {
+public:
+	typedef void (*MixStereoFunc)(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR);
+	typedef int32 (*DotProductFunc)(const int16 *samples, const int16 *coeffs, uint count);
+
+	/**
+	 * Mix @p numPairs stereo sample pairs from @p src into @p dst.
+	 * The best implementation supported by the host CPU is picked on
+	 * first use.
+	 */
+	static void mixStereo(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR) {
+		if (!_mixStereoFunc)
+			selectImplementation();
+		_mixStereoFunc(dst, src, numPairs, volL, volR);
+	}
+
+	/**
+	 * Return the sum of the products of @p count samples and coefficients.
+	 * @p count must be a multiple of 16.
+	 */
+	static int32 dotProduct(const int16 *samples, const int16 *coeffs, uint count) {
+		if (!_dotProductFunc)
+			selectImplementation();
+		return _dotProductFunc(samples, coeffs, count);
+	}
+
+	/**
+	 * Return the dot product implementation for the host CPU, for callers
+	 * which want to avoid the indirection check in tight loops.
+	 */
+	static DotProductFunc getDotProduct() {
+		if (!_dotProductFunc)
+			selectImplementation();
+		return _dotProductFunc;
+	}
+
+private:
+	static void mixStereoGeneric(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR);
+	static int32 dotProductGeneric(const int16 *samples, const int16 *coeffs, uint count);
+#ifdef SCUMMVM_SSE2
+	static void mixStereoSSE2(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR);
+	static int32 dotProductSSE2(const int16 *samples, const int16 *coeffs, uint count);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void mixStereoAVX2(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR);
+	static int32 dotProductAVX2(const int16 *samples, const int16 *coeffs, uint count);
+#endif
+#ifdef SCUMMVM_NEON
+	static void mixStereoNEON(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR);
+	static int32 dotProductNEON(const int16 *samples, const int16 *coeffs, uint count);
+#endif
+
+	static void selectImplementation();
+
+	static MixStereoFunc _mixStereoFunc;
+	static DotProductFunc _dotProductFunc;
+	friend class ::MixerTestSuite;
+	friend class ::RateConverterTestSuite;
+};
+
+} // End of namespace Audio
+
+#endif
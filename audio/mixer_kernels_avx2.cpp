@@ -0,0 +1,87 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/mixer_kernels.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Audio {
+
+// Divide 32-bit products by 256, rounding towards zero like the C division
+// in the scalar path does.
+static FORCEINLINE __m256i avx2_div256(__m256i p) {
+	__m256i bias = _mm256_and_si256(_mm256_srai_epi32(p, 31), _mm256_set1_epi32(255));
+	return _mm256_srai_epi32(_mm256_add_epi32(p, bias), 8);
+}
+
+void MixerKernels::mixStereoAVX2(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR) {
+	// Interleaved L/R volumes, matching the sample layout
+	const __m256i vol = _mm256_set1_epi32(((uint32)volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 8 <= numPairs; i += 8) {
+		__m256i s = _mm256_loadu_si256((const __m256i *)(src + i * 2));
+		__m256i d = _mm256_loadu_si256((const __m256i *)(dst + i * 2));
+
+		// Unpack and pack both work per 128-bit lane, so the sample
+		// order is preserved without any cross-lane shuffles.
+		__m256i lo = _mm256_mullo_epi16(s, vol);
+		__m256i hi = _mm256_mulhi_epi16(s, vol);
+		__m256i p0 = avx2_div256(_mm256_unpacklo_epi16(lo, hi));
+		__m256i p1 = avx2_div256(_mm256_unpackhi_epi16(lo, hi));
+
+		d = _mm256_adds_epi16(d, _mm256_packs_epi32(p0, p1));
+		_mm256_storeu_si256((__m256i *)(dst + i * 2), d);
+	}
+
+	mixStereoGeneric(dst + i * 2, src + i * 2, numPairs - i, volL, volR);
+}
+
+int32 MixerKernels::dotProductAVX2(const int16 *samples, const int16 *coeffs, uint count) {
+	__m256i sum = _mm256_setzero_si256();
+	for (uint i = 0; i < count; i += 16) {
+		__m256i s = _mm256_loadu_si256((const __m256i *)(samples + i));
+		__m256i c = _mm256_loadu_si256((const __m256i *)(coeffs + i));
+		sum = _mm256_add_epi32(sum, _mm256_madd_epi16(s, c));
+	}
+
+	__m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum128 = _mm_add_epi32(sum128, _mm_shuffle_epi32(sum128, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum128);
+}
+
+} // End of namespace Audio
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
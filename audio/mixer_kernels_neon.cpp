@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "audio/mixer_kernels.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__) && !defined(__ARM_NEON)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__) && !defined(__ARM_NEON)
+
+namespace Audio {
+
+// Divide 32-bit products by 256, rounding towards zero like the C division
+// in the scalar path does.
+static FORCEINLINE int32x4_t neon_div256(int32x4_t p) {
+	int32x4_t bias = vandq_s32(vshrq_n_s32(p, 31), vdupq_n_s32(255));
+	return vshrq_n_s32(vaddq_s32(p, bias), 8);
+}
+
+void MixerKernels::mixStereoNEON(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR) {
+	// Interleaved L/R volumes, matching the sample layout
+	const int16 volPair[4] = { (int16)volL, (int16)volR, (int16)volL, (int16)volR };
+	const int16x4_t vol = vld1_s16(volPair);
+
+	uint i = 0;
+	for (; i + 4 <= numPairs; i += 4) {
+		int16x8_t s = vld1q_s16(src + i * 2);
+		int16x8_t d = vld1q_s16(dst + i * 2);
+
+		int32x4_t p0 = neon_div256(vmull_s16(vget_low_s16(s), vol));
+		int32x4_t p1 = neon_div256(vmull_s16(vget_high_s16(s), vol));
+
+		d = vqaddq_s16(d, vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1)));
+		vst1q_s16(dst + i * 2, d);
+	}
+
+	mixStereoGeneric(dst + i * 2, src + i * 2, numPairs - i, volL, volR);
+}
+
+int32 MixerKernels::dotProductNEON(const int16 *samples, const int16 *coeffs, uint count) {
+	int32x4_t sum = vdupq_n_s32(0);
+	for (uint i = 0; i < count; i += 8) {
+		int16x8_t s = vld1q_s16(samples + i);
+		int16x8_t c = vld1q_s16(coeffs + i);
+		sum = vmlal_s16(sum, vget_low_s16(s), vget_low_s16(c));
+		sum = vmlal_s16(sum, vget_high_s16(s), vget_high_s16(c));
+	}
+
+	int32x2_t pair = vadd_s32(vget_low_s32(sum), vget_high_s32(sum));
+	return vget_lane_s32(vpadd_s32(pair, pair), 0);
+}
+
+} // End of namespace Audio
+
+#if !defined(__aarch64__) && !defined(__ARM_NEON)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__) && !defined(__ARM_NEON)
+
+#endif // SCUMMVM_NEON
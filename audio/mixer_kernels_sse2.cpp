@@ -0,0 +1,95 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "audio/mixer_kernels.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Audio {
+
+// Divide 32-bit products by 256, rounding towards zero like the C division
+// in the scalar path does.
+static FORCEINLINE __m128i sse2_div256(__m128i p) {
+	__m128i bias = _mm_and_si128(_mm_srai_epi32(p, 31), _mm_set1_epi32(255));
+	return _mm_srai_epi32(_mm_add_epi32(p, bias), 8);
+}
+
+void MixerKernels::mixStereoSSE2(int16 *dst, const int16 *src, uint numPairs, uint16 volL, uint16 volR) {
+	// Interleaved L/R volumes, matching the sample layout
+	const __m128i vol = _mm_set1_epi32(((uint32)volR << 16) | volL);
+
+	uint i = 0;
+	for (; i + 4 <= numPairs; i += 4) {
+		__m128i s = _mm_loadu_si128((const __m128i *)(src + i * 2));
+		__m128i d = _mm_loadu_si128((const __m128i *)(dst + i * 2));
+
+		__m128i lo = _mm_mullo_epi16(s, vol);
+		__m128i hi = _mm_mulhi_epi16(s, vol);
+		__m128i p0 = sse2_div256(_mm_unpacklo_epi16(lo, hi));
+		__m128i p1 = sse2_div256(_mm_unpackhi_epi16(lo, hi));
+
+		d = _mm_adds_epi16(d, _mm_packs_epi32(p0, p1));
+		_mm_storeu_si128((__m128i *)(dst + i * 2), d);
+	}
+
+	mixStereoGeneric(dst + i * 2, src + i * 2, numPairs - i, volL, volR);
+}
+
+int32 MixerKernels::dotProductSSE2(const int16 *samples, const int16 *coeffs, uint count) {
+	__m128i sum = _mm_setzero_si128();
+	for (uint i = 0; i < count; i += 16) {
+		__m128i s0 = _mm_loadu_si128((const __m128i *)(samples + i));
+		__m128i s1 = _mm_loadu_si128((const __m128i *)(samples + i + 8));
+		__m128i c0 = _mm_loadu_si128((const __m128i *)(coeffs + i));
+		__m128i c1 = _mm_loadu_si128((const __m128i *)(coeffs + i + 8));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s0, c0));
+		sum = _mm_add_epi32(sum, _mm_madd_epi16(s1, c1));
+	}
+
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(sum);
+}
+
+} // End of namespace Audio
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
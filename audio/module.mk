@@ -19,6 +19,7 @@ MODULE_OBJS := \
 	miles_adlib.o \
 	miles_midi.o \
 	mixer.o \
+	mixer_kernels.o \
 	mpu401.o \
 	mt32gm.o \
 	musicplugin.o \
@@ -132,5 +133,18 @@ MODULE_OBJS += \
 	soundfont/vab/vab.o
 endif
 
+ifdef SCUMMVM_NEON
+MODULE_OBJS += \
+	mixer_kernels_neon.o
+endif
+ifdef SCUMMVM_SSE2
+MODULE_OBJS += \
+	mixer_kernels_sse2.o
+endif
+ifdef SCUMMVM_AVX2
+MODULE_OBJS += \
+	mixer_kernels_avx2.o
+endif
+
 # Include common rules
 include $(srcdir)/rules.mk
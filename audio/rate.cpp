@@ -30,6 +30,7 @@
 #include "audio/audiostream.h"
 #include "audio/rate.h"
 #include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
 #include "common/util.h"
 
 namespace Audio {
@@ -112,6 +113,19 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::copyConvert(AudioStr
 				return (outBuffer - outStart) / (outStereo ? 2 : 1);
 		}
 
+#ifndef OUTPUT_UNSIGNED_AUDIO
+		// Stereo to stereo without swapping is a plain scaled add, which
+		// the mixer kernels do a whole block at a time
+		if (inStereo && outStereo && !reverseStereo) {
+			const int pairs = MIN<int>(_bufferSize, outEnd - outBuffer) / 2;
+			MixerKernels::mixStereo(outBuffer, _bufferPos, pairs, volL, volR);
+			_bufferPos += pairs * 2;
+			_bufferSize -= pairs * 2;
+			outBuffer += pairs * 2;
+			continue;
+		}
+#endif
+
 		// Mix the data into the output buffer
 		st_sample_t inL, inR;
 		inL = *_bufferPos++;
@@ -297,21 +311,285 @@ int RateConverter_Impl<inStereo, outStereo, reverseStereo>::convert(AudioStream
 	}
 }
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
+/**
+ * Band-limited resampler using a windowed-sinc FIR filter.
+ *
+ * The filter is stored as a table of NUM_PHASES sub-filters of NUM_TAPS
+ * coefficients each (Q15), one for every fractional position between two
+ * input samples. Each output sample is the dot product of NUM_TAPS input
+ * samples with the sub-filter of the nearest phase, which is what the
+ * vectorized MixerKernels::dotProduct() computes.
+ *
+ * Input is read in large blocks and de-interleaved into per-channel history
+ * buffers, so the filter loop works on contiguous memory and as many output
+ * samples as the history allows are produced in one go.
+ */
+template<bool inStereo, bool outStereo, bool reverseStereo>
+class PolyphaseRateConverter : public RateConverter {
+private:
+	enum {
+		NUM_TAPS = 16,
+		NUM_PHASES = 256,
+		HISTORY_SIZE = 1024
+	};
+
+	/** Input and output rates */
+	st_rate_t _inRate, _outRate;
+
+	/** Whole input samples to advance per output sample */
+	uint32 _step;
+	/** Remaining fraction of the advance, in units of 1/_outRate */
+	uint32 _stepFrac;
+
+	/** Fractional position of the next output sample, in units of 1/_outRate */
+	uint32 _posFrac;
+
+	/** Cut-off frequency the filter table was built for, relative to the input Nyquist frequency */
+	double _cutoff;
+	int16 _filter[NUM_PHASES][NUM_TAPS];
+
+	/** De-interleaved input history */
+	st_sample_t _historyL[HISTORY_SIZE + NUM_TAPS];
+	st_sample_t _historyR[HISTORY_SIZE + NUM_TAPS];
+	/** Index of the first tap of the next output sample */
+	uint _historyPos;
+	/** Number of valid samples in the history */
+	uint _historyEnd;
+
+	/** Whether the end of the input has been padded with silence */
+	bool _flushed;
+
+	st_sample_t _readBuffer[HISTORY_SIZE * 2];
+
+	MixerKernels::DotProductFunc _dotProduct;
+
+	void updateStep();
+	void buildFilter(double cutoff);
+	bool fillHistory(AudioStream &input);
+
+	inline st_sample_t filter(const st_sample_t *history, const int16 *coeffs) const {
+		int32 val = (_dotProduct(history, coeffs, NUM_TAPS) + (1 << 14)) >> 15;
+		return (st_sample_t)CLIP<int32>(val, ST_SAMPLE_MIN, ST_SAMPLE_MAX);
+	}
+
+public:
+	PolyphaseRateConverter(st_rate_t inputRate, st_rate_t outputRate);
+	virtual ~PolyphaseRateConverter() {}
+
+	int convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t vol_l, st_volume_t vol_r) override;
+
+	void setInputRate(st_rate_t inputRate) override { _inRate = inputRate; updateStep(); }
+	void setOutputRate(st_rate_t outputRate) override { _outRate = outputRate; updateStep(); }
+
+	st_rate_t getInputRate() const override { return _inRate; }
+	st_rate_t getOutputRate() const override { return _outRate; }
+
+	bool needsDraining() const override {
+		return _historyPos + NUM_TAPS <= _historyEnd || (!_flushed && _historyEnd > NUM_TAPS / 2 - 1);
+	}
+};
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+PolyphaseRateConverter<inStereo, outStereo, reverseStereo>::PolyphaseRateConverter(st_rate_t inputRate, st_rate_t outputRate) :
+	_inRate(inputRate),
+	_outRate(outputRate),
+	_step(0),
+	_stepFrac(0),
+	_posFrac(0),
+	_cutoff(0.0),
+	_historyPos(0),
+	_historyEnd(NUM_TAPS / 2 - 1),
+	_flushed(true) {
+
+	// Start with the filter centered on the first input sample
+	memset(_historyL, 0, sizeof(_historyL));
+	memset(_historyR, 0, sizeof(_historyR));
+
+	_dotProduct = MixerKernels::getDotProduct();
+	updateStep();
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void PolyphaseRateConverter<inStereo, outStereo, reverseStereo>::updateStep() {
+	assert(_outRate > 0);
+
+	_step = _inRate / _outRate;
+	_stepFrac = _inRate % _outRate;
+	_posFrac %= _outRate;
+
+	// When downsampling, the cut-off has to move down to the output Nyquist
+	// frequency. It is quantized so that small rate changes, as done by
+	// engines for pitch effects, do not rebuild the table every time.
+	double cutoff = 0.95;
+	if (_inRate > _outRate)
+		cutoff *= floor((double)_outRate / _inRate * 64.0) / 64.0;
+	cutoff = MAX(cutoff, 1.0 / 64.0);
+
+	if (cutoff != _cutoff)
+		buildFilter(cutoff);
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+void PolyphaseRateConverter<inStereo, outStereo, reverseStereo>::buildFilter(double cutoff) {
+	_cutoff = cutoff;
+
+	for (int phase = 0; phase < NUM_PHASES; ++phase) {
+		const double frac = (double)phase / NUM_PHASES;
+		double taps[NUM_TAPS];
+		double sum = 0.0;
+
+		for (int i = 0; i < NUM_TAPS; ++i) {
+			// Distance between the output sample and input sample i
+			const double x = i - (NUM_TAPS / 2 - 1) - frac;
+			const double sinc = (x == 0.0) ? 1.0 : sin(M_PI * cutoff * x) / (M_PI * cutoff * x);
+
+			// Blackman window spanning the filter
+			const double t = (x + NUM_TAPS / 2) / NUM_TAPS;
+			const double window = 0.42 - 0.5 * cos(2.0 * M_PI * t) + 0.08 * cos(4.0 * M_PI * t);
+
+			taps[i] = sinc * window;
+			sum += taps[i];
+		}
+
+		// Normalize each phase to unity gain, and put the rounding error
+		// into the largest tap so that DC passes through unchanged
+		int total = 0, largest = 0;
+		for (int i = 0; i < NUM_TAPS; ++i) {
+			_filter[phase][i] = (int16)floor(taps[i] / sum * 32768.0 + 0.5);
+			total += _filter[phase][i];
+			if (_filter[phase][i] > _filter[phase][largest])
+				largest = i;
+		}
+		_filter[phase][largest] += 32768 - total;
+	}
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+bool PolyphaseRateConverter<inStereo, outStereo, reverseStereo>::fillHistory(AudioStream &input) {
+	// Move the samples still needed to the start of the history
+	if (_historyPos > 0) {
+		const uint remaining = _historyEnd - MIN(_historyPos, _historyEnd);
+		memmove(_historyL, _historyL + _historyEnd - remaining, remaining * sizeof(st_sample_t));
+		if (inStereo)
+			memmove(_historyR, _historyR + _historyEnd - remaining, remaining * sizeof(st_sample_t));
+		_historyPos -= _historyEnd - remaining;
+		_historyEnd = remaining;
+	}
+
+	const uint space = HISTORY_SIZE + NUM_TAPS - _historyEnd;
+	const int read = input.readBuffer(_readBuffer, MIN<uint>(space, HISTORY_SIZE) * (inStereo ? 2 : 1));
+
+	if (read <= 0) {
+		// A stream which has run dry for now, like a queuing stream waiting
+		// for more data, continues later on without a gap
+		if (_flushed || !input.endOfStream())
+			return false;
+
+		// Pad the end of the input with silence so that the last input
+		// samples make it through the filter
+		const uint pad = MIN<uint>(NUM_TAPS / 2, space);
+		memset(_historyL + _historyEnd, 0, pad * sizeof(st_sample_t));
+		if (inStereo)
+			memset(_historyR + _historyEnd, 0, pad * sizeof(st_sample_t));
+		_historyEnd += pad;
+		_flushed = true;
+		return true;
+	}
+
+	_flushed = false;
+	if (inStereo) {
+		const st_sample_t *src = _readBuffer;
+		for (int i = 0; i < read / 2; ++i) {
+			_historyL[_historyEnd + i] = *src++;
+			_historyR[_historyEnd + i] = *src++;
+		}
+		_historyEnd += read / 2;
+	} else {
+		memcpy(_historyL + _historyEnd, _readBuffer, read * sizeof(st_sample_t));
+		_historyEnd += read;
+	}
+
+	return true;
+}
+
+template<bool inStereo, bool outStereo, bool reverseStereo>
+int PolyphaseRateConverter<inStereo, outStereo, reverseStereo>::convert(AudioStream &input, st_sample_t *outBuffer, st_size_t numSamples, st_volume_t volL, st_volume_t volR) {
+	assert(input.isStereo() == inStereo);
+
+	st_sample_t *outStart, *outEnd;
+	outStart = outBuffer;
+	outEnd = outBuffer + numSamples * (outStereo ? 2 : 1);
+
+	while (outBuffer < outEnd) {
+		if (_historyPos + NUM_TAPS > _historyEnd && !fillHistory(input))
+			break;
+
+		// Produce as many output samples as the history allows
+		while (_historyPos + NUM_TAPS <= _historyEnd && outBuffer < outEnd) {
+			// Round to the nearest phase. Past the last one, the nearest
+			// would be the first phase of the next input sample, which the
+			// last one is close enough to.
+			const uint32 phase = (uint32)(((uint64)_posFrac * NUM_PHASES + _outRate / 2) / _outRate);
+			const int16 *coeffs = _filter[MIN<uint32>(phase, NUM_PHASES - 1)];
+
+			st_sample_t inL, inR;
+			inL = filter(_historyL + _historyPos, coeffs);
+			inR = (inStereo ? filter(_historyR + _historyPos, coeffs) : inL);
+
+			st_sample_t outL, outR;
+			outL = (inL * (int)volL) / Audio::Mixer::kMaxMixerVolume;
+			outR = (inR * (int)volR) / Audio::Mixer::kMaxMixerVolume;
+
+			if (outStereo) {
+				// Output left channel
+				clampedAdd(outBuffer[reverseStereo    ], outL);
+
+				// Output right channel
+				clampedAdd(outBuffer[reverseStereo ^ 1], outR);
+
+				outBuffer += 2;
+			} else {
+				// Output mono channel
+				clampedAdd(outBuffer[0], (outL + outR) / 2);
+
+				outBuffer += 1;
+			}
+
+			// Advance the input position
+			_historyPos += _step;
+			_posFrac += _stepFrac;
+			if (_posFrac >= _outRate) {
+				_posFrac -= _outRate;
+				_historyPos++;
+			}
+		}
+	}
+
+	return (outBuffer - outStart) / (outStereo ? 2 : 1);
+}
+
+template<template<bool, bool, bool> class T>
+static RateConverter *makeRateConverterT(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo) {
 	if (inStereo) {
 		if (outStereo) {
 			if (reverseStereo)
-				return new RateConverter_Impl<true, true, true>(inRate, outRate);
+				return new T<true, true, true>(inRate, outRate);
 			else
-				return new RateConverter_Impl<true, true, false>(inRate, outRate);
+				return new T<true, true, false>(inRate, outRate);
 		} else
-			return new RateConverter_Impl<true, false, false>(inRate, outRate);
+			return new T<true, false, false>(inRate, outRate);
 	} else {
 		if (outStereo) {
-			return new RateConverter_Impl<false, true, false>(inRate, outRate);
+			return new T<false, true, false>(inRate, outRate);
 		} else
-			return new RateConverter_Impl<false, false, false>(inRate, outRate);
+			return new T<false, false, false>(inRate, outRate);
 	}
 }
 
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo, RateConverterType type) {
+	if (type == kRateConverterPolyphase)
+		return makeRateConverterT<PolyphaseRateConverter>(inRate, outRate, inStereo, outStereo, reverseStereo);
+	return makeRateConverterT<RateConverter_Impl>(inRate, outRate, inStereo, outStereo, reverseStereo);
+}
+
 } // End of namespace Audio
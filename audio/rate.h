@@ -104,7 +104,21 @@ public:
 	virtual bool needsDraining() const = 0;
 };
 
-RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo);
+/**
+ * Resampling algorithms available for rate conversion.
+ */
+enum RateConverterType {
+	/** Nearest neighbour for integer ratios, linear interpolation otherwise. */
+	kRateConverterLinear,
+	/**
+	 * Band-limited polyphase windowed-sinc filter. Costs a little more per
+	 * output sample than linear interpolation, but does not alias.
+	 */
+	kRateConverterPolyphase
+};
+
+RateConverter *makeRateConverter(st_rate_t inRate, st_rate_t outRate, bool inStereo, bool outStereo, bool reverseStereo,
+                                 RateConverterType type = kRateConverterLinear);
 
 /** @} */
 } // End of namespace Audio
@@ -39,3 +39,19 @@ const char *AbstractFSNode::lastPathComponent(const Common::String &str, const c
 Common::SeekableReadStream *AbstractFSNode::createReadStreamForAltStream(Common::AltStreamType altStreamType) {
 	return nullptr;
 }
+
+bool AbstractFSNode::getFileStats(int64 &size, int64 &modificationTime) const {
+	return false;
+}
+
+bool AbstractFSNode::getDirectoryModificationTime(int64 &modificationTime) const {
+	return false;
+}
+
+bool AbstractFSNode::removeFile() {
+	return false;
+}
+
+AbstractFSNode *AbstractFSNode::getChildWithKnownType(const Common::String &name, bool isDirectory) const {
+	return getChild(name);
+}
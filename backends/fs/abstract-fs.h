@@ -41,6 +41,7 @@ typedef Common::Array<AbstractFSNode *>	AbstractFSList;
 class AbstractFSNode {
 protected:
 	friend class Common::FSNode;
+	friend class Common::FSDirectoryIndex;
 	typedef Common::FSNode::ListMode ListMode;
 
 	/**
@@ -62,6 +63,16 @@ protected:
 	 */
 	virtual AbstractFSNode *getChild(const Common::String &name) const = 0;
 
+	/**
+	 * Returns the child node with the given name, which is known to exist and
+	 * to be a file or a directory as specified, e.g. from an earlier directory
+	 * listing. Backends can use this to skip querying the file system for it.
+	 *
+	 * @param name String containing the name of the child to create a new node.
+	 * @param isDirectory Whether the child is a directory.
+	 */
+	virtual AbstractFSNode *getChildWithKnownType(const Common::String &name, bool isDirectory) const;
+
 	/**
 	 * The parent node of this directory.
 	 * The parent of the root is the root itself.
@@ -172,6 +183,25 @@ public:
 	 */
 	virtual bool isWritable() const = 0;
 
+	/**
+	 * Query the size and the time of the last modification of the file
+	 * referred by this node. The modification time is only meant to be
+	 * compared against an earlier result, its unit and epoch are up to
+	 * the backend.
+	 *
+	 * @return true if the file exists and the backend supports this query.
+	 */
+	virtual bool getFileStats(int64 &size, int64 &modificationTime) const;
+
+	/**
+	 * Query the time of the last modification of the directory referred by
+	 * this node, which changes when entries are added, removed or renamed.
+	 * Its unit and epoch are up to the backend.
+	 *
+	 * @return true if the directory exists and the backend supports this query.
+	 */
+	virtual bool getDirectoryModificationTime(int64 &modificationTime) const;
+
 
 	/**
 	 * Creates a SeekableReadStream instance corresponding to the file
@@ -212,6 +242,15 @@ public:
 	* @return true if the directory is created successfully
 	*/
 	virtual bool createDirectory() = 0;
+
+	/**
+	 * Removes the file referred by this node. This is only used for files
+	 * ScummVM keeps for itself, like the directory indexes.
+	 *
+	 * @return true if the file was removed, false if it could not be or
+	 *         the backend does not support it.
+	 */
+	virtual bool removeFile();
 };
 
 
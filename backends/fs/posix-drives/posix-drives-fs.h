@@ -77,7 +77,7 @@ protected:
 private:
 	bool _isPseudoRoot;
 
-	DrivePOSIXFilesystemNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const;
+	DrivePOSIXFilesystemNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const override;
 	bool isDrive(const Common::String &path) const;
 	void configureStream(StdioStream *stream);
 };
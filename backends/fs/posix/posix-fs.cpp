@@ -33,6 +33,7 @@
 
 #include "backends/fs/posix/posix-fs.h"
 #include "backends/fs/posix/posix-iostream.h"
+#include "backends/fs/posix/posix-mmapstream.h"
 #include "common/algorithm.h"
 
 #include <sys/param.h>
@@ -55,6 +56,8 @@
 #include <os2.h>
 #endif
 
+bool POSIXFilesystemNode::_useMemoryMapping = false;
+
 bool POSIXFilesystemNode::exists() const {
 	return access(_path.c_str(), F_OK) == 0;
 }
@@ -67,6 +70,35 @@ bool POSIXFilesystemNode::isWritable() const {
 	return access(_path.c_str(), W_OK) == 0;
 }
 
+bool POSIXFilesystemNode::getFileStats(int64 &size, int64 &modificationTime) const {
+	struct stat st;
+
+	if (stat(_path.c_str(), &st) != 0 || S_ISDIR(st.st_mode))
+		return false;
+
+	size = st.st_size;
+	modificationTime = st.st_mtime;
+	return true;
+}
+
+bool POSIXFilesystemNode::getDirectoryModificationTime(int64 &modificationTime) const {
+	struct stat st;
+
+	if (stat(_path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+		return false;
+
+	// In nanoseconds where possible, so that changes within the same second
+	// are not missed
+#if defined(HAS_STAT_MTIM)
+	modificationTime = (int64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#elif defined(HAS_STAT_MTIMESPEC)
+	modificationTime = (int64)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+	modificationTime = (int64)st.st_mtime * 1000000000;
+#endif
+	return true;
+}
+
 void POSIXFilesystemNode::setFlags() {
 	struct stat st;
 
@@ -137,6 +169,25 @@ AbstractFSNode *POSIXFilesystemNode::getChild(const Common::String &n) const {
 	return makeNode(newPath);
 }
 
+AbstractFSNode *POSIXFilesystemNode::getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const {
+	assert(!_path.empty());
+	assert(_isDirectory);
+
+	// Make sure the string contains no slashes
+	assert(!n.contains('/'));
+
+	// Like getChildren(), start with a clone of this node and don't stat()
+	POSIXFilesystemNode *child = new POSIXFilesystemNode(*this);
+	child->_displayName = n;
+	if (_path.lastChar() != '/')
+		child->_path += '/';
+	child->_path += n;
+	child->_isValid = true;
+	child->_isDirectory = isDirectoryFlag;
+
+	return child;
+}
+
 bool POSIXFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -276,6 +327,15 @@ AbstractFSNode *POSIXFilesystemNode::getParent() const {
 }
 
 Common::SeekableReadStream *POSIXFilesystemNode::createReadStream() {
+#ifdef HAS_MMAP
+	// Map larger files so they can be read without an extra copy. This
+	// fails for small files and non-regular files, which go through stdio.
+	if (_useMemoryMapping) {
+		Common::SeekableReadStream *stream = PosixMmapStream::makeFromPath(getPath());
+		if (stream)
+			return stream;
+	}
+#endif
 	return PosixIoStream::makeFromPath(getPath(), StdioStream::WriteMode_Read);
 }
 
@@ -302,6 +362,14 @@ bool POSIXFilesystemNode::createDirectory() {
 	return _isValid && _isDirectory;
 }
 
+bool POSIXFilesystemNode::removeFile() {
+	if (unlink(_path.c_str()) != 0)
+		return false;
+
+	setFlags();
+	return true;
+}
+
 namespace Posix {
 
 bool assureDirectoryExists(const Common::String &dir, const char *prefix) {
@@ -36,6 +36,8 @@ protected:
 	bool _isDirectory;
 	bool _isValid;
 
+	static bool _useMemoryMapping;
+
 	virtual AbstractFSNode *makeNode(const Common::String &path) const {
 		return new POSIXFilesystemNode(path);
 	}
@@ -60,8 +62,11 @@ public:
 	bool isDirectory() const override { return _isDirectory; }
 	bool isReadable() const override;
 	bool isWritable() const override;
+	bool getFileStats(int64 &size, int64 &modificationTime) const override;
+	bool getDirectoryModificationTime(int64 &modificationTime) const override;
 
 	AbstractFSNode *getChild(const Common::String &n) const override;
+	AbstractFSNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
 	AbstractFSNode *getParent() const override;
 
@@ -69,6 +74,17 @@ public:
 	Common::SeekableReadStream *createReadStreamForAltStream(Common::AltStreamType altStreamType) override;
 	Common::SeekableWriteStream *createWriteStream(bool atomic) override;
 	bool createDirectory() override;
+	bool removeFile() override;
+
+	/**
+	 * Enables opening large files as memory mappings, see PosixMmapStream.
+	 *
+	 * This is off by default: a mapped file which gets truncated, or which
+	 * lives on a network share that fails, raises SIGBUS on access instead
+	 * of a read error. Backends turn it on from the "mmap_game_data"
+	 * setting once the configuration is loaded.
+	 */
+	static void setUseMemoryMapping(bool enable) { _useMemoryMapping = enable; }
 
 protected:
 	/**
@@ -0,0 +1,100 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "backends/fs/posix/posix-mmapstream.h"
+#include "common/util.h"
+
+#ifdef HAS_MMAP
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+PosixMmapStream *PosixMmapStream::makeFromPath(const Common::String &path) {
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd == -1)
+		return nullptr;
+
+	struct stat st;
+	if (fstat(fd, &st) == -1 || !S_ISREG(st.st_mode) ||
+	        st.st_size < kMinMappedSize || st.st_size > kMaxMappedSize) {
+		close(fd);
+		return nullptr;
+	}
+
+	// The mapping keeps its own reference to the file
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return nullptr;
+
+	return new PosixMmapStream((const byte *)data, st.st_size);
+}
+
+PosixMmapStream::PosixMmapStream(const byte *data, uint32 size) :
+		_data(data), _size(size), _pos(0), _eos(false) {
+}
+
+PosixMmapStream::~PosixMmapStream() {
+	munmap(const_cast<byte *>(_data), _size);
+}
+
+uint32 PosixMmapStream::read(void *dataPtr, uint32 dataSize) {
+	if (!dataPtr)
+		return 0;
+
+	if (dataSize > _size - _pos) {
+		dataSize = _size - _pos;
+		_eos = true;
+	}
+	memcpy(dataPtr, _data + _pos, dataSize);
+	_pos += dataSize;
+
+	return dataSize;
+}
+
+bool PosixMmapStream::seek(int64 offs, int whence) {
+	switch (whence) {
+	case SEEK_END:
+		offs = _size + offs;
+		break;
+	case SEEK_CUR:
+		offs = _pos + offs;
+		break;
+	case SEEK_SET:
+	default:
+		break;
+	}
+
+	if (offs < 0)
+		return false;
+
+	// Seeking past the end is allowed, like fseek, but there is nothing to
+	// read there
+	_pos = MIN<int64>(offs, _size);
+	_eos = false;
+	return true;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BACKENDS_FS_POSIX_POSIXMMAPSTREAM_H
+#define BACKENDS_FS_POSIX_POSIXMMAPSTREAM_H
+
+#include "common/scummsys.h"
+
+#ifdef HAS_MMAP
+
+#include "common/noncopyable.h"
+#include "common/stream.h"
+#include "common/str.h"
+
+/**
+ * A read-only file stream which maps the complete file into memory.
+ *
+ * Reading copies straight out of the page cache, without going through a
+ * stdio buffer first, and the contents are available through
+ * getDirectData() so they can be parsed in place.
+ *
+ * The file must not be truncated while it is mapped: accessing pages past
+ * the new end raises SIGBUS. The same happens when the pages cannot be read
+ * in, e.g. on a network share which went away.
+ */
+class PosixMmapStream final : public Common::SeekableReadStream, public Common::NonCopyable {
+public:
+	/**
+	 * Files smaller than this are cheaper to read through stdio than to map.
+	 */
+	static const int64 kMinMappedSize = 64 * 1024;
+
+	/**
+	 * Files larger than this are not mapped. On 32-bit hosts, a few mapped
+	 * game files would otherwise use up most of the address space.
+	 */
+	static const int64 kMaxMappedSize = sizeof(void *) > 4 ? 0xFFFFFFFFLL : 64 * 1024 * 1024;
+
+	/**
+	 * Map the regular file at the given path.
+	 *
+	 * @return The new stream, or nullptr if the file is not a regular file,
+	 *         is smaller than kMinMappedSize or larger than kMaxMappedSize,
+	 *         or could not be mapped. The caller should fall back to a
+	 *         PosixIoStream in that case.
+	 */
+	static PosixMmapStream *makeFromPath(const Common::String &path);
+
+	~PosixMmapStream() override;
+
+	bool eos() const override { return _eos; }
+	void clearErr() override { _eos = false; }
+
+	int64 pos() const override { return _pos; }
+	int64 size() const override { return _size; }
+	bool seek(int64 offs, int whence = SEEK_SET) override;
+	uint32 read(void *dataPtr, uint32 dataSize) override;
+
+	const byte *getDirectData() const override { return _data; }
+
+private:
+	PosixMmapStream(const byte *data, uint32 size);
+
+	const byte *_data;
+	uint32 _size;
+	uint32 _pos;
+	bool _eos;
+};
+
+#endif
+
+#endif
@@ -35,6 +35,12 @@
 #include "backends/fs/stdiostream.h"
 #include "common/textconsole.h"
 
+#if defined(WIN32)
+#include <io.h>	// for _commit()
+#elif defined(POSIX)
+#include <unistd.h>	// for fsync()
+#endif
+
 #if defined(__DC__)
 // libronin doesn't support rename
 #define STDIOSTREAM_NO_ATOMIC_SUPPORT
@@ -173,6 +179,18 @@ bool StdioStream::flush() {
 	return fflush((FILE *)_handle) == 0;
 }
 
+bool StdioStream::sync() {
+	if (fflush((FILE *)_handle) != 0)
+		return false;
+#if defined(WIN32)
+	return _commit(_fileno((FILE *)_handle)) == 0;
+#elif defined(POSIX)
+	return fsync(fileno((FILE *)_handle)) == 0;
+#else
+	return true;
+#endif
+}
+
 StdioStream *StdioStream::makeFromPathHelper(const Common::String &path, WriteMode writeMode,
 		StdioStream *(*factory)(void *handle)) {
 	Common::String tmpPath(path);
@@ -80,6 +80,14 @@ public:
 	 */
 	bool setBufferSize(uint32 bufferSize);
 
+	/**
+	 * Flush the buffered data, and wait until the system has stored it
+	 * on the disk, where supported.
+	 *
+	 * @return success or failure
+	 */
+	bool sync();
+
 private:
 	/**
 	 * Move the file from src to dst.
@@ -44,6 +44,27 @@ bool WindowsFilesystemNode::isWritable() const {
 	return ((fileAttribs != INVALID_FILE_ATTRIBUTES) && (!(fileAttribs & FILE_ATTRIBUTE_READONLY)));
 }
 
+bool WindowsFilesystemNode::getFileStats(int64 &size, int64 &modificationTime) const {
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(charToTchar(_path.c_str()), GetFileExInfoStandard, &data) ||
+	    (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		return false;
+
+	size = ((int64)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+	modificationTime = ((int64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
+bool WindowsFilesystemNode::getDirectoryModificationTime(int64 &modificationTime) const {
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if (!GetFileAttributesEx(charToTchar(_path.c_str()), GetFileExInfoStandard, &data) ||
+	    !(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		return false;
+
+	modificationTime = ((int64)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+	return true;
+}
+
 void WindowsFilesystemNode::addFile(AbstractFSList &list, ListMode mode, const char *base, bool hidden, WIN32_FIND_DATA* find_data) {
 	// Skip local directory (.) and parent (..)
 	if (!_tcscmp(find_data->cFileName, TEXT(".")) ||
@@ -151,6 +172,28 @@ AbstractFSNode *WindowsFilesystemNode::getChild(const Common::String &n) const {
 	return new WindowsFilesystemNode(newPath, false);
 }
 
+AbstractFSNode *WindowsFilesystemNode::getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const {
+	assert(_isDirectory);
+
+	// Make sure the string contains no slashes
+	assert(!n.contains('/'));
+
+	// Same as the entries created by addFile()
+	WindowsFilesystemNode *child = new WindowsFilesystemNode();
+	child->_isDirectory = isDirectoryFlag;
+	child->_displayName = n;
+	child->_path = _path;
+	if (_path.lastChar() != '\\')
+		child->_path += '\\';
+	child->_path += n;
+	if (isDirectoryFlag)
+		child->_path += "\\";
+	child->_isValid = true;
+	child->_isPseudoRoot = false;
+
+	return child;
+}
+
 bool WindowsFilesystemNode::getChildren(AbstractFSList &myList, ListMode mode, bool hidden) const {
 	assert(_isDirectory);
 
@@ -238,4 +281,12 @@ bool WindowsFilesystemNode::createDirectory() {
 	return _isValid && _isDirectory;
 }
 
+bool WindowsFilesystemNode::removeFile() {
+	if (DeleteFile(charToTchar(_path.c_str())) == 0)
+		return false;
+
+	setFlags();
+	return true;
+}
+
 #endif //#ifdef WIN32
@@ -72,14 +72,18 @@ public:
 	bool isDirectory() const override { return _isDirectory; }
 	bool isReadable() const override;
 	bool isWritable() const override;
+	bool getFileStats(int64 &size, int64 &modificationTime) const override;
+	bool getDirectoryModificationTime(int64 &modificationTime) const override;
 
 	AbstractFSNode *getChild(const Common::String &n) const override;
+	AbstractFSNode *getChildWithKnownType(const Common::String &n, bool isDirectoryFlag) const override;
 	bool getChildren(AbstractFSList &list, ListMode mode, bool hidden) const override;
 	AbstractFSNode *getParent() const override;
 
 	Common::SeekableReadStream *createReadStream() override;
 	Common::SeekableWriteStream *createWriteStream(bool atomic) override;
 	bool createDirectory() override;
+	bool removeFile() override;
 
 private:
 	/**
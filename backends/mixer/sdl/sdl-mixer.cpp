@@ -144,6 +144,10 @@ void SdlMixerManager::init() {
 
 	_mixer = new Audio::MixerImpl(_obtained.freq, _obtained.channels >= 2, desiredSamples);
 	assert(_mixer);
+	if (ConfMan.hasKey("lock_free_mixer") && ConfMan.getBool("lock_free_mixer"))
+		_mixer->setLockFreeControl(true);
+	if (ConfMan.hasKey("resampler") && ConfMan.get("resampler") == "polyphase")
+		_mixer->setRateConverterType(Audio::kRateConverterPolyphase);
 	_mixer->setReady(true);
 
 	startAudio();
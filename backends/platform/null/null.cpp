@@ -51,6 +51,10 @@ typedef void (*sighandler_t)(int);
 #include "backends/mutex/null/null-mutex.h"
 #include "base/main.h"
 
+#if defined(NULL_DRIVER_USE_FOR_TEST) && defined(POSIX)
+#include "backends/mutex/pthread/pthread-mutex.h"
+#endif
+
 #ifndef NULL_DRIVER_USE_FOR_TEST
 #include "backends/saves/default/default-saves.h"
 #include "backends/timer/default/default-timer.h"
@@ -187,7 +191,12 @@ bool OSystem_NULL::pollEvent(Common::Event &event) {
 }
 
 Common::MutexInternal *OSystem_NULL::createMutex() {
+#if defined(NULL_DRIVER_USE_FOR_TEST) && defined(POSIX)
+	// Tests may run code on real threads, see createTestWorkerThreads()
+	return createPthreadMutexInternal();
+#else
 	return new NullMutexInternal();
+#endif
 }
 
 uint32 OSystem_NULL::getMillis(bool skipRecord) {
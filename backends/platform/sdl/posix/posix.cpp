@@ -43,6 +43,7 @@
 #include "backends/audiocd/linux/linux-audiocd.h"
 #endif
 
+#include "common/config-manager.h"
 #include "common/textconsole.h"
 
 #include <stdlib.h>
@@ -83,6 +84,11 @@ void OSystem_POSIX::initBackend() {
 	if (_savefileManager == 0)
 		_savefileManager = new POSIXSaveFileManager();
 
+	// Memory mapping game files is opt-in, as a file which becomes
+	// unreadable while it is mapped crashes with SIGBUS
+	ConfMan.registerDefault("mmap_game_data", false);
+	POSIXFilesystemNode::setUseMemoryMapping(ConfMan.getBool("mmap_game_data"));
+
 #if defined(USE_SPEECH_DISPATCHER) && defined(USE_TTS)
 	// Initialize Text to Speech manager
 	_textToSpeechManager = new SpeechDispatcherManager();
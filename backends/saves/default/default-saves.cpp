@@ -37,6 +37,12 @@
 #include "common/archive.h"
 #include "common/config-manager.h"
 #include "common/compression/deflate.h"
+#include "common/memstream.h"
+#include "common/threadpool.h"
+
+#if !defined(DISABLE_STDIO_FILESTREAM)
+#include "backends/fs/stdiostream.h"	// for writePendingSave()
+#endif
 
 #include <errno.h>	// for removeSavefile()
 
@@ -44,13 +50,71 @@
 const char *const DefaultSaveFileManager::TIMESTAMPS_FILENAME = "timestamps";
 #endif
 
-DefaultSaveFileManager::DefaultSaveFileManager() {
+/**
+ * Collects the data of a save file in memory, and hands it over to a worker
+ * thread once it has been finalized. The worker compresses and writes it,
+ * which keeps big autosaves from stalling the engine thread.
+ */
+class DefaultSaveFileManager::BackgroundOutSaveFile : public Common::OutSaveFile {
+public:
+	BackgroundOutSaveFile(DefaultSaveFileManager *manager, PendingSave *save) :
+		Common::OutSaveFile(new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO)), _manager(manager), _save(save) {}
+
+	~BackgroundOutSaveFile() override {
+		finalize();
+		delete _wrapped;
+		_wrapped = nullptr;
+	}
+
+	void finalize() override {
+		if (!_save)
+			return;
+
+		Common::MemoryWriteStreamDynamic *buffer = (Common::MemoryWriteStreamDynamic *)_wrapped;
+		_manager->queueSave(_save, buffer->getData(), buffer->size());
+		_save = nullptr;
+	}
+
+	uint32 write(const void *dataPtr, uint32 dataSize) override {
+		// The buffer belongs to the worker after finalize()
+		if (!_save)
+			return 0;
+		return _wrapped->write(dataPtr, dataSize);
+	}
+
+	bool seek(int64 offset, int whence) override {
+		if (_save && !_save->compress)
+			return ((Common::MemoryWriteStreamDynamic *)_wrapped)->seek(offset, whence);
+
+		warning("Seeking isn't supported for compressed save files");
+		return false;
+	}
+
+	int64 size() const override {
+		if (_save && !_save->compress)
+			return ((Common::MemoryWriteStreamDynamic *)_wrapped)->size();
+
+		warning("Size isn't supported for compressed save files");
+		return -1;
+	}
+
+private:
+	DefaultSaveFileManager *_manager;
+	PendingSave *_save;
+};
+
+DefaultSaveFileManager::DefaultSaveFileManager() : _saveTasks(nullptr), _backgroundSaving(false) {
 }
 
-DefaultSaveFileManager::DefaultSaveFileManager(const Common::Path &defaultSavepath) {
+DefaultSaveFileManager::DefaultSaveFileManager(const Common::Path &defaultSavepath) : _saveTasks(nullptr), _backgroundSaving(false) {
 	ConfMan.registerDefault("savepath", defaultSavepath);
 }
 
+DefaultSaveFileManager::~DefaultSaveFileManager() {
+	checkPendingSaves(true);
+	delete _saveTasks;
+}
+
 
 void DefaultSaveFileManager::checkPath(const Common::FSNode &dir) {
 	clearError();
@@ -92,6 +156,8 @@ Common::StringArray DefaultSaveFileManager::listSavefiles(const Common::String &
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openRawFile(const Common::String &filename) {
+	waitForPendingSave(filename);
+
 	// Assure the savefile name cache is up-to-date.
 	assureCached(getSavePath());
 	if (getError().getCode() != Common::kNoError)
@@ -108,6 +174,8 @@ Common::InSaveFile *DefaultSaveFileManager::openRawFile(const Common::String &fi
 }
 
 Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String &filename) {
+	waitForPendingSave(filename);
+
 	// Assure the savefile name cache is up-to-date.
 	assureCached(getSavePath());
 	if (getError().getCode() != Common::kNoError)
@@ -130,6 +198,9 @@ Common::InSaveFile *DefaultSaveFileManager::openForLoading(const Common::String
 }
 
 Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String &filename, bool compress) {
+	// Keep the writes to one file in order
+	waitForPendingSave(filename);
+
 	// Assure the savefile name cache is up-to-date.
 	const Common::Path savePathName = getSavePath();
 	assureCached(savePathName);
@@ -165,7 +236,25 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 	Common::SeekableWriteStream *const sf = fileNode.createWriteStream();
 	if (!sf)
 		return nullptr;
-	Common::OutSaveFile *const result = new Common::OutSaveFile(compress ? Common::wrapCompressedWriteStream(sf) : sf);
+
+	Common::OutSaveFile *result;
+	if (_backgroundSaving && g_system->getThreadPool()->getWorkerCount() > 0) {
+		// Compress and write the file in the background
+		PendingSave *save = new PendingSave();
+		save->manager = this;
+		save->filename = filename;
+		save->directory = savePathName;
+		save->path = fileNode.getPath();
+		save->stream = sf;
+		save->compress = compress;
+		save->data = nullptr;
+		save->size = 0;
+		save->finished = false;
+		save->result = Common::kNoError;
+		result = new BackgroundOutSaveFile(this, save);
+	} else {
+		result = new Common::OutSaveFile(compress ? Common::wrapCompressedWriteStream(sf) : sf);
+	}
 
 	// Add file to cache now that it exists.
 	_saveFileCache[filename] = Common::FSNode(fileNode.getPath());
@@ -174,6 +263,8 @@ Common::OutSaveFile *DefaultSaveFileManager::openForSaving(const Common::String
 }
 
 bool DefaultSaveFileManager::removeSavefile(const Common::String &filename) {
+	waitForPendingSave(filename);
+
 	// Assure the savefile name cache is up-to-date.
 	assureCached(getSavePath());
 	if (getError().getCode() != Common::kNoError)
@@ -219,6 +310,99 @@ Common::ErrorCode DefaultSaveFileManager::removeFile(const Common::FSNode &fileN
 	return Common::kUnknownError;
 }
 
+void DefaultSaveFileManager::queueSave(PendingSave *save, byte *data, uint32 size) {
+	save->data = data;
+	save->size = size;
+	_pendingSaves.push_back(save);
+
+	if (!_saveTasks)
+		_saveTasks = new Common::TaskGroup();
+	_saveTasks->run(writePendingSave, save);
+}
+
+void DefaultSaveFileManager::writePendingSave(void *data) {
+	PendingSave *save = (PendingSave *)data;
+
+	// Write streams are atomic, the old file stays until the new one is complete
+	Common::WriteStream *const stream = save->compress ? Common::wrapCompressedWriteStream(save->stream) : save->stream;
+	stream->write(save->data, save->size);
+	stream->finalize();
+	Common::ErrorCode result = stream->err() ? Common::kWritingFailed : Common::kNoError;
+
+#if !defined(DISABLE_STDIO_FILESTREAM)
+	// Make sure the data is on the disk before the new file replaces the old one
+	StdioStream *const stdioStream = dynamic_cast<StdioStream *>(save->stream);
+	if (result == Common::kNoError && stdioStream && !stdioStream->sync())
+		result = Common::kWritingFailed;
+#endif
+
+	delete stream;
+	save->stream = nullptr;
+
+	free(save->data);
+	save->data = nullptr;
+
+	Common::StackLock lock(save->manager->_pendingSavesMutex);
+	save->result = result;
+	save->finished = true;
+}
+
+void DefaultSaveFileManager::waitForPendingSave(const Common::String &filename) {
+	for (uint i = 0; i < _pendingSaves.size(); ++i) {
+		if (_pendingSaves[i]->filename.equalsIgnoreCase(filename)) {
+			_saveTasks->wait();
+			return;
+		}
+	}
+}
+
+void DefaultSaveFileManager::setBackgroundSaving(bool enable) {
+	_backgroundSaving = enable;
+}
+
+bool DefaultSaveFileManager::checkPendingSaves(bool wait) {
+	if (_pendingSaves.empty())
+		return true;
+	if (wait)
+		_saveTasks->wait();
+
+	Common::Array<PendingSave *> finished;
+	{
+		Common::StackLock lock(_pendingSavesMutex);
+		for (uint i = 0; i < _pendingSaves.size();) {
+			if (_pendingSaves[i]->finished) {
+				finished.push_back(_pendingSaves[i]);
+				_pendingSaves.remove_at(i);
+			} else {
+				++i;
+			}
+		}
+	}
+
+	bool success = true;
+	for (uint i = 0; i < finished.size(); ++i) {
+		PendingSave *save = finished[i];
+		if (save->result != Common::kNoError) {
+			Common::Error error(save->result);
+			warning("DefaultSaveFileManager: Failed to write savefile '%s': %s", save->filename.c_str(), error.getDesc().c_str());
+			setError(error, "Failed to write savefile '" + save->filename + "': " + error.getDesc());
+
+			// Drop the file from the cache if there was no older version
+			if (save->directory == _cachedDirectory && !Common::FSNode(save->path).exists())
+				_saveFileCache.erase(save->filename);
+			success = false;
+		}
+		delete save;
+	}
+
+#if defined(USE_CLOUD) && defined(USE_LIBCURL)
+	if (!finished.empty())
+		CloudMan.syncSaves();
+#endif
+
+	return success;
+}
+
 bool DefaultSaveFileManager::exists(const Common::String &filename) {
 	// Assure the savefile name cache is up-to-date.
 	assureCached(getSavePath());
@@ -291,6 +475,13 @@ void DefaultSaveFileManager::assureCached(const Common::Path &savePathName) {
 		}
 	}
 
+	// Save files which are still being written may not exist yet
+	for (uint i = 0; i < _pendingSaves.size(); ++i) {
+		const PendingSave *save = _pendingSaves[i];
+		if (save->directory == savePathName && !_saveFileCache.contains(save->filename))
+			_saveFileCache[save->filename] = Common::FSNode(save->path);
+	}
+
 	// Only now store that we cached 'savePathName' to indicate we successfully
 	// cached the directory.
 	_cachedDirectory = savePathName;
@@ -27,6 +27,11 @@
 #include "common/str.h"
 #include "common/fs.h"
 #include "common/hash-str.h"
+#include "common/mutex.h"
+
+namespace Common {
+class TaskGroup;
+}
 
 /**
  * Provides a default savefile manager implementation for common platforms.
@@ -35,6 +40,7 @@ class DefaultSaveFileManager : public Common::SaveFileManager {
 public:
 	DefaultSaveFileManager();
 	DefaultSaveFileManager(const Common::Path &defaultSavepath);
+	~DefaultSaveFileManager() override;
 
 	void updateSavefilesList(Common::StringArray &lockedFiles) override;
 	Common::StringArray listSavefiles(const Common::String &pattern) override;
@@ -43,6 +49,8 @@ public:
 	Common::OutSaveFile *openForSaving(const Common::String &filename, bool compress = true) override;
 	bool removeSavefile(const Common::String &filename) override;
 	bool exists(const Common::String &filename) override;
+	bool checkPendingSaves(bool wait) override;
+	void setBackgroundSaving(bool enable) override;
 
 #ifdef USE_LIBCURL
 
@@ -100,10 +108,51 @@ protected:
 	Common::StringArray _lockedFiles;
 
 private:
+	class BackgroundOutSaveFile;
+
+	/**
+	 * A save file which is written by a worker thread. Only the main thread
+	 * adds and removes these, the worker sets the result.
+	 */
+	struct PendingSave {
+		DefaultSaveFileManager *manager;
+		Common::String filename;
+		Common::Path directory;
+		Common::Path path;
+		/** Opened by the main thread, so that failing to create the file shows up right away. */
+		Common::SeekableWriteStream *stream;
+		bool compress;
+		byte *data;
+		uint32 size;
+
+		// Guarded by _pendingSavesMutex
+		bool finished;
+		Common::ErrorCode result;
+	};
+
+	/**
+	 * Start writing the given save file on a worker thread.
+	 * Takes ownership of the malloc'ed data.
+	 */
+	void queueSave(PendingSave *save, byte *data, uint32 size);
+
+	static void writePendingSave(void *data);
+
+	/**
+	 * Wait until the given save file is stored, if it is still written in
+	 * the background.
+	 */
+	void waitForPendingSave(const Common::String &filename);
+
 	/**
 	 * The currently cached directory.
 	 */
 	Common::Path _cachedDirectory;
+
+	Common::Array<PendingSave *> _pendingSaves;
+	Common::TaskGroup *_saveTasks;
+	bool _backgroundSaving;
+	Common::Mutex _pendingSavesMutex;
 };
 
 #endif
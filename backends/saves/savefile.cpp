@@ -31,6 +31,11 @@ namespace Common {
 OutSaveFile::OutSaveFile(WriteStream *w): _wrapped(w) {}
 
 OutSaveFile::~OutSaveFile() {
+	// Save files which are written in the background hand their stream
+	// over before this point, and are synced once they are stored
+	if (!_wrapped)
+		return;
+
 	delete _wrapped;
 #if defined(USE_CLOUD) && defined(USE_LIBCURL)
 	CloudMan.syncSaves();
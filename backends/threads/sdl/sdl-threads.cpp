@@ -0,0 +1,142 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#if defined(SDL_BACKEND)
+
+#include "backends/threads/sdl/sdl-threads.h"
+#include "backends/platform/sdl/sdl-sys.h"
+
+#include "common/array.h"
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+
+#if SDL_VERSION_ATLEAST(3, 0, 0)
+typedef SDL_Semaphore SdlSemaphore;
+#define SdlSemWait SDL_WaitSemaphore
+#define SdlSemPost SDL_SignalSemaphore
+#define SdlCPUCount SDL_GetNumLogicalCPUCores
+#else
+typedef SDL_sem SdlSemaphore;
+#define SdlSemWait SDL_SemWait
+#define SdlSemPost SDL_SemPost
+#define SdlCPUCount SDL_GetCPUCount
+#endif
+
+class SdlWorkerThreadsInternal final : public Common::WorkerThreadsInternal {
+public:
+	SdlWorkerThreadsInternal() : _proc(nullptr), _data(nullptr) {
+		_wake = SDL_CreateSemaphore(0);
+		_wakeWaiter = SDL_CreateSemaphore(0);
+	}
+
+	~SdlWorkerThreadsInternal() override {
+		join();
+		SDL_DestroySemaphore(_wake);
+		SDL_DestroySemaphore(_wakeWaiter);
+	}
+
+	uint getCPUCount() const override {
+		const int count = SdlCPUCount();
+		return count > 1 ? count : 1;
+	}
+
+	uint start(WorkerProc proc, void *data, uint count) override {
+		_proc = proc;
+		_data = data;
+
+		// Each thread needs its index before it starts
+		_threads.resize(count);
+		_starts.resize(count);
+		for (uint i = 0; i < count; ++i) {
+			_starts[i]._owner = this;
+			_starts[i]._index = i;
+		}
+
+		uint started = 0;
+		for (uint i = 0; i < count; ++i) {
+			SDL_Thread *thread = SDL_CreateThread(threadMain, "ScummVM worker", &_starts[i]);
+			if (!thread)
+				break;
+			_threads[started++] = thread;
+		}
+		_threads.resize(started);
+		return started;
+	}
+
+	void join() override {
+		for (uint i = 0; i < _threads.size(); ++i)
+			SDL_WaitThread(_threads[i], nullptr);
+		_threads.clear();
+	}
+
+	void sleep() override {
+		SdlSemWait(_wake);
+	}
+
+	void wake(uint count) override {
+		for (uint i = 0; i < count; ++i)
+			SdlSemPost(_wake);
+	}
+
+	void sleepWaiter() override {
+		SdlSemWait(_wakeWaiter);
+	}
+
+	void wakeWaiters(uint count) override {
+		for (uint i = 0; i < count; ++i)
+			SdlSemPost(_wakeWaiter);
+	}
+
+private:
+	struct StartInfo {
+		SdlWorkerThreadsInternal *_owner;
+		uint _index;
+	};
+
+	static int threadMain(void *arg) {
+		const StartInfo *info = (const StartInfo *)arg;
+		info->_owner->_proc(info->_owner->_data, info->_index);
+		return 0;
+	}
+
+	Common::Array<SDL_Thread *> _threads;
+	Common::Array<StartInfo> _starts;
+	SdlSemaphore *_wake;
+	SdlSemaphore *_wakeWaiter;
+	WorkerProc _proc;
+	void *_data;
+};
+
+Common::WorkerThreadsInternal *createSdlWorkerThreads() {
+	return new SdlWorkerThreadsInternal();
+}
+
+#else
+
+Common::WorkerThreadsInternal *createSdlWorkerThreads() {
+	return nullptr;
+}
+
+#endif
+
+#endif
@@ -24,104 +24,138 @@
 #include "common/util.h"
 #include "common/system.h"
 
+enum {
+	// Longest time handler() asks to wait, in case a timer gets installed
+	// by a thread which does not wake up the backend
+	kMaxHandlerDelay = 10
+};
+
 struct TimerSlot {
 	Common::TimerManager::TimerProc callback;
 	void *refCon;
 	Common::String id;
 	uint32 interval;	// in microseconds
 
-	uint32 nextFireTime;	// in milliseconds
-	uint32 nextFireTimeMicro;	// microseconds part of nextFire
-
-	TimerSlot *next;
-
-	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), nextFireTime(0), nextFireTimeMicro(0), next(nullptr) {}
-};
+	uint64 nextFireTime;	// in microseconds
+	uint32 sequence;	// keeps timers with the same deadline in installation order
 
-void insertPrioQueue(TimerSlot *head, TimerSlot *newSlot) {
-	// The head points to a fake anchor TimerSlot; this common
-	// trick allows us to get rid of many special cases.
+	DefaultTimerManager::TimerStats stats;
 
-	const uint32 nextFireTime = newSlot->nextFireTime;
-	TimerSlot *slot = head;
-	newSlot->next = nullptr;
+	TimerSlot() : callback(nullptr), refCon(nullptr), interval(0), nextFireTime(0), sequence(0) {}
 
-	// Insert the new slot into the sorted list of already scheduled
-	// timers in such a way that the list stays sorted...
-	while (true) {
-		assert(slot);
-		if (slot->next == nullptr || nextFireTime < slot->next->nextFireTime) {
-			newSlot->next = slot->next;
-			slot->next = newSlot;
-			return;
-		}
-		slot = slot->next;
+	bool firesBefore(const TimerSlot *other) const {
+		if (nextFireTime != other->nextFireTime)
+			return nextFireTime < other->nextFireTime;
+		return (int32)(sequence - other->sequence) < 0;
 	}
-}
+};
 
 
 DefaultTimerManager::DefaultTimerManager() :
-	_timerCallbackNext(0),
-	_head(nullptr) {
-
-	_head = new TimerSlot();
+	_nextDeadline(0),
+	_millis(0),
+	_nextSequence(0) {
 }
 
 DefaultTimerManager::~DefaultTimerManager() {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
-	while (slot) {
-		TimerSlot *next = slot->next;
-		delete slot;
-		slot = next;
-	}
-	_head = nullptr;
+	for (uint i = 0; i < _slots.size(); ++i)
+		delete _slots[i];
+	_slots.clear();
 }
 
-void DefaultTimerManager::handler() {
-	Common::StackLock lock(_mutex);
+uint64 DefaultTimerManager::getMicros(uint32 millis) {
+	// Extend the millisecond counter so deadlines survive its wrap around.
+	// Recorded and real time may disagree a little, so only move forward.
+	const int32 delta = (int32)(millis - (uint32)_millis);
+	if (delta > 0)
+		_millis += delta;
+	return (_millis - (delta < 0 ? (uint32)-delta : 0)) * 1000;
+}
 
-	uint32 curTime = g_system->getMillis(true);
+void DefaultTimerManager::siftUp(uint index) {
+	TimerSlot *slot = _slots[index];
+	while (index > 0) {
+		const uint parent = (index - 1) / 2;
+		if (!slot->firesBefore(_slots[parent]))
+			break;
+		_slots[index] = _slots[parent];
+		index = parent;
+	}
+	_slots[index] = slot;
+}
 
-	// On slow systems this could still be run after destructor
-	if (!_head)
-		return;
+void DefaultTimerManager::siftDown(uint index) {
+	TimerSlot *slot = _slots[index];
+	const uint size = _slots.size();
+	while (true) {
+		uint child = index * 2 + 1;
+		if (child >= size)
+			break;
+		if (child + 1 < size && _slots[child + 1]->firesBefore(_slots[child]))
+			child++;
+		if (!_slots[child]->firesBefore(slot))
+			break;
+		_slots[index] = _slots[child];
+		index = child;
+	}
+	_slots[index] = slot;
+}
 
-	// Repeat as long as there is a TimerSlot that is scheduled to fire.
-	TimerSlot *slot = _head->next;
-	while (slot && slot->nextFireTime < curTime) {
-		// Remove the slot from the priority queue
-		_head->next = slot->next;
+void DefaultTimerManager::updateNextDeadline() {
+	if (_slots.empty())
+		_nextDeadline.store((uint32)_millis + kMaxHandlerDelay);
+	else
+		_nextDeadline.store((uint32)((_slots[0]->nextFireTime + 999) / 1000));
+}
 
-		// Update the fire time and reinsert the TimerSlot into the priority
-		// queue.
+uint32 DefaultTimerManager::handler() {
+	Common::StackLock lock(_mutex);
+
+	const uint64 curTime = getMicros(g_system->getMillis(true));
+
+	// Repeat as long as there is a TimerSlot that is due. Timers which fell
+	// behind are called once for every deadline they missed, so the number
+	// of calls stays right, and only the top of the heap is ever looked at.
+	while (!_slots.empty() && _slots[0]->nextFireTime <= curTime) {
+		TimerSlot *slot = _slots[0];
+
+		// Statistics
+		const uint64 drift = curTime - slot->nextFireTime;
+		slot->stats.calls++;
+		slot->stats.totalDrift += drift;
+		if (drift > slot->stats.maxDrift)
+			slot->stats.maxDrift = (uint32)MIN<uint64>(drift, 0xFFFFFFFF);
+		if (drift >= slot->interval)
+			slot->stats.missedDeadlines++;
+
+		// Update the fire time and move the TimerSlot to its new place in
+		// the heap. The callback may remove itself, so do it before.
 		assert(slot->interval > 0);
-		slot->nextFireTime += (slot->interval / 1000);
-		slot->nextFireTimeMicro += (slot->interval % 1000);
-		if (slot->nextFireTimeMicro > 1000) {
-			slot->nextFireTime += slot->nextFireTimeMicro / 1000;
-			slot->nextFireTimeMicro %= 1000;
-		}
-		insertPrioQueue(_head, slot);
+		slot->nextFireTime += slot->interval;
+		slot->sequence = _nextSequence++;
+		siftDown(0);
 
 		// Invoke the timer callback
 		assert(slot->callback);
 		slot->callback(slot->refCon);
-
-		// Look at the next scheduled timer
-		slot = _head->next;
 	}
+
+	updateNextDeadline();
+
+	const uint32 now = (uint32)(curTime / 1000);
+	const int32 delay = (int32)(_nextDeadline.load() - now);
+	return CLIP<int32>(delay, 1, kMaxHandlerDelay);
 }
 
-void DefaultTimerManager::checkTimers(uint32 interval) {
+void DefaultTimerManager::checkTimers() {
 	uint32 curTime = g_system->getMillis();
 
-	// Timer checking & firing
-	if (curTime >= _timerCallbackNext) {
+	// Timer checking & firing. Taking the mutex every time would make
+	// pollEvent() wait for timers running on another thread.
+	if ((int32)(curTime - _nextDeadline.load()) >= 0)
 		handler();
-		_timerCallbackNext = curTime + interval;
-	}
 }
 
 bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, void *refCon, const Common::String &id) {
@@ -147,11 +181,14 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 	slot->refCon = refCon;
 	slot->id = id;
 	slot->interval = interval;
-	slot->nextFireTime = g_system->getMillis() + interval / 1000;
-	slot->nextFireTimeMicro = interval % 1000;
-	slot->next = nullptr;
+	slot->nextFireTime = getMicros(g_system->getMillis()) + interval;
+	slot->sequence = _nextSequence++;
+	slot->stats.id = id;
+	slot->stats.interval = interval;
 
-	insertPrioQueue(_head, slot);
+	_slots.push_back(slot);
+	siftUp(_slots.size() - 1);
+	updateNextDeadline();
 
 	return true;
 }
@@ -159,17 +196,24 @@ bool DefaultTimerManager::installTimerProc(TimerProc callback, int32 interval, v
 void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 	Common::StackLock lock(_mutex);
 
-	TimerSlot *slot = _head;
+	for (uint i = 0; i < _slots.size();) {
+		if (_slots[i]->callback != callback) {
+			++i;
+			continue;
+		}
 
-	while (slot->next) {
-		if (slot->next->callback == callback) {
-			TimerSlot *next = slot->next->next;
-			delete slot->next;
-			slot->next = next;
-		} else {
-			slot = slot->next;
+		delete _slots[i];
+		TimerSlot *last = _slots.back();
+		_slots.pop_back();
+		if (i < _slots.size()) {
+			// Move the last timer into the gap and restore the heap order
+			_slots[i] = last;
+			siftDown(i);
+			siftUp(i);
 		}
+		i = 0;
 	}
+	updateNextDeadline();
 
 	// We need to remove all names referencing the timer proc here.
 	//
@@ -188,3 +232,24 @@ void DefaultTimerManager::removeTimerProc(TimerProc callback) {
 			_callbacks.erase(i);
 	}
 }
+
+bool DefaultTimerManager::getTimerStats(TimerProc callback, TimerStats &stats) {
+	Common::StackLock lock(_mutex);
+
+	for (uint i = 0; i < _slots.size(); ++i) {
+		if (_slots[i]->callback == callback) {
+			stats = _slots[i]->stats;
+			return true;
+		}
+	}
+	return false;
+}
+
+void DefaultTimerManager::getAllTimerStats(Common::Array<TimerStats> &stats) {
+	Common::StackLock lock(_mutex);
+
+	stats.clear();
+	stats.reserve(_slots.size());
+	for (uint i = 0; i < _slots.size(); ++i)
+		stats.push_back(_slots[i]->stats);
+}
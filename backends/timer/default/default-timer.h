@@ -23,6 +23,8 @@
 #define BACKENDS_TIMER_DEFAULT_H
 
 #include "common/str.h"
+#include "common/array.h"
+#include "common/atomic.h"
 #include "common/hash-str.h"
 #include "common/timer.h"
 #include "common/mutex.h"
@@ -30,14 +32,39 @@
 struct TimerSlot;
 
 class DefaultTimerManager : public Common::TimerManager {
+public:
+	/**
+	 * How well a timer keeps to its schedule. Times are in microseconds,
+	 * measured with the millisecond resolution of OSystem::getMillis().
+	 */
+	struct TimerStats {
+		Common::String id;      ///< ID the timer was installed with.
+		uint32 interval;        ///< Interval the timer was installed with.
+		uint32 calls;           ///< Number of times the callback was invoked.
+		uint32 missedDeadlines; ///< Calls which came a whole interval or more late.
+		uint32 maxDrift;        ///< Largest delay between a deadline and its call.
+		uint64 totalDrift;      ///< Sum of the delays of all calls.
+
+		TimerStats() : interval(0), calls(0), missedDeadlines(0), maxDrift(0), totalDrift(0) {}
+	};
+
 private:
 	typedef Common::HashMap<Common::String, TimerProc, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> TimerSlotMap;
 
 	Common::Mutex _mutex;
-	TimerSlot *_head;
+	/** Binary min-heap of the installed timers, ordered by their next deadline. */
+	Common::Array<TimerSlot *> _slots;
 	TimerSlotMap _callbacks;
 
-	uint32 _timerCallbackNext;
+	/** In milliseconds. Written under the mutex, read by checkTimers() without it. */
+	Common::Atomic<uint32> _nextDeadline;
+	uint64 _millis;
+	uint32 _nextSequence;
+
+	uint64 getMicros(uint32 millis);
+	void siftUp(uint index);
+	void siftDown(uint index);
+	void updateNextDeadline();
 
 public:
 	DefaultTimerManager();
@@ -47,14 +74,28 @@ public:
 
 	/**
 	 * Timer callback, to be invoked at regular time intervals by the backend.
+	 *
+	 * @return The number of milliseconds until the next timer is due, at
+	 *         most 10. Backends which can vary the interval of their system
+	 *         timer can use this to call the handler right on time.
 	 */
-	void handler();
+	uint32 handler();
 
 	/*
-	 * Ensure that the callback is called at regular time intervals.
+	 * Ensure that the callback is called once a timer is due.
 	 * Should be called from pollEvents() on backends without threads.
 	 */
-	void checkTimers(uint32 interval = 10);
+	void checkTimers();
+
+	/**
+	 * Get the statistics of the given timer callback.
+	 *
+	 * @return True if the callback is installed, false otherwise.
+	 */
+	bool getTimerStats(TimerProc proc, TimerStats &stats);
+
+	/** Get the statistics of all installed timers, in no particular order. */
+	void getAllTimerStats(Common::Array<TimerStats> &stats);
 };
 
 #endif
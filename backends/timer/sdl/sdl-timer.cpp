@@ -30,13 +30,13 @@
 
 #if SDL_VERSION_ATLEAST(3, 0, 0)
 static Uint32 timer_handler(void *userdata, SDL_TimerID timerID, Uint32 interval) {
-	((DefaultTimerManager *)userdata)->handler();
-	return interval;
+	// Wake up again when the next timer is due
+	return ((DefaultTimerManager *)userdata)->handler();
 }
 #else
 static Uint32 timer_handler(Uint32 interval, void *param) {
-	((DefaultTimerManager *)param)->handler();
-	return interval;
+	// Wake up again when the next timer is due
+	return ((DefaultTimerManager *)param)->handler();
 }
 #endif
 
@@ -390,6 +390,8 @@ void registerDefaults() {
 	// If number of game entries in scummvm.ini exceeds the specified
 	// number, then skip scanning. -1 = scan always
 	ConfMan.registerDefault("gui_list_max_scan_entries", -1);
+	ConfMan.registerDefault("detection_cache", true);
+	ConfMan.registerDefault("directory_index", true);
 	ConfMan.registerDefault("game", "");
 
 #ifdef USE_FLUIDSYNTH
@@ -1548,6 +1550,7 @@ static Common::String detectGames(const Common::Path &path, const Common::String
 	//Current directory
 	Common::FSNode dir(path);
 	DetectedGames candidates = recListGames(dir, engineId, gameId, recursive);
+	ADCacheMan.saveFilePropertiesCache();
 
 	if (candidates.empty()) {
 		printf("WARNING: ScummVM could not find any game in %s\n", dir.getPath().toString(Common::Path::kNativeSeparator).c_str());
@@ -1691,6 +1694,7 @@ static bool addGames(const Common::Path &path, const Common::String &engineId, c
 	//Current directory
 	Common::FSNode dir(path);
 	int added = recAddGames(dir, engineId, gameId, recursive);
+	ADCacheMan.saveFilePropertiesCache();
 	printf("Added %d games\n", added);
 	if (added == 0 && !recursive) {
 		printf("Consider using --recursive to search inside subdirectories\n");
@@ -257,6 +257,13 @@ static Common::Error runGame(const Plugin *enginePlugin, OSystem &system, const
 	// Setup various paths in the SearchManager
 	//
 
+	// Remember the directory listings of the game specific paths, so the
+	// next start doesn't have to walk them again, and forget the ones of
+	// games which were removed since
+	if (ConfMan.getBool("directory_index"))
+		Common::FSDirectory::prunePersistentIndexes();
+	SearchMan.setPersistentIndex(ConfMan.getBool("directory_index"));
+
 	// Add the game path to the directory search list
 	engine->initializePath(dir);
 
@@ -324,6 +331,7 @@ static Common::Error runGame(const Plugin *enginePlugin, OSystem &system, const
 	metaEngine.deleteInstance(engine, game, meDescriptor);
 
 	// Reset the file/directory mappings
+	SearchMan.setPersistentIndex(false);
 	SearchMan.clear();
 
 #ifdef USE_TRANSLATION
@@ -674,6 +674,16 @@ DetectionResults EngineManager::detectGames(const Common::FSList &fslist, uint32
 
 	// Clear md5 cache before each detection starts, just in case.
 	ADCacheMan.clear();
+	ADCacheMan.loadFilePropertiesCache();
+
+	// Let the engines tell which files they are interested in, so that
+	// every file is only read once for all of them.
+	for (const auto &plugin : plugins) {
+		MetaEngineDetection &metaEngine = plugin->get<MetaEngineDetection>();
+		DebugMan.addAllDebugChannels(metaEngine.getDebugChannels());
+		metaEngine.prefetchFileProperties(fslist);
+	}
+	ADCacheMan.computeQueuedFileProperties();
 
 	// Iterate over all known games and for each check if it might be
 	// the game in the presented directory.
@@ -173,6 +173,17 @@ Common::Error Archive::dumpArchive(const Path &destPath) {
 	return Common::kNoError;
 }
 
+int Archive::createReadStreamsForMembers(const Array<Path> &paths, Array<SeekableReadStream *> &streams) const {
+	int count = 0;
+	for (const Path &path : paths) {
+		SeekableReadStream *stream = createReadStreamForMember(path);
+		if (stream)
+			count++;
+		streams.push_back(stream);
+	}
+	return count;
+}
+
 char Archive::getPathSeparator() const {
 	return '/';
 }
@@ -249,13 +260,9 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 	cacheKey.path = translatePath(path);
 	cacheKey.altStreamType = isAltStream ? altStreamType : AltStreamType::Invalid;
 
-	bool isNew = false;
 	if (!_cache.contains(cacheKey)) {
 		SharedArchiveContents readResult = isAltStream ? readContentsForPathAltStream(cacheKey.path, altStreamType) : readContentsForPath(cacheKey.path);
-		if (readResult._bypass)
-			return readResult._bypass;
-		_cache[cacheKey] = readResult;
-		isNew = true;
+		return cacheContents(cacheKey, readResult);
 	}
 
 	SharedArchiveContents* entry = &_cache[cacheKey];
@@ -269,30 +276,78 @@ SeekableReadStream *MemcachingCaseInsensitiveArchive::createReadStreamForMemberI
 	if (!entry->makeStrong()) {
 		// If it's expired, recreate the entry.
 		SharedArchiveContents readResult = isAltStream ? readContentsForPathAltStream(cacheKey.path, altStreamType) : readContentsForPath(cacheKey.path);
-		if (readResult._bypass)
-			return readResult._bypass;
-		_cache[cacheKey] = readResult;
-		entry = &_cache[cacheKey];
-		isNew = true;
+		return cacheContents(cacheKey, readResult);
 	}
 
-	// It's possible that recreation failed in case of e.g. network
+	// Now we have a valid contents reference. Make stream for it.
+	return new Common::MemoryReadStream(entry->getContents(), entry->getSize());
+}
+
+SeekableReadStream *MemcachingCaseInsensitiveArchive::cacheContents(const CacheKey &cacheKey, const SharedArchiveContents &contents) const {
+	if (contents._bypass)
+		return contents._bypass;
+
+	_cache[cacheKey] = contents;
+	SharedArchiveContents *entry = &_cache[cacheKey];
+
+	// It's possible that reading failed in case of e.g. network
 	// share going offline.
 	if (entry->isFileMissing())
 		return nullptr;
 
-	// Now we have a valid contents reference. Make stream for it.
 	Common::MemoryReadStream *memStream = new Common::MemoryReadStream(entry->getContents(), entry->getSize());
 
-	// If the entry was just created and it's too big for strong caching,
-	// mark the copy in cache as weak
-	if (isNew && entry->getSize() > _maxStronglyCachedSize) {
+	// If the entry is too big for strong caching, mark the copy in cache
+	// as weak
+	if (entry->getSize() > _maxStronglyCachedSize) {
 		entry->makeWeak();
 	}
 
 	return memStream;
 }
 
+int MemcachingCaseInsensitiveArchive::createReadStreamsForMembers(const Array<Path> &paths, Array<SeekableReadStream *> &streams) const {
+	// Read all members which are not cached yet in one go
+	Array<Path> uncachedPaths;
+	Array<int> contentIndex;
+	for (const Path &path : paths) {
+		CacheKey cacheKey;
+		cacheKey.path = translatePath(path);
+		if (_cache.contains(cacheKey)) {
+			contentIndex.push_back(-1);
+		} else {
+			contentIndex.push_back(uncachedPaths.size());
+			uncachedPaths.push_back(cacheKey.path);
+		}
+	}
+
+	Array<SharedArchiveContents> contents;
+	if (!uncachedPaths.empty())
+		readContentsForPaths(uncachedPaths, contents);
+
+	int count = 0;
+	for (uint i = 0; i < paths.size(); i++) {
+		SeekableReadStream *stream;
+		if (contentIndex[i] < 0) {
+			stream = createReadStreamForMember(paths[i]);
+		} else {
+			CacheKey cacheKey;
+			cacheKey.path = uncachedPaths[contentIndex[i]];
+			stream = cacheContents(cacheKey, contents[contentIndex[i]]);
+		}
+
+		if (stream)
+			count++;
+		streams.push_back(stream);
+	}
+	return count;
+}
+
+void MemcachingCaseInsensitiveArchive::readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents) const {
+	for (const Path &path : translatedPaths)
+		contents.push_back(readContentsForPath(path));
+}
+
 SharedArchiveContents MemcachingCaseInsensitiveArchive::readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const {
 	return SharedArchiveContents();
 }
@@ -361,7 +416,9 @@ void SearchSet::addDirectory(const String &name, const FSNode &dir, int priority
 	if (!dir.exists() || !dir.isDirectory())
 		return;
 
-	add(name, new FSDirectory(dir, depth, flat, _ignoreClashes), priority);
+	FSDirectory *fsDir = new FSDirectory(dir, depth, flat, _ignoreClashes);
+	fsDir->setPersistentIndex(_persistentIndex);
+	add(name, fsDir, priority);
 }
 
 void SearchSet::addDirectory(const Path &directory, int priority, int depth, bool flat) {
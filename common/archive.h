@@ -204,6 +204,16 @@ public:
 		return createReadStreamForMember(path);
 	}
 
+	/**
+	 * Create streams for several members at once. For every path, a stream
+	 * is appended to @p streams, or nullptr if no member with this name
+	 * exists. Archives which have to decompress their members may do so
+	 * on several threads at once.
+	 *
+	 * @return The number of streams which could be created.
+	 */
+	virtual int createReadStreamsForMembers(const Array<Path> &paths, Array<SeekableReadStream *> &streams) const;
+
 	/**
 	 * Dump all files from the archive to the given directory
 	 */
@@ -289,6 +299,7 @@ public:
 	MemcachingCaseInsensitiveArchive(uint32 maxStronglyCachedSize = 512) : _maxStronglyCachedSize(maxStronglyCachedSize) {}
 	SeekableReadStream *createReadStreamForMember(const Path &path) const;
 	SeekableReadStream *createReadStreamForMemberAltStream(const Path &path, Common::AltStreamType altStreamType) const;
+	int createReadStreamsForMembers(const Array<Path> &paths, Array<SeekableReadStream *> &streams) const;
 
 	virtual Path translatePath(const Path &path) const {
 		return path.normalize();
@@ -297,6 +308,13 @@ public:
 	virtual SharedArchiveContents readContentsForPath(const Path &translatedPath) const = 0;
 	virtual SharedArchiveContents readContentsForPathAltStream(const Path &translatedPath, AltStreamType altStreamType) const;
 
+	/**
+	 * Read the contents of several members, appending one entry per path
+	 * to @p contents. The default implementation calls readContentsForPath()
+	 * for each of them.
+	 */
+	virtual void readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents) const;
+
 private:
 	struct CacheKey {
 		CacheKey();
@@ -314,6 +332,7 @@ private:
 	};
 
 	SeekableReadStream *createReadStreamForMemberImpl(const Path &path, bool isAltStream, Common::AltStreamType altStreamType) const;
+	SeekableReadStream *cacheContents(const CacheKey &cacheKey, const SharedArchiveContents &contents) const;
 
 	mutable HashMap<CacheKey, SharedArchiveContents, CacheKey_Hash, CacheKey_EqualTo> _cache;
 	uint32 _maxStronglyCachedSize;
@@ -347,9 +366,10 @@ class SearchSet : public Archive {
 	void insert(const Node& node); //!< Add an archive while keeping the list sorted by descending priority.
 
 	bool _ignoreClashes;
+	bool _persistentIndex;
 
 public:
-	SearchSet() : _ignoreClashes(false) { }
+	SearchSet() : _ignoreClashes(false), _persistentIndex(false) { }
 	virtual ~SearchSet() { clear(); }
 
 	char getPathSeparator() const override { return '/'; }
@@ -477,6 +497,12 @@ public:
 	 */
 	void setIgnoreClashes(bool ignoreClashes) { _ignoreClashes = ignoreClashes; }
 
+	/**
+	 * Keep a persistent index of the directories added from now on. For more details,
+	 * see @ref FSDirectory::setPersistentIndex.
+	 */
+	void setPersistentIndex(bool persistentIndex) { _persistentIndex = persistentIndex; }
+
 	bool getChildren(const Common::Path &path, Common::Array<Common::String> &list, ListMode mode = kListDirectoriesOnly, bool hidden = true) const override;
 };
 
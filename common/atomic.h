@@ -0,0 +1,86 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_ATOMIC_H
+#define COMMON_ATOMIC_H
+
+#include "common/scummsys.h"
+
+#include <atomic>
+
+namespace Common {
+
+/**
+ * @defgroup common_atomic Atomic values
+ * @ingroup common
+ *
+ * @brief Minimal atomic value wrapper for data shared between threads.
+ * @{
+ */
+
+/**
+ * Atomic integral or pointer value.
+ *
+ * Loads use acquire and stores use release semantics, which is what
+ * the producer/consumer structures in ScummVM need. The relaxed
+ * variants are meant for statistics counters and similar values that
+ * do not publish other memory.
+ */
+template<typename T>
+class Atomic {
+public:
+	Atomic() : _value(T()) {}
+	explicit Atomic(T value) : _value(value) {}
+
+	T load() const { return _value.load(std::memory_order_acquire); }
+	T loadRelaxed() const { return _value.load(std::memory_order_relaxed); }
+	void store(T value) { _value.store(value, std::memory_order_release); }
+	void storeRelaxed(T value) { _value.store(value, std::memory_order_relaxed); }
+
+	T exchange(T value) { return _value.exchange(value, std::memory_order_acq_rel); }
+
+	/**
+	 * Replace the value with @p desired if it currently equals @p expected.
+	 * On failure, @p expected receives the current value.
+	 *
+	 * @return true if the value was replaced.
+	 */
+	bool compareExchange(T &expected, T desired) {
+		return _value.compare_exchange_strong(expected, desired, std::memory_order_acq_rel, std::memory_order_acquire);
+	}
+
+	/** Add @p delta and return the previous value. */
+	T fetchAdd(T delta) { return _value.fetch_add(delta, std::memory_order_acq_rel); }
+	/** Subtract @p delta and return the previous value. */
+	T fetchSub(T delta) { return _value.fetch_sub(delta, std::memory_order_acq_rel); }
+
+private:
+	Atomic(const Atomic &);
+	Atomic &operator=(const Atomic &);
+
+	std::atomic<T> _value;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
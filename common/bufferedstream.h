@@ -58,7 +58,8 @@ ReadStream *wrapBufferedReadStream(ReadStream *parentStream, uint32 bufSize, Dis
  * stream should be disposed when the wrapper is disposed.
  *
  * It is safe to call this with a NULL parameter (in this case, NULL is
- * returned).
+ * returned). If the stream contents are already directly addressable in
+ * memory and the wrapper would take ownership, the stream is returned as is.
  *
  * @param parentStream        The SeekableReadStream to wrap in a custom stream.
  * @param bufSize             Size of the buffer.
@@ -95,6 +95,9 @@ typedef Byte Bytef;
 #include "common/compression/deflate.h"
 #include "common/compression/unzip.h"
 #include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/substream.h"
+#include "common/threadpool.h"
 
 #include "common/hashmap.h"
 #include "common/hash-str.h"
@@ -325,6 +328,8 @@ typedef Common::HashMap<Common::Path, cached_file_in_zip, Common::Path::IgnoreCa
 */
 typedef struct {
 	Common::SeekableReadStream *_stream;				/* io structore of the zipfile */
+	Common::SharedPtr<Common::SeekableReadStream> _streamRef;	/* owns _stream, shared with streamed files */
+	Common::SharedPtr<Common::Mutex> _streamMutex;	/* serializes seek+read on _stream, shared with streamed files */
 	unz_global_info gi;				/* public global information */
 	uLong byte_before_the_zipfile;	/* byte before the zipfile, (>0 for sfx)*/
 	uLong num_file;					/* number of the current file in the zipfile*/
@@ -459,6 +464,8 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 	int err = UNZ_OK;
 
 	us->_stream = stream;
+	us->_streamRef = Common::SharedPtr<Common::SeekableReadStream>(stream);
+	us->_streamMutex = Common::SharedPtr<Common::Mutex>(new Common::Mutex());
 
 	central_pos = unzlocal_SearchCentralDir(*us->_stream);
 	if (central_pos == 0)
@@ -489,7 +496,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 		err = UNZ_ERRNO;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -516,7 +522,6 @@ unzFile unzOpen(Common::SeekableReadStream *stream, bool flattenTree) {
 		err = UNZ_BADZIPFILE;
 
 	if (err != UNZ_OK) {
-		delete us->_stream;
 		delete us;
 		return nullptr;
 	}
@@ -606,7 +611,6 @@ int unzClose(unzFile file) {
 		return UNZ_PARAMERROR;
 	s = (unz_s *)file;
 
-	delete s->_stream;
 	delete s;
 	return UNZ_OK;
 }
@@ -641,6 +645,7 @@ static int unzlocal_GetCurrentFileInfoInternal(unzFile file,
 	if (file == nullptr)
 		return UNZ_PARAMERROR;
 	s = (unz_s *)file;
+	Common::StackLock lock(*s->_streamMutex);
 	s->_stream->seek(s->pos_in_central_dir + s->byte_before_the_zipfile, SEEK_SET);
 	if (s->_stream->err())
 		err = UNZ_ERRNO;
@@ -958,62 +963,197 @@ static int unzlocal_CheckCurrentFileCoherencyHeader(unz_s *s, uInt *piSizeVar,
 	return err;
 }
 
-/*
-  Open for reading data the current file in the zipfile.
-  If there is no error and the file is opened, the return value is UNZ_OK.
-*/
-Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
+/* Files from this size on are read while they are used, instead of all at
+   once when they are opened */
+#define UNZ_STREAMING_THRESHOLD (1024 * 1024)
+
+/* Deflated files can only be read while they are used when seeking back in
+   them does not inflate the file again from the start, which needs the seek
+   checkpoints of GZipReadStream. Stored files can always be. */
+#if defined(USE_ZLIB) && ZLIB_VERNUM >= 0x1271
+#define UNZ_STREAM_DEFLATED_FILES
+#endif
+
+/* A file read straight from the zipfile. It shares the zipfile stream
+   and its mutex, so it stays usable after the zipfile has been closed and
+   can be read alongside other files of the zipfile, from any thread. */
+class ZipFileReadStream : public Common::SafeMutexedSeekableSubReadStream {
+public:
+	ZipFileReadStream(const Common::SharedPtr<Common::SeekableReadStream> &parentStream,
+			const Common::SharedPtr<Common::Mutex> &mutex, uint32 begin, uint32 end) :
+		Common::SafeMutexedSeekableSubReadStream(parentStream.get(), begin, end, DisposeAfterUse::NO, *mutex),
+		_parentRef(parentStream), _mutexRef(mutex) {}
+
+private:
+	Common::SharedPtr<Common::SeekableReadStream> _parentRef;
+	Common::SharedPtr<Common::Mutex> _mutexRef;
+};
+
+/* Checks the CRC of a file which is read while it is used. This is only
+   possible when all of the file has been read in order; reads past data
+   which was skipped by seeking ahead are not checked. A mismatch is
+   reported through err(). */
+class ZipCrcCheckingReadStream : public Common::SeekableReadStream {
+public:
+	ZipCrcCheckingReadStream(Common::SeekableReadStream *parentStream, uint32 expectedCrc) :
+		_parentStream(parentStream), _expectedCrc(expectedCrc), _checkedSize(0), _crcError(false) {
+#ifdef USE_ZLIB
+		_crc = crc32(0, nullptr, 0);
+#else
+		_crc = _crcTable.getInitRemainder();
+#endif
+	}
+
+	bool eos() const override { return _parentStream->eos(); }
+	bool err() const override { return _crcError || _parentStream->err(); }
+	void clearErr() override { _crcError = false; _parentStream->clearErr(); }
+
+	int64 pos() const override { return _parentStream->pos(); }
+	int64 size() const override { return _parentStream->size(); }
+	bool seek(int64 offset, int whence = SEEK_SET) override { return _parentStream->seek(offset, whence); }
+
+	uint32 read(void *dataPtr, uint32 dataSize) override {
+		const int64 start = _parentStream->pos();
+		const uint32 len = _parentStream->read(dataPtr, dataSize);
+
+		if (start <= _checkedSize && start + len > _checkedSize) {
+			const uint32 skip = (uint32)(_checkedSize - start);
+			const byte *data = (const byte *)dataPtr + skip;
+#ifdef USE_ZLIB
+			_crc = crc32(_crc, data, len - skip);
+#else
+			for (uint32 i = 0; i < len - skip; i++)
+				_crc = _crcTable.processByte(data[i], _crc);
+#endif
+			_checkedSize = start + len;
+
+			if (_checkedSize == _parentStream->size()) {
 #ifndef USE_ZLIB
-		, const Common::CRC32 &crc
+				_crc = _crcTable.finalize(_crc);
 #endif
-		) {
+				if (_crc != _expectedCrc) {
+					warning("CRC32 mismatch: %08x, %08x", _crc, _expectedCrc);
+					_crcError = true;
+				}
+			}
+		}
+
+		return len;
+	}
+
+private:
+	Common::ScopedPtr<Common::SeekableReadStream> _parentStream;
+#ifndef USE_ZLIB
+	Common::CRC32 _crcTable;
+#endif
+	uint32 _crc;
+	uint32 _expectedCrc;
+	int64 _checkedSize;
+	bool _crcError;
+};
+
+/* unz_pending_file contains a file which has been read from the zipfile,
+   but not decompressed yet */
+typedef struct {
+	unz_file_info file_info;			/* public info about the file */
+	byte *compressedBuffer;				/* the compressed data of small files */
+	Common::SeekableReadStream *stream;	/* the data of large files, decompressed while it is read */
+} unz_pending_file;
+
+/*
+  Read the current file in the zipfile into pending, so that it can be
+  decompressed by unzlocal_DecompressFile, possibly on another thread.
+  Large files are not read yet but get a stream which reads them on demand.
+*/
+static bool unzlocal_ReadCurrentFile(unz_s *s, unz_pending_file *pending) {
 	uInt iSizeVar;
-	unz_s *s;
 	uLong offset_local_extrafield;  /* offset of the local extra field */
 	uInt  size_local_extrafield;    /* size of the local extra field */
 
-	if (file == nullptr)
-		return Common::SharedArchiveContents();
-	s = (unz_s *)file;
+	pending->compressedBuffer = nullptr;
+	pending->stream = nullptr;
+
 	if (!s->current_file_ok)
-		return Common::SharedArchiveContents();
+		return false;
 
-	if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
-				&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
-		return Common::SharedArchiveContents();
+	/* Streamed files of this zipfile may be read on other threads, so
+	   seek+read on the zipfile stream has to be done under its mutex */
+	{
+		Common::StackLock lock(*s->_streamMutex);
+		if (unzlocal_CheckCurrentFileCoherencyHeader(s, &iSizeVar,
+					&offset_local_extrafield, &size_local_extrafield) != UNZ_OK)
+			return false;
+	}
 
 	if (s->cur_file_info.compression_method != 0 && s->cur_file_info.compression_method != Z_DEFLATED) {
 		warning("Unknown compression algoritthm %d", (int)s->cur_file_info.compression_method);
-		return Common::SharedArchiveContents();
+		return false;
+	}
+
+	pending->file_info = s->cur_file_info;
+	uint32 dataOffset = s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar;
+
+	bool streamed = s->cur_file_info.uncompressed_size >= UNZ_STREAMING_THRESHOLD;
+#ifndef UNZ_STREAM_DEFLATED_FILES
+	streamed = streamed && s->cur_file_info.compression_method == 0;
+#endif
+
+	if (streamed) {
+		pending->stream = new ZipFileReadStream(s->_streamRef, s->_streamMutex, dataOffset, dataOffset + s->cur_file_info.compressed_size);
+		if (s->cur_file_info.compression_method == Z_DEFLATED)
+			pending->stream = Common::wrapDeflateReadStream(pending->stream, DisposeAfterUse::YES, s->cur_file_info.uncompressed_size);
+		if (!pending->stream)
+			return false;
+
+		pending->stream = new ZipCrcCheckingReadStream(pending->stream, s->cur_file_info.crc);
+		return true;
 	}
 
-	uint32 crc32_wait = s->cur_file_info.crc;
+	pending->compressedBuffer = new byte[s->cur_file_info.compressed_size];
+	Common::StackLock lock(*s->_streamMutex);
+	s->_stream->seek(dataOffset);
+	s->_stream->read(pending->compressedBuffer, s->cur_file_info.compressed_size);
+	return true;
+}
+
+/*
+  Decompress a file read by unzlocal_ReadCurrentFile and check its CRC.
+  This does not access the zipfile and can run on any thread.
+*/
+static Common::SharedArchiveContents unzlocal_DecompressFile(unz_pending_file *pending
+#ifndef USE_ZLIB
+		, const Common::CRC32 &crc
+#endif
+		) {
+	if (pending->stream)
+		return Common::SharedArchiveContents::bypass(pending->stream);
+
+	const unz_file_info &file_info = pending->file_info;
+	uint32 crc32_wait = file_info.crc;
 
-	byte *compressedBuffer = new byte[s->cur_file_info.compressed_size];
-	s->_stream->seek(s->cur_file_info_internal.offset_curfile + SIZEZIPLOCALHEADER + iSizeVar);
-	s->_stream->read(compressedBuffer, s->cur_file_info.compressed_size);
+	byte *compressedBuffer = pending->compressedBuffer;
 	byte *uncompressedBuffer = nullptr;
 
-	switch (s->cur_file_info.compression_method) {
+	switch (file_info.compression_method) {
 	case 0: // Store
 		uncompressedBuffer = compressedBuffer;
 		break;
 	case Z_DEFLATED:
-		uncompressedBuffer = new byte[s->cur_file_info.uncompressed_size];
-		assert(s->cur_file_info.uncompressed_size == 0 || uncompressedBuffer != nullptr);
-		Common::inflateZlibHeaderless(uncompressedBuffer, s->cur_file_info.uncompressed_size, compressedBuffer, s->cur_file_info.compressed_size);
+		uncompressedBuffer = new byte[file_info.uncompressed_size];
+		assert(file_info.uncompressed_size == 0 || uncompressedBuffer != nullptr);
+		Common::inflateZlibHeaderless(uncompressedBuffer, file_info.uncompressed_size, compressedBuffer, file_info.compressed_size);
 		delete[] compressedBuffer;
 		compressedBuffer = nullptr;
 		break;
 	default:
-		warning("Unknown compression algoritthm %d", (int)s->cur_file_info.compression_method);
+		warning("Unknown compression algoritthm %d", (int)file_info.compression_method);
 		delete[] compressedBuffer;
 		return Common::SharedArchiveContents();
 	}
 #ifndef USE_ZLIB
-	uint32 crc32_data = crc.crcFast(uncompressedBuffer, s->cur_file_info.uncompressed_size);
+	uint32 crc32_data = crc.crcFast(uncompressedBuffer, file_info.uncompressed_size);
 #else
-	uint32 crc32_data = crc32(0, uncompressedBuffer, s->cur_file_info.uncompressed_size);
+	uint32 crc32_data = crc32(0, uncompressedBuffer, file_info.uncompressed_size);
 #endif
 	if (crc32_data != crc32_wait) {
 		delete[] uncompressedBuffer;
@@ -1021,7 +1161,30 @@ Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
 		return Common::SharedArchiveContents();
 	}
 
-	return Common::SharedArchiveContents(uncompressedBuffer, s->cur_file_info.uncompressed_size);
+	return Common::SharedArchiveContents(uncompressedBuffer, file_info.uncompressed_size);
+}
+
+/*
+  Open for reading data the current file in the zipfile.
+  If there is no error and the file is opened, the return value is UNZ_OK.
+*/
+Common::SharedArchiveContents unzOpenCurrentFile (unzFile file
+#ifndef USE_ZLIB
+		, const Common::CRC32 &crc
+#endif
+		) {
+	unz_pending_file pending;
+
+	if (file == nullptr)
+		return Common::SharedArchiveContents();
+	if (!unzlocal_ReadCurrentFile((unz_s *)file, &pending))
+		return Common::SharedArchiveContents();
+
+#ifndef USE_ZLIB
+	return unzlocal_DecompressFile(&pending, crc);
+#else
+	return unzlocal_DecompressFile(&pending);
+#endif
 }
 
 
@@ -1046,6 +1209,7 @@ public:
 	int listMembers(ArchiveMemberList &list) const override;
 	const ArchiveMemberPtr getMember(const Path &path) const override;
 	Common::SharedArchiveContents readContentsForPath(const Common::Path &translated) const override;
+	void readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents) const override;
 	Common::Path translatePath(const Common::Path &path) const override {
 		return _flattenTree ? path.getLastComponent() : path;
 	}
@@ -1121,6 +1285,33 @@ Common::SharedArchiveContents ZipArchive::readContentsForPath(const Common::Path
 #endif
 }
 
+void ZipArchive::readContentsForPaths(const Array<Path> &translatedPaths, Array<SharedArchiveContents> &contents) const {
+	// The zip file can only be read by one thread, but the files can then
+	// be decompressed in parallel
+	Array<unz_pending_file> pending;
+	Array<bool> found;
+	pending.resize(translatedPaths.size());
+	found.resize(translatedPaths.size());
+	for (uint i = 0; i < translatedPaths.size(); i++) {
+		found[i] = unzLocateFile(_zipFile, translatedPaths[i], 2) == UNZ_OK &&
+		           unzlocal_ReadCurrentFile((unz_s *)_zipFile, &pending[i]);
+	}
+
+	const uint first = contents.size();
+	contents.resize(first + translatedPaths.size());
+	parallelFor(0, translatedPaths.size(), 1, [&](uint begin, uint end) {
+		for (uint i = begin; i < end; i++) {
+			if (!found[i])
+				continue;
+#ifndef USE_ZLIB
+			contents[first + i] = unzlocal_DecompressFile(&pending[i], _crc);
+#else
+			contents[first + i] = unzlocal_DecompressFile(&pending[i]);
+#endif
+		}
+	});
+}
+
 Archive *makeZipArchive(const Path &name, bool flattenTree) {
 	return makeZipArchive(SearchMan.createReadStreamForMember(name), flattenTree);
 }
@@ -31,8 +31,15 @@
 #error Version 1.2.0.4 or newer of zlib is required for this code
 #endif
 
+// Resuming inflation in the middle of a stream needs inflateGetDictionary(),
+// which was added in zlib 1.2.7.1.
+#if ZLIB_VERNUM >= 0x1271
+#define ZLIB_HAS_SEEK_CHECKPOINTS
+#endif
+
 #include "common/compression/deflate.h"
 
+#include "common/array.h"
 #include "common/ptr.h"
 #include "common/util.h"
 #include "common/stream.h"
@@ -91,11 +98,30 @@ static bool _shownBackwardSeekingWarning = false;
  * A simple wrapper class which can be used to wrap around an arbitrary
  * other SeekableReadStream and will then provide on-the-fly decompression support.
  * Assumes the compressed data to be in gzip format.
+ *
+ * While decompressing, the stream records a checkpoint roughly every
+ * CHECKPOINT_INTERVAL bytes of output. Seeking resumes from the closest
+ * checkpoint before the target, instead of inflating everything from the
+ * start of the stream again.
  */
 class GZipReadStream : public SeekableReadStream {
 protected:
 	enum {
-		BUFSIZE = 16384		// 1 << MAX_WBITS
+		BUFSIZE = 16384,		// 1 << MAX_WBITS
+		WINDOWSIZE = 32768,		// 1 << MAX_WBITS
+		CHECKPOINT_INTERVAL = 1024 * 1024
+	};
+
+	/**
+	 * A place where inflating can be resumed: the end of a deflate block,
+	 * together with the output window preceding it.
+	 */
+	struct Checkpoint {
+		uint32 pos;			///< Position in the uncompressed data
+		uint64 parentPos;	///< Position of the next compressed byte in the wrapped stream
+		int bits;			///< Number of unused bits in the byte before parentPos
+		uint windowSize;
+		byte *window;
 	};
 
 	byte	_buf[BUFSIZE];
@@ -103,14 +129,76 @@ protected:
 	DisposablePtr<SeekableReadStream> _wrapped;
 	z_stream _stream;
 	int _zlibErr;
+	int _windowBits;
 	uint64 _parentPos;
 	uint32 _pos;
 	uint32 _origSize;
 	bool _eos;
 
+	Array<Checkpoint> _checkpoints;
+	uint32 _nextCheckpoint;
+
+	void addCheckpoint(uint32 pos) {
+#ifdef ZLIB_HAS_SEEK_CHECKPOINTS
+		Checkpoint checkpoint;
+		checkpoint.pos = pos;
+		checkpoint.parentPos = _wrapped->pos() - _stream.avail_in;
+		checkpoint.bits = _stream.data_type & 7;
+		checkpoint.window = new byte[WINDOWSIZE];
+		uInt windowSize = WINDOWSIZE;
+		if (inflateGetDictionary(&_stream, checkpoint.window, &windowSize) != Z_OK) {
+			delete[] checkpoint.window;
+			_nextCheckpoint = 0xFFFFFFFF;
+			return;
+		}
+		checkpoint.windowSize = windowSize;
+		_checkpoints.push_back(checkpoint);
+
+		if (pos < 0xFFFFFFFF - CHECKPOINT_INTERVAL)
+			_nextCheckpoint = pos + CHECKPOINT_INTERVAL;
+		else
+			_nextCheckpoint = 0xFFFFFFFF;
+#else
+		// There is no way to resume from here, stop looking for block ends
+		_nextCheckpoint = 0xFFFFFFFF;
+#endif
+	}
+
+	bool restoreCheckpoint(const Checkpoint &checkpoint) {
+#ifdef ZLIB_HAS_SEEK_CHECKPOINTS
+		// The data after a checkpoint is plain deflate, whatever the
+		// header of the stream was
+		_zlibErr = inflateReset2(&_stream, -MAX_WBITS);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		if (checkpoint.bits) {
+			// The block starts in the middle of the previous byte
+			_wrapped->seek(checkpoint.parentPos - 1, SEEK_SET);
+			const byte partial = _wrapped->readByte();
+			_zlibErr = inflatePrime(&_stream, checkpoint.bits, partial >> (8 - checkpoint.bits));
+			if (_zlibErr != Z_OK)
+				return false;
+		} else {
+			_wrapped->seek(checkpoint.parentPos, SEEK_SET);
+		}
+
+		_zlibErr = inflateSetDictionary(&_stream, checkpoint.window, checkpoint.windowSize);
+		if (_zlibErr != Z_OK)
+			return false;
+
+		_stream.next_in = _buf;
+		_stream.avail_in = 0;
+		_pos = checkpoint.pos;
+		return true;
+#else
+		return false;
+#endif
+	}
+
 public:
 
-	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize) : _wrapped(w, disposeParent), _stream() {
+	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize) : _wrapped(w, disposeParent), _stream(), _nextCheckpoint(CHECKPOINT_INTERVAL) {
 		assert(w != nullptr);
 
 		_parentPos = w->pos();
@@ -137,7 +225,8 @@ public:
 		// the compressed file. This feature was added in zlib 1.2.0.4,
 		// released 10 August 2003.
 		// Note: This is *crucial* for savegame compatibility, do *not* remove!
-		_zlibErr = inflateInit2(&_stream, MAX_WBITS + 32);
+		_windowBits = MAX_WBITS + 32;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -146,7 +235,7 @@ public:
 		_stream.avail_in = 0;
 	}
 
-	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize, const byte *dict, uint dictLen) : _wrapped(w, disposeParent), _stream() {
+	GZipReadStream(SeekableReadStream *w, DisposeAfterUse::Flag disposeParent, uint32 knownSize, const byte *dict, uint dictLen) : _wrapped(w, disposeParent), _stream(), _nextCheckpoint(CHECKPOINT_INTERVAL) {
 		assert(w != nullptr);
 
 		_parentPos = w->pos();
@@ -157,7 +246,8 @@ public:
 		_pos = 0;
 		_eos = false;
 
-		_zlibErr = inflateInit2(&_stream, -MAX_WBITS);
+		_windowBits = -MAX_WBITS;
+		_zlibErr = inflateInit2(&_stream, _windowBits);
 		if (_zlibErr != Z_OK)
 			return;
 
@@ -175,6 +265,8 @@ public:
 
 	~GZipReadStream() {
 		inflateEnd(&_stream);
+		for (uint i = 0; i < _checkpoints.size(); i++)
+			delete[] _checkpoints[i].window;
 	}
 
 	bool err() const override { return (_zlibErr != Z_OK) && (_zlibErr != Z_STREAM_END); }
@@ -194,7 +286,16 @@ public:
 				_stream.next_in = _buf;
 				_stream.avail_in = _wrapped->read(_buf, BUFSIZE);
 			}
-			_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+			const uint32 outPos = _pos + dataSize - _stream.avail_out;
+			if (outPos < _nextCheckpoint) {
+				_zlibErr = inflate(&_stream, Z_NO_FLUSH);
+			} else {
+				// Stop at the end of the next block, the only place where
+				// inflating can be resumed later
+				_zlibErr = inflate(&_stream, Z_BLOCK);
+				if (_zlibErr == Z_OK && (_stream.data_type & 128) && !(_stream.data_type & 64))
+					addCheckpoint(_pos + dataSize - _stream.avail_out);
+			}
 		}
 
 		// Update the position counter
@@ -234,8 +335,20 @@ public:
 
 		assert(newPos >= 0);
 
-		if ((uint32)newPos < _pos) {
-			// To search backward, we have to restart the whole decompression
+		// Find the closest checkpoint before the target
+		const Checkpoint *checkpoint = nullptr;
+		for (uint i = _checkpoints.size(); i > 0; i--) {
+			if (_checkpoints[i - 1].pos <= (uint32)newPos) {
+				checkpoint = &_checkpoints[i - 1];
+				break;
+			}
+		}
+
+		if (checkpoint && (checkpoint->pos > _pos || (uint32)newPos < _pos)) {
+			if (!restoreCheckpoint(*checkpoint))
+				return false;
+		} else if ((uint32)newPos < _pos) {
+			// Without a checkpoint, we have to restart the whole decompression
 			// from the start of the file. A rather wasteful operation, best
 			// to avoid it. :/
 
@@ -251,7 +364,12 @@ public:
 
 			_pos = 0;
 			_wrapped->seek(_parentPos, SEEK_SET);
+#ifdef ZLIB_HAS_SEEK_CHECKPOINTS
+			// Restoring a checkpoint switches the stream to raw deflate
+			_zlibErr = inflateReset2(&_stream, _windowBits);
+#else
 			_zlibErr = inflateReset(&_stream);
+#endif
 			if (_zlibErr != Z_OK)
 				return false; // FIXME: STREAM REWRITE
 			_stream.next_in = _buf;
@@ -0,0 +1,655 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// The hash map implementation in this file uses open addressing with
+// Robin Hood hashing and backward shift deletion.
+
+#ifndef COMMON_FLAT_HASHMAP_H
+#define COMMON_FLAT_HASHMAP_H
+
+#include "common/hashmap.h"
+#include "common/util.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_flat_hashmap Flat hash table (FlatHashMap)
+ * @ingroup common
+ *
+ * @brief Open addressing hash table storing its nodes inline.
+ *
+ * @{
+ */
+
+/**
+ * FlatHashMap<Key,Val> is a drop-in replacement for HashMap<Key,Val> which
+ * stores its nodes directly in the table instead of allocating each of them
+ * separately. Lookups therefore touch a single contiguous array, and inserting
+ * a key does not allocate unless the table has to grow.
+ *
+ * Collisions are resolved with linear probing. Every slot records how far its
+ * node is from the slot it hashed to, and on insertion nodes that are closer
+ * to their home slot make room for the new one ("Robin Hood" hashing). This
+ * keeps probe sequences short and lets unsuccessful lookups stop early.
+ * Erasing a node shifts the following nodes of its cluster back by one, so
+ * there are no tombstones and the table never degrades after many erasures.
+ *
+ * Since nodes live inside the table, there are some differences to HashMap:
+ * - Inserting a key may move every node, which invalidates all references,
+ *   pointers and iterators into the map.
+ * - Erasing a key may move other nodes. To erase while iterating, use the
+ *   iterator returned by erase(iterator); other iterators are invalidated.
+ * - The key of a node must not be modified through an iterator.
+ */
+template<class Key, class Val, class HashFunc = Hash<Key>, class EqualFunc = EqualTo<Key> >
+class FlatHashMap {
+public:
+	typedef uint size_type;
+
+	struct Node {
+		Val _value;
+		Key _key;
+		explicit Node(const Key &key) : _value(), _key(key) {}
+	};
+
+private:
+
+	typedef FlatHashMap<Key, Val, HashFunc, EqualFunc> FHM_t;
+
+	enum {
+		FLATHASHMAP_MIN_CAPACITY = 16,
+
+		// The quotient of the next two constants controls how much the
+		// internal storage of the hashmap may fill up before being
+		// increased automatically. Robin Hood hashing copes well with
+		// high loads, but it must stay below 1 so that there is always
+		// a free slot.
+		FLATHASHMAP_LOADFACTOR_NUMERATOR = 7,
+		FLATHASHMAP_LOADFACTOR_DENOMINATOR = 8,
+
+		// Largest probe distance a slot can record.
+		FLATHASHMAP_MAX_DISTANCE = 0xFFFF
+	};
+
+	/** Default value, returned by the const getVal. */
+	Val _defaultVal;
+
+	Node *_nodes;		///< Node storage, only slots with a non-zero distance are constructed.
+	uint16 *_dist;		///< Probe distance plus one for every slot, 0 marks a free slot.
+	size_type _mask;	///< Capacity of the FlatHashMap minus one; capacity is a power of two.
+	size_type _shift;	///< 32 minus log2 of the capacity, used to map hashes to slots.
+	size_type _size;
+
+	HashFunc _hash;
+	EqualFunc _equal;
+
+	size_type slotForHash(size_type hash) const {
+		// Fibonacci hashing spreads out the poor hash values of simple
+		// hash functions, e.g. the identity for integers
+		return (size_type)((uint32)hash * 2654435769U) >> _shift;
+	}
+
+	/** Find a slot in which every cluster starts, see IteratorImpl. */
+	size_type clusterStart() const {
+		size_type ctr = 0;
+		while (_dist[ctr] > 1)
+			ctr++;
+		return ctr;
+	}
+
+	void allocStorage(size_type capacity);
+	void freeStorage();
+	void assign(const FHM_t &map);
+	size_type lookup(const Key &key) const;
+	size_type lookupAndCreateIfMissing(const Key &key);
+	size_type makeRoom(size_type hash);
+	void eraseSlot(size_type ctr);
+	void expandStorage(size_type newCapacity);
+
+	/**
+	 * FlatHashMap iterator implementation.
+	 *
+	 * Iteration starts at a slot that is either free or holds a node in
+	 * its home slot, and wraps around the table from there. Since erasing
+	 * never shifts such a node, nodes are only ever moved from slots which
+	 * have not been visited yet into the erased one.
+	 *
+	 * Finding the start slot may scan a whole cluster, so iterators
+	 * returned by find() only do so once they are advanced or erased.
+	 */
+	template<class NodeType>
+	class IteratorImpl {
+		friend class FlatHashMap;
+		template<class T> friend class IteratorImpl;
+	protected:
+		typedef const FlatHashMap hashmap_t;
+
+		size_type _idx;
+		size_type _start;	///< (size_type)-1 until it is needed, see resolveStart()
+		hashmap_t *_hashmap;
+
+	protected:
+		IteratorImpl(size_type idx, size_type start, hashmap_t *hashmap) : _idx(idx), _start(start), _hashmap(hashmap) {}
+
+		NodeType *deref() const {
+			assert(_hashmap != nullptr);
+			assert(_idx <= _hashmap->_mask);
+			assert(_hashmap->_dist[_idx] != 0);
+			return &_hashmap->_nodes[_idx];
+		}
+
+		void resolveStart() {
+			if (_start == (size_type)-1)
+				_start = _hashmap->clusterStart();
+		}
+
+		void skipFree() {
+			while (_hashmap->_dist[_idx] == 0) {
+				_idx = (_idx + 1) & _hashmap->_mask;
+				if (_idx == _start) {
+					_idx = (size_type)-1;
+					break;
+				}
+			}
+		}
+
+	public:
+		IteratorImpl() : _idx(0), _start(0), _hashmap(nullptr) {}
+		template<class T>
+		IteratorImpl(const IteratorImpl<T> &c) : _idx(c._idx), _start(c._start), _hashmap(c._hashmap) {}
+
+		NodeType &operator*() const { return *deref(); }
+		NodeType *operator->() const { return deref(); }
+
+		bool operator==(const IteratorImpl &iter) const { return _idx == iter._idx && _hashmap == iter._hashmap; }
+		bool operator!=(const IteratorImpl &iter) const { return !(*this == iter); }
+
+		IteratorImpl &operator++() {
+			assert(_hashmap);
+			assert(_idx != (size_type)-1);
+			resolveStart();
+			_idx = (_idx + 1) & _hashmap->_mask;
+			if (_idx == _start)
+				_idx = (size_type)-1;
+			else
+				skipFree();
+
+			return *this;
+		}
+
+		IteratorImpl operator++(int) {
+			IteratorImpl old = *this;
+			operator ++();
+			return old;
+		}
+	};
+
+public:
+	typedef IteratorImpl<Node> iterator;
+	typedef IteratorImpl<const Node> const_iterator;
+
+	FlatHashMap();
+	FlatHashMap(const FHM_t &map);
+	~FlatHashMap();
+
+	FHM_t &operator=(const FHM_t &map) {
+		if (this == &map)
+			return *this;
+
+		// Remove the previous content and ...
+		freeStorage();
+		// ... copy the new stuff.
+		assign(map);
+		return *this;
+	}
+
+	bool contains(const Key &key) const;
+
+	Val &operator[](const Key &key);
+	const Val &operator[](const Key &key) const;
+
+	Val &getOrCreateVal(const Key &key);
+	Val &getVal(const Key &key);
+	const Val &getVal(const Key &key) const;
+	const Val &getValOrDefault(const Key &key) const;
+	const Val &getValOrDefault(const Key &key, const Val &defaultVal) const;
+	bool tryGetVal(const Key &key, Val &out) const;
+	void setVal(const Key &key, const Val &val);
+
+	void clear(bool shrinkArray = 0);
+	void reserve(size_type count);
+
+	iterator erase(iterator entry);
+	void erase(const Key &key);
+
+	size_type size() const { return _size; }
+
+	iterator	begin() {
+		iterator it(clusterStart(), clusterStart(), this);
+		it.skipFree();
+		return it;
+	}
+	iterator	end() {
+		return iterator((size_type)-1, 0, this);
+	}
+
+	const_iterator	begin() const {
+		const_iterator it(clusterStart(), clusterStart(), this);
+		it.skipFree();
+		return it;
+	}
+	const_iterator	end() const {
+		return const_iterator((size_type)-1, 0, this);
+	}
+
+	iterator	find(const Key &key) {
+		size_type ctr = lookup(key);
+		if (ctr != (size_type)-1)
+			return iterator(ctr, (size_type)-1, this);
+		return end();
+	}
+
+	const_iterator	find(const Key &key) const {
+		size_type ctr = lookup(key);
+		if (ctr != (size_type)-1)
+			return const_iterator(ctr, (size_type)-1, this);
+		return end();
+	}
+
+	/** Return true if hashmap is empty. */
+	bool empty() const {
+		return (_size == 0);
+	}
+};
+
+//-------------------------------------------------------
+// FlatHashMap functions
+
+/**
+ * Base constructor, creates an empty hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap() : _defaultVal() {
+	allocStorage(FLATHASHMAP_MIN_CAPACITY);
+}
+
+/**
+ * Copy constructor, creates a full copy of the given hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::FlatHashMap(const FHM_t &map) : _defaultVal() {
+	assign(map);
+}
+
+/**
+ * Destructor, frees all used memory.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+FlatHashMap<Key, Val, HashFunc, EqualFunc>::~FlatHashMap() {
+	freeStorage();
+}
+
+/**
+ * Internal method for allocating an empty table of the given capacity.
+ *
+ * @note The previous storage is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::allocStorage(size_type capacity) {
+	assert(capacity >= FLATHASHMAP_MIN_CAPACITY && (capacity & (capacity - 1)) == 0);
+
+	_mask = capacity - 1;
+	_shift = 32;
+	for (size_type c = capacity; c > 1; c >>= 1)
+		_shift--;
+	_size = 0;
+
+	_nodes = (Node *)malloc(capacity * sizeof(Node));
+	_dist = (uint16 *)calloc(capacity, sizeof(uint16));
+	assert(_nodes != nullptr && _dist != nullptr);
+}
+
+/**
+ * Internal method for destroying all nodes and freeing the table.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::freeStorage() {
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_dist[ctr])
+			_nodes[ctr].~Node();
+	}
+	free(_nodes);
+	free(_dist);
+	_nodes = nullptr;
+	_dist = nullptr;
+	_size = 0;
+}
+
+/**
+ * Internal method for assigning the content of another FlatHashMap
+ * to this one.
+ *
+ * @note The previous storage is *not* deallocated here -- the caller is
+ *       responsible for doing that!
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::assign(const FHM_t &map) {
+	allocStorage(map._mask + 1);
+
+	// The hash functions are the same, so the layout can be copied as is.
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		_dist[ctr] = map._dist[ctr];
+		if (_dist[ctr])
+			new (&_nodes[ctr]) Node(map._nodes[ctr]);
+	}
+	_size = map._size;
+}
+
+/**
+ * Clear all values in the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::clear(bool shrinkArray) {
+	if (shrinkArray && _mask >= FLATHASHMAP_MIN_CAPACITY) {
+		freeStorage();
+		allocStorage(FLATHASHMAP_MIN_CAPACITY);
+		return;
+	}
+
+	for (size_type ctr = 0; ctr <= _mask; ++ctr) {
+		if (_dist[ctr]) {
+			_nodes[ctr].~Node();
+			_dist[ctr] = 0;
+		}
+	}
+	_size = 0;
+}
+
+/**
+ * Make sure that @p count elements can be stored without the table growing.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::reserve(size_type count) {
+	size_type capacity = _mask + 1;
+	while (count * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		capacity *= 2;
+	if (capacity > _mask + 1)
+		expandStorage(capacity);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::expandStorage(size_type newCapacity) {
+	assert(newCapacity > _mask + 1);
+
+	const size_type old_size = _size;
+	const size_type old_mask = _mask;
+	Node *old_nodes = _nodes;
+	uint16 *old_dist = _dist;
+
+	allocStorage(newCapacity);
+
+	// Move all the old elements over. Since we know that no key exists
+	// twice in the old table, we don't have to call _equal().
+	for (size_type ctr = 0; ctr <= old_mask; ++ctr) {
+		if (!old_dist[ctr])
+			continue;
+
+		const size_type idx = makeRoom(_hash(old_nodes[ctr]._key));
+		new (&_nodes[idx]) Node(Common::move(old_nodes[ctr]));
+		old_nodes[ctr].~Node();
+	}
+
+	// Perform a sanity check: Old number of elements should match the new one!
+	assert(_size == old_size);
+
+	free(old_nodes);
+	free(old_dist);
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookup(const Key &key) const {
+	size_type ctr = slotForHash(_hash(key));
+	for (uint dist = 1; ; ++dist) {
+		// Robin Hood hashing keeps the nodes of a cluster ordered by their
+		// home slot, so once a node is closer to its home than we are to
+		// ours, the key cannot be further along.
+		const uint16 d = _dist[ctr];
+		if (d < dist)
+			return (size_type)-1;
+		if (d == dist && _equal(_nodes[ctr]._key, key))
+			return ctr;
+		ctr = (ctr + 1) & _mask;
+	}
+}
+
+/**
+ * Internal method for reserving the slot a new node with the given hash
+ * belongs in. Nodes which are closer to their home slot are shifted back
+ * by one to make room. The returned slot is marked as used, but the caller
+ * has to construct the node in it.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::makeRoom(size_type hash) {
+	size_type ctr = slotForHash(hash);
+	uint dist = 1;
+	while (_dist[ctr] >= dist) {
+		ctr = (ctr + 1) & _mask;
+		dist++;
+	}
+
+	if (_dist[ctr]) {
+		// Find the end of the cluster and shift everything up to it
+		size_type last = ctr;
+		while (_dist[last])
+			last = (last + 1) & _mask;
+
+		while (last != ctr) {
+			const size_type prev = (last - 1) & _mask;
+			if (_dist[prev] >= FLATHASHMAP_MAX_DISTANCE)
+				error("FlatHashMap: Probe sequence too long, the hash function is likely broken");
+			new (&_nodes[last]) Node(Common::move(_nodes[prev]));
+			_nodes[prev].~Node();
+			_dist[last] = _dist[prev] + 1;
+			last = prev;
+		}
+	}
+
+	if (dist > FLATHASHMAP_MAX_DISTANCE)
+		error("FlatHashMap: Probe sequence too long, the hash function is likely broken");
+	_dist[ctr] = dist;
+	_size++;
+	return ctr;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::size_type FlatHashMap<Key, Val, HashFunc, EqualFunc>::lookupAndCreateIfMissing(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		return ctr;
+
+	// Keep the load factor below a certain threshold.
+	size_type capacity = _mask + 1;
+	if ((_size + 1) * FLATHASHMAP_LOADFACTOR_DENOMINATOR > capacity * FLATHASHMAP_LOADFACTOR_NUMERATOR)
+		expandStorage(capacity < 500 ? (capacity * 4) : (capacity * 2));
+
+	ctr = makeRoom(_hash(key));
+	new (&_nodes[ctr]) Node(key);
+	return ctr;
+}
+
+/**
+ * Internal method for removing the node in the given slot. The following
+ * nodes of the cluster are shifted back by one, so no tombstone is needed.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::eraseSlot(size_type ctr) {
+	_nodes[ctr].~Node();
+	_size--;
+
+	size_type next = (ctr + 1) & _mask;
+	while (_dist[next] > 1) {
+		new (&_nodes[ctr]) Node(Common::move(_nodes[next]));
+		_nodes[next].~Node();
+		_dist[ctr] = _dist[next] - 1;
+		ctr = next;
+		next = (next + 1) & _mask;
+	}
+	_dist[ctr] = 0;
+}
+
+/**
+ * Check whether the hashmap contains the given key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::contains(const Key &key) const {
+	return lookup(key) != (size_type)-1;
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) {
+	return getOrCreateVal(key);
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::operator[](const Key &key) const {
+	return getVal(key);
+}
+
+/**
+ * Get a value from the hashmap.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getOrCreateVal(const Key &key) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	return _nodes[ctr]._value;
+}
+
+/**
+ * @overload
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		return _nodes[ctr]._value;
+	else
+		// See comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getVal(const Key &key) const {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		return _nodes[ctr]._value;
+	else
+		// See comment in HashMap::getVal().
+#ifdef RELEASE_BUILD
+		return _defaultVal;
+#else
+		unknownKeyError(key);
+#endif
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key) const {
+	return getValOrDefault(key, _defaultVal);
+}
+
+/**
+ * Get a value from the hashmap. If the key is not present, then return @p defaultVal.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+const Val &FlatHashMap<Key, Val, HashFunc, EqualFunc>::getValOrDefault(const Key &key, const Val &defaultVal) const {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		return _nodes[ctr]._value;
+	else
+		return defaultVal;
+}
+
+template<class Key, class Val, class HashFunc, class EqualFunc>
+bool FlatHashMap<Key, Val, HashFunc, EqualFunc>::tryGetVal(const Key &key, Val &out) const {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1) {
+		out = _nodes[ctr]._value;
+		return true;
+	} else {
+		return false;
+	}
+}
+
+/**
+ * Assign an element specified by @p key to a value @p val.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::setVal(const Key &key, const Val &val) {
+	size_type ctr = lookupAndCreateIfMissing(key);
+	_nodes[ctr]._value = val;
+}
+
+/**
+ * Erase an element referred to by an iterator.
+ *
+ * @return An iterator to the element following the erased one.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+typename FlatHashMap<Key, Val, HashFunc, EqualFunc>::iterator FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(iterator entry) {
+	// Check whether we have a valid iterator
+	assert(entry._hashmap == this);
+	assert(entry._idx <= _mask);
+	assert(_dist[entry._idx] != 0);
+
+	// Erasing may change where clusters start
+	entry.resolveStart();
+	eraseSlot(entry._idx);
+
+	// The erased slot now either holds the next node, or is free
+	entry.skipFree();
+	return entry;
+}
+
+/**
+ * Erase an element specified by a key.
+ */
+template<class Key, class Val, class HashFunc, class EqualFunc>
+void FlatHashMap<Key, Val, HashFunc, EqualFunc>::erase(const Key &key) {
+	size_type ctr = lookup(key);
+	if (ctr != (size_type)-1)
+		eraseSlot(ctr);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -20,7 +20,12 @@
  */
 
 #include "common/system.h"
+#include "common/config-manager.h"
 #include "common/debug.h"
+#include "common/hash-str.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+#include "common/endian.h"
 #include "common/punycode.h"
 #include "common/textconsole.h"
 #include "backends/fs/abstract-fs.h"
@@ -233,6 +238,14 @@ bool FSNode::isWritable() const {
 	return _realNode && _realNode->isWritable();
 }
 
+bool FSNode::getFileStats(int64 &size, int64 &modificationTime) const {
+	return _realNode && _realNode->getFileStats(size, modificationTime);
+}
+
+bool FSNode::getDirectoryModificationTime(int64 &modificationTime) const {
+	return _realNode && _realNode->getDirectoryModificationTime(modificationTime);
+}
+
 SeekableReadStream *FSNode::createReadStream() const {
 	if (_realNode == nullptr)
 		return nullptr;
@@ -291,27 +304,275 @@ bool FSNode::createDirectory() const {
 	return _realNode->createDirectory();
 }
 
+/** Version of the directory index files, to be bumped whenever their format changes. */
+static const uint32 kFSDirectoryIndexVersion = 2;
+
+/**
+ * Persistent cache of the directory listings done by an FSDirectory.
+ *
+ * Listings are keyed by the path of the listed directory and are only
+ * reused while its modification time stays the same, so only directories
+ * which changed since the previous run are listed again.
+ */
+class FSDirectoryIndex {
+public:
+	FSDirectoryIndex(const FSNode &root);
+
+	/** List all children of the given directory, using the index if possible. */
+	bool getChildren(const FSNode &dir, FSList &list);
+
+	/** Write the index back, dropping listings which were not used. */
+	void save();
+
+	/** Remove the indexes of directories which are not part of any game anymore. */
+	static void prune();
+
+private:
+	struct Entry {
+		String name;
+		bool isDirectory;
+	};
+
+	struct Listing {
+		int64 modificationTime;
+		Array<Entry> entries;
+		bool used;
+	};
+
+	typedef HashMap<String, Listing> ListingMap;
+
+	static Path getIndexDirectory();
+	static bool readHeader(SeekableReadStream &stream, String &root);
+	Path getIndexFile() const;
+	void load();
+
+	String _root;
+	ListingMap _listings;
+	bool _dirty;
+};
+
+FSDirectoryIndex::FSDirectoryIndex(const FSNode &root) : _root(root.getPath().toString('/')), _dirty(false) {
+	load();
+}
+
+Path FSDirectoryIndex::getIndexDirectory() {
+	// Keep the indexes next to the configuration file
+	Path configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return configFile.getParent().appendComponent("fsindex");
+}
+
+Path FSDirectoryIndex::getIndexFile() const {
+	return getIndexDirectory().appendComponent(String::format("%08x.dat", hashit(_root.c_str())));
+}
+
+bool FSDirectoryIndex::readHeader(SeekableReadStream &stream, String &root) {
+	if (stream.readUint32BE() != MKTAG('F', 'S', 'I', 'X') || stream.readUint32LE() != kFSDirectoryIndexVersion)
+		return false;
+
+	root = stream.readString();
+	return !stream.eos() && !stream.err();
+}
+
+void FSDirectoryIndex::load() {
+	FSNode file(getIndexFile());
+	if (!file.exists())
+		return;
+
+	ScopedPtr<SeekableReadStream> stream(file.createReadStream());
+	String root;
+	if (!stream || !readHeader(*stream, root))
+		return;
+
+	// Another directory which happens to have the same hash
+	if (root != _root)
+		return;
+
+	ListingMap listings;
+	const uint32 count = stream->readUint32LE();
+	for (uint32 i = 0; i < count && !stream->eos() && !stream->err(); i++) {
+		String path = stream->readString();
+		Listing listing;
+		listing.modificationTime = stream->readSint64LE();
+		listing.used = false;
+
+		const uint32 entries = stream->readUint32LE();
+		for (uint32 j = 0; j < entries && !stream->eos() && !stream->err(); j++) {
+			Entry entry;
+			entry.isDirectory = stream->readByte() != 0;
+			entry.name = stream->readString();
+			listing.entries.push_back(entry);
+		}
+
+		listings.setVal(path, listing);
+	}
+
+	// An index which was not written completely is not used at all
+	if (stream->readUint32BE() != MKTAG('E', 'N', 'D', ' ') || stream->eos() || stream->err())
+		return;
+
+	_listings = listings;
+}
+
+void FSDirectoryIndex::save() {
+	// Forget directories which are gone or outside of the walked depth
+	Array<String> unused;
+	for (const auto &listing : _listings) {
+		if (!listing._value.used)
+			unused.push_back(listing._key);
+	}
+	for (const auto &path : unused)
+		_listings.erase(path);
+
+	if (!_dirty && unused.empty())
+		return;
+
+	Path indexFile = getIndexFile();
+	FSNode dir(indexFile.getParent());
+	if (!dir.exists() && !dir.createDirectory())
+		return;
+
+	// The index is written to a temporary file, which replaces the old one
+	// when the stream is closed. Another ScummVM instance reading the index
+	// at the same time thus never sees it half written.
+	ScopedPtr<SeekableWriteStream> stream(FSNode(indexFile).createWriteStream(true));
+	if (!stream) {
+		warning("FSDirectoryIndex: Could not write directory index '%s'", indexFile.toString(Path::kNativeSeparator).c_str());
+		return;
+	}
+
+	stream->writeUint32BE(MKTAG('F', 'S', 'I', 'X'));
+	stream->writeUint32LE(kFSDirectoryIndexVersion);
+	stream->writeString(_root);
+	stream->writeByte(0);
+	stream->writeUint32LE(_listings.size());
+	for (const auto &listing : _listings) {
+		stream->writeString(listing._key);
+		stream->writeByte(0);
+		stream->writeSint64LE(listing._value.modificationTime);
+		stream->writeUint32LE(listing._value.entries.size());
+		for (const auto &entry : listing._value.entries) {
+			stream->writeByte(entry.isDirectory ? 1 : 0);
+			stream->writeString(entry.name);
+			stream->writeByte(0);
+		}
+	}
+	stream->writeUint32BE(MKTAG('E', 'N', 'D', ' '));
+
+	if (!stream->flush() || stream->err())
+		warning("FSDirectoryIndex: Could not write directory index '%s'", indexFile.toString(Path::kNativeSeparator).c_str());
+	else
+		_dirty = false;
+}
+
+void FSDirectoryIndex::prune() {
+	FSNode dir(getIndexDirectory());
+	FSList files;
+	if (!dir.isDirectory() || !dir.getChildren(files, FSNode::kListFilesOnly))
+		return;
+
+	// The paths the games are in, as they are written to the indexes
+	Array<String> gamePaths;
+	for (const auto &domain : ConfMan.getGameDomains()) {
+		for (const char *key : { "path", "extrapath" }) {
+			if (!domain._value.contains(key))
+				continue;
+
+			String path = FSNode(Path::fromConfig(domain._value.getVal(key))).getPath().toString('/');
+			if (path.lastChar() != '/')
+				path += '/';
+			gamePaths.push_back(path);
+		}
+	}
+
+	for (const auto &file : files) {
+		String root;
+		bool keep = false;
+		{
+			ScopedPtr<SeekableReadStream> stream(file.createReadStream());
+			keep = stream && readHeader(*stream, root);
+		}
+
+		if (keep) {
+			// Indexes are also kept for the subdirectories the engines add,
+			// as long as they are still there
+			keep = false;
+			for (const auto &gamePath : gamePaths) {
+				if ((root + '/').hasPrefix(gamePath)) {
+					keep = FSNode(Path(root, '/')).isDirectory();
+					break;
+				}
+			}
+		}
+
+		if (!keep && !file._realNode->removeFile())
+			warning("FSDirectoryIndex: Could not remove directory index '%s'", file.getPath().toString(Path::kNativeSeparator).c_str());
+	}
+}
+
+bool FSDirectoryIndex::getChildren(const FSNode &dir, FSList &list) {
+	int64 modificationTime;
+	if (!dir.getDirectoryModificationTime(modificationTime))
+		return dir.getChildren(list, FSNode::kListAll);
+
+	String path = dir.getPath().toString('/');
+	ListingMap::iterator it = _listings.find(path);
+	if (it != _listings.end() && it->_value.modificationTime == modificationTime) {
+		it->_value.used = true;
+		for (const auto &entry : it->_value.entries)
+			list.push_back(FSNode(dir._realNode->getChildWithKnownType(entry.name, entry.isDirectory)));
+		return true;
+	}
+
+	if (!dir.getChildren(list, FSNode::kListAll))
+		return false;
+
+	_dirty = true;
+
+	// Don't remember the listing if the directory changed while listing it
+	int64 newModificationTime;
+	if (!dir.getDirectoryModificationTime(newModificationTime) || newModificationTime != modificationTime) {
+		_listings.erase(path);
+		return true;
+	}
+
+	Listing &listing = _listings[path];
+	listing.modificationTime = modificationTime;
+	listing.used = true;
+	listing.entries.clear();
+	listing.entries.reserve(list.size());
+	for (const auto &node : list) {
+		Entry entry;
+		entry.name = node.getRealName();
+		entry.isDirectory = node.isDirectory();
+		listing.entries.push_back(entry);
+	}
+	return true;
+}
+
 FSDirectory::FSDirectory(const FSNode &node, int depth, bool flat, bool ignoreClashes, bool includeDirectories)
-  : _node(node), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+  : _node(node), _cached(false), _persistentIndex(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
 	_includeDirectories(includeDirectories) {
 }
 
 FSDirectory::FSDirectory(const Path &prefix, const FSNode &node, int depth, bool flat,
 						 bool ignoreClashes, bool includeDirectories)
-  : _node(node), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+  : _node(node), _cached(false), _persistentIndex(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
 	_includeDirectories(includeDirectories) {
 
 	setPrefix(prefix);
 }
 
 FSDirectory::FSDirectory(const Path &name, int depth, bool flat, bool ignoreClashes, bool includeDirectories)
-  : _node(name), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+  : _node(name), _cached(false), _persistentIndex(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
 	_includeDirectories(includeDirectories) {
 }
 
 FSDirectory::FSDirectory(const Path &prefix, const Path &name, int depth, bool flat,
 						 bool ignoreClashes, bool includeDirectories)
-  : _node(name), _cached(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
+  : _node(name), _cached(false), _persistentIndex(false), _depth(depth), _flat(flat), _ignoreClashes(ignoreClashes),
 	_includeDirectories(includeDirectories) {
 
 	setPrefix(prefix);
@@ -324,6 +585,10 @@ void FSDirectory::setPrefix(const Path &prefix) {
 	_prefix = prefix;
 }
 
+void FSDirectory::prunePersistentIndexes() {
+	FSDirectoryIndex::prune();
+}
+
 FSNode FSDirectory::getFSNode() const {
 	return _node;
 }
@@ -333,8 +598,9 @@ FSNode *FSDirectory::lookupCache(NodeCache &cache, const Path &name) const {
 	if (!name.empty()) {
 		ensureCached();
 
-		if (cache.contains(name))
-			return &cache[name];
+		NodeCache::iterator it = cache.find(name);
+		if (it != cache.end())
+			return &it->_value;
 	}
 
 	return nullptr;
@@ -423,12 +689,15 @@ FSDirectory *FSDirectory::getSubDirectory(const Path &prefix, const Path &name,
 	return new FSDirectory(prefix, *node, depth, flat, ignoreClashes);
 }
 
-void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const Path& prefix) const {
+void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const Path& prefix, FSDirectoryIndex *index) const {
 	if (depth <= 0)
 		return;
 
 	FSList list;
-	node.getChildren(list, FSNode::kListAll);
+	if (index)
+		index->getChildren(node, list);
+	else
+		node.getChildren(list, FSNode::kListAll);
 
 	for (auto &curNode : list) {
 		Path name = prefix.appendComponent(curNode.getRealName());
@@ -447,7 +716,7 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const Path& pr
 						        Common::toPrintable(name.toString(Common::Path::kNativeSeparator)).c_str());
 					}
 				}
-				cacheDirectoryRecursive(curNode, depth - 1, _flat ? prefix : name);
+				cacheDirectoryRecursive(curNode, depth - 1, _flat ? prefix : name, index);
 				_subDirCache[name] = curNode;
 				_dirMapCache[prefix].push_back(curNode.getRealName());
 			}
@@ -469,7 +738,14 @@ void FSDirectory::cacheDirectoryRecursive(FSNode node, int depth, const Path& pr
 void FSDirectory::ensureCached() const  {
 	if (_cached)
 		return;
-	cacheDirectoryRecursive(_node, _depth, _prefix);
+
+	if (_persistentIndex && _node.isDirectory()) {
+		FSDirectoryIndex index(_node);
+		cacheDirectoryRecursive(_node, _depth, _prefix, &index);
+		index.save();
+	} else {
+		cacheDirectoryRecursive(_node, _depth, _prefix, nullptr);
+	}
 	_cached = true;
 }
 
@@ -24,6 +24,7 @@
 
 #include "common/array.h"
 #include "common/archive.h"
+#include "common/flat-hashmap.h"
 #include "common/hash-str.h"
 #include "common/hashmap.h"
 #include "common/ptr.h"
@@ -45,6 +46,7 @@ namespace Common {
 
 class FSNode;
 class FSDirectory;
+class FSDirectoryIndex;
 class SeekableReadStream;
 class WriteStream;
 class SeekableWriteStream;
@@ -70,6 +72,7 @@ class FSNode : public ArchiveMember {
 private:
 	friend class ::AbstractFSNode;
 	friend class FSDirectory;
+	friend class FSDirectoryIndex;
 	SharedPtr<AbstractFSNode>	_realNode;
 	/**
 	 * Construct an FSNode from a backend's AbstractFSNode implementation.
@@ -252,6 +255,25 @@ public:
 	 */
 	bool isWritable() const;
 
+	/**
+	 * Query the size and the time of the last modification of the file
+	 * referred by this node. The modification time can only be compared
+	 * against another result of this function.
+	 *
+	 * @return True if the file exists and the backend supports the query, false otherwise.
+	 */
+	bool getFileStats(int64 &size, int64 &modificationTime) const;
+
+	/**
+	 * Query the time of the last modification of the directory referred by
+	 * this node, which changes whenever entries are added to, removed from
+	 * or renamed in it. The result can only be compared against another
+	 * result of this function.
+	 *
+	 * @return True if the directory exists and the backend supports the query, false otherwise.
+	 */
+	bool getDirectoryModificationTime(int64 &modificationTime) const;
+
 	/**
 	 * Create a SeekableReadStream instance corresponding to the file
 	 * referred by this node. This assumes that the node actually refers
@@ -350,17 +372,18 @@ class FSDirectory : public Archive {
 
 	// Caches are case insensitive, clashes are dealt with when creating
 	// Key is stored in lowercase.
-	typedef HashMap<Path, FSNode, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> NodeCache;
-	typedef HashMap<Path, Array<String>, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> NodeMapCache;
+	typedef FlatHashMap<Path, FSNode, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> NodeCache;
+	typedef FlatHashMap<Path, Array<String>, Path::IgnoreCaseAndMac_Hash, Path::IgnoreCaseAndMac_EqualTo> NodeMapCache;
 	mutable NodeCache	_fileCache, _subDirCache;
 	mutable NodeMapCache	_fileMapCache, _dirMapCache;
 	mutable bool _cached;
+	bool _persistentIndex;
 
 	// look for a match
 	FSNode *lookupCache(NodeCache &cache, const Path &name) const;
 
 	// cache management
-	void cacheDirectoryRecursive(FSNode node, int depth, const Path& prefix) const;
+	void cacheDirectoryRecursive(FSNode node, int depth, const Path& prefix, FSDirectoryIndex *index) const;
 
 	// fill cache if not already cached
 	void ensureCached() const;
@@ -398,6 +421,21 @@ public:
 	 */
 	FSNode getFSNode() const;
 
+	/**
+	 * Keep the directory listings of the tree in an index file next to the
+	 * configuration file, and reuse them on the next run for directories
+	 * whose modification time did not change. Must be called before the
+	 * first lookup. Has no effect if the backend can't query directory
+	 * modification times.
+	 */
+	void setPersistentIndex(bool enable) { _persistentIndex = enable; }
+
+	/**
+	 * Remove the index files of directories which are gone, or which are
+	 * not within the path or extra path of any configured game anymore.
+	 */
+	static void prunePersistentIndexes();
+
 	/**
 	 * Create a new FSDirectory pointing to a subdirectory of the instance.
 	 * @return A new FSDirectory instance.
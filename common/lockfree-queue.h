@@ -0,0 +1,130 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_LOCKFREE_QUEUE_H
+#define COMMON_LOCKFREE_QUEUE_H
+
+#include "common/atomic.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_lockfree_queue Lock-free queue
+ * @ingroup common
+ *
+ * @brief Bounded lock-free FIFO queue.
+ * @{
+ */
+
+/**
+ * Bounded FIFO queue which can be pushed to and popped from by any number
+ * of threads without taking a lock.
+ *
+ * Every slot carries a sequence number which tells producers and consumers
+ * whether it is ready to be written or read, so neither side ever waits on
+ * the other. When the queue is full, push() fails instead of blocking; it is
+ * up to the caller to decide how to handle that case.
+ *
+ * @tparam T        Element type. Must be default constructible and copyable.
+ * @tparam CAPACITY Number of slots, must be a power of two.
+ */
+template<class T, uint CAPACITY>
+class LockFreeQueue {
+public:
+	LockFreeQueue() : _enqueuePos(0), _dequeuePos(0) {
+		static_assert((CAPACITY & (CAPACITY - 1)) == 0, "LockFreeQueue capacity must be a power of two");
+		for (uint i = 0; i < CAPACITY; ++i)
+			_cells[i].sequence.storeRelaxed(i);
+	}
+
+	/**
+	 * Append an element to the queue.
+	 *
+	 * @return false if the queue is full.
+	 */
+	bool push(const T &value) {
+		Cell *cell;
+		uint32 pos = _enqueuePos.loadRelaxed();
+		for (;;) {
+			cell = &_cells[pos & (CAPACITY - 1)];
+			const int32 diff = (int32)(cell->sequence.load() - pos);
+			if (diff == 0) {
+				if (_enqueuePos.compareExchange(pos, pos + 1))
+					break;
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _enqueuePos.loadRelaxed();
+			}
+		}
+
+		cell->data = value;
+		cell->sequence.store(pos + 1);
+		return true;
+	}
+
+	/**
+	 * Remove the oldest element from the queue.
+	 *
+	 * @return false if the queue is empty.
+	 */
+	bool pop(T &value) {
+		Cell *cell;
+		uint32 pos = _dequeuePos.loadRelaxed();
+		for (;;) {
+			cell = &_cells[pos & (CAPACITY - 1)];
+			const int32 diff = (int32)(cell->sequence.load() - (pos + 1));
+			if (diff == 0) {
+				if (_dequeuePos.compareExchange(pos, pos + 1))
+					break;
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _dequeuePos.loadRelaxed();
+			}
+		}
+
+		value = cell->data;
+		cell->sequence.store(pos + CAPACITY);
+		return true;
+	}
+
+	/** Whether the queue looked empty at the time of the call. */
+	bool empty() const {
+		return _enqueuePos.load() == _dequeuePos.load();
+	}
+
+private:
+	struct Cell {
+		Atomic<uint32> sequence;
+		T data;
+	};
+
+	Cell _cells[CAPACITY];
+	Atomic<uint32> _enqueuePos;
+	Atomic<uint32> _dequeuePos;
+};
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
@@ -93,6 +93,8 @@ public:
 	int64 size() const { return _size; }
 
 	bool seek(int64 offs, int whence = SEEK_SET);
+
+	const byte *getDirectData() const { return _ptrOrig.get(); }
 };
 
 
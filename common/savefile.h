@@ -182,6 +182,34 @@ public:
 	 */
 	virtual String popErrorDesc();
 
+	/**
+	 * Report the outcome of save files which are written in the background.
+	 *
+	 * While background saving is enabled, some implementations hand the data
+	 * of a finalized OutSaveFile over to a worker thread, which compresses
+	 * and stores it while the engine keeps running. This collects the save
+	 * files which have been stored since the last call, and sets the error
+	 * code and description if one of them could not be written.
+	 *
+	 * @param wait  Whether to wait for the save files which are still being written.
+	 * @return False if a save file could not be written, true otherwise.
+	 *
+	 * @see setBackgroundSaving
+	 */
+	virtual bool checkPendingSaves(bool wait) { return true; }
+
+	/**
+	 * Allow the save files opened from now on to be written in the background.
+	 *
+	 * This is meant for autosaves, which should not stall the game. Errors
+	 * of such save files are only reported by checkPendingSaves(). Otherwise,
+	 * a save file has been stored once OutSaveFile::finalize() returns, and
+	 * OutSaveFile::err() tells whether that succeeded.
+	 *
+	 * @param enable  Whether to write save files in the background.
+	 */
+	virtual void setBackgroundSaving(bool enable) {}
+
 	/**
 	 * Open the save file with the specified @p name in the given directory for
 	 * saving.
@@ -495,8 +495,12 @@ bool BufferedSeekableReadStream::seek(int64 offset, int whence) {
 } // End of anonymous namespace
 
 SeekableReadStream *wrapBufferedSeekableReadStream(SeekableReadStream *parentStream, uint32 bufSize, DisposeAfterUse::Flag disposeParentStream) {
-	if (parentStream)
+	if (parentStream) {
+		// Buffering a stream which is already in memory only adds a copy
+		if (disposeParentStream == DisposeAfterUse::YES && parentStream->getDirectData())
+			return parentStream;
 		return new BufferedSeekableReadStream(parentStream, bufSize, disposeParentStream);
+	}
 	return nullptr;
 }
 
@@ -608,4 +612,9 @@ uint32 SafeMutexedSeekableSubReadStream::read(void *dataPtr, uint32 dataSize) {
 	return Common::SafeSeekableSubReadStream::read(dataPtr, dataSize);
 }
 
+bool SafeMutexedSeekableSubReadStream::seek(int64 offset, int whence) {
+	Common::StackLock lock(_mutex);
+	return Common::SafeSeekableSubReadStream::seek(offset, whence);
+}
+
 } // End of namespace Common
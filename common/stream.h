@@ -792,6 +792,20 @@ public:
 	 */
 	virtual bool skip(uint32 offset) { return seek(offset, SEEK_CUR); }
 
+	/**
+	 * Obtain a pointer to the complete contents of the stream, if they are
+	 * directly addressable in memory (for example, a memory stream or a
+	 * memory-mapped file).
+	 *
+	 * The returned pointer covers size() bytes starting at position 0,
+	 * does not depend on the stream position, and remains valid for the
+	 * lifetime of the stream. It allows parsing data in place instead of
+	 * copying it into a separate buffer first.
+	 *
+	 * @return Pointer to the stream contents, or nullptr if not available.
+	 */
+	virtual const byte *getDirectData() const { return nullptr; }
+
 	/**
 	 * Read at most one less than the number of characters specified
 	 * by @p bufSize from the stream and store them in the string buffer.
@@ -86,6 +86,11 @@ public:
 	virtual int64 size() const { return _end - _begin; }
 
 	virtual bool seek(int64 offset, int whence = SEEK_SET);
+
+	virtual const byte *getDirectData() const {
+		const byte *data = _parentStream->getDirectData();
+		return data ? data + _begin : nullptr;
+	}
 };
 
 /**
@@ -111,7 +116,8 @@ public:
 };
 
 /**
- * A special variant of SafeSeekableSubReadStream which locks a mutex during each read.
+ * A special variant of SafeSeekableSubReadStream which locks a mutex during each read
+ * and seek.
  * This is necessary if the music is streamed from disk and it could happen
  * that a sound effect or another music track is played from the same read stream
  * while the first music track is updated/read.
@@ -124,6 +130,7 @@ public:
 		: SafeSeekableSubReadStream(parentStream, begin, end, disposeParentStream), _mutex(mutex) {
 	}
 	uint32 read(void *dataPtr, uint32 dataSize) override;
+	bool seek(int64 offset, int whence = SEEK_SET) override;
 protected:
 	Common::Mutex &_mutex;
 };
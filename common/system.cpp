@@ -28,6 +28,7 @@
 #include "common/savefile.h"
 #include "common/str.h"
 #include "common/taskbar.h"
+#include "common/threadpool.h"
 #include "common/updates.h"
 #include "common/dialogs.h"
 #include "common/str-enc.h"
@@ -58,6 +59,7 @@ OSystem::OSystem() {
 #endif
 	_fsFactory = nullptr;
 	_dlcStore = nullptr;
+	_threadPool = nullptr;
 	_backendInitialized = false;
 }
 
@@ -120,12 +122,26 @@ void OSystem::initBackend() {
 }
 
 void OSystem::destroy() {
+	// Save files may still be written in the background
+	if (_savefileManager)
+		_savefileManager->checkPendingSaves(true);
+
+	// The worker threads may depend on the backend, stop them first
+	delete _threadPool;
+	_threadPool = nullptr;
+
 	_backendInitialized = false;
 	Common::String::releaseMemoryPoolMutex();
 	Common::releaseCJKTables();
 	delete this;
 }
 
+Common::ThreadPool *OSystem::getThreadPool() {
+	if (!_threadPool)
+		_threadPool = new Common::ThreadPool(createWorkerThreads());
+	return _threadPool;
+}
+
 void OSystem::updateStartSettings(const Common::String &executable, Common::String &command, Common::StringMap &settings, Common::StringArray& additionalArgs) {
 	// If a command was explicitly passed on the command line, do not override it
 	if (!command.empty())
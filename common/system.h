@@ -71,6 +71,8 @@ class DialogManager;
 #endif
 class TimerManager;
 class SeekableReadStream;
+class ThreadPool;
+class WorkerThreadsInternal;
 class WriteStream;
 class HardwareInputSet;
 class Keymap;
@@ -267,6 +269,13 @@ protected:
 	 */
 	DLC::Store *_dlcStore;
 
+	/**
+	 * Created by getThreadPool() on first use.
+	 *
+	 * @note _threadPool is deleted by destroy(), before the backend goes away.
+	 */
+	Common::ThreadPool *_threadPool;
+
 	/**
 	 * Used by the default clipboard implementation, for backends that don't
 	 * implement clipboard support.
@@ -1591,7 +1600,7 @@ public:
 
 
 	/**
-	 * @defgroup common_system_mutex Mutex handling
+	 * @defgroup common_system_mutex Mutex and thread pool handling
 	 * @ingroup common_system
 	 * @{
 	 *
@@ -1607,6 +1616,10 @@ public:
 	 *
 	 * Hence, backends that do not use threads to implement the timers can simply
 	 * use dummy implementations for these methods.
+	 *
+	 * Work which can be split up, like converting video frames, can use the
+	 * thread pool. Engine code never sees the threads themselves, and on
+	 * backends without threads the pool runs everything on the main thread.
 	 */
 
 	/**
@@ -1616,6 +1629,26 @@ public:
 	 */
 	virtual Common::MutexInternal *createMutex() = 0;
 
+	/**
+	 * Create the threads of the thread pool.
+	 *
+	 * Backends which can run threads on several cores should override
+	 * this. The threads must be able to use the mutexes of createMutex().
+	 *
+	 * @return The threads, or nullptr if the backend cannot provide them.
+	 *         All tasks then run on the calling thread.
+	 */
+	virtual Common::WorkerThreadsInternal *createWorkerThreads() { return nullptr; }
+
+	/**
+	 * Return the thread pool shared by engines and subsystems, see
+	 * Common::ThreadPool.
+	 *
+	 * The pool is created on the first call, which must come from the
+	 * main thread.
+	 */
+	Common::ThreadPool *getThreadPool();
+
 	/** @} */
 
 
@@ -0,0 +1,255 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/threadpool.h"
+#include "common/system.h"
+
+namespace Common {
+
+bool ThreadPool::WorkQueue::push(const Task &task) {
+	StackLock lock(_mutex);
+	if (_tail - _head == kSize)
+		return false;
+	_tasks[_tail++ % kSize] = task;
+	return true;
+}
+
+bool ThreadPool::WorkQueue::popBack(Task &task) {
+	StackLock lock(_mutex);
+	if (_tail == _head)
+		return false;
+	task = _tasks[--_tail % kSize];
+	return true;
+}
+
+bool ThreadPool::WorkQueue::popFront(Task &task) {
+	StackLock lock(_mutex);
+	if (_tail == _head)
+		return false;
+	task = _tasks[_head++ % kSize];
+	return true;
+}
+
+ThreadPool::ThreadPool(WorkerThreadsInternal *internal) : _internal(internal), _nextQueue(0), _quit(0), _waitMutex(nullptr), _waiters(0) {
+	if (!_internal)
+		return;
+
+	const uint numCPUs = _internal->getCPUCount();
+	const uint numWorkers = MIN<uint>(numCPUs > 1 ? numCPUs - 1 : 0, kMaxWorkers);
+
+	// The queues must exist before the workers look at them. If fewer
+	// threads can be started, the others steal from the surplus queues.
+	for (uint i = 0; i < numWorkers; ++i)
+		_queues.push_back(new WorkQueue());
+
+	_waitMutex = new Mutex();
+
+	if (!numWorkers || !_internal->start(&workerMain, this, numWorkers)) {
+		for (uint i = 0; i < _queues.size(); ++i)
+			delete _queues[i];
+		_queues.clear();
+		delete _waitMutex;
+		_waitMutex = nullptr;
+		delete _internal;
+		_internal = nullptr;
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	if (_internal) {
+		_quit.store(1);
+		_internal->wake(_queues.size());
+		_internal->join();
+		delete _internal;
+	}
+
+	for (uint i = 0; i < _queues.size(); ++i)
+		delete _queues[i];
+	delete _waitMutex;
+}
+
+bool ThreadPool::submit(const Task &task) {
+	const uint count = _queues.size();
+	const uint first = _nextQueue.fetchAdd(1) % count;
+
+	for (uint i = 0; i < count; ++i) {
+		if (_queues[(first + i) % count]->push(task)) {
+			_internal->wake(1);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::runTask(const Task &task) {
+	TaskGroup *group = task.group;
+	task.func(task.data);
+
+	// The group may be gone as soon as its last task is done, so only
+	// the pool is touched afterwards
+	if (group->_pending.fetchSub(1) == 1) {
+		_waitMutex->lock();
+		const uint waiters = _waiters;
+		_waiters = 0;
+		_waitMutex->unlock();
+
+		if (waiters)
+			_internal->wakeWaiters(waiters);
+	}
+}
+
+void ThreadPool::waitForGroup(TaskGroup *group) {
+	// Every waiter is woken when any group finishes, and checks again
+	// whether it was its own. Registering under the mutex makes sure the
+	// wake-up for the last task of the group is not missed.
+	_waitMutex->lock();
+	if (group->_pending.load() == 0) {
+		_waitMutex->unlock();
+		return;
+	}
+	_waiters++;
+	_waitMutex->unlock();
+
+	_internal->sleepWaiter();
+}
+
+bool ThreadPool::runTask(uint worker, bool owner) {
+	const uint count = _queues.size();
+	Task task;
+
+	if (owner && _queues[worker]->popBack(task)) {
+		runTask(task);
+		return true;
+	}
+
+	for (uint i = owner ? 1 : 0; i < count; ++i) {
+		if (_queues[(worker + i) % count]->popFront(task)) {
+			runTask(task);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::workerMain(void *data, uint index) {
+	ThreadPool *pool = (ThreadPool *)data;
+
+	// Every submitted task wakes a worker once, and a woken worker only
+	// sleeps again after finding all queues empty, so no task is left
+	// behind while the workers sleep.
+	while (!pool->_quit.load()) {
+		if (!pool->runTask(index, true))
+			pool->_internal->sleep();
+	}
+}
+
+TaskGroup::TaskGroup(ThreadPool *pool) : _pool(pool), _pending(0) {
+	if (!_pool)
+		_pool = g_system->getThreadPool();
+}
+
+TaskGroup::~TaskGroup() {
+	wait();
+}
+
+void TaskGroup::run(ThreadPool::TaskFunc func, void *data) {
+	if (_pool->getWorkerCount() == 0) {
+		func(data);
+		return;
+	}
+
+	ThreadPool::Task task;
+	task.func = func;
+	task.data = data;
+	task.group = this;
+
+	_pending.fetchAdd(1);
+	if (!_pool->submit(task)) {
+		_pending.fetchSub(1);
+		func(data);
+	}
+}
+
+void TaskGroup::wait() {
+	uint next = 0;
+	while (_pending.load() > 0) {
+		// Help out while there is work in the queues. Once they are empty,
+		// the remaining tasks of this group are running on other threads,
+		// which may take a while, so sleep until they are done.
+		if (!_pool->runTask(next++ % _pool->getWorkerCount(), false))
+			_pool->waitForGroup(this);
+	}
+}
+
+namespace {
+
+struct ParallelForJob {
+	RangeFunc func;
+	void *data;
+	uint end;
+	uint grain;
+	Atomic<uint> next;
+
+	ParallelForJob(RangeFunc f, void *d, uint b, uint e, uint g) : func(f), data(d), end(e), grain(g), next(b) {}
+};
+
+void runParallelFor(void *arg) {
+	ParallelForJob *job = (ParallelForJob *)arg;
+
+	// Threads take chunks until none are left, so a slow thread does not
+	// hold up the others
+	for (;;) {
+		const uint begin = job->next.fetchAdd(job->grain);
+		if (begin >= job->end)
+			break;
+		const uint end = (job->end - begin > job->grain) ? begin + job->grain : job->end;
+		job->func(job->data, begin, end);
+	}
+}
+
+} // End of anonymous namespace
+
+void parallelFor(uint begin, uint end, uint grain, RangeFunc func, void *data, ThreadPool *pool) {
+	if (begin >= end)
+		return;
+	if (!pool)
+		pool = g_system->getThreadPool();
+	if (grain == 0)
+		grain = 1;
+
+	const uint numChunks = (end - begin - 1) / grain + 1;
+	if (numChunks == 1 || pool->getWorkerCount() == 0) {
+		func(data, begin, end);
+		return;
+	}
+
+	ParallelForJob job(func, data, begin, end, grain);
+	TaskGroup group(pool);
+
+	const uint numHelpers = MIN<uint>(numChunks - 1, pool->getWorkerCount());
+	for (uint i = 0; i < numHelpers; ++i)
+		group.run(&runParallelFor, &job);
+
+	runParallelFor(&job);
+	group.wait();
+}
+
+} // End of namespace Common
@@ -0,0 +1,277 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include "common/array.h"
+#include "common/atomic.h"
+#include "common/mutex.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+/**
+ * @defgroup common_threadpool Thread pool
+ * @ingroup common
+ *
+ * @brief Worker threads shared by engines and subsystems.
+ * @{
+ */
+
+/**
+ * Backend side of the thread pool, as returned by
+ * OSystem::createWorkerThreads(). It starts the worker threads and lets
+ * them sleep while there is nothing to do.
+ */
+class WorkerThreadsInternal {
+public:
+	typedef void (*WorkerProc)(void *data, uint index);
+
+	virtual ~WorkerThreadsInternal() {}
+
+	/**
+	 * Return the number of threads the host can run at the same time,
+	 * including the main thread.
+	 */
+	virtual uint getCPUCount() const = 0;
+
+	/**
+	 * Start @p count threads. Thread number i runs proc(data, i).
+	 *
+	 * @return The number of threads which could be started.
+	 */
+	virtual uint start(WorkerProc proc, void *data, uint count) = 0;
+
+	/**
+	 * Wait until all threads started by start() have returned.
+	 */
+	virtual void join() = 0;
+
+	/**
+	 * Block the calling thread until wake() is called. Calls to wake()
+	 * are counted like the posts of a semaphore, so a wake() which comes
+	 * before the sleep() is not lost.
+	 */
+	virtual void sleep() = 0;
+
+	/**
+	 * Let @p count calls to sleep() return.
+	 */
+	virtual void wake(uint count) = 0;
+
+	/**
+	 * Block a thread waiting on a TaskGroup until wakeWaiters() is called.
+	 * This works like sleep(), but keeps its own count.
+	 */
+	virtual void sleepWaiter() = 0;
+
+	/**
+	 * Let @p count calls to sleepWaiter() return.
+	 */
+	virtual void wakeWaiters(uint count) = 0;
+};
+
+class TaskGroup;
+
+/**
+ * A fixed set of worker threads, started once and shared by everything
+ * which has work to split up. Use g_system->getThreadPool() to get it.
+ *
+ * Every worker owns a queue of tasks. A worker takes new tasks from the
+ * back of its own queue, and steals from the front of the other queues
+ * when its own is empty. Threads waiting on a TaskGroup run tasks as well,
+ * so waiting never leaves a core idle while there is work left.
+ *
+ * On backends without threads, the pool has no workers and tasks run on
+ * the calling thread right away.
+ */
+class ThreadPool : NonCopyable {
+public:
+	typedef void (*TaskFunc)(void *data);
+
+	/**
+	 * More workers than this mostly wait on memory in the kind of work
+	 * ScummVM splits up.
+	 */
+	static const uint kMaxWorkers = 15;
+
+	/**
+	 * @param internal The backend threads, or nullptr to run everything
+	 *                 on the calling thread. The pool takes ownership.
+	 */
+	explicit ThreadPool(WorkerThreadsInternal *internal);
+	~ThreadPool();
+
+	/**
+	 * Return the number of worker threads. This is 0 if tasks run on the
+	 * calling thread.
+	 */
+	uint getWorkerCount() const { return _queues.size(); }
+
+	/**
+	 * Return the number of threads which take part in a parallelFor(),
+	 * i.e. the workers plus the calling thread.
+	 */
+	uint getConcurrency() const { return _queues.size() + 1; }
+
+private:
+	friend class TaskGroup;
+
+	struct Task {
+		TaskFunc func;
+		void *data;
+		TaskGroup *group;
+	};
+
+	/**
+	 * The tasks of one worker. The owner takes the newest task from the
+	 * back, other threads steal the oldest one from the front.
+	 */
+	class WorkQueue {
+	public:
+		static const uint kSize = 256;
+
+		WorkQueue() : _head(0), _tail(0) {}
+
+		bool push(const Task &task);
+		bool popBack(Task &task);
+		bool popFront(Task &task);
+
+	private:
+		Mutex _mutex;
+		Task _tasks[kSize];
+		uint _head, _tail;
+	};
+
+	bool submit(const Task &task);
+
+	/**
+	 * Run one pending task, starting the search at the queue of @p worker.
+	 *
+	 * @return false if there was no task to run.
+	 */
+	bool runTask(uint worker, bool owner);
+
+	void runTask(const Task &task);
+	static void workerMain(void *data, uint index);
+
+	/**
+	 * Block until a task group finishes, unless @p group has no pending
+	 * tasks left.
+	 */
+	void waitForGroup(TaskGroup *group);
+
+	WorkerThreadsInternal *_internal;
+	Array<WorkQueue *> _queues;
+	Atomic<uint32> _nextQueue;
+	Atomic<int> _quit;
+
+	Mutex *_waitMutex;
+	uint _waiters;
+};
+
+/**
+ * A set of tasks which can be waited on together.
+ *
+ * The tasks must not wait on the task group they belong to. They can
+ * start and wait on task groups of their own, though.
+ */
+class TaskGroup : NonCopyable {
+public:
+	/**
+	 * @param pool The pool to run the tasks on, nullptr for the pool of
+	 *             g_system.
+	 */
+	explicit TaskGroup(ThreadPool *pool = nullptr);
+
+	/**
+	 * Waits for all tasks which are still running.
+	 */
+	~TaskGroup();
+
+	ThreadPool *getPool() const { return _pool; }
+
+	/**
+	 * Run func(data) asynchronously. If the pool has no workers, or its
+	 * queues are full, the task runs before this returns.
+	 */
+	void run(ThreadPool::TaskFunc func, void *data);
+
+	/**
+	 * Run func() asynchronously. The function object must stay alive
+	 * until wait() returns.
+	 */
+	template<class F>
+	void run(F &func) {
+		run(&callFunction<F>, &func);
+	}
+
+	/**
+	 * Wait until all tasks of this group have finished. The calling thread
+	 * runs pending tasks, of this group or any other, in the meantime, and
+	 * sleeps once there are none left.
+	 */
+	void wait();
+
+private:
+	friend class ThreadPool;
+
+	template<class F>
+	static void callFunction(void *data) {
+		(*(F *)data)();
+	}
+
+	ThreadPool *_pool;
+	Atomic<int> _pending;
+};
+
+typedef void (*RangeFunc)(void *data, uint begin, uint end);
+
+/**
+ * Call func(data, b, e) for consecutive sub-ranges [b, e) which together
+ * cover [begin, end), distributed over the threads of @p pool. Sub-ranges
+ * are at least @p grain elements long, except for the last one. Returns
+ * when the whole range has been processed.
+ *
+ * @param pool The pool to use, nullptr for the pool of g_system.
+ */
+void parallelFor(uint begin, uint end, uint grain, RangeFunc func, void *data, ThreadPool *pool = nullptr);
+
+/**
+ * Call func(b, e) for consecutive sub-ranges [b, e) of [begin, end), see
+ * above. The function object is called from several threads at once.
+ */
+template<class F>
+void parallelFor(uint begin, uint end, uint grain, const F &func, ThreadPool *pool = nullptr) {
+	struct Caller {
+		static void call(void *data, uint b, uint e) {
+			(*(const F *)data)(b, e);
+		}
+	};
+	parallelFor(begin, end, grain, &Caller::call, const_cast<F *>(&func), pool);
+}
+
+/** @} */
+
+} // End of namespace Common
+
+#endif
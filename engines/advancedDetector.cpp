@@ -27,9 +27,11 @@
 #include "common/macresman.h"
 #include "common/md5.h"
 #include "common/config-manager.h"
+#include "common/ptr.h"
 #include "common/punycode.h"
 #include "common/system.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
 #include "common/compression/clickteam.h"
@@ -442,7 +444,7 @@ void AdvancedMetaEngineDetectionBase::composeFileHashMap(FileMap &allFiles, cons
 				continue;
 
 			Common::FSList files;
-			if (!file.getChildren(files, Common::FSNode::kListAll))
+			if (!ADCacheMan.getChildren(file, files))
 				continue;
 
 			composeFileHashMap(allFiles, files, depth - 1, tstr);
@@ -532,6 +534,27 @@ Common::String md5PropToGameFile(MD5Properties flags) {
 
 static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngineBase::FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps);
 
+static bool computeStreamProperties(Common::SeekableReadStream &stream, uint md5Bytes, MD5Properties md5prop, FileProperties &fileProps) {
+	if (md5prop & kMD5Tail) {
+		if (stream.size() > md5Bytes)
+			stream.seek(-(int64)md5Bytes, SEEK_END);
+	}
+
+	fileProps.size = stream.size();
+	fileProps.md5 = Common::computeStreamMD5AsString(stream, md5Bytes);
+	fileProps.md5prop = (MD5Properties) (md5prop & kMD5Tail);
+	return true;
+}
+
+/** Compute the properties of a plain file, i.e. not a Mac fork or an archive member. */
+static bool computeFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes, FileProperties &fileProps) {
+	Common::File file;
+	if (!file.open(node))
+		return false;
+
+	return computeStreamProperties(file, md5Bytes, md5prop, fileProps);
+}
+
 bool AdvancedMetaEngineDetectionBase::getFileProperties(const FileMap &allFiles, MD5Properties md5prop, const Common::Path &fname, FileProperties &fileProps) const {
 	Common::String hashname = md5PropToCachePrefix(md5prop);
 		hashname += ':';
@@ -649,25 +672,254 @@ static bool getFilePropertiesIntern(uint md5Bytes, const AdvancedMetaEngineBase:
 			return false;
 		}
 	} else {
-		if (!allFiles.contains(fname))
+		AdvancedMetaEngineBase::FileMap::const_iterator file = allFiles.find(fname);
+		if (file == allFiles.end())
 			return false;
 
-		testFile.reset(new Common::File());
-		if (!((Common::File *)testFile.get())->open(allFiles[fname]))
+		// Plain files are shared between engines and detection runs
+		if (ADCacheMan.getFileProperties(file->_value, md5prop, md5Bytes, fileProps))
+			return true;
+
+		if (!computeFileProperties(file->_value, md5prop, md5Bytes, fileProps))
 			return false;
+
+		ADCacheMan.setFileProperties(file->_value, md5prop, md5Bytes, fileProps);
+		return true;
 	}
 
-	if (md5prop & kMD5Tail) {
-		if (testFile->size() > md5Bytes)
-			testFile->seek(-(int64)md5Bytes, SEEK_END);
+	return computeStreamProperties(*testFile.get(), md5Bytes, md5prop, fileProps);
+}
+
+/** Version of the detection cache file, to be bumped whenever its format changes. */
+static const uint32 kFilePropertiesCacheVersion = 1;
+
+bool AdvancedDetectorCacheManager::getChildren(const Common::FSNode &dir, Common::FSList &list) {
+	DirHashMap::const_iterator it = dirHashMap.find(dir.getPath());
+	if (it != dirHashMap.end()) {
+		list = it->_value;
+		return true;
 	}
 
-	fileProps.size = testFile->size();
-	fileProps.md5 = Common::computeStreamMD5AsString(*testFile.get(), md5Bytes);
-	fileProps.md5prop = (MD5Properties) (md5prop & kMD5Tail);
+	if (!dir.getChildren(list, Common::FSNode::kListAll))
+		return false;
+
+	dirHashMap.setVal(dir.getPath(), list);
 	return true;
 }
 
+Common::String AdvancedDetectorCacheManager::filePropertiesKey(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes) {
+	return Common::String::format("%s:%u:%s", md5PropToCachePrefix(md5prop).c_str(), md5Bytes, node.getPath().toString('/').c_str());
+}
+
+bool AdvancedDetectorCacheManager::getFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes, FileProperties &fileProps) {
+	FilePropertiesMap::iterator it = filePropertiesMap.find(filePropertiesKey(node, md5prop, md5Bytes));
+	if (it == filePropertiesMap.end())
+		return false;
+
+	CachedFileProperties &cached = it->_value;
+	if (cached.session != session) {
+		int64 size, modificationTime;
+		if (!node.getFileStats(size, modificationTime) || size != cached.size || modificationTime != cached.modificationTime) {
+			filePropertiesMap.erase(it);
+			filePropertiesDirty = true;
+			return false;
+		}
+		cached.session = session;
+	}
+
+	fileProps.size = cached.size;
+	fileProps.md5 = cached.md5;
+	fileProps.md5prop = (MD5Properties)(md5prop & kMD5Tail);
+	return true;
+}
+
+void AdvancedDetectorCacheManager::setFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes, const FileProperties &fileProps) {
+	CachedFileProperties cached;
+	if (!node.getFileStats(cached.size, cached.modificationTime) || cached.size != fileProps.size)
+		return;
+
+	cached.md5 = fileProps.md5;
+	cached.session = session;
+	filePropertiesMap.setVal(filePropertiesKey(node, md5prop, md5Bytes), cached);
+	filePropertiesDirty = true;
+}
+
+void AdvancedDetectorCacheManager::queueFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes) {
+	QueuedFile file;
+	file.key = filePropertiesKey(node, md5prop, md5Bytes);
+
+	// Many engines share file names, only queue every file once
+	FilePropertiesMap::const_iterator it = filePropertiesMap.find(file.key);
+	if (it != filePropertiesMap.end() && it->_value.session == session)
+		return;
+	for (const auto &queued : queuedFiles) {
+		if (queued.key == file.key)
+			return;
+	}
+
+	file.node = node;
+	file.md5prop = md5prop;
+	file.md5Bytes = md5Bytes;
+	queuedFiles.push_back(file);
+}
+
+void AdvancedDetectorCacheManager::computeQueuedFileProperties() {
+	struct Computed {
+		const QueuedFile *queued;
+		FileProperties fileProps;
+		bool valid;
+	};
+
+	// The cache is only used on this thread
+	Common::Array<Computed> computed;
+	for (const auto &queued : queuedFiles) {
+		FileProperties fileProps;
+		if (getFileProperties(queued.node, queued.md5prop, queued.md5Bytes, fileProps))
+			continue;
+
+		Computed entry;
+		entry.queued = &queued;
+		entry.valid = false;
+		computed.push_back(entry);
+	}
+
+	// Reading and hashing the files is what takes the time
+	Common::parallelFor(0, computed.size(), 1, [&computed](uint begin, uint end) {
+		for (uint i = begin; i < end; i++) {
+			const QueuedFile &queued = *computed[i].queued;
+			computed[i].valid = computeFileProperties(queued.node, queued.md5prop, queued.md5Bytes, computed[i].fileProps);
+		}
+	});
+
+	for (const auto &entry : computed) {
+		if (entry.valid)
+			setFileProperties(entry.queued->node, entry.queued->md5prop, entry.queued->md5Bytes, entry.fileProps);
+	}
+	queuedFiles.clear();
+}
+
+Common::Path AdvancedDetectorCacheManager::filePropertiesCachePath() {
+	// Keep the cache next to the configuration file
+	Common::Path configFile = ConfMan.getCustomConfigFileName();
+	if (configFile.empty())
+		configFile = g_system->getDefaultConfigFileName();
+
+	return configFile.getParent().appendComponent("detection-cache.dat");
+}
+
+void AdvancedDetectorCacheManager::loadFilePropertiesCache() {
+	if (filePropertiesLoaded || !ConfMan.getBool("detection_cache"))
+		return;
+
+	filePropertiesLoaded = true;
+
+	Common::FSNode file(filePropertiesCachePath());
+	if (!file.exists())
+		return;
+
+	Common::ScopedPtr<Common::SeekableReadStream> stream(file.createReadStream());
+	if (!stream || stream->readUint32BE() != MKTAG('A', 'D', 'F', 'P') || stream->readUint32LE() != kFilePropertiesCacheVersion) {
+		warning("AdvancedDetectorCacheManager: Ignoring invalid detection cache '%s'", file.getPath().toString(Common::Path::kNativeSeparator).c_str());
+		return;
+	}
+
+	const uint32 count = stream->readUint32LE();
+	for (uint32 i = 0; i < count && !stream->eos() && !stream->err(); i++) {
+		Common::String key = stream->readString();
+		CachedFileProperties cached;
+		cached.size = stream->readSint64LE();
+		cached.modificationTime = stream->readSint64LE();
+		cached.md5 = stream->readString();
+
+		// Only trust the properties once the file was checked again
+		cached.session = 0;
+
+		if (!stream->eos() && !stream->err())
+			filePropertiesMap.setVal(key, cached);
+	}
+
+	debugC(2, kDebugGlobalDetection, "Loaded %u cached file properties", filePropertiesMap.size());
+}
+
+void AdvancedDetectorCacheManager::pruneFilePropertiesCache() {
+	Common::Array<Common::String> gone;
+	for (const auto &entry : filePropertiesMap) {
+		// Files which were checked during this run are still there
+		if (entry._value.session == session)
+			continue;
+
+		// The key is the cache prefix, the byte count and the path
+		const char *path = strchr(entry._key.c_str(), ':');
+		if (path)
+			path = strchr(path + 1, ':');
+		if (!path || !Common::FSNode(Common::Path(path + 1, '/')).exists())
+			gone.push_back(entry._key);
+	}
+
+	for (const auto &key : gone)
+		filePropertiesMap.erase(key);
+	if (!gone.empty())
+		filePropertiesDirty = true;
+}
+
+void AdvancedDetectorCacheManager::saveFilePropertiesCache() {
+	if (!filePropertiesLoaded)
+		return;
+
+	// Forget the files of games which were deleted or moved
+	pruneFilePropertiesCache();
+	if (!filePropertiesDirty)
+		return;
+
+	Common::FSNode file(filePropertiesCachePath());
+	Common::ScopedPtr<Common::SeekableWriteStream> stream(file.createWriteStream());
+	if (!stream) {
+		warning("AdvancedDetectorCacheManager: Could not write detection cache '%s'", file.getPath().toString(Common::Path::kNativeSeparator).c_str());
+		return;
+	}
+
+	stream->writeUint32BE(MKTAG('A', 'D', 'F', 'P'));
+	stream->writeUint32LE(kFilePropertiesCacheVersion);
+	stream->writeUint32LE(filePropertiesMap.size());
+	for (const auto &entry : filePropertiesMap) {
+		stream->writeString(entry._key);
+		stream->writeByte(0);
+		stream->writeSint64LE(entry._value.size);
+		stream->writeSint64LE(entry._value.modificationTime);
+		stream->writeString(entry._value.md5);
+		stream->writeByte(0);
+	}
+
+	if (!stream->flush() || stream->err())
+		warning("AdvancedDetectorCacheManager: Could not write detection cache '%s'", file.getPath().toString(Common::Path::kNativeSeparator).c_str());
+	else
+		filePropertiesDirty = false;
+}
+
+void AdvancedMetaEngineDetectionBase::prefetchFileProperties(const Common::FSList &fslist) {
+	if (fslist.empty())
+		return;
+
+	preprocessDescriptions();
+
+	FileMap allFiles;
+	composeFileHashMap(allFiles, fslist, (_maxScanDepth == 0 ? 1 : _maxScanDepth));
+
+	for (const byte *descPtr = _gameDescriptors; ((const ADGameDescription *)descPtr)->gameId != nullptr; descPtr += _descItemSize) {
+		const ADGameDescription *g = (const ADGameDescription *)descPtr;
+
+		for (const ADGameFileDescription *fileDesc = g->filesDescriptions; fileDesc->fileName; fileDesc++) {
+			MD5Properties md5prop = gameFileToMD5Props(fileDesc, g->flags);
+			if (md5prop & (kMD5MacMask | kMD5Archive))
+				continue;
+
+			FileMap::const_iterator file = allFiles.find(Common::Path(fileDesc->fileName));
+			if (file != allFiles.end())
+				ADCacheMan.queueFileProperties(file->_value, md5prop, _md5Bytes);
+		}
+	}
+}
+
 // Add backslash before double quotes (") and backslashes themselves (\)
 Common::String escapeString(const char *string) {
 	if (string == nullptr)
@@ -25,6 +25,7 @@
 #include "engines/metaengine.h"
 #include "engines/engine.h"
 
+#include "common/flat-hashmap.h"
 #include "common/hash-str.h"
 
 #include "common/gui_options.h" // Keep it here, so detection tables can refer to them
@@ -513,6 +514,12 @@ public:
 	 */
 	DetectedGames detectGames(const Common::FSList &fslist, uint32 skipADFlags, bool skipIncomplete) override;
 
+	/**
+	 * Queue the plain files referenced by the detection entries which are
+	 * present in the given list with the @ref AdvancedDetectorCacheManager.
+	 */
+	void prefetchFileProperties(const Common::FSList &fslist) override;
+
 	uint getMD5Bytes() const override final { return _md5Bytes; }
 
 	int getGameVariantCount() const override final {
@@ -528,7 +535,7 @@ protected:
 	/**
 	 * A hashmap of file paths and their file system nodes.
 	 */
-	typedef Common::HashMap<Common::Path, Common::FSNode, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> FileMap;
+	typedef Common::FlatHashMap<Common::Path, Common::FSNode, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> FileMap;
 
 	/**
 	 * An (optional) generic fallback detection function that is invoked
@@ -652,7 +659,7 @@ public:
 	/**
 	 * A hashmap of file paths and their file system nodes.
 	 */
-	typedef Common::HashMap<Common::Path, Common::FSNode, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> FileMap;
+	typedef Common::FlatHashMap<Common::Path, Common::FSNode, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> FileMap;
 
 	/**
 	 * An (optional) generic fallback detection function that is invoked
@@ -771,7 +778,7 @@ public:
 		return archiveHashMap.getValOrDefault(node.getPath(), nullptr);
 	}
 
-	AdvancedDetectorCacheManager() {
+	AdvancedDetectorCacheManager() : session(0), filePropertiesLoaded(false), filePropertiesDirty(false) {
 		clear();
 	}
 
@@ -785,12 +792,82 @@ public:
 	void clear() {
 		md5HashMap.clear(true);
 		sizeHashMap.clear(true);
+		dirHashMap.clear(true);
 		clearArchives();
+
+		// File properties are kept, but have to be checked again
+		session++;
 	}
 
+	/**
+	 * List the children of @p dir. The listing is shared by all engines
+	 * until the next call to clear(), so every directory is only scanned
+	 * once per detection.
+	 */
+	bool getChildren(const Common::FSNode &dir, Common::FSList &list);
+
+	/**
+	 * Look up the properties of a plain file (i.e. no Mac fork or archive
+	 * member) computed earlier, possibly during a previous run. They are
+	 * only used if the size and modification time of the file are still
+	 * the same.
+	 */
+	bool getFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes, FileProperties &fileProps);
+
+	/** Remember the properties of a plain file, see getFileProperties(). */
+	void setFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes, const FileProperties &fileProps);
+
+	/** Queue a plain file whose properties are going to be requested. */
+	void queueFileProperties(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes);
+
+	/** Compute the properties of all queued files which are not known yet. */
+	void computeQueuedFileProperties();
+
+	/**
+	 * Load the file properties computed during previous runs, if the
+	 * detection_cache option is enabled. Does nothing if they were already
+	 * loaded.
+	 */
+	void loadFilePropertiesCache();
+
+	/**
+	 * Write the file properties back, if they were loaded and changed since.
+	 * The properties of files which do not exist anymore are dropped.
+	 */
+	void saveFilePropertiesCache();
+
 private:
 	friend class Common::Singleton<AdvancedDetectorCacheManager>;
 
+	struct CachedFileProperties {
+		int64 size;
+		int64 modificationTime;
+		Common::String md5;
+		uint32 session;	///< Detection in which the file was last checked to be unchanged
+
+		CachedFileProperties() : size(-1), modificationTime(0), session(0) {}
+	};
+
+	struct QueuedFile {
+		Common::String key;
+		Common::FSNode node;
+		MD5Properties md5prop;
+		uint md5Bytes;
+	};
+
+	static Common::String filePropertiesKey(const Common::FSNode &node, MD5Properties md5prop, uint md5Bytes);
+	static Common::Path filePropertiesCachePath();
+	void pruneFilePropertiesCache();
+
+	typedef Common::FlatHashMap<Common::String, CachedFileProperties> FilePropertiesMap;
+	typedef Common::FlatHashMap<Common::Path, Common::FSList, Common::Path::Hash, Common::Path::EqualTo> DirHashMap;
+	FilePropertiesMap filePropertiesMap;
+	DirHashMap dirHashMap;
+	Common::Array<QueuedFile> queuedFiles;
+	uint32 session;
+	bool filePropertiesLoaded;
+	bool filePropertiesDirty;
+
 	typedef Common::HashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> FileHashMap;
 	typedef Common::HashMap<Common::String, int64, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> SizeHashMap;
 	typedef Common::HashMap<Common::Path, Common::Archive *, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> ArchiveHashMap;
@@ -25,6 +25,8 @@
 #include "ags/shared/ac/sprite_cache.h"
 #include "ags/shared/gfx/allegro_bitmap.h"
 #include "ags/shared/script/cc_common.h"
+#include "ags/engine/script/cc_instance.h"
+#include "common/algorithm.h"
 #include "image/png.h"
 
 namespace AGS {
@@ -33,6 +35,7 @@ AGSConsole::AGSConsole(AGSEngine *vm) : GUI::Debugger(), _vm(vm), _logOutputTarg
 	registerCmd("ags_debug_groups_list",   WRAP_METHOD(AGSConsole, Cmd_listDebugGroups));
 	registerCmd("ags_debug_groups_set",  WRAP_METHOD(AGSConsole, Cmd_setDebugGroupLevel));
 	registerCmd("ags_set_script_dump", WRAP_METHOD(AGSConsole, Cmd_SetScriptDump));
+	registerCmd("ags_script_profile", WRAP_METHOD(AGSConsole, Cmd_scriptProfile));
 	registerCmd("ags_sprite_info",   WRAP_METHOD(AGSConsole, Cmd_getSpriteInfo));
 	registerCmd("ags_sprite_dump",  WRAP_METHOD(AGSConsole, Cmd_dumpSprite));
 
@@ -184,6 +187,75 @@ bool AGSConsole::Cmd_SetScriptDump(int argc, const char **argv) {
 	return true;
 }
 
+struct ScriptFunctionCount {
+	const AGS3::ccInstance *inst;
+	int32 start;
+	uint32 count;
+
+	bool operator<(const ScriptFunctionCount &other) const {
+		return count > other.count;
+	}
+};
+
+bool AGSConsole::Cmd_scriptProfile(int argc, const char **argv) {
+	if (argc == 2 && (strcmp(argv[1], "on") == 0 || strcmp(argv[1], "off") == 0)) {
+		_G(scriptProfiling) = strcmp(argv[1], "on") == 0;
+		return true;
+	}
+
+	const bool reset = argc == 2 && strcmp(argv[1], "reset") == 0;
+	if (argc > 2 || (argc == 2 && !reset && !Common::isDigit(argv[1][0]))) {
+		debugPrintf("Usage: %s [on|off|reset|count]\n", argv[0]);
+		debugPrintf("Without arguments, lists the functions which executed the most instructions\n");
+		return true;
+	}
+
+	// Forks share the counters of the instance they were created from
+	Common::Array<ScriptFunctionCount> functions;
+	for (int i = 0; i < MAX_LOADED_INSTANCES; ++i) {
+		const AGS3::ccInstance *inst = _G(loadedInstances)[i];
+		if (!inst || (inst->flags & INSTF_SHAREDATA) || !inst->exec_counts)
+			continue;
+
+		Common::Array<AGS3::uint32_t> &counts = *inst->exec_counts;
+		if (reset) {
+			// Scripts waiting on a blocking call still point into the array
+			Common::fill(counts.begin(), counts.end(), 0u);
+			continue;
+		}
+		for (uint j = 0; j < counts.size(); ++j) {
+			if (counts[j]) {
+				ScriptFunctionCount func = { inst, (int32)j, counts[j] };
+				functions.push_back(func);
+			}
+		}
+	}
+	if (reset)
+		return true;
+
+	if (!_G(scriptProfiling))
+		debugPrintf("Script profiling is off, use '%s on' to enable it\n", argv[0]);
+
+	Common::sort(functions.begin(), functions.end());
+	const uint maxLines = argc == 2 ? (uint)atoi(argv[1]) : 20;
+	for (uint i = 0; i < functions.size() && i < maxLines; ++i) {
+		const ScriptFunctionCount &func = functions[i];
+		const AGS3::ccScript *script = func.inst->instanceof.get();
+
+		// Script functions start where their export says
+		const char *name = "(not exported)";
+		for (int k = 0; k < script->numexports; ++k) {
+			if (((script->export_addr[k] >> 24) & 0xff) == EXPORT_FUNCTION &&
+					(script->export_addr[k] & 0x00ffffff) == func.start) {
+				name = script->exports[k];
+				break;
+			}
+		}
+		debugPrintf("%10u  %s: %s (pc %d)\n", func.count, script->GetSectionName(func.start), name, func.start);
+	}
+	return true;
+}
+
 bool AGSConsole::Cmd_getSpriteInfo(int argc, const char **argv) {
 	if (argc != 2) {
 		debugPrintf("Usage: %s SpriteNumber\n", argv[0]);
@@ -47,6 +47,7 @@ private:
 	bool Cmd_setDebugGroupLevel(int argc, const char **argv);
 
 	bool Cmd_SetScriptDump(int argc, const char **argv);
+	bool Cmd_scriptProfile(int argc, const char **argv);
 
 	bool Cmd_getSpriteInfo(int argc, const char **argv);
 	bool Cmd_dumpSprite(int argc, const char **argv);
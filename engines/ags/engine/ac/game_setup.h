@@ -91,6 +91,7 @@ struct GameSetup {
 	MouseSpeedDef mouse_speed_def;
 	bool  RenderAtScreenRes; // render sprites at screen resolution, as opposed to native one
 	size_t SpriteCacheSize = DefSpriteCacheSize;  // in KB
+	bool  SpriteCacheCostAware = false; // weigh sprite disposal by decode cost, prefetch room sprites
 	size_t TextureCacheSize = DefTexCacheSize;  // in KB
 	bool  clear_cache_on_room_change; // for low-end devices: clear resource caches on room change
 	bool  load_latest_save; // load latest saved game on launch
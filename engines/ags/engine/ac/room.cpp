@@ -410,6 +410,39 @@ HError LoadRoomScript(RoomStruct *room, int newnum) {
 	return HError::None();
 }
 
+// Adds all the frames of the view to the list, ignoring invalid views
+static void add_view_sprites(int view, std::vector<sprkey_t> &sprites) {
+	if (view < 0 || view >= _GP(game).numviews)
+		return;
+	const ViewStruct &vw = _GP(views)[view];
+	for (int loop = 0; loop < vw.numLoops; ++loop) {
+		const ViewLoopNew &vloop = vw.loops[loop];
+		for (int frame = 0; frame < vloop.numFrames; ++frame)
+			sprites.push_back(vloop.frames[frame].pic);
+	}
+}
+
+// Queues the sprites of the views the characters and objects in the room are
+// currently using, so that they are loaded during spare frame time instead
+// of when they are first drawn
+static void queue_room_sprite_prefetch() {
+	std::vector<sprkey_t> sprites;
+	for (size_t cc = 0; cc < _G(croom)->numobj; cc++) {
+		const RoomObject &obj = _G(objs)[cc];
+		sprites.push_back(obj.num);
+		if (obj.view != RoomObject::NoView)
+			add_view_sprites(obj.view, sprites);
+	}
+	for (int cc = 0; cc < _GP(game).numcharacters; cc++) {
+		const CharacterInfo &chi = _GP(game).chars[cc];
+		if (chi.room != _G(displayed_room))
+			continue;
+		add_view_sprites(chi.view, sprites);
+		add_view_sprites(chi.idleview, sprites);
+	}
+	_GP(spriteset).QueuePrefetch(sprites);
+}
+
 static void reset_temp_room() {
 	_GP(troom) = RoomStatus();
 }
@@ -864,6 +897,7 @@ void load_new_room(int newnum, CharacterInfo *forchar) {
 	set_our_eip(220);
 	update_polled_stuff();
 	debug_script_log("Now in room %d", _G(displayed_room));
+	queue_room_sprite_prefetch();
 	GUI::MarkAllGUIForUpdate(true, true);
 	pl_run_plugin_hooks(AGSE_ENTERROOM, _G(displayed_room));
 }
@@ -363,6 +363,7 @@ void apply_config(const ConfigTree &cfg) {
 		// Resource caches and options
 		_GP(usetup).clear_cache_on_room_change = CfgReadBoolInt(cfg, "misc", "clear_cache_on_room_change", _GP(usetup).clear_cache_on_room_change);
 		_GP(usetup).SpriteCacheSize = CfgReadInt(cfg, "graphics", "sprite_cache_size", _GP(usetup).SpriteCacheSize);
+		_GP(usetup).SpriteCacheCostAware = CfgReadBoolInt(cfg, "graphics", "sprite_cache_cost_aware", _GP(usetup).SpriteCacheCostAware);
 		_GP(usetup).TextureCacheSize = CfgReadInt(cfg, "graphics", "texture_cache_size", _GP(usetup).TextureCacheSize);
 
 		// Mouse options
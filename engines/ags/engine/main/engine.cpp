@@ -510,7 +510,9 @@ int engine_init_sprites() {
 
 	if (_GP(usetup).SpriteCacheSize > 0)
 		_GP(spriteset).SetMaxCacheSize(_GP(usetup).SpriteCacheSize * 1024);
-	Debug::Printf("Sprite cache set: %zu KB", _GP(spriteset).GetMaxCacheSize() / 1024);
+	_GP(spriteset).SetCacheMode(_GP(usetup).SpriteCacheCostAware ? kSprCacheMode_CostAware : kSprCacheMode_LRU);
+	Debug::Printf("Sprite cache set: %zu KB%s", _GP(spriteset).GetMaxCacheSize() / 1024,
+		_GP(usetup).SpriteCacheCostAware ? ", cost-aware" : "");
 	return 0;
 }
 
@@ -749,6 +749,15 @@ static void game_loop_update_loop_counter() {
 	}
 }
 
+// Spends the time left until the next frame on loading sprites ahead of use
+static void game_loop_prefetch_sprites() {
+	const auto now = AGS_Clock::now();
+	if (_G(next_frame_timestamp) <= now)
+		return;
+	const auto time_left = std::chrono::duration_cast<std::chrono::milliseconds>(_G(next_frame_timestamp) - now);
+	_GP(spriteset).ProcessPrefetch(time_left.count());
+}
+
 static void game_loop_update_fps() {
 	auto t2 = AGS_Clock::now();
 	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - _G(t1));
@@ -892,6 +901,8 @@ void UpdateGameOnce(bool checkControls, IDriverDependantBitmap *extraBitmap, int
 	if (_G(abort_engine))
 		return;
 
+	game_loop_prefetch_sprites();
+
 	WaitForNextFrame();
 }
 
@@ -542,6 +542,25 @@ inline bool FixupArgument(RuntimeScriptValue &arg, const int fixup, const uintpt
 	}
 }
 
+// Variables are accessed by loading their address into MAR, immediately
+// followed by a MEMREAD or MEMWRITE. If the instruction at `next_pc` is one of
+// those, performs it right away, saving a pass through the dispatch loop.
+// Returns the number of code cells consumed.
+inline int32_t RunFusedMemAccess(const intptr_t *code, const int32_t next_pc, const int32_t codesize, RuntimeScriptValue *registers) {
+	if (next_pc + 1 >= codesize)
+		return 0;
+	switch (code[next_pc]) {
+	case SCMD_MEMREAD:
+		registers[code[next_pc + 1]] = registers[SREG_MAR].ReadValue();
+		return 2;
+	case SCMD_MEMWRITE:
+		registers[SREG_MAR].WriteValue(registers[code[next_pc + 1]]);
+		return 2;
+	default:
+		return 0;
+	}
+}
+
 #define MAXNEST 50  // number of recursive function calls allowed
 int ccInstance::Run(int32_t curpc) {
 	pc = curpc;
@@ -565,7 +584,18 @@ int ccInstance::Run(int32_t curpc) {
 #if DEBUG_CC_EXEC
 	const bool dump_opcodes = (ccGetOption(SCOPT_DEBUGRUN) != 0) ||
 							  (gDebugLevel > 0 && DebugMan.isDebugChannelEnabled(::AGS::kDebugScript));
+	// Fused instructions would be missing from the dump
+	const bool fuse_ops = !dump_opcodes;
+#else
+	const bool fuse_ops = true;
 #endif
+	uint32_t *profile_counts = nullptr;
+	if (_G(scriptProfiling)) {
+		std::vector<uint32_t> &counts = *codeInst->exec_counts;
+		if (counts.size() != static_cast<size_t>(codeInst->codesize))
+			counts.resize(codeInst->codesize);
+		profile_counts = counts.data();
+	}
 	int loopIterationCheckDisabled = 0;
 	unsigned loopIterations = 0u;      // any loop iterations (needed for timeout test)
 	unsigned loopCheckIterations = 0u; // loop iterations accumulated only if check is enabled
@@ -595,6 +625,9 @@ int ccInstance::Run(int32_t curpc) {
 		CC_ERROR_IF_RETCODE(pc + codeOp.ArgCount >= codeInst->codesize,
 							"unexpected end of code data (%d; %d)", pc + codeOp.ArgCount, codeInst->codesize);
 
+		if (profile_counts)
+			profile_counts[funcstart[curnest]]++;
+
 
 		// Read arguments; use switch as it proved to be faster than the loop
 
@@ -733,6 +766,12 @@ int ccInstance::Run(int32_t curpc) {
 			ASSERT_CC_ERROR();
 			const auto &arg_value = codeOp.Arg2();
 			reg1 = arg_value;
+			if (fuse_ops && codeOp.Arg1i() == SREG_MAR) {
+				const int32_t fused = RunFusedMemAccess(codeInst->code, pc + 3, codeInst->codesize, registers);
+				if (fused && profile_counts)
+					profile_counts[funcstart[curnest]]++;
+				pc += fused;
+			}
 			break;
 		}
 		case SCMD_MEMREAD: {
@@ -751,6 +790,12 @@ int ccInstance::Run(int32_t curpc) {
 			const auto arg_off = codeOp.Arg1i();
 			registers[SREG_MAR] = GetStackPtrOffsetRw(arg_off);
 			ASSERT_CC_ERROR();
+			if (fuse_ops) {
+				const int32_t fused = RunFusedMemAccess(codeInst->code, pc + 2, codeInst->codesize, registers);
+				if (fused && profile_counts)
+					profile_counts[funcstart[curnest]]++;
+				pc += fused;
+			}
 			break;
 		}
 		case SCMD_MULREG: {
@@ -1651,7 +1696,9 @@ bool ccInstance::_Create(PScript scri, const ccInstance *joined) {
 	if (joined) {
 		resolved_imports = joined->resolved_imports;
 		code_fixups = joined->code_fixups;
+		exec_counts = joined->exec_counts;
 	} else {
+		exec_counts.reset(new std::vector<uint32_t>());
 		if (!CreateGlobalVars(scri.get())) {
 			return false;
 		}
@@ -1740,6 +1787,7 @@ void ccInstance::Free() {
 	}
 	resolved_imports = nullptr;
 	code_fixups = nullptr;
+	exec_counts.reset();
 }
 
 bool ccInstance::ResolveScriptImports(const ccScript *scri) {
@@ -24,6 +24,7 @@
 
 #include "common/std/memory.h"
 #include "common/std/map.h"
+#include "common/std/vector.h"
 #include "ags/engine/ac/timer.h"
 #include "ags/shared/script/cc_internal.h"
 #include "ags/shared/script/cc_script.h"  // ccScript
@@ -115,6 +116,7 @@ struct ccInstance {
 public:
 	typedef std::unordered_map<int32_t, ScriptVariable> ScVarMap;
 	typedef std::shared_ptr<ScVarMap>                   PScVarMap;
+	typedef std::shared_ptr<std::vector<uint32_t> >     PExecCounts;
 public:
 	int32_t flags;
 	PScVarMap globalvars;
@@ -155,6 +157,11 @@ public:
 
 	char *code_fixups;
 
+	// Number of instructions executed in each function, indexed by the
+	// function's start in the bytecode; only gathered while script profiling
+	// is enabled. Shared with the forks of this instance.
+	PExecCounts exec_counts;
+
 	// returns the currently executing instance, or NULL if none
 	static ccInstance *GetCurrentInstance(void);
 	// clears recorded stack of current instances
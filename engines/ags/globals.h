@@ -1306,6 +1306,8 @@ public:
 	 */
 
 	new_line_hook_type _new_line_hook = nullptr;
+	// Count executed instructions per script function (debugger)
+	bool _scriptProfiling = false;
 	// Minimal timeout: how much time may pass without any engine update
 	// before we want to check on the situation and do system poll
 	unsigned _timeoutCheckMs = 60u;
@@ -25,7 +25,9 @@
 //
 //=============================================================================
 
+#include "common/atomic.h"
 #include "common/system.h"
+#include "common/threadpool.h"
 #include "ags/shared/core/platform.h"
 #include "ags/shared/util/stream.h"
 #include "common/std/algorithm.h"
@@ -58,9 +60,24 @@ using namespace AGS::Shared;
 namespace AGS {
 namespace Shared {
 
+// A queued sprite, read from the file on the game thread and decoded by a worker
+struct SpriteCache::PrefetchJob {
+	const SpriteFile *File = nullptr;
+	sprkey_t Index = -1;
+	SpriteDatHeader Hdr;
+	std::vector<uint8_t> Data;
+	std::unique_ptr<Bitmap> Image;
+	bool Decoded = false; // set by the worker before Done
+	Common::Atomic<int> Done;
+	Common::TaskGroup Group;
+};
+
 SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks)
 	: _sprInfos(sprInfos), _maxCacheSize(DEFAULTCACHESIZE_KB * 1024u),
-	  _cacheSize(0u), _lockedSize(0u) {
+	  _cacheSize(0u), _lockedSize(0u), _mruCount(0u),
+	  _accessStamp(0u), _cacheMode(kSprCacheMode_LRU), _prefetchPos(0u), _prefetchStamp(0u) {
+	for (int i = 0; i < kNumCostClasses; ++i)
+		_mruHead[i] = _mruTail[i] = -1;
 	_callbacks.AdjustSize = (callbacks.AdjustSize) ? callbacks.AdjustSize : DummyAdjustSize;
 	_callbacks.InitSprite = (callbacks.InitSprite) ? callbacks.InitSprite : DummyInitSprite;
 	_callbacks.PostInitSprite = (callbacks.PostInitSprite) ? callbacks.PostInitSprite : DummyPostInitSprite;
@@ -70,6 +87,10 @@ SpriteCache::SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &cal
 	_placeholder.reset(BitmapHelper::CreateTransparentBitmap(1, 1, 8));
 }
 
+SpriteCache::~SpriteCache() {
+	CancelPrefetch();
+}
+
 size_t SpriteCache::GetCacheSize() const {
 	return _cacheSize;
 }
@@ -91,6 +112,19 @@ void SpriteCache::SetMaxCacheSize(size_t size) {
 	_maxCacheSize = size;
 }
 
+void SpriteCache::SetCacheMode(SpriteCacheMode mode) {
+	_cacheMode = mode;
+	if (mode != kSprCacheMode_CostAware) {
+		CancelPrefetch();
+		_prefetchQueue.clear();
+		_prefetchPos = 0;
+	}
+}
+
+SpriteCacheMode SpriteCache::GetCacheMode() const {
+	return _cacheMode;
+}
+
 bool SpriteCache::HasFreeSlots() const {
 	return !((_spriteData.size() == SIZE_MAX) || (_spriteData.size() > MAX_SPRITE_INDEX));
 }
@@ -101,9 +135,14 @@ bool SpriteCache::IsAssetSprite(sprkey_t index) const {
 }
 
 void SpriteCache::Reset() {
+	CancelPrefetch();
 	_file.Close();
 	_spriteData.clear();
-	_mru.clear();
+	for (int i = 0; i < kNumCostClasses; ++i)
+		_mruHead[i] = _mruTail[i] = -1;
+	_mruCount = 0;
+	_prefetchQueue.clear();
+	_prefetchPos = 0;
 	_cacheSize = 0;
 	_lockedSize = 0;
 }
@@ -124,6 +163,7 @@ bool SpriteCache::SetSprite(sprkey_t index, std::unique_ptr<Bitmap> image, int f
 		| (SPF_TRUECOLOR * image->GetColorDepth() > 16);
 	_sprInfos[index] = SpriteInfo(image->GetWidth(), image->GetHeight(), spf_flags);
 	// Assign sprite with 0 size, as it will not be included into the cache size
+	MruUnlink(index);
 	_spriteData[index] = SpriteData(image.release(), 0, SPRCACHEFLAG_EXTERNAL | SPRCACHEFLAG_LOCKED);
 	SprCacheLog("SetSprite: (external) %d", index);
 	return true;
@@ -228,20 +268,75 @@ Bitmap *SpriteCache::operator[](sprkey_t index) {
 	// Either use ready image, or load one from assets
 	if (_spriteData[index].Image) {
 		// Move to the beginning of the MRU list
-		_mru.splice(_mru.begin(), _mru, _spriteData[index].MruIt);
+		MruTouch(index);
 		return _spriteData[index].Image.get();
 	} else {
 		// Sprite exists in file but is not in mem, load it and add to MRU list
 		if (LoadSprite(index)) {
-			_spriteData[index].MruIt = _mru.insert(_mru.begin(), index);
+			MruTouch(index);
 			return _spriteData[index].Image.get();
 		}
 	}
 	return _placeholder.get();
 }
 
+void SpriteCache::MruLinkFront(sprkey_t index) {
+	SpriteData &spr = _spriteData[index];
+	sprkey_t &head = _mruHead[spr.Cost];
+	spr.MruPrev = -1;
+	spr.MruNext = head;
+	if (head >= 0)
+		_spriteData[head].MruPrev = index;
+	else
+		_mruTail[spr.Cost] = index;
+	head = index;
+	_mruCount++;
+}
+
+void SpriteCache::MruUnlink(sprkey_t index) {
+	SpriteData &spr = _spriteData[index];
+	if (spr.MruPrev < 0 && _mruHead[spr.Cost] != index)
+		return; // not in the list
+	if (spr.MruPrev >= 0)
+		_spriteData[spr.MruPrev].MruNext = spr.MruNext;
+	else
+		_mruHead[spr.Cost] = spr.MruNext;
+	if (spr.MruNext >= 0)
+		_spriteData[spr.MruNext].MruPrev = spr.MruPrev;
+	else
+		_mruTail[spr.Cost] = spr.MruPrev;
+	spr.MruPrev = spr.MruNext = -1;
+	_mruCount--;
+}
+
+void SpriteCache::MruTouch(sprkey_t index) {
+	SpriteData &spr = _spriteData[index];
+	spr.LastUse = ++_accessStamp;
+	spr.Priority = spr.LastUse;
+	// In the cost-aware mode, an expensive sprite counts as used later by
+	// about one round through the cache per cost class
+	if (_cacheMode == kSprCacheMode_CostAware)
+		spr.Priority += spr.Cost * (uint32_t)_mruCount;
+	if (_mruHead[spr.Cost] == index)
+		return;
+	MruUnlink(index);
+	MruLinkFront(index);
+}
+
+sprkey_t SpriteCache::MruOldest() const {
+	sprkey_t oldest = -1;
+	for (int i = 0; i < kNumCostClasses; ++i) {
+		const sprkey_t tail = _mruTail[i];
+		// The stamps are compared with wraparound in mind
+		if (tail >= 0 && (oldest < 0 ||
+			(int32_t)(_spriteData[tail].Priority - _spriteData[oldest].Priority) < 0))
+			oldest = tail;
+	}
+	return oldest;
+}
+
 void SpriteCache::FreeMem(size_t space) {
-	for (int tries = 0; (_mru.size() > 0) && (_cacheSize >= (_maxCacheSize - space)); ++tries) {
+	for (int tries = 0; (_mruCount > 0) && (_cacheSize >= (_maxCacheSize - space)); ++tries) {
 		DisposeOldest();
 		if (tries > 1000) { // ???
 			Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "RUNTIME CACHE ERROR: STUCK IN FREE_UP_MEM; RESETTING CACHE");
@@ -251,11 +346,10 @@ void SpriteCache::FreeMem(size_t space) {
 }
 
 void SpriteCache::DisposeOldest() {
-	assert(_mru.size() > 0);
-	if (_mru.size() == 0)
+	assert(_mruCount > 0);
+	if (_mruCount == 0)
 		return;
-	auto it = std::prev(_mru.end());
-	const auto sprnum = *it;
+	const sprkey_t sprnum = MruOldest();
 	// Safety check: must be a sprite from resources
 	// TODO: compare with latest upstream
 	// Commented out the assertion, since it triggers for sprites that are in the list but remapped to the placeholder (sprite 0)
@@ -265,10 +359,7 @@ void SpriteCache::DisposeOldest() {
 
 	if (!_spriteData[sprnum].IsAssetSprite()) {
 		Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Error, "SpriteCache::DisposeOldest: in MRU list sprite %d is external or does not exist", sprnum);
-		_mru.erase(it);
-		// std::list::erase() invalidates iterators to the erased item.
-		// But our implementation does not.
-		_spriteData[sprnum].MruIt._node = nullptr;
+		MruUnlink(sprnum);
 		return;
 	}
 	// Delete the image, unless is locked
@@ -279,10 +370,7 @@ void SpriteCache::DisposeOldest() {
 		SprCacheLog("DisposeOldest: disposed %d, size now %d KB", sprnum, _cacheSize / 1024);
 	}
 	// Remove from the mru list
-	_mru.erase(it);
-	// std::list::erase() invalidates iterators to the erased item.
-	// But our implementation does not.
-	_spriteData[sprnum].MruIt._node = nullptr;
+	MruUnlink(sprnum);
 }
 
 void SpriteCache::DisposeAllCached() {
@@ -292,9 +380,144 @@ void SpriteCache::DisposeAllCached() {
 		{
 			_spriteData[i].Image.reset();
 		}
+		_spriteData[i].MruPrev = _spriteData[i].MruNext = -1;
 	}
 	_cacheSize = _lockedSize;
-	_mru.clear();
+	for (int i = 0; i < kNumCostClasses; ++i)
+		_mruHead[i] = _mruTail[i] = -1;
+	_mruCount = 0;
+}
+
+void SpriteCache::QueuePrefetch(const std::vector<sprkey_t> &sprites) {
+	_prefetchQueue.clear();
+	_prefetchPos = 0;
+	if (_cacheMode != kSprCacheMode_CostAware)
+		return;
+	_prefetchQueue = sprites;
+	_prefetchStamp = _accessStamp;
+}
+
+bool SpriteCache::IsFullOfRecentSprites() const {
+	// The stamps are compared with wraparound in mind
+	const sprkey_t oldest = MruOldest();
+	return (_cacheSize >= _maxCacheSize) && (oldest >= 0) &&
+		((int32_t)(_spriteData[oldest].LastUse - _prefetchStamp) > 0);
+}
+
+void SpriteCache::ProcessPrefetch(uint32_t time_budget_ms) {
+	// Add the sprites which the workers have decoded by now
+	for (size_t i = 0; i < _prefetchJobs.size();) {
+		if (!_prefetchJobs[i]->Done.load()) {
+			++i;
+			continue;
+		}
+		// Only make room by disposing of sprites which were not used since
+		// the queue was set
+		if (IsFullOfRecentSprites()) {
+			SprCacheLog("Prefetch: cache is full, dropped %zu sprites", _prefetchQueue.size() - _prefetchPos + 1);
+			FinishPrefetch(i, false);
+			_prefetchQueue.clear();
+			_prefetchPos = 0;
+			continue;
+		}
+		const sprkey_t index = _prefetchJobs[i]->Index;
+		if (FinishPrefetch(i, true)) {
+			MruTouch(index);
+			SprCacheLog("Prefetched %d", index);
+		}
+	}
+
+	if (_prefetchPos >= _prefetchQueue.size() || time_budget_ms == 0) {
+		if (_prefetchPos >= _prefetchQueue.size()) {
+			_prefetchQueue.clear();
+			_prefetchPos = 0;
+		}
+		return;
+	}
+
+	const uint workers = g_system->getThreadPool()->getWorkerCount();
+	const uint32_t start = g_system->getMillis();
+	while (_prefetchPos < _prefetchQueue.size()) {
+		if (g_system->getMillis() - start >= time_budget_ms)
+			return;
+		// Give each worker one sprite at a time
+		if (workers > 0 && _prefetchJobs.size() >= workers)
+			return;
+
+		const sprkey_t index = _prefetchQueue[_prefetchPos++];
+		if (index < 0 || (size_t)index >= _spriteData.size())
+			continue;
+		const SpriteData &spr = _spriteData[index];
+		if (!spr.IsAssetSprite() || spr.IsError() || spr.Image)
+			continue; // nothing to load
+
+		if (IsFullOfRecentSprites()) {
+			SprCacheLog("Prefetch: cache is full, dropped %zu sprites", _prefetchQueue.size() - _prefetchPos + 1);
+			_prefetchQueue.clear();
+			_prefetchPos = 0;
+			return;
+		}
+
+		if (workers > 0) {
+			StartPrefetch(index);
+		} else if (LoadSprite(index)) {
+			MruTouch(index);
+			SprCacheLog("Prefetched %d", index);
+		}
+	}
+
+	_prefetchQueue.clear();
+	_prefetchPos = 0;
+}
+
+void SpriteCache::StartPrefetch(sprkey_t index) {
+	for (size_t i = 0; i < _prefetchJobs.size(); ++i) {
+		if (_prefetchJobs[i]->Index == index)
+			return; // already being decoded
+	}
+
+	// Reading stays on this thread, as the sprite file has a single stream;
+	// a sprite which fails here is left for LoadSprite to report
+	std::unique_ptr<PrefetchJob> job(new PrefetchJob());
+	job->File = &_file;
+	job->Index = index;
+	HError err = _file.LoadRawData(index, job->Hdr, job->Data);
+	if (!err || job->Hdr.BPP == 0)
+		return;
+	job->Image.reset(BitmapHelper::CreateBitmap(job->Hdr.Width, job->Hdr.Height, job->Hdr.BPP * 8));
+	if (!job->Image)
+		return;
+
+	_prefetchJobs.push_back(job.release());
+	_prefetchJobs.back()->Group.run(RunPrefetchJob, _prefetchJobs.back());
+}
+
+void SpriteCache::RunPrefetchJob(void *data) {
+	PrefetchJob *job = (PrefetchJob *)data;
+	HError err = job->File->DecodeRawData(job->Index, job->Hdr, job->Data, job->Image.get());
+	job->Decoded = (bool)err;
+	job->Done.store(1);
+}
+
+size_t SpriteCache::FinishPrefetch(size_t job_index, bool install, bool lock) {
+	PrefetchJob *job = _prefetchJobs[job_index];
+	_prefetchJobs.erase(_prefetchJobs.begin() + job_index);
+	job->Group.wait();
+
+	size_t size = 0;
+	if (install && job->Decoded && (size_t)job->Index < _spriteData.size()) {
+		// The sprite may have been loaded or replaced in the meantime
+		const SpriteData &spr = _spriteData[job->Index];
+		if (spr.IsAssetSprite() && !spr.IsError() && !spr.Image)
+			size = AddLoadedSprite(job->Index, job->Image.release(), job->Hdr.Compress, lock);
+	}
+	delete job;
+	return size;
+}
+
+void SpriteCache::CancelPrefetch() {
+	while (!_prefetchJobs.empty())
+		FinishPrefetch(_prefetchJobs.size() - 1, false);
 }
 
 void SpriteCache::PrecacheSprite(sprkey_t index) {
@@ -310,10 +533,7 @@ void SpriteCache::PrecacheSprite(sprkey_t index) {
 	} else if (!_spriteData[index].IsLocked()) {
 		size = _spriteData[index].Size;
 		// Remove locked sprite from the MRU list
-		_mru.erase(_spriteData[index].MruIt);
-		// std::list::erase() invalidates iterators to the erased item.
-		// But our implementation does not.
-		_spriteData[index].MruIt._node = nullptr;
+		MruUnlink(index);
 	}
 
 	// make sure locked sprites can't fill the cache
@@ -356,8 +576,19 @@ size_t SpriteCache::LoadSprite(sprkey_t index, bool lock) {
 		return 0;
 	assert((_spriteData[index].Flags & SPRCACHEFLAG_ISASSET) != 0);
 
+	// Take the sprite from the prefetch, if it's being decoded already
+	for (size_t i = 0; i < _prefetchJobs.size(); ++i) {
+		if (_prefetchJobs[i]->Index == index) {
+			const size_t size = FinishPrefetch(i, true, lock);
+			if (size > 0 || _spriteData[index].IsError())
+				return size;
+			break;
+		}
+	}
+
 	Bitmap *image;
-	HError err = _file.LoadSprite(index, image);
+	SpriteCompression compress = kSprCompress_None;
+	HError err = _file.LoadSprite(index, image, &compress);
 	if (!image) {
 		Debug::Printf(kDbgGroup_SprCache, kDbgMsg_Warn,
 			"LoadSprite: failed to load sprite %d:\n%s\n - remapping to placeholder", index,
@@ -365,7 +596,10 @@ size_t SpriteCache::LoadSprite(sprkey_t index, bool lock) {
 		RemapSpriteToPlaceholder(index);
 		return 0;
 	}
+	return AddLoadedSprite(index, image, compress, lock);
+}
 
+size_t SpriteCache::AddLoadedSprite(sprkey_t index, Bitmap *image, SpriteCompression compress, bool lock) {
 	// Let the external user convert this sprite's image for their needs
 	image = _callbacks.InitSprite(index, image, _sprInfos[index].Flags);
 	if (!image) {
@@ -383,8 +617,16 @@ size_t SpriteCache::LoadSprite(sprkey_t index, bool lock) {
 	FreeMem(size);
 	// Add to the cache, lock if requested or if it's sprite 0
 	const bool should_lock = lock || (index == 0);
+	MruUnlink(index);
 	_spriteData[index] = SpriteData(image, size, SPRCACHEFLAG_ISASSET);
 	_spriteData[index].Flags |= (SPRCACHEFLAG_LOCKED * should_lock);
+	// Decompressing takes considerably longer than reading raw pixels,
+	// and LZW or Deflate are slower to decode than RLE
+	switch (compress) {
+	case kSprCompress_None: _spriteData[index].Cost = 0; break;
+	case kSprCompress_RLE: _spriteData[index].Cost = 1; break;
+	default: _spriteData[index].Cost = 2; break;
+	}
 	_cacheSize += size;
 	SprCacheLog("Loaded %d, size now %zu KB", index, _cacheSize / 1024);
 
@@ -405,6 +647,7 @@ void SpriteCache::RemapSpriteToPlaceholder(sprkey_t index) {
 
 void SpriteCache::InitNullSprite(sprkey_t index) {
 	assert(index >= 0);
+	MruUnlink(index);
 	_sprInfos[index] = SpriteInfo();
 	_spriteData[index] = SpriteData();
 }
@@ -430,7 +673,6 @@ HError SpriteCache::InitFile(const String &filename, const String &sprindex_file
 	size_t newsize = metrics.size();
 	_sprInfos.resize(newsize);
 	_spriteData.resize(newsize);
-	_mru.clear();
 	for (size_t i = 0; i < metrics.size(); ++i) {
 		if (!metrics[i].IsNull()) {
 			// Existing sprite
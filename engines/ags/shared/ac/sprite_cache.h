@@ -24,7 +24,9 @@
 //
 // SpriteFile handles sprite serialization and streaming.
 // SpriteCache provides bitmaps by demand; it uses SpriteFile to load sprites
-// and does MRU (most-recent-use) caching.
+// and does MRU (most-recent-use) caching. In the cost-aware mode sprites which
+// are slow to decompress survive longer, and sprites may be queued to be
+// loaded ahead of use in the spare time between frames.
 //
 // TODO: store sprite data in a specialized container type that is optimized
 // for having most keys allocated in large continious sequences by default.
@@ -43,13 +45,16 @@
 
 #include "common/std/memory.h"
 #include "common/std/vector.h"
-#include "common/std/list.h"
 #include "ags/shared/ac/sprite_file.h"
 #include "ags/shared/core/platform.h"
 #include "ags/shared/gfx/bitmap.h"
 #include "ags/shared/util/error.h"
 #include "ags/shared/util/geometry.h"
 
+namespace Common {
+class TaskGroup;
+}
+
 namespace AGS3 {
 
 namespace AGS {
@@ -77,6 +82,15 @@ struct SpriteInfo;
 namespace AGS {
 namespace Shared {
 
+// Sprite cache eviction policy
+enum SpriteCacheMode {
+	// Dispose the least recently used sprites first
+	kSprCacheMode_LRU,
+	// Keep compressed sprites longer, as reloading them is expensive;
+	// allow prefetching sprites
+	kSprCacheMode_CostAware
+};
+
 class SpriteCache {
 public:
 	static const sprkey_t MIN_SPRITE_INDEX = 1; // 0 is reserved for "empty sprite"
@@ -96,7 +110,7 @@ public:
 	};
 
 	SpriteCache(std::vector<SpriteInfo> &sprInfos, const Callbacks &callbacks);
-	~SpriteCache() = default;
+	~SpriteCache();
 
 	// Loads sprite reference information and inits sprite stream
 	HError      InitFile(const String &filename, const String &sprindex_filename);
@@ -169,6 +183,19 @@ public:
 	void        SetEmptySprite(sprkey_t index, bool as_asset);
 	// Sets max cache size in bytes
 	void        SetMaxCacheSize(size_t size);
+	// Sets the eviction policy
+	void        SetCacheMode(SpriteCacheMode mode);
+	// Gets the eviction policy
+	SpriteCacheMode GetCacheMode() const;
+	// Queues sprites to be loaded by ProcessPrefetch, replacing any sprites
+	// still queued before; does nothing unless in the cost-aware mode
+	void        QueuePrefetch(const std::vector<sprkey_t> &sprites);
+	// Loads queued sprites until the time budget (in milliseconds) runs out.
+	// If the system has worker threads, the sprites are decoded there, and
+	// added to the cache by a later call once they are ready.
+	// Prefetching stops once the cache is full of sprites which were used
+	// after the queue was set, so that it never pushes them out.
+	void        ProcessPrefetch(uint32_t time_budget_ms);
 
 	// Loads (if it's not in cache yet) and returns bitmap by the sprite index
 	Bitmap *operator[](sprkey_t index);
@@ -176,10 +203,31 @@ public:
 private:
 	// Load sprite from game resource
 	size_t      LoadSprite(sprkey_t index, bool lock = false);
+	// Add a sprite image loaded from game resource to the cache
+	size_t      AddLoadedSprite(sprkey_t index, Bitmap *image, SpriteCompression compress, bool lock);
+	// Tells if the cache is full of sprites used since the prefetch queue was set
+	bool        IsFullOfRecentSprites() const;
+	// Read a queued sprite, and start decoding it on a worker thread
+	void        StartPrefetch(sprkey_t index);
+	// Add a sprite decoded by a worker to the cache, or drop it if that
+	// sprite was loaded or replaced in the meantime; waits for the worker
+	size_t      FinishPrefetch(size_t job_index, bool install, bool lock = false);
+	// Wait for the sprites still being decoded, and drop them
+	void        CancelPrefetch();
+	static void RunPrefetchJob(void *data);
 	// Remap the given index to the placeholder
 	void        RemapSpriteToPlaceholder(sprkey_t index);
-	// Delete the oldest (least recently used) image in cache
+	// Delete the oldest (least recently used) image in cache;
+	// in the cost-aware mode expensive sprites count as used more recently
 	void        DisposeOldest();
+	// Returns the sprite to dispose of next, -1 if there is none
+	sprkey_t    MruOldest() const;
+	// Put the sprite at the front of its MRU list
+	void        MruLinkFront(sprkey_t index);
+	// Take the sprite out of its MRU list, if it's in there
+	void        MruUnlink(sprkey_t index);
+	// Marks sprite as just used, moving it to the front of its MRU list
+	void        MruTouch(sprkey_t index);
 	// Keep disposing oldest elements until cache has at least the given free space
 	void        FreeMem(size_t space);
 	// Initialize the empty sprite slot
@@ -198,8 +246,12 @@ private:
 		uint32_t Flags = 0;			   // SPRCACHEFLAG* flags
 		std::unique_ptr<Bitmap> Image; // actual bitmap
 
-		// MRU list reference
-		std::list<sprkey_t>::iterator MruIt;
+		// MRU list links, -1 for none
+		sprkey_t MruPrev = -1;
+		sprkey_t MruNext = -1;
+		uint32_t LastUse = 0;		   // access stamp of the last use
+		uint32_t Priority = 0;		   // last use, plus a bonus for the reload cost
+		uint8_t  Cost = 0;			   // reload cost class, selects the MRU list
 
 		SpriteData() = default;
 		SpriteData(SpriteData &&other) = default;
@@ -235,10 +287,26 @@ private:
 	size_t _lockedSize;    // size in bytes of currently locked images
 	size_t _cacheSize;     // size in bytes of currently cached images
 
-	// MRU list: the way to track which sprites were used recently.
+	// MRU lists: the way to track which sprites were used recently.
 	// When clearing up space for new sprites, cache first deletes the sprites
-	// that were last time used long ago.
-	std::list<sprkey_t> _mru;
+	// that were last time used long ago. The lists are linked through the
+	// sprite slots themselves, so using a sprite never allocates.
+	// There is a list per reload cost class, all in the order of use, so the
+	// sprite to dispose of is always one of their tails.
+	static const int kNumCostClasses = 3;
+	sprkey_t _mruHead[kNumCostClasses];
+	sprkey_t _mruTail[kNumCostClasses];
+	size_t _mruCount;
+	uint32_t _accessStamp; // incremented on each sprite use
+
+	SpriteCacheMode _cacheMode;
+	// Sprites to load ahead of use, and the access stamp when they were queued
+	std::vector<sprkey_t> _prefetchQueue;
+	size_t _prefetchPos;
+	uint32_t _prefetchStamp;
+	// Sprites being decoded on worker threads
+	struct PrefetchJob;
+	std::vector<PrefetchJob *> _prefetchJobs;
 
 };
 
@@ -355,7 +355,7 @@ HError SpriteFile::RebuildSpriteIndex(Stream *in, sprkey_t topmost,
 	return HError::None();
 }
 
-HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
+HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite, SpriteCompression *compress) {
 	sprite = nullptr;
 	if (index < 0 || (size_t)index >= _spriteData.size())
 		return new Error(String::FromFormat("LoadSprite: slot index %d out of bounds (%d - %d).",
@@ -370,12 +370,31 @@ HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	SpriteDatHeader hdr;
 	ReadSprHeader(hdr, _stream.get(), _version, _compress);
 	if (hdr.BPP == 0) return HError::None(); // empty slot, this is normal
+	if (compress)
+		*compress = hdr.Compress;
 	int bpp = hdr.BPP, w = hdr.Width, h = hdr.Height;
 	std::unique_ptr<Bitmap> image(BitmapHelper::CreateBitmap(w, h, bpp * 8));
 	if (image == nullptr) {
 		return new Error(String::FromFormat("LoadSprite: failed to allocate bitmap %d (%dx%d%d).",
 			index, w, h, bpp * 8));
 	}
+	HError err = ReadSpriteData(index, hdr, _stream.get(), image.get());
+	if (!err)
+		return err;
+
+	sprite = image.release(); // FIXME: pass unique_ptr in this function
+	_curPos = index + 1; // mark correct pos
+	return HError::None();
+}
+
+HError SpriteFile::DecodeRawData(sprkey_t index, const SpriteDatHeader &hdr, const std::vector<uint8_t> &data, Bitmap *image) const {
+	assert(image->GetWidth() == hdr.Width && image->GetHeight() == hdr.Height && image->GetBPP() == hdr.BPP);
+	MemoryStream in(data.data(), data.size());
+	return ReadSpriteData(index, hdr, &in, image);
+}
+
+HError SpriteFile::ReadSpriteData(sprkey_t index, const SpriteDatHeader &hdr, Stream *in, Bitmap *image) const {
+	int bpp = hdr.BPP, w = hdr.Width, h = hdr.Height;
 	ImBufferPtr im_data(image->GetDataForWriting(), w * h * bpp, bpp);
 	// (Optional) Handle storage options, reverse
 	std::vector<uint8_t> indexed_buf;
@@ -384,11 +403,11 @@ HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	if (pal_bpp > 0) { // read palette if format assumes one
 		switch (pal_bpp) {
 		case 2: for (uint32_t i = 0; i < hdr.PalCount; ++i) {
-			palette[i] = _stream->ReadInt16();
+			palette[i] = in->ReadInt16();
 		}
 			  break;
 		case 4: for (uint32_t i = 0; i < hdr.PalCount; ++i) {
-			palette[i] = _stream->ReadInt32();
+			palette[i] = in->ReadInt32();
 		}
 			  break;
 		default: assert(0); break;
@@ -399,7 +418,7 @@ HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	// (Optional) Decompress the image data into the temp buffer
 	size_t in_data_size =
 		((_version >= kSprfVersion_StorageFormats) || _compress != kSprCompress_None) ?
-		(uint32_t)_stream->ReadInt32() : (w * h * bpp);
+		(uint32_t)in->ReadInt32() : (w * h * bpp);
 	if (hdr.Compress != kSprCompress_None) {
 		// TODO: rewrite this to only make a choice once the SpriteFile is initialized
 		// and use either function ptr or a decompressing stream class object
@@ -408,11 +427,11 @@ HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 		}
 		bool result;
 		switch (hdr.Compress) {
-		case kSprCompress_RLE: result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get());
+		case kSprCompress_RLE: result = rle_decompress(im_data.Buf, im_data.Size, im_data.BPP, in);
 			break;
-		case kSprCompress_LZW: result = lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get(), in_data_size);
+		case kSprCompress_LZW: result = lzw_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
 			break;
-		case kSprCompress_Deflate: result = inflate_decompress(im_data.Buf, im_data.Size, im_data.BPP, _stream.get(), in_data_size);
+		case kSprCompress_Deflate: result = inflate_decompress(im_data.Buf, im_data.Size, im_data.BPP, in, in_data_size);
 			break;
 		default: assert(!"Unsupported compression type!"); result = false; break;
 		}
@@ -424,12 +443,12 @@ HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	// Otherwise (no compression) read directly
 	else {
 		switch (im_data.BPP) {
-		case 1: _stream->Read(im_data.Buf, im_data.Size);
+		case 1: in->Read(im_data.Buf, im_data.Size);
 			break;
-		case 2: _stream->ReadArrayOfInt16(
+		case 2: in->ReadArrayOfInt16(
 			reinterpret_cast<int16_t *>(im_data.Buf), im_data.Size / sizeof(int16_t));
 			break;
-		case 4: _stream->ReadArrayOfInt32(
+		case 4: in->ReadArrayOfInt32(
 			reinterpret_cast<int32_t *>(im_data.Buf), im_data.Size / sizeof(int32_t));
 			break;
 		default: assert(0); break;
@@ -437,11 +456,8 @@ HError SpriteFile::LoadSprite(sprkey_t index, Shared::Bitmap *&sprite) {
 	}
 	// Finally revert storage options
 	if (pal_bpp > 0) {
-		UnpackIndexedBitmap(image.get(), im_data.Buf, im_data.Size, palette, hdr.PalCount);
+		UnpackIndexedBitmap(image, im_data.Buf, im_data.Size, palette, hdr.PalCount);
 	}
-
-	sprite = image.release(); // FIXME: pass unique_ptr in this function
-	_curPos = index + 1; // mark correct pos
 	return HError::None();
 }
 
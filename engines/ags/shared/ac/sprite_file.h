@@ -150,14 +150,21 @@ public:
 	HError      RebuildSpriteIndex(Stream *in, sprkey_t topmost,
 		std::vector<Size> &metrics);
 
-	// Loads an image data and creates a ready bitmap
-	HError      LoadSprite(sprkey_t index, Bitmap *&sprite);
+	// Loads an image data and creates a ready bitmap;
+	// optionally reports the compression the sprite was stored with
+	HError      LoadSprite(sprkey_t index, Bitmap *&sprite, SpriteCompression *compress = nullptr);
 	// Loads a raw sprite element data into the buffer, stores header info separately
 	HError      LoadRawData(sprkey_t index, SpriteDatHeader &hdr, std::vector<uint8_t> &data);
+	// Decodes the data loaded by LoadRawData into a bitmap of the sprite's size
+	// and color depth. This does not use the file stream, so it may run on
+	// another thread while the file stays open.
+	HError      DecodeRawData(sprkey_t index, const SpriteDatHeader &hdr, const std::vector<uint8_t> &data, Bitmap *image) const;
 
 private:
 	// Seek stream to sprite
 	void        SeekToSprite(sprkey_t index);
+	// Reads the sprite's pixels, following its header, into the bitmap
+	HError      ReadSpriteData(sprkey_t index, const SpriteDatHeader &hdr, Stream *in, Bitmap *image) const;
 
 	// Internal sprite reference
 	struct SpriteRef {
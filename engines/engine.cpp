@@ -611,6 +611,12 @@ void Engine::warnMissingExtractedCDAudio() {
 }
 
 void Engine::handleAutoSave() {
+	// Autosaves are written in the background, report when that failed
+	if (!_saveFileMan->checkPendingSaves(false)) {
+		g_system->displayMessageOnOSD(_("Error occurred making autosave"));
+		_saveFileMan->clearError();
+	}
+
 #ifdef ENABLE_EVENTRECORDER
 	if (!g_eventRec.processAutosave())
 		return;
@@ -675,10 +681,15 @@ void Engine::saveAutosaveIfEnabled() {
 	if (saveFlag)
 		saveFlag = warnBeforeOverwritingAutosave();
 
-	if (saveFlag && saveGameState(autoSaveSlot, autoSaveName, true).getCode() != Common::kNoError) {
-		// Couldn't autosave at the designated time
-		g_system->displayMessageOnOSD(_("Error occurred making autosave"));
-		saveFlag = false;
+	if (saveFlag) {
+		// Let the save file be written while the game goes on
+		_saveFileMan->setBackgroundSaving(true);
+		if (saveGameState(autoSaveSlot, autoSaveName, true).getCode() != Common::kNoError) {
+			// Couldn't autosave at the designated time
+			g_system->displayMessageOnOSD(_("Error occurred making autosave"));
+			saveFlag = false;
+		}
+		_saveFileMan->setBackgroundSaving(false);
 	}
 
 	_lastAutosaveTime = _system->getMillis();
@@ -158,6 +158,14 @@ public:
 	 */
 	virtual DetectedGames detectGames(const Common::FSList &fslist, uint32 skipADFlags = 0, bool skipIncomplete = false) = 0;
 
+	/**
+	 * Queue the files among the given list whose properties detectGames()
+	 * is going to compute, so that they can be computed for all engines
+	 * at once beforehand. This is an optimization, engines do not have to
+	 * implement it.
+	 */
+	virtual void prefetchFileProperties(const Common::FSList &fslist) {}
+
 	/** Returns the number of bytes used for MD5-based detection, or 0 if not supported. */
 	virtual uint getMD5Bytes() const = 0;
 
@@ -22,6 +22,7 @@
 #ifndef PRIVATE_SYMBOL_H
 #define PRIVATE_SYMBOL_H
 
+#include "common/flat-hashmap.h"
 #include "common/str.h"
 #include "common/hash-str.h"
 #include "common/hash-ptr.h"
@@ -46,7 +47,7 @@ typedef struct Symbol {	 /* symbol table entry */
 
 void setSymbol(Symbol *, int);
 
-typedef Common::HashMap<Common::String, Symbol *> SymbolMap;
+typedef Common::FlatHashMap<Common::String, Symbol *> SymbolMap;
 typedef Common::List<Common::String> NameList;
 typedef Common::List<Symbol *> ConstantList;
 
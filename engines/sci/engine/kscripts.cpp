@@ -45,6 +45,23 @@ reg_t kLoad(EngineState *s, int argc, reg_t *argv) {
 	if (restype == kResourceTypeMemory)
 		return s->_segMan->allocateHunkEntry("kLoad()", resnr);
 
+	// Scripts load the resources of a room when entering it. They are only
+	// looked up once actually used, so load them in the meantime.
+	switch (restype) {
+	case kResourceTypeView:
+	case kResourceTypePic:
+	case kResourceTypePalette:
+	case kResourceTypeAudio:
+		g_sci->getResMan()->prefetchResource(ResourceId(restype, resnr));
+		break;
+	case kResourceTypeSound:
+		if (getSciVersion() < SCI_VERSION_1_1)
+			g_sci->getResMan()->prefetchResource(ResourceId(restype, resnr));
+		break;
+	default:
+		break;
+	}
+
 	return make_reg(0, ((restype << 11) | resnr)); // Return the resource identifier as handle
 }
 
@@ -274,6 +291,11 @@ reg_t kScriptID(EngineState *s, int argc, reg_t *argv) {
 	if (!scriptSeg)
 		return NULL_REG;
 
+	// Rooms are loaded through their script, which by convention has the
+	// same number as the room's picture
+	if (script == s->currentRoomNumber())
+		g_sci->getResMan()->prefetchResource(ResourceId(kResourceTypePic, script));
+
 	Script *scr = s->_segMan->getScript(scriptSeg);
 
 	if (!scr->getExportsNr()) {
@@ -74,6 +74,9 @@ void Script::freeScript(const bool keepLocalsSegment) {
 	_offsetLookupObjectCount = 0;
 	_offsetLookupStringCount = 0;
 	_offsetLookupSaidCount = 0;
+
+	_decodedIndex.clear();
+	_decodedInstructions.clear();
 }
 
 enum {
@@ -790,6 +793,25 @@ const SciSpan<const uint16> Script::getRelocationTableSci0Sci21() const {
 	return relocationBlock.subspan<const uint16>(dataOffset, numEntries * sizeof(uint16));
 }
 
+const DecodedInstruction &Script::decodeInstruction(uint32 offset) {
+	if (_decodedIndex.empty())
+		_decodedIndex.resize(_buf->size(), 0);
+
+	DecodedInstruction instruction;
+	instruction.size = readPMachineInstruction(getBuf(offset), instruction.extOpcode, instruction.opparams);
+
+	// The index is 16-bit. Should a huge script ever run out of slots, the
+	// remaining instructions are simply decoded every time they are executed.
+	if (offset >= _decodedIndex.size() || _decodedInstructions.size() >= 0xFFFF) {
+		_uncachedInstruction = instruction;
+		return _uncachedInstruction;
+	}
+
+	_decodedInstructions.push_back(instruction);
+	_decodedIndex[offset] = _decodedInstructions.size();
+	return _decodedInstructions.back();
+}
+
 void Script::relocateSci0Sci21(const SegmentId segmentId) {
 	const SciSpan<const uint16> relocEntries = getRelocationTableSci0Sci21();
 
@@ -68,6 +68,13 @@ struct offsetLookupArrayEntry {
 
 typedef Common::Array<offsetLookupArrayEntry> offsetLookupArrayType;
 
+/** A VM instruction with its operands already read from the script buffer */
+struct DecodedInstruction {
+	int16 opparams[4]; /**< Operands, as returned by readPMachineInstruction */
+	uint16 size;       /**< Length of the encoded instruction in bytes */
+	byte extOpcode;    /**< "Extended" opcode (lower bit has special meaning) */
+};
+
 class Script : public SegmentObj {
 private:
 	int _nr; /**< Script number */
@@ -101,6 +108,15 @@ private:
 	uint16 _offsetLookupStringCount;
 	uint16 _offsetLookupSaidCount;
 
+	/**
+	 * Maps each offset of the script buffer to the index + 1 of its entry in
+	 * _decodedInstructions, or 0 if the instruction there was not decoded yet.
+	 * Allocated the first time code of this script is executed.
+	 */
+	Common::Array<uint16> _decodedIndex;
+	Common::Array<DecodedInstruction> _decodedInstructions;
+	DecodedInstruction _uncachedInstruction;
+
 public:
 	int getLocalsOffset() const { return _localsOffset; }
 	uint16 getLocalsCount() const { return _localsCount; }
@@ -131,6 +147,21 @@ public:
 		return _buf->getUint16SEAt(offset + SCRIPT_OBJECT_MAGIC_OFFSET) == SCRIPT_OBJECT_MAGIC_NUMBER;
 	}
 
+	/**
+	 * Returns the instruction at the given offset of the script buffer.
+	 * Instructions are decoded once and then served from a per-script cache,
+	 * which is dropped whenever the script is (re)loaded and patched.
+	 * The returned reference is only valid until the next call.
+	 */
+	const DecodedInstruction &getDecodedInstruction(uint32 offset) {
+		if (offset < _decodedIndex.size()) {
+			const uint16 index = _decodedIndex[offset];
+			if (index)
+				return _decodedInstructions[index - 1];
+		}
+		return decodeInstruction(offset);
+	}
+
 public:
 	Script();
 	~Script() override;
@@ -326,6 +357,12 @@ private:
 
 	bool relocateLocal(SegmentId segment, int location, uint32 offset);
 
+	/**
+	 * Decodes the instruction at the given offset and adds it to the
+	 * instruction cache. Slow path of getDecodedInstruction().
+	 */
+	const DecodedInstruction &decodeInstruction(uint32 offset);
+
 #ifdef ENABLE_SCI32
 	/**
 	 * Gets a pointer to the beginning of the objects in a SCI3 script
@@ -25,7 +25,9 @@
 #include "common/file.h"
 #include "common/fs.h"
 #include "common/macresman.h"
+#include "common/system.h"
 #include "common/textconsole.h"
+#include "common/threadpool.h"
 #include "common/translation.h"
 #ifdef ENABLE_SCI32
 #include "common/compression/installshield_cab.h"
@@ -598,11 +600,11 @@ Common::SeekableReadStream *ResourceSource::getVolumeFile(ResourceManager *resMa
 	return fileStream;
 }
 
-void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
-	Common::SeekableReadStream *fileStream = getVolumeFile(resMan, res);
-	if (!fileStream)
-		return;
-
+/**
+ * Returns the version of the volume a resource is in, and leaves the volume
+ * at the offset of the resource.
+ */
+static ResVersion seekVolumeResource(ResourceManager *resMan, const Resource *res, int32 fileOffset, Common::SeekableReadStream *fileStream) {
 	fileStream->seek(0, SEEK_SET);
 	ResourceType type = resMan->convertResType(fileStream->readByte());
 	ResVersion volVersion = resMan->getVolVersion();
@@ -615,7 +617,16 @@ void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
 		) &&
 		g_sci && g_sci->getLanguage() == Common::KO_KOR)
 		volVersion = kResVersionSci11;
-	fileStream->seek(res->_fileOffset, SEEK_SET);
+	fileStream->seek(fileOffset, SEEK_SET);
+	return volVersion;
+}
+
+void ResourceSource::loadResource(ResourceManager *resMan, Resource *res) {
+	Common::SeekableReadStream *fileStream = getVolumeFile(resMan, res);
+	if (!fileStream)
+		return;
+
+	ResVersion volVersion = seekVolumeResource(resMan, res, res->_fileOffset, fileStream);
 
 	int error = res->decompress(volVersion, fileStream);
 	if (error) {
@@ -1107,6 +1118,9 @@ void ResourceManager::init() {
 }
 
 ResourceManager::~ResourceManager() {
+	// The workers use the volume files and resources freed below
+	cancelPrefetch();
+
 	// freeing resources
 	ResourceMap::iterator itr = _resMap.begin();
 	while (itr != _resMap.end()) {
@@ -1147,6 +1161,163 @@ void ResourceManager::addToLRU(Resource *res) {
 	res->_status = kResStatusEnqueued;
 }
 
+/**
+ * A resource which is read and decompressed on the thread pool. The worker
+ * only uses the stream and a resource of its own, which is moved into the
+ * real one on the main thread, so the resource map is never touched while
+ * other threads use it.
+ */
+struct ResourceManager::PrefetchJob {
+	ResourceManager *resMan;
+	Resource *res;
+	Resource *loaded;
+	Common::SeekableReadStream *stream;
+	int error;
+	Common::Atomic<int> done;
+	Common::TaskGroup group;
+
+	PrefetchJob() : resMan(nullptr), res(nullptr), loaded(nullptr), stream(nullptr), error(0), done(0) {}
+};
+
+void ResourceManager::prefetchResource(const ResourceId &id) {
+	// Scripts may announce more resources than fit into the LRU, later hints
+	// are less likely to be needed soon, so they are dropped
+	const uint kMaxPrefetchQueue = 64;
+
+	// Loading them on the main thread would take the time from the game
+	if (g_system->getThreadPool()->getWorkerCount() == 0)
+		return;
+
+	Resource *res = testResource(id);
+	if (!res || res->_status != kResStatusNoMalloc)
+		return;
+	if (_prefetchQueue.size() >= kMaxPrefetchQueue)
+		return;
+	for (uint i = 0; i < _prefetchQueue.size(); ++i) {
+		if (_prefetchQueue[i] == id)
+			return;
+	}
+	_prefetchQueue.push_back(id);
+}
+
+bool ResourceManager::processPrefetch(uint32 msecs) {
+	const uint32 startTime = g_system->getMillis();
+	bool progress = false;
+
+	// Take over the resources which are done
+	for (uint i = 0; i < _prefetchJobs.size();) {
+		if (_prefetchJobs[i]->done.load()) {
+			finishPrefetch(_prefetchJobs[i]->res, true);
+			progress = true;
+		} else {
+			++i;
+		}
+	}
+
+	// Start new loads, but not more than the workers can run, so the ones
+	// which are needed first are not stuck behind others
+	const uint maxJobs = g_system->getThreadPool()->getWorkerCount();
+	while (!_prefetchQueue.empty() && _prefetchJobs.size() < maxJobs && g_system->getMillis() - startTime < msecs) {
+		Resource *res = testResource(_prefetchQueue.front());
+		_prefetchQueue.remove_at(0);
+
+		// The resource may have been looked up since it was queued
+		if (!res || res->_status != kResStatusNoMalloc)
+			continue;
+
+		if (startPrefetch(res))
+			progress = true;
+	}
+	return progress;
+}
+
+bool ResourceManager::startPrefetch(Resource *res) {
+	// Only resources in plain volumes are decompressed here. Patches,
+	// audio volumes, chunks and resource forks have loaders of their own
+	// which use state of the resource manager. Audio is also left out, as
+	// decompress() validates its header with error().
+	ResourceSource *source = res->_source;
+	if (source->getSourceType() != kSourceVolume || res->getType() == kResourceTypeAudio)
+		return false;
+
+	// The worker gets a file handle of its own, the cached volume files are
+	// used by the main thread
+	Common::SeekableReadStream *stream = nullptr;
+	if (source->_resourceFile) {
+		stream = source->_resourceFile->createReadStream();
+	} else {
+		Common::File *file = new Common::File();
+		if (file->open(source->getLocationName()))
+			stream = file;
+		else
+			delete file;
+	}
+	if (!stream)
+		return false;
+
+	PrefetchJob *job = new PrefetchJob();
+	job->resMan = this;
+	job->res = res;
+	job->loaded = new Resource(this, res->_id);
+	job->loaded->_source = source;
+	job->loaded->_fileOffset = res->_fileOffset;
+	job->stream = stream;
+	_prefetchJobs.push_back(job);
+	job->group.run(runPrefetchJob, job);
+	return true;
+}
+
+void ResourceManager::runPrefetchJob(void *data) {
+	PrefetchJob *job = (PrefetchJob *)data;
+	Resource *loaded = job->loaded;
+
+	ResVersion volVersion = seekVolumeResource(job->resMan, loaded, loaded->_fileOffset, job->stream);
+	job->error = loaded->decompress(volVersion, job->stream);
+	job->done.store(1);
+}
+
+void ResourceManager::finishPrefetch(Resource *res, bool install) {
+	for (uint i = 0; i < _prefetchJobs.size(); ++i) {
+		PrefetchJob *job = _prefetchJobs[i];
+		if (job->res != res)
+			continue;
+
+		// Only blocks if the worker is not done yet
+		job->group.wait();
+		_prefetchJobs.remove_at(i);
+
+		Resource *loaded = job->loaded;
+		if (job->error) {
+			warning("Error %d occurred while reading %s from resource file %s: %s",
+					job->error, res->_id.toString().c_str(), res->getResourceLocation().toString().c_str(),
+					s_errorDescriptions[job->error]);
+		} else if (install && res->_status == kResStatusNoMalloc) {
+			res->_data = loaded->_data;
+			res->_size = loaded->_size;
+			res->_status = kResStatusAllocated;
+			loaded->_data = nullptr;
+
+			if (_patcher)
+				_patcher->applyPatch(*res);
+			addToLRU(res);
+			freeOldResources();
+		}
+
+		// The source belongs to the real resource
+		loaded->_source = nullptr;
+		delete loaded;
+		delete job->stream;
+		delete job;
+		return;
+	}
+}
+
+void ResourceManager::cancelPrefetch() {
+	_prefetchQueue.clear();
+	while (!_prefetchJobs.empty())
+		finishPrefetch(_prefetchJobs.back()->res, false);
+}
+
 void ResourceManager::freeOldResources() {
 	while (_maxMemoryLRU < _memoryLRU) {
 		assert(!_LRU.empty());
@@ -1195,6 +1366,11 @@ Resource *ResourceManager::findResource(ResourceId id, bool lock) {
 	if (!retval)
 		return nullptr;
 
+	// A resource being prefetched is taken over once it is loaded, instead
+	// of loading it a second time
+	if (retval->_status == kResStatusNoMalloc && !_prefetchJobs.empty())
+		finishPrefetch(retval, true);
+
 	if (retval->_status == kResStatusNoMalloc)
 		loadResource(retval);
 	else if (retval->_status == kResStatusEnqueued)
@@ -2211,6 +2387,10 @@ Resource *ResourceManager::updateResource(ResourceId resId, ResourceSource *src,
 	// Update a patched resource, whether it exists or not
 	Resource *res = _resMap.getValOrDefault(resId, nullptr);
 
+	// A load from the previous source is of no use anymore
+	if (res != nullptr && !_prefetchJobs.empty())
+		finishPrefetch(res, false);
+
 	// When pulling from resource the "main" file may not even
 	// exist as both forks may be combined into MacBin
 	Common::SeekableReadStream *volumeFile = nullptr;
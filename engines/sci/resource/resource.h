@@ -380,6 +380,24 @@ public:
 	 */
 	void unlockResource(Resource *res);
 
+	/**
+	 * Queues a resource to be loaded by processPrefetch, ahead of its first
+	 * use. Resources which do not exist or are already in memory are ignored,
+	 * and so are all resources if there are no worker threads.
+	 * @param id	The resource to load
+	 */
+	void prefetchResource(const ResourceId &id);
+
+	/**
+	 * Starts reading and decompressing queued resources on the thread pool,
+	 * and puts the ones which are done under LRU control, so they are found
+	 * in memory when they are looked up the first time. findResource() waits
+	 * for a resource which is still being loaded.
+	 * @param msecs	The time to spend, in milliseconds
+	 * @return		true if any load was started or finished
+	 */
+	bool processPrefetch(uint32 msecs);
+
 	/**
 	 * Tests whether a resource exists.
 	 *
@@ -502,6 +520,28 @@ protected:
 	int _memoryLocked;	///< Amount of resource bytes in locked memory
 	int _memoryLRU;		///< Amount of resource bytes under LRU control
 	Common::List<Resource *> _LRU; ///< Last Resource Used list
+	Common::Array<ResourceId> _prefetchQueue; ///< Resources to load ahead of use
+
+	struct PrefetchJob;
+	Common::Array<PrefetchJob *> _prefetchJobs; ///< Resources being loaded on the thread pool
+
+	/**
+	 * Starts loading a resource from a resource volume on the thread pool.
+	 * @return	false if the volume file could not be opened
+	 */
+	bool startPrefetch(Resource *res);
+
+	/**
+	 * Waits for the load of a prefetched resource, if one is running.
+	 * @param res		The resource
+	 * @param install	true to keep the loaded data, false to drop it
+	 */
+	void finishPrefetch(Resource *res, bool install);
+
+	/** Waits for all prefetched resources and drops them. */
+	void cancelPrefetch();
+
+	static void runPrefetchJob(void *data);
 	ResourceMap _resMap;
 	Common::List<Common::File *> _volumeFiles; ///< list of opened volume files
 	ResourceSource *_audioMapSCI1; ///< Currently loaded audio map for SCI1
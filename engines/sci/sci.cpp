@@ -996,6 +996,11 @@ void SciEngine::sleep(uint32 msecs) {
 #endif
 		uint32 time = _system->getMillis();
 		if (time + 10 < wakeUpTime) {
+			// Use the idle time to start loading resources the scripts will
+			// need soon, and to take over the ones which are loaded, then
+			// check the time again
+			if (_resMan->processPrefetch(wakeUpTime - time - 10))
+				continue;
 			_system->delayMillis(10);
 		} else {
 			if (time < wakeUpTime)
@@ -39,6 +39,8 @@
 
 namespace Scumm {
 
+extern const char *nameOfResType(ResType type);
+
 void debugC(int channel, const char *s, ...) {
 	char buf[STRINGBUFLEN];
 	va_list va;
@@ -111,6 +113,7 @@ ScummDebugger::ScummDebugger(ScummEngine *s)
 #endif
 
 	registerCmd("resetcursors",    WRAP_METHOD(ScummDebugger, Cmd_ResetCursors));
+	registerCmd("heap",            WRAP_METHOD(ScummDebugger, Cmd_Heap));
 }
 
 void ScummDebugger::preEnter() {
@@ -1414,4 +1417,25 @@ bool ScummDebugger::Cmd_ResetCursors(int argc, const char **argv) {
 	return false;
 }
 
+bool ScummDebugger::Cmd_Heap(int argc, const char **argv) {
+	const ResourceManager *res = _vm->_res;
+	const ResourceManager::HeapStats &stats = res->getHeapStats();
+
+	debugPrintf("Type         Loaded       Bytes\n");
+	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
+		const ResourceManager::ResTypeData &rtd = res->_types[type];
+		if (rtd.getNumLoaded())
+			debugPrintf("%-12s %6d %11d\n", nameOfResType(type), rtd.getNumLoaded(), rtd.getHeapSize());
+	}
+
+	debugPrintf("\nHeap size %d (peak %d), thresholds %d - %d\n", _vm->_res->getHeapSize(), stats.peakSize,
+				res->getMinHeapThreshold(), res->getMaxHeapThreshold());
+	debugPrintf("%d resources created, %d expired in %d runs\n", stats.allocations, stats.expirations, stats.expireRuns);
+	if (res->isArenaEnabled())
+		debugPrintf("Arena: %d bytes kept for reuse, %d allocations served\n", res->getArenaSize(), stats.arenaReuses);
+	else
+		debugPrintf("Arena: disabled\n");
+	return true;
+}
+
 } // End of namespace Scumm
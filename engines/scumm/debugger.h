@@ -75,6 +75,7 @@ private:
 	bool Cmd_DiMuse(int argc, const char **argv);
 
 	bool Cmd_ResetCursors(int argc, const char **argv);
+	bool Cmd_Heap(int argc, const char **argv);
 
 	void printBox(int box);
 	void drawBox(int box, int color);
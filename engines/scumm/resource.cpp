@@ -45,13 +45,18 @@ namespace Scumm {
 
 enum {
 	RF_LOCK = 0x80,
-	RF_USAGE = 0x7F,
-	RF_USAGE_MAX = RF_USAGE,
+	RF_USAGE_MAX = 0x7F,
 
+	RS_LRU = 0x01,
+	RS_ARENA = 0x02,
 	RS_MODIFIED = 0x10,
 	RF_OFFHEAP = 0x40
 };
 
+enum : uint32 {
+	kLruNone = 0xFFFFFFFF
+};
+
 
 
 extern const char *nameOfResType(ResType type);
@@ -542,12 +547,16 @@ void ResourceManager::allocResTypeData(ResType type, uint32 tag, int num, ResTyp
 	if (num >= 8000)
 		error("Too many %s resources (%d) in directory", nameOfResType(type), num);
 
-	_types[type]._mode = mode;
-	_types[type]._tag = tag;
-
 	// If there was data in there, let's clear it out completely. This is important
 	// in case we are restarting the game.
+	for (ResId idx = 0; idx < _types[type].size(); idx++) {
+		if (_types[type][idx]._address)
+			nukeResource(type, idx);
+	}
 	_types[type].clear();
+
+	_types[type]._mode = mode;
+	_types[type]._tag = tag;
 	_types[type].resize(num);
 
 /*
@@ -814,33 +823,150 @@ void ResourceManager::increaseExpireCounter() {
 }
 
 void ResourceManager::increaseResourceCounters() {
-	for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-		ResId idx = _types[type].size();
-		while (idx-- > 0) {
-			byte counter = _types[type][idx].getResourceCounter();
-			if (counter && counter < RF_USAGE_MAX) {
-				setResourceCounter(type, idx, counter + 1);
+	// The counters are derived from the epoch, so this ages all resources
+	// at once.
+	_epoch++;
+}
+
+void ResourceManager::setResourceCounter(ResType type, ResId idx, byte counter) {
+	Resource &res = _types[type][idx];
+
+	if (counter > RF_USAGE_MAX)
+		counter = RF_USAGE_MAX;
+	res._lastUse = _epoch - (counter ? counter - 1 : 0);
+
+	// Keep the expiry list sorted by age: resources which were just used go
+	// to the front, resources which are marked as old go to the back.
+	if (res._status & RS_LRU) {
+		if (counter <= 1) {
+			if (_lruHead != lruKey(type, idx)) {
+				lruUnlink(type, idx);
+				lruLinkHead(type, idx);
 			}
+		} else if (_lruTail != lruKey(type, idx)) {
+			lruUnlink(type, idx);
+			lruLinkTail(type, idx);
 		}
 	}
 }
 
-void ResourceManager::setResourceCounter(ResType type, ResId idx, byte counter) {
-	_types[type][idx].setResourceCounter(counter);
+byte ResourceManager::getResourceCounter(ResType type, ResId idx) const {
+	const Resource &res = _types[type][idx];
+	if (!res._address)
+		return 0;
+	return (byte)MIN<uint32>(_epoch - res._lastUse + 1, RF_USAGE_MAX);
 }
 
-void ResourceManager::Resource::setResourceCounter(byte counter) {
-	_flags &= RF_LOCK;	// Clear lower 7 bits, preserve the lock bit.
-	_flags |= counter;	// Update the usage counter
+void ResourceManager::lruLinkHead(ResType type, ResId idx) {
+	Resource &res = _types[type][idx];
+	uint32 key = lruKey(type, idx);
+
+	res._lruPrev = kLruNone;
+	res._lruNext = _lruHead;
+	if (_lruHead != kLruNone)
+		lruResource(_lruHead)._lruPrev = key;
+	else
+		_lruTail = key;
+	_lruHead = key;
+	res._status |= RS_LRU;
 }
 
-byte ResourceManager::Resource::getResourceCounter() const {
-	return _flags & RF_USAGE;
+void ResourceManager::lruLinkTail(ResType type, ResId idx) {
+	Resource &res = _types[type][idx];
+	uint32 key = lruKey(type, idx);
+
+	res._lruPrev = _lruTail;
+	res._lruNext = kLruNone;
+	if (_lruTail != kLruNone)
+		lruResource(_lruTail)._lruNext = key;
+	else
+		_lruHead = key;
+	_lruTail = key;
+	res._status |= RS_LRU;
+}
+
+void ResourceManager::lruUnlink(ResType type, ResId idx) {
+	Resource &res = _types[type][idx];
+
+	if (res._lruPrev != kLruNone)
+		lruResource(res._lruPrev)._lruNext = res._lruNext;
+	else
+		_lruHead = res._lruNext;
+	if (res._lruNext != kLruNone)
+		lruResource(res._lruNext)._lruPrev = res._lruPrev;
+	else
+		_lruTail = res._lruPrev;
+	res._lruPrev = res._lruNext = kLruNone;
+	res._status &= ~RS_LRU;
 }
 
 /* 2 bytes safety area to make "precaching" of bytes in the gdi drawer easier */
 #define SAFETY_AREA 2
 
+/**
+ * Round the size of an arena block up, so that blocks of similar size can be
+ * recycled for each other while wasting at most one eighth of the memory.
+ */
+static uint32 arenaBlockSize(uint32 size) {
+	uint32 step = 256;
+	while (step * 16 <= size)
+		step <<= 1;
+	return (size + step - 1) & ~(step - 1);
+}
+
+static bool isArenaResType(ResType type) {
+	return type == rtRoom || type == rtRoomImage || type == rtRoomScripts || type == rtCostume;
+}
+
+byte *ResourceManager::allocateBlock(ResType type, ResId idx, uint32 size) {
+	if (!_arenaEnabled || !isArenaResType(type))
+		return new byte[size + SAFETY_AREA]();
+
+	uint32 blockSize = arenaBlockSize(size + SAFETY_AREA);
+	byte *ptr;
+
+	ArenaMap::iterator i = _arenaBlocks.find(blockSize);
+	if (i != _arenaBlocks.end() && !i->_value.empty()) {
+		ptr = i->_value.back();
+		i->_value.pop_back();
+		_arenaSize -= blockSize;
+		memset(ptr, 0, size + SAFETY_AREA);
+		_stats.arenaReuses++;
+	} else {
+		ptr = new byte[blockSize]();
+	}
+
+	_types[type][idx]._status |= RS_ARENA;
+	return ptr;
+}
+
+void ResourceManager::freeBlock(byte *ptr, uint32 size) {
+	uint32 blockSize = arenaBlockSize(size + SAFETY_AREA);
+
+	if (!_arenaEnabled || _arenaSize + blockSize > _arenaMaxSize) {
+		delete[] ptr;
+		return;
+	}
+
+	_arenaBlocks[blockSize].push_back(ptr);
+	_arenaSize += blockSize;
+}
+
+void ResourceManager::freeArena() {
+	for (ArenaMap::iterator i = _arenaBlocks.begin(); i != _arenaBlocks.end(); ++i) {
+		for (uint j = 0; j < i->_value.size(); j++)
+			delete[] i->_value[j];
+	}
+	_arenaBlocks.clear();
+	_arenaSize = 0;
+}
+
+void ResourceManager::setArenaEnabled(bool enabled) {
+	_arenaEnabled = enabled;
+	if (!enabled)
+		freeArena();
+}
+
 byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 	debugC(DEBUG_RESOURCE, "_res->createResource(%s,%d,%d)", nameOfResType(type), idx, size);
 
@@ -864,16 +990,23 @@ byte *ResourceManager::createResource(ResType type, ResId idx, uint32 size) {
 
 	expireResources(size);
 
-	byte *ptr = new byte[size + SAFETY_AREA]();
+	byte *ptr = allocateBlock(type, idx, size);
 	if (ptr == nullptr) {
 		error("createResource(%s,%d): Out of memory while allocating %d", nameOfResType(type), idx, size);
 	}
 
 	_allocatedSize += size;
+	_types[type]._numLoaded++;
+	_types[type]._heapSize += size;
+	_stats.allocations++;
+	if (_allocatedSize > _stats.peakSize)
+		_stats.peakSize = _allocatedSize;
 
 	_types[type][idx]._address = ptr;
 	_types[type][idx]._size = size;
-	setResourceCounter(type, idx, 1);
+	_types[type][idx]._lastUse = _epoch;
+	if (_types[type]._mode != kDynamicResTypeMode)
+		lruLinkHead(type, idx);
 
 	_vm->_insideCreateResource--;
 
@@ -885,6 +1018,8 @@ ResourceManager::Resource::Resource() {
 	_size = 0;
 	_flags = 0;
 	_status = 0;
+	_lastUse = 0;
+	_lruPrev = _lruNext = kLruNone;
 	_roomno = 0;
 	_roomoffs = 0;
 }
@@ -899,12 +1034,14 @@ void ResourceManager::Resource::nuke() {
 	_address = nullptr;
 	_size = 0;
 	_flags = 0;
-	_status &= ~RS_MODIFIED;
+	_status &= ~(RS_MODIFIED | RS_ARENA);
 }
 
 ResourceManager::ResTypeData::ResTypeData() {
 	_mode = kDynamicResTypeMode;
 	_tag = 0;
+	_numLoaded = 0;
+	_heapSize = 0;
 }
 
 ResourceManager::ResTypeData::~ResTypeData() {
@@ -915,6 +1052,12 @@ ResourceManager::ResourceManager(ScummEngine *vm) : _vm(vm) {
 	_maxHeapThreshold = 0;
 	_minHeapThreshold = 0;
 	_expireCounter = 0;
+	_epoch = 0;
+	_lruHead = _lruTail = kLruNone;
+	_arenaEnabled = false;
+	_arenaSize = 0;
+	_arenaMaxSize = 0;
+	memset(&_stats, 0, sizeof(_stats));
 }
 
 ResourceManager::~ResourceManager() {
@@ -926,6 +1069,9 @@ void ResourceManager::setHeapThreshold(int min, int max) {
 	assert(min <= max);
 	_maxHeapThreshold = max;
 	_minHeapThreshold = min;
+
+	// Keep the recycled blocks at a fraction of the heap they serve
+	_arenaMaxSize = max / 4;
 }
 
 bool ResourceManager::validateResource(const char *str, ResType type, ResId idx) const {
@@ -937,11 +1083,20 @@ bool ResourceManager::validateResource(const char *str, ResType type, ResId idx)
 }
 
 void ResourceManager::nukeResource(ResType type, ResId idx) {
-	byte *ptr = _types[type][idx]._address;
+	Resource &res = _types[type][idx];
+	byte *ptr = res._address;
 	if (ptr != nullptr) {
 		debugC(DEBUG_RESOURCE, "nukeResource(%s,%d)", nameOfResType(type), idx);
-		_allocatedSize -= _types[type][idx]._size;
-		_types[type][idx].nuke();
+		_allocatedSize -= res._size;
+		_types[type]._numLoaded--;
+		_types[type]._heapSize -= res._size;
+		if (res._status & RS_LRU)
+			lruUnlink(type, idx);
+		if (res._status & RS_ARENA) {
+			res._address = nullptr;
+			freeBlock(ptr, res._size);
+		}
+		res.nuke();
 	}
 }
 
@@ -1082,9 +1237,6 @@ void ResourceManager::Resource::setOnHeap() {
 }
 
 void ResourceManager::expireResources(uint32 size) {
-	byte best_counter;
-	ResType best_type;
-	int best_res = 0;
 	uint32 oldAllocatedSize;
 
 	if (_expireCounter != 0xFF) {
@@ -1096,31 +1248,35 @@ void ResourceManager::expireResources(uint32 size) {
 		return;
 
 	oldAllocatedSize = _allocatedSize;
+	_stats.expireRuns++;
 
+	// The expiry list only holds resources which can be reloaded from the
+	// data files, oldest last. Walk it from the back and throw out what is
+	// not needed any more, until we reach resources which were used since
+	// the resources were last aged.
+	uint32 key = _lruTail;
 	do {
-		best_type = rtInvalid;
-		best_counter = 2;
-
-		for (ResType type = rtFirst; type <= rtLast; type = ResType(type + 1)) {
-			if (_types[type]._mode != kDynamicResTypeMode) {
-				// Resources of this type can be reloaded from the data files,
-				// so we can potentially unload them to free memory.
-				ResId idx = _types[type].size();
-				while (idx-- > 0) {
-					Resource &tmp = _types[type][idx];
-					byte counter = tmp.getResourceCounter();
-					if (!tmp.isLocked() && counter >= best_counter && tmp._address && !_vm->isResourceInUse(type, idx) && !tmp.isOffHeap()) {
-						best_counter = counter;
-						best_type = type;
-						best_res = idx;
-					}
-				}
-			}
-		}
+		if (key == kLruNone)
+			break;
 
-		if (!best_type)
+		ResType type = ResType(key >> 16);
+		ResId idx = key & 0xFFFF;
+		Resource &tmp = _types[type][idx];
+		uint32 prev = tmp._lruPrev;
+
+		if (getResourceCounter(type, idx) < 2)
 			break;
-		nukeResource(best_type, best_res);
+
+		if (tmp.isLocked() || tmp.isOffHeap() || _vm->isResourceInUse(type, idx)) {
+			// Give it another round, instead of checking it again on every
+			// later expiry.
+			setResourceCounter(type, idx, 1);
+		} else {
+			nukeResource(type, idx);
+			_stats.expirations++;
+		}
+
+		key = prev;
 	} while (size + _allocatedSize > _minHeapThreshold);
 
 	increaseResourceCounters();
@@ -1137,6 +1293,7 @@ void ResourceManager::freeResources() {
 		}
 		_types[type].clear();
 	}
+	freeArena();
 }
 
 void ScummEngine::loadPtrToResource(ResType type, ResId idx, const byte *source) {
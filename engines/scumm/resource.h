@@ -23,6 +23,7 @@
 #define SCUMM_RESOURCE_H
 
 #include "common/array.h"
+#include "common/hashmap.h"
 #include "scumm/scumm.h"	// for ResType
 
 namespace Scumm {
@@ -92,23 +93,38 @@ public:
 		uint32 _size;
 
 	protected:
+		friend class ResourceManager;
+
 		/**
 		 * The uppermost bit indicates whether the resources is locked.
-		 * The lower 7 bits contain a counter. This counter measures roughly
-		 * how old the resource is; it starts out with a count of 1 and can go
-		 * as high as 127. When memory falls low resp. when the engine decides
-		 * that it should throw out some unused stuff, then it begins by
-		 * removing the resources with the highest counter (excluding locked
-		 * resources and resources that are known to be in use).
 		 */
 		byte _flags;
 
 		/**
-		 * The status of the resource. Currently only one bit is used, which
-		 * indicates whether the resource is modified.
+		 * The status of the resource: whether it is modified, kept off the
+		 * heap, linked into the expiry list, or allocated from the arena.
 		 */
 		byte _status;
 
+		/**
+		 * The value of the resource manager's epoch when this resource was
+		 * last used. The difference to the current epoch is the resource
+		 * counter, which measures roughly how old the resource is; it starts
+		 * out with a count of 1 and can go as high as 127. When memory falls
+		 * low resp. when the engine decides that it should throw out some
+		 * unused stuff, then it begins by removing the resources with the
+		 * highest counter (excluding locked resources and resources that
+		 * are known to be in use).
+		 */
+		uint32 _lastUse;
+
+		/**
+		 * Neighbours in the expiry list, which links all loaded resources of
+		 * reloadable types from the most to the least recently used one.
+		 * Entries are packed (type, index) pairs, see ResourceManager::lruKey().
+		 */
+		uint32 _lruPrev, _lruNext;
+
 	public:
 		/**
 		 * The id of the room (resp. the disk) the resource is contained in.
@@ -131,9 +147,6 @@ public:
 
 		void nuke();
 
-		inline void setResourceCounter(byte counter);
-		inline byte getResourceCounter() const;
-
 		void lock();
 		void unlock();
 		bool isLocked() const;
@@ -164,23 +177,77 @@ public:
 		 */
 		uint32 _tag;
 
+	protected:
+		/**
+		 * Number of loaded resources of this type and the memory they use.
+		 */
+		uint32 _numLoaded;
+		uint32 _heapSize;
+
 	public:
 		ResTypeData();
 		~ResTypeData();
+
+		uint32 getNumLoaded() const { return _numLoaded; }
+		uint32 getHeapSize() const { return _heapSize; }
 	};
 	ResTypeData _types[rtLast + 1];
 
+	/**
+	 * Counters describing how the resource heap has been used so far.
+	 */
+	struct HeapStats {
+		uint32 peakSize;        ///< Largest heap size seen
+		uint32 allocations;     ///< Resources created
+		uint32 expirations;     ///< Resources thrown out to make room
+		uint32 expireRuns;      ///< Times the heap went over the threshold
+		uint32 arenaReuses;     ///< Allocations served by a recycled block
+	};
+
 protected:
 	uint32 _allocatedSize;
 	uint32 _maxHeapThreshold, _minHeapThreshold;
 	byte _expireCounter;
 
+	/**
+	 * Aging all resources is done by incrementing this, instead of
+	 * incrementing the counter of every single resource.
+	 */
+	uint32 _epoch;
+
+	/**
+	 * Most and least recently used entries of the expiry list.
+	 */
+	uint32 _lruHead, _lruTail;
+
+	/**
+	 * Freed room and costume blocks kept for reuse, indexed by block size.
+	 * HE games with big rooms otherwise spend a lot of time freeing and
+	 * reallocating the same few large buffers.
+	 */
+	typedef Common::HashMap<uint32, Common::Array<byte *> > ArenaMap;
+	ArenaMap _arenaBlocks;
+	bool _arenaEnabled;
+	uint32 _arenaSize, _arenaMaxSize;
+
+	HeapStats _stats;
+
 public:
 	ResourceManager(ScummEngine *vm);
 	~ResourceManager();
 
 	void setHeapThreshold(int min, int max);
 	uint32 getHeapSize() { return _allocatedSize; }
+	uint32 getMinHeapThreshold() const { return _minHeapThreshold; }
+	uint32 getMaxHeapThreshold() const { return _maxHeapThreshold; }
+	const HeapStats &getHeapStats() const { return _stats; }
+
+	/**
+	 * Enable or disable recycling of room and costume memory blocks.
+	 */
+	void setArenaEnabled(bool enabled);
+	bool isArenaEnabled() const { return _arenaEnabled; }
+	uint32 getArenaSize() const { return _arenaSize; }
 
 	void allocResTypeData(ResType type, uint32 tag, int num, ResTypeMode mode);
 	void freeResources();
@@ -212,13 +279,15 @@ public:
 	void increaseExpireCounter();
 
 	/**
-	 * Update the specified resource's counter.
+	 * Update the specified resource's counter. A counter of 1 marks the
+	 * resource as just used, higher counters make it expire sooner.
 	 */
 	void setResourceCounter(ResType type, ResId idx, byte counter);
+	byte getResourceCounter(ResType type, ResId idx) const;
 
 	/**
-	 * Increment the counter of all unlocked loaded resources.
-	 * The maximal count is 255.
+	 * Increment the counter of all loaded resources.
+	 * The maximal count is 127.
 	 * This is called by increaseExpireCounter and expireResources,
 	 * but also by ScummEngine::startScene.
 	 */
@@ -230,6 +299,16 @@ public:
 	bool validateResource(const char *str, ResType type, ResId idx) const;
 protected:
 	void expireResources(uint32 size);
+
+	static uint32 lruKey(ResType type, ResId idx) { return ((uint32)type << 16) | idx; }
+	Resource &lruResource(uint32 key) { return _types[key >> 16][key & 0xFFFF]; }
+	void lruLinkHead(ResType type, ResId idx);
+	void lruLinkTail(ResType type, ResId idx);
+	void lruUnlink(ResType type, ResId idx);
+
+	byte *allocateBlock(ResType type, ResId idx, uint32 size);
+	void freeBlock(byte *ptr, uint32 size);
+	void freeArena();
 };
 
 } // End of namespace Scumm
@@ -46,7 +46,16 @@
 namespace Ultima {
 namespace Ultima8 {
 
-typedef Std::list<Item *> item_list;
+typedef Std::vector<Item *> item_list;
+
+// Returns the index of item in the chunk list, or -1 if it isn't there
+static int findItemIndex(const item_list &items, const Item *item) {
+	for (uint i = 0; i < items.size(); i++) {
+		if (items[i] == item)
+			return i;
+	}
+	return -1;
+}
 
 const int INT_MAX_VALUE = 0x7fffffff;
 const int INT_MIN_VALUE = -INT_MAX_VALUE - 1;
@@ -161,7 +170,7 @@ void CurrentMap::writeback() {
 }
 
 void CurrentMap::loadItems(const Std::list<Item *> &itemlist, bool callCacheIn) {
-	item_list::const_iterator iter;
+	Std::list<Item *>::const_iterator iter;
 	for (iter = itemlist.begin(); iter != itemlist.end(); ++iter) {
 		Item *item = *iter;
 
@@ -245,18 +254,14 @@ void CurrentMap::addItem(Item *item) {
 #ifdef VALIDATE_CHUNKS
 	for (int32 ccy = 0; ccy < MAP_NUM_CHUNKS; ccy++) {
 		for (int32 ccx = 0; ccx < MAP_NUM_CHUNKS; ccx++) {
-			item_list::const_iterator iter;
-			for (iter = _items[ccx][ccy].begin();
-					iter != _items[ccx][ccy].end(); ++iter) {
-				if (*iter == item) {
-					warning("item %d already exists in map chunk (%d, %d)", item->getObjId(), ccx, ccy);
-				}
+			if (findItemIndex(_items[ccx][ccy], item) >= 0) {
+				warning("item %d already exists in map chunk (%d, %d)", item->getObjId(), ccx, ccy);
 			}
 		}
 	}
 #endif
 
-	_items[cx][cy].push_front(item);
+	_items[cx][cy].insert_at(0, item);
 	item->setExtFlag(Item::EXT_INCURMAP);
 
 	Egg *egg = dynamic_cast<Egg *>(item);
@@ -282,12 +287,8 @@ void CurrentMap::addItemToEnd(Item *item) {
 #ifdef VALIDATE_CHUNKS
 	for (int32 ccy = 0; ccy < MAP_NUM_CHUNKS; ccy++) {
 		for (int32 ccx = 0; ccx < MAP_NUM_CHUNKS; ccx++) {
-			item_list::const_iterator iter;
-			for (iter = _items[ccx][ccy].begin();
-					iter != _items[ccx][ccy].end(); ++iter) {
-				if (*iter == item) {
-					warning("item %d already exists in map chunk (%d, %d)", item->getObjId(), ccx, ccy);
-				}
+			if (findItemIndex(_items[ccx][ccy], item) >= 0) {
+				warning("item %d already exists in map chunk (%d, %d)", item->getObjId(), ccx, ccy);
 			}
 		}
 	}
@@ -391,9 +392,8 @@ Item *CurrentMap::findBestTargetItem(int32 x, int32 y, int32 z, Direction dir, D
 
 
 void CurrentMap::removeItemFromList(Item *item, int32 oldx, int32 oldy) {
-	//! This might a bit too inefficient
-	// if it's really a problem we could change the item lists into sets
-	// or something, but let's see how it turns out
+	// Linear search, but removal has to keep the list order intact as
+	// usecode relies on it when searching the map
 
 	if (oldx < 0 || oldx >= _mapChunkSize * MAP_NUM_CHUNKS ||
 	        oldy < 0 || oldy >= _mapChunkSize * MAP_NUM_CHUNKS) {
@@ -404,7 +404,9 @@ void CurrentMap::removeItemFromList(Item *item, int32 oldx, int32 oldy) {
 	int32 cx = oldx / _mapChunkSize;
 	int32 cy = oldy / _mapChunkSize;
 
-	_items[cx][cy].remove(item);
+	int index = findItemIndex(_items[cx][cy], item);
+	if (index >= 0)
+		_items[cx][cy].remove_at(index);
 	item->clearExtFlag(Item::EXT_INCURMAP);
 }
 
@@ -517,20 +519,27 @@ void CurrentMap::updateFastArea(const Point3 &from, const Point3 &to) {
 void CurrentMap::setChunkFast(int32 cx, int32 cy) {
 	_fast[cy][cx / 32] |= 1 << (cx & 31);
 
-	item_list::iterator iter;
-	for (iter = _items[cx][cy].begin();
-	        iter != _items[cx][cy].end(); ++iter) {
-		(*iter)->enterFastArea();
+	// Entering the fast area can add items to this chunk (eg, expanding
+	// a GlobEgg puts its contents at the end), so walk by index and look
+	// the current item up again if the list changed underneath us.
+	item_list &items = _items[cx][cy];
+	for (int i = 0; i < (int)items.size(); ++i) {
+		Item *item = items[i];
+		item->enterFastArea();
+		if (i >= (int)items.size() || items[i] != item) {
+			// If the item is gone, the next one has taken its place
+			int index = findItemIndex(items, item);
+			i = (index >= 0) ? index : i - 1;
+		}
 	}
 }
 
 void CurrentMap::unsetChunkFast(int32 cx, int32 cy) {
 	_fast[cy][cx / 32] &= ~(1 << (cx & 31));
 
-	item_list::iterator iter = _items[cx][cy].begin();
-	while (iter != _items[cx][cy].end()) {
-		Item *item = *iter;
-		++iter;
+	item_list &items = _items[cx][cy];
+	for (int i = 0; i < (int)items.size(); ++i) {
+		Item *item = items[i];
 #ifdef VALIDATE_CHUNKS
 		int32 x, y, z;
 		item->getLocation(x, y, z);
@@ -540,6 +549,11 @@ void CurrentMap::unsetChunkFast(int32 cx, int32 cy) {
 		}
 #endif
 		item->leaveFastArea();  // Can destroy the item
+		if (i >= (int)items.size() || items[i] != item) {
+			// If the item is gone, the next one has taken its place
+			int index = findItemIndex(items, item);
+			i = (index >= 0) ? index : i - 1;
+		}
 	}
 }
 
@@ -699,7 +713,7 @@ TeleportEgg *CurrentMap::findDestination(uint16 id) {
 	return nullptr;
 }
 
-const Std::list<Item *> *CurrentMap::getItemList(int32 gx, int32 gy) const {
+const Std::vector<Item *> *CurrentMap::getItemList(int32 gx, int32 gy) const {
 	if (gx < 0 || gy < 0 || gx >= MAP_NUM_CHUNKS || gy >= MAP_NUM_CHUNKS)
 		return nullptr;
 	return &_items[gx][gy];
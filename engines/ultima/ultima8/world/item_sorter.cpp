@@ -45,10 +45,16 @@ namespace Ultima8 {
 static const uint32 TRANSPARENT_COLOR = TEX32_PACK_RGBA(0x7F, 0x00, 0x00, 0x7F);
 static const uint32 HIGHLIGHT_COLOR = TEX32_PACK_RGBA(0xFF, 0xFF, 0x00, 0x1F);
 
+// Size in pixels of the screenspace grid cells
+static const int32 CELL_SIZE = 64;
+
 ItemSorter::ItemSorter(int capacity) :
 	_shapes(nullptr), _clipWindow(0, 0, 0, 0), _items(nullptr), _itemsTail(nullptr),
 	_itemsUnused(nullptr), _painted(nullptr), _camSx(0), _camSy(0),
-	_sortLimit(0), _sortLimitChanged(false) {
+	_sortLimit(0), _sortLimitChanged(false), _cellsX(0), _cellsY(0),
+	_nextSeq(0) {
+	_stats.items = _stats.comparisons = _stats.depends = 0;
+
 	int i = capacity;
 	while (i--) {
 		SortItem *next = _itemsUnused;
@@ -88,6 +94,18 @@ void ItemSorter::BeginDisplayList(const Rect &clipWindow, const Point3 &cam) {
 	_itemsTail = nullptr;
 	_painted = nullptr;
 
+	// Reset the grid, keeping the memory of the cells
+	_cellsX = MAX<int32>(1, (clipWindow.width() + CELL_SIZE - 1) / CELL_SIZE);
+	_cellsY = MAX<int32>(1, (clipWindow.height() + CELL_SIZE - 1) / CELL_SIZE);
+	if (_cells.size() != (uint)(_cellsX * _cellsY))
+		_cells.resize(_cellsX * _cellsY);
+	for (uint i = 0; i < _cells.size(); i++)
+		_cells[i].resize(0);
+	_listHeads.resize(0);
+
+	_nextSeq = 0;
+	_stats.items = _stats.comparisons = _stats.depends = 0;
+
 	// Screenspace bounding box bottom x coord (RNB x coord)
 	int32 camSx = (cam.x - cam.y) / 4;
 	// Screenspace bounding box bottom extent  (RNB y coord)
@@ -187,15 +205,20 @@ void ItemSorter::AddItem(const Point3 &pt, uint32 shapeNum, uint32 frame_num, ui
 	// are never deleted
 	si->_depends.clear();
 
-	// Iterate the list and compare _shapes
+	si->_seq = _nextSeq++;
 
-	// Ok,
-	SortItem *addpoint = nullptr;
-	for (SortItem *si2 = _items; si2 != nullptr; si2 = si2->_next) {
-		// Get the insert point... which is before the first item that has higher z than us
-		if (!addpoint && si->listLessThan(*si2))
-			addpoint = si2;
+	// Compare against the items we may overlap, in list order
+#ifdef SORTITEM_OCCLUSION_EXPERIMENTAL
+	// Adjoining items may only touch our rect
+	Rect adjoinRect = si->_sr;
+	adjoinRect.grow(1);
+	GatherCandidates(adjoinRect);
+#else
+	GatherCandidates(si->_sr);
+#endif
 
+	for (uint i = 0; i < _candidates.size(); i++) {
+		SortItem *si2 = _candidates[i];
 		if (si2->_occluded)
 			continue;
 
@@ -221,6 +244,7 @@ void ItemSorter::AddItem(const Point3 &pt, uint32 shapeNum, uint32 frame_num, ui
 #endif // SORTITEM_OCCLUSION_EXPERIMENTAL
 
 		// Attempt to find paint dependency order
+		_stats.comparisons++;
 		if (si->overlap(*si2)) {
 			if (si->below(*si2)) {
 				if (si2->_occl && si2->occludes(*si)) {
@@ -229,7 +253,8 @@ void ItemSorter::AddItem(const Point3 &pt, uint32 shapeNum, uint32 frame_num, ui
 					break;
 				} else {
 					// si1 is behind si2, so add it to si2's dependency list
-					si2->_depends.insert_sorted(si);
+					si2->_depends.push_back(si);
+					_stats.depends++;
 				}
 			} else {
 				if (si->_occl && si->occludes(*si2)) {
@@ -237,7 +262,8 @@ void ItemSorter::AddItem(const Point3 &pt, uint32 shapeNum, uint32 frame_num, ui
 					si2->_occluded = true;
 				} else {
 					// si2 is behind si1, so add it to si1's dependency list
-					si->_depends.insert_sorted(si2);
+					si->_depends.push_back(si2);
+					_stats.depends++;
 				}
 			}
 		}
@@ -245,9 +271,41 @@ void ItemSorter::AddItem(const Point3 &pt, uint32 shapeNum, uint32 frame_num, ui
 
 	// Add it to the list
 	_itemsUnused = _itemsUnused->_next;
+	_stats.items++;
+
+	// Get the insert point... which is before the first item that has higher z than us
+	uint lo = 0;
+	uint hi = _listHeads.size();
+	while (lo < hi) {
+		uint mid = (lo + hi) / 2;
+		if (si->listLessThan(*_listHeads[mid]))
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	SortItem *addpoint = lo < _listHeads.size() ? _listHeads[lo] : nullptr;
+	if (lo == 0 || _listHeads[lo - 1]->listLessThan(*si))
+		_listHeads.insert_at(lo, si);
+
+	// Register in the grid, keeping the cells in list order
+	int32 cx0, cy0, cx1, cy1;
+	GetCellRange(si->_sr, cx0, cy0, cx1, cy1);
+	for (int32 cy = cy0; cy <= cy1; cy++) {
+		for (int32 cx = cx0; cx <= cx1; cx++) {
+			Common::Array<SortItem *> &cell = _cells[cy * _cellsX + cx];
+			lo = 0;
+			hi = cell.size();
+			while (lo < hi) {
+				uint mid = (lo + hi) / 2;
+				if (si->listOrderLessThan(*cell[mid]))
+					hi = mid;
+				else
+					lo = mid + 1;
+			}
+			cell.insert_at(lo, si);
+		}
+	}
 
-	// have a position
-	//addpoint = 0;
 	if (addpoint) {
 		si->_next = addpoint;
 		si->_prev = addpoint->_prev;
@@ -354,7 +412,9 @@ void ItemSorter::PaintDisplayList(RenderSurface *surf, bool item_highlight, bool
 
 				oc.setBoxBounds(box, _camSx, _camSy);
 
-				for (si2 = _items; si2 != nullptr; si2 = si2->_next) {
+				GatherCandidates(oc._sr);
+				for (uint i = 0; i < _candidates.size(); i++) {
+					si2 = _candidates[i];
 					if (si2->_groupNum != group && !si2->_occluded &&
 						si2->overlap(oc) && si2->below(oc) && oc.occludes(*si2)) {
 						si2->_occluded = true;
@@ -407,6 +467,9 @@ bool ItemSorter::PaintSortItem(RenderSurface *surf, SortItem *si, bool showFootp
 	// Resursion detection
 	si->_order = -2;
 
+	// Dependencies were added unsorted
+	si->_depends.sort();
+
 	// Iterate through our dependancies, and paint them, if possible
 	SortItem::DependsList::iterator it = si->_depends.begin();
 	SortItem::DependsList::iterator end = si->_depends.end();
@@ -503,6 +566,53 @@ bool ItemSorter::PaintSortItem(RenderSurface *surf, SortItem *si, bool showFootp
 	return false;
 }
 
+void ItemSorter::GetCellRange(const Rect &r, int32 &cx0, int32 &cy0, int32 &cx1, int32 &cy1) const {
+	// Empty rects still intersect the rects around their top left corner
+	cx0 = CLIP<int32>((r.left - _clipWindow.left) / CELL_SIZE, 0, _cellsX - 1);
+	cy0 = CLIP<int32>((r.top - _clipWindow.top) / CELL_SIZE, 0, _cellsY - 1);
+	cx1 = CLIP<int32>((MAX(r.left, r.right - 1) - _clipWindow.left) / CELL_SIZE, 0, _cellsX - 1);
+	cy1 = CLIP<int32>((MAX(r.top, r.bottom - 1) - _clipWindow.top) / CELL_SIZE, 0, _cellsY - 1);
+}
+
+void ItemSorter::GatherCandidates(const Rect &r) {
+	_candidates.resize(0);
+
+	_mergeCells.resize(0);
+
+	int32 cx0, cy0, cx1, cy1;
+	GetCellRange(r, cx0, cy0, cx1, cy1);
+	for (int32 cy = cy0; cy <= cy1; cy++) {
+		for (int32 cx = cx0; cx <= cx1; cx++) {
+			const Common::Array<SortItem *> &cell = _cells[cy * _cellsX + cx];
+			if (!cell.empty())
+				_mergeCells.push_back(CellCursor(&cell));
+		}
+	}
+
+	// The cells are in list order, so merge them. Items spanning several
+	// cells are at the head of each of those cells at the same time.
+	for (;;) {
+		SortItem *next = nullptr;
+		for (uint i = 0; i < _mergeCells.size(); i++) {
+			const CellCursor &cursor = _mergeCells[i];
+			if (cursor.pos < cursor.cell->size()) {
+				SortItem *si = (*cursor.cell)[cursor.pos];
+				if (!next || si->listOrderLessThan(*next))
+					next = si;
+			}
+		}
+		if (!next)
+			break;
+
+		_candidates.push_back(next);
+		for (uint i = 0; i < _mergeCells.size(); i++) {
+			CellCursor &cursor = _mergeCells[i];
+			if (cursor.pos < cursor.cell->size() && (*cursor.cell)[cursor.pos] == next)
+				cursor.pos++;
+		}
+	}
+}
+
 uint16 ItemSorter::Trace(int32 x, int32 y, HitFace *face, bool item_highlight) {
 	SortItem *it;
 	SortItem *selected;
@@ -23,6 +23,7 @@
 #define ULTIMA8_WORLD_ITEMSORTER_H
 
 #include "ultima/ultima8/misc/rect.h"
+#include "common/array.h"
 
 namespace Ultima {
 namespace Ultima8 {
@@ -46,7 +47,32 @@ class ItemSorter {
 	int32       _sortLimit;
 	bool        _sortLimitChanged;
 
+	// Screenspace grid over the clip window. Each cell lists the items whose
+	// frame rect covers it; items outside the window are clamped to the
+	// border cells. Only items sharing a cell can overlap.
+	Common::Array<Common::Array<SortItem *> > _cells;
+	int32       _cellsX, _cellsY;
+	Common::Array<SortItem *> _candidates;
+
+	struct CellCursor {
+		const Common::Array<SortItem *> *cell;
+		uint pos;
+		CellCursor(const Common::Array<SortItem *> *c = nullptr) : cell(c), pos(0) {}
+	};
+	Common::Array<CellCursor> _mergeCells;
+
+	// First item of each run of equal listLessThan keys, in list order
+	Common::Array<SortItem *> _listHeads;
+
+	uint32      _nextSeq;
+
 public:
+	struct Stats {
+		uint32 items;       // Items added to the display list
+		uint32 comparisons; // Pairs of items tested for overlap
+		uint32 depends;     // Paint dependencies recorded
+	};
+
 	ItemSorter(int capacity);
 	~ItemSorter();
 
@@ -69,8 +95,22 @@ public:
 
 	void IncSortLimit(int count);
 
+	// Statistics of the current display list
+	const Stats &getStats() const {
+		return _stats;
+	}
+
 private:
+	Stats       _stats;
+
 	bool PaintSortItem(RenderSurface *surf, SortItem *si, bool showFootpad);
+
+	// Get the range of grid cells covered by a screenspace rect
+	void GetCellRange(const Rect &r, int32 &cx0, int32 &cy0, int32 &cx1, int32 &cy1) const;
+
+	// Fill _candidates with the items whose cells intersect the given
+	// rect, in display list order
+	void GatherCandidates(const Rect &r);
 };
 
 } // End of namespace Ultima8
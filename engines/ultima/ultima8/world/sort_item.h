@@ -41,7 +41,7 @@ class Shape;
  * Other code should have no reason to include it.
  */
 struct SortItem {
-	SortItem() : _next(nullptr), _prev(nullptr), _itemNum(0),
+	SortItem() : _next(nullptr), _prev(nullptr), _seq(0), _itemNum(0),
 			_shape(nullptr), _order(-1), _depends(), _shapeNum(0),
 			_frame(0), _flags(0), _extFlags(0), _sr(),
 			_x(0), _y(0), _z(0), _xLeft(0),
@@ -55,6 +55,8 @@ struct SortItem {
 	SortItem                *_next;
 	SortItem                *_prev;
 
+	uint32                  _seq;       // Order of addition, breaks ties in listLessThan
+
 	uint16                  _itemNum;   // Owner item number
 
 	const Shape             *_shape;
@@ -208,6 +210,57 @@ struct SortItem {
 			tail = nn;
 		}
 
+		// Stable sort, giving the same order as adding with insert_sorted
+		void sort() {
+			if (list == tail)
+				return;
+
+			list = mergeSort(list);
+
+			// Restore the back links
+			Node *prev = nullptr;
+			for (Node *n = list; n != nullptr; n = n->_next) {
+				n->_prev = prev;
+				prev = n;
+			}
+			tail = prev;
+		}
+
+		static Node *mergeSort(Node *head) {
+			if (!head->_next)
+				return head;
+
+			// Split the list in half
+			Node *slow = head;
+			Node *fast = head->_next;
+			while (fast && fast->_next) {
+				slow = slow->_next;
+				fast = fast->_next->_next;
+			}
+			Node *left = head;
+			Node *right = slow->_next;
+			slow->_next = nullptr;
+
+			left = mergeSort(left);
+			right = mergeSort(right);
+
+			// Merge, taking from the left half on ties
+			Node merged;
+			Node *last = &merged;
+			while (left && right) {
+				if (right->val->listLessThan(*left->val)) {
+					last->_next = right;
+					right = right->_next;
+				} else {
+					last->_next = left;
+					left = left->_next;
+				}
+				last = last->_next;
+			}
+			last->_next = left ? left : right;
+			return merged._next;
+		}
+
 		DependsList() : list(nullptr), tail(nullptr), unused(nullptr) { }
 
 		~DependsList() {
@@ -263,6 +316,15 @@ struct SortItem {
 		return si1._flat > si2._flat;
 	}
 
+	// Comparison matching the order of the display list
+	inline bool listOrderLessThan(const SortItem &si2) const {
+		if (listLessThan(si2))
+			return true;
+		if (si2.listLessThan(*this))
+			return false;
+		return _seq < si2._seq;
+	}
+
 	Common::String dumpInfo() const;
 };
 
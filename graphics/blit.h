@@ -30,6 +30,7 @@ struct Point;
 }
 
 class BlendBlitUnfilteredTestSuite;
+class BlitAlphaTestSuite;
 
 namespace Graphics {
 
@@ -292,6 +293,7 @@ private:
 	typedef void(*BlitFunc)(Args &, const TSpriteBlendMode &, const AlphaType &);
 	static BlitFunc blitFunc;
 	friend class ::BlendBlitUnfilteredTestSuite;
+	friend class ::BlitAlphaTestSuite;
 	friend class BlendBlitImpl_Default;
 	friend class BlendBlitImpl_NEON;
 	friend class BlendBlitImpl_SSE2;
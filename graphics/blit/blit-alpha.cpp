@@ -21,6 +21,7 @@
 
 #include "common/system.h"
 #include "graphics/blit.h"
+#include "graphics/blit/blit-alpha.h"
 #include "graphics/pixelformat.h"
 
 namespace Graphics {
@@ -85,8 +86,84 @@ inline void setAlphaLogic(byte *dst, const byte *src, const uint w, const uint h
 	}
 }
 
+inline void applyColorKeyLogic32(byte *dst, const byte *src, const uint w, const uint h,
+								 const uint srcPitch, const uint dstPitch,
+								 const Graphics::PixelFormat &format, const bool overwriteAlpha,
+								 const uint8 rKey, const uint8 gKey, const uint8 bKey,
+								 const uint8 rNew, const uint8 gNew, const uint8 bNew) {
+
+	AlphaKernels::ColorKeyArgs args;
+	args.keyPix         = format.ARGBToColor(0,   rKey, gKey, bKey);
+	args.newPix         = format.ARGBToColor(0,   rNew, gNew, bNew);
+	args.rgbMask        = format.ARGBToColor(0,   255,  255,  255);
+	args.alphaMask      = format.ARGBToColor(255, 0,    0,    0);
+	args.overwriteAlpha = overwriteAlpha;
+
+	const AlphaKernels::ApplyColorKeyFunc func = AlphaKernels::getApplyColorKey();
+	for (uint y = 0; y < h; ++y) {
+		func((uint32 *)dst, (const uint32 *)src, w, args);
+		src += srcPitch;
+		dst += dstPitch;
+	}
+}
+
+inline void setAlphaLogic32(byte *dst, const byte *src, const uint w, const uint h,
+							const uint srcPitch, const uint dstPitch,
+							const Graphics::PixelFormat &format,
+							const bool skipTransparent, const uint8 alpha) {
+
+	AlphaKernels::SetAlphaArgs args;
+	args.newAlpha        = format.ARGBToColor(alpha, 0,   0,   0);
+	args.rgbMask         = format.ARGBToColor(0,     255, 255, 255);
+	args.alphaMask       = format.ARGBToColor(255,   0,   0,   0);
+	args.skipTransparent = skipTransparent;
+
+	const AlphaKernels::SetAlphaFunc func = AlphaKernels::getSetAlpha();
+	for (uint y = 0; y < h; ++y) {
+		func((uint32 *)dst, (const uint32 *)src, w, args);
+		src += srcPitch;
+		dst += dstPitch;
+	}
+}
+
 } // End of anonymous namespace
 
+AlphaKernels::ApplyColorKeyFunc AlphaKernels::applyColorKeyFunc = nullptr;
+AlphaKernels::SetAlphaFunc AlphaKernels::setAlphaFunc = nullptr;
+
+void AlphaKernels::applyColorKeyGeneric(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args) {
+	for (uint x = 0; x < w; ++x)
+		dst[x] = colorKeyPixel(src[x], dst[x], args);
+}
+
+void AlphaKernels::setAlphaGeneric(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args) {
+	for (uint x = 0; x < w; ++x)
+		dst[x] = setAlphaPixel(src[x], args);
+}
+
+void AlphaKernels::selectImplementation() {
+	applyColorKeyFunc = applyColorKeyGeneric;
+	setAlphaFunc = setAlphaGeneric;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON)) {
+		applyColorKeyFunc = applyColorKeyNEON;
+		setAlphaFunc = setAlphaNEON;
+	}
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2)) {
+		applyColorKeyFunc = applyColorKeySSE2;
+		setAlphaFunc = setAlphaSSE2;
+	}
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2)) {
+		applyColorKeyFunc = applyColorKeyAVX2;
+		setAlphaFunc = setAlphaAVX2;
+	}
+#endif
+}
+
 // Function to merge a transparent color key with the alpha channel
 bool applyColorKey(byte *dst, const byte *src,
 				   const uint dstPitch, const uint srcPitch,
@@ -109,7 +186,7 @@ bool applyColorKey(byte *dst, const byte *src,
 		} else if (format.bytesPerPixel == 2) {
 			applyColorKeyLogic<uint16, true>(dst, src, w, h, srcDelta, dstDelta, format, rKey, gKey, bKey, rNew, gNew, bNew);
 		} else if (format.bytesPerPixel == 4) {
-			applyColorKeyLogic<uint32, true>(dst, src, w, h, srcDelta, dstDelta, format, rKey, gKey, bKey, rNew, gNew, bNew);
+			applyColorKeyLogic32(dst, src, w, h, srcPitch, dstPitch, format, true, rKey, gKey, bKey, rNew, gNew, bNew);
 		} else {
 			return false;
 		}
@@ -119,7 +196,7 @@ bool applyColorKey(byte *dst, const byte *src,
 		} else if (format.bytesPerPixel == 2) {
 			applyColorKeyLogic<uint16, false>(dst, src, w, h, srcDelta, dstDelta, format, rKey, gKey, bKey, rNew, gNew, bNew);
 		} else if (format.bytesPerPixel == 4) {
-			applyColorKeyLogic<uint32, false>(dst, src, w, h, srcDelta, dstDelta, format, rKey, gKey, bKey, rNew, gNew, bNew);
+			applyColorKeyLogic32(dst, src, w, h, srcPitch, dstPitch, format, false, rKey, gKey, bKey, rNew, gNew, bNew);
 		} else {
 			return false;
 		}
@@ -149,7 +226,7 @@ bool setAlpha(byte *dst, const byte *src,
 		} else if (format.bytesPerPixel == 2) {
 			setAlphaLogic<uint16, true>(dst, src, w, h, srcDelta, dstDelta, format, alpha);
 		} else if (format.bytesPerPixel == 4) {
-			setAlphaLogic<uint32, true>(dst, src, w, h, srcDelta, dstDelta, format, alpha);
+			setAlphaLogic32(dst, src, w, h, srcPitch, dstPitch, format, true, alpha);
 		} else {
 			return false;
 		}
@@ -159,7 +236,7 @@ bool setAlpha(byte *dst, const byte *src,
 		} else if (format.bytesPerPixel == 2) {
 			setAlphaLogic<uint16, false>(dst, src, w, h, srcDelta, dstDelta, format, alpha);
 		} else if (format.bytesPerPixel == 4) {
-			setAlphaLogic<uint32, false>(dst, src, w, h, srcDelta, dstDelta, format, alpha);
+			setAlphaLogic32(dst, src, w, h, srcPitch, dstPitch, format, false, alpha);
 		} else {
 			return false;
 		}
@@ -166,23 +166,23 @@ public:
 
 		if (ina == 255) {
 			if (rgbmod) {
-				out[BlendBlit::kBIndex] = out[BlendBlit::kBIndex] + ((in[BlendBlit::kBIndex] * this->cb) >> 8);
-				out[BlendBlit::kGIndex] = out[BlendBlit::kGIndex] + ((in[BlendBlit::kGIndex] * this->cg) >> 8);
-				out[BlendBlit::kRIndex] = out[BlendBlit::kRIndex] + ((in[BlendBlit::kRIndex] * this->cr) >> 8);
+				out[BlendBlit::kBIndex] = MIN<uint32>(out[BlendBlit::kBIndex] + ((in[BlendBlit::kBIndex] * this->cb) >> 8), 255);
+				out[BlendBlit::kGIndex] = MIN<uint32>(out[BlendBlit::kGIndex] + ((in[BlendBlit::kGIndex] * this->cg) >> 8), 255);
+				out[BlendBlit::kRIndex] = MIN<uint32>(out[BlendBlit::kRIndex] + ((in[BlendBlit::kRIndex] * this->cr) >> 8), 255);
 			} else {
-				out[BlendBlit::kBIndex] = out[BlendBlit::kBIndex] + in[BlendBlit::kBIndex];
-				out[BlendBlit::kGIndex] = out[BlendBlit::kGIndex] + in[BlendBlit::kGIndex];
-				out[BlendBlit::kRIndex] = out[BlendBlit::kRIndex] + in[BlendBlit::kRIndex];
+				out[BlendBlit::kBIndex] = MIN<uint32>(out[BlendBlit::kBIndex] + in[BlendBlit::kBIndex], 255);
+				out[BlendBlit::kGIndex] = MIN<uint32>(out[BlendBlit::kGIndex] + in[BlendBlit::kGIndex], 255);
+				out[BlendBlit::kRIndex] = MIN<uint32>(out[BlendBlit::kRIndex] + in[BlendBlit::kRIndex], 255);
 			}
 		} else if (ina != 0) {
 			if (rgbmod) {
-				out[BlendBlit::kBIndex] = out[BlendBlit::kBIndex] + ((in[BlendBlit::kBIndex] * this->cb * ina) >> 16);
-				out[BlendBlit::kGIndex] = out[BlendBlit::kGIndex] + ((in[BlendBlit::kGIndex] * this->cg * ina) >> 16);
-				out[BlendBlit::kRIndex] = out[BlendBlit::kRIndex] + ((in[BlendBlit::kRIndex] * this->cr * ina) >> 16);
+				out[BlendBlit::kBIndex] = MIN<uint32>(out[BlendBlit::kBIndex] + ((in[BlendBlit::kBIndex] * this->cb * ina) >> 16), 255);
+				out[BlendBlit::kGIndex] = MIN<uint32>(out[BlendBlit::kGIndex] + ((in[BlendBlit::kGIndex] * this->cg * ina) >> 16), 255);
+				out[BlendBlit::kRIndex] = MIN<uint32>(out[BlendBlit::kRIndex] + ((in[BlendBlit::kRIndex] * this->cr * ina) >> 16), 255);
 			} else {
-				out[BlendBlit::kBIndex] = out[BlendBlit::kBIndex] + ((in[BlendBlit::kBIndex] * ina) >> 8);
-				out[BlendBlit::kGIndex] = out[BlendBlit::kGIndex] + ((in[BlendBlit::kGIndex] * ina) >> 8);
-				out[BlendBlit::kRIndex] = out[BlendBlit::kRIndex] + ((in[BlendBlit::kRIndex] * ina) >> 8);
+				out[BlendBlit::kBIndex] = MIN<uint32>(out[BlendBlit::kBIndex] + ((in[BlendBlit::kBIndex] * ina) >> 8), 255);
+				out[BlendBlit::kGIndex] = MIN<uint32>(out[BlendBlit::kGIndex] + ((in[BlendBlit::kGIndex] * ina) >> 8), 255);
+				out[BlendBlit::kRIndex] = MIN<uint32>(out[BlendBlit::kRIndex] + ((in[BlendBlit::kRIndex] * ina) >> 8), 255);
 			}
 		}
 	}
@@ -344,4 +344,73 @@ void BlendBlit::blitT(Args &args, const TSpriteBlendMode &blendMode, const Alpha
 	}
 }
 
+/**
+ * Row kernels for the 32bpp case of applyColorKey() and setAlpha().
+ *
+ * The best implementation supported by the host CPU is picked on first
+ * use, like for BlendBlit. All variants give the same result as the
+ * generic code.
+ */
+class AlphaKernels {
+public:
+	struct ColorKeyArgs {
+		uint32 rgbMask, keyPix, newPix, alphaMask;
+		bool overwriteAlpha;
+	};
+
+	struct SetAlphaArgs {
+		uint32 rgbMask, newAlpha, alphaMask;
+		bool skipTransparent;
+	};
+
+	typedef void (*ApplyColorKeyFunc)(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args);
+	typedef void (*SetAlphaFunc)(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args);
+
+	static ApplyColorKeyFunc getApplyColorKey() {
+		if (!applyColorKeyFunc)
+			selectImplementation();
+		return applyColorKeyFunc;
+	}
+
+	static SetAlphaFunc getSetAlpha() {
+		if (!setAlphaFunc)
+			selectImplementation();
+		return setAlphaFunc;
+	}
+
+	static inline uint32 colorKeyPixel(uint32 pix, uint32 dstPix, const ColorKeyArgs &args) {
+		if ((pix & args.rgbMask) == args.keyPix)
+			return args.newPix;
+		return args.overwriteAlpha ? (pix | args.alphaMask) : dstPix;
+	}
+
+	static inline uint32 setAlphaPixel(uint32 pix, const SetAlphaArgs &args) {
+		if (!args.skipTransparent || (pix & args.alphaMask))
+			return (pix & args.rgbMask) | args.newAlpha;
+		return pix;
+	}
+
+private:
+	static void applyColorKeyGeneric(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args);
+	static void setAlphaGeneric(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args);
+#ifdef SCUMMVM_NEON
+	static void applyColorKeyNEON(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args);
+	static void setAlphaNEON(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void applyColorKeySSE2(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args);
+	static void setAlphaSSE2(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void applyColorKeyAVX2(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args);
+	static void setAlphaAVX2(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args);
+#endif
+
+	static void selectImplementation();
+
+	static ApplyColorKeyFunc applyColorKeyFunc;
+	static SetAlphaFunc setAlphaFunc;
+	friend class ::BlitAlphaTestSuite;
+}; // End of class AlphaKernels
+
 } // End of namespace Graphics
@@ -35,106 +35,114 @@
 
 namespace Graphics {
 
+/**
+ * The blend functions widen the pixels to 16 bits per channel, four pixels per
+ * register, so that the results are bit-exact with the generic code.
+ *
+ * The generic code special cases fully opaque pixels. Using 256 instead of 255
+ * as the alpha value of such pixels gives the same results without branches.
+ */
+static FORCEINLINE __m256i avx2_splatAlpha(__m256i pix) {
+	const int shuf = _MM_SHUFFLE(BlendBlit::kAIndex, BlendBlit::kAIndex, BlendBlit::kAIndex, BlendBlit::kAIndex);
+	return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pix, shuf), shuf);
+}
+
+static FORCEINLINE __m256i avx2_opaqueAlpha(__m256i ina) {
+	return _mm256_add_epi16(ina, _mm256_srli_epi16(_mm256_cmpeq_epi16(ina, _mm256_set1_epi16(255)), 15));
+}
+
+static FORCEINLINE __m256i avx2_select(__m256i mask, __m256i a, __m256i b) {
+	return _mm256_blendv_epi8(b, a, mask);
+}
+
+static FORCEINLINE __m256i avx2_channelMask(int index) {
+	uint16 lanes[16] = { 0 };
+	for (int i = 0; i < 16; i += 4)
+		lanes[i + index] = 0xffff;
+	return _mm256_loadu_si256((const __m256i *)lanes);
+}
+
+static FORCEINLINE __m256i avx2_colorMod(byte ca, byte cr, byte cg, byte cb) {
+	uint16 lanes[16];
+	for (int i = 0; i < 16; i += 4) {
+		lanes[i + BlendBlit::kAIndex] = ca;
+		lanes[i + BlendBlit::kRIndex] = cr;
+		lanes[i + BlendBlit::kGIndex] = cg;
+		lanes[i + BlendBlit::kBIndex] = cb;
+	}
+	return _mm256_loadu_si256((const __m256i *)lanes);
+}
+
+template<class Blend>
+static FORCEINLINE __m256i avx2_blend(const Blend &blend, __m256i src, __m256i dst) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i lo = blend.blend16(_mm256_unpacklo_epi8(src, zero), _mm256_unpacklo_epi8(dst, zero));
+	const __m256i hi = blend.blend16(_mm256_unpackhi_epi8(src, zero), _mm256_unpackhi_epi8(dst, zero));
+	return _mm256_packus_epi16(lo, hi);
+}
+
 class BlendBlitImpl_AVX2 : public BlendBlitImpl_Base {
 	friend class BlendBlit;
 
 template<bool rgbmod, bool alphamod>
 struct AlphaBlend : public BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod> {
 public:
-	constexpr AlphaBlend(const uint32 color) : BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod>(color) {}
+	AlphaBlend(const uint32 color) : BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod>(color),
+		_mod(avx2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(avx2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m256i simd(__m256i src, __m256i dst) const {
-		__m256i ina;
+		return avx2_blend(*this, src, dst);
+	}
+
+	inline __m256i blend16(__m256i src, __m256i dst) const {
+		__m256i ina = avx2_splatAlpha(src);
 		if (alphamod)
-			ina = _mm256_srli_epi32(_mm256_mullo_epi16(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask)), _mm256_set1_epi32(this->ca)), 8);
+			ina = _mm256_srli_epi16(_mm256_mullo_epi16(ina, _mm256_set1_epi16(this->ca)), 8);
+		const __m256i inaOpaque = avx2_opaqueAlpha(ina);
+		const __m256i dstFactor = _mm256_mullo_epi16(dst, _mm256_sub_epi16(_mm256_set1_epi16(255), ina));
+
+		__m256i res;
+		if (rgbmod)
+			res = _mm256_add_epi16(_mm256_srli_epi16(dstFactor, 8), _mm256_mulhi_epu16(_mm256_mullo_epi16(src, _mod), inaOpaque));
 		else
-			ina = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask));
-		__m256i alphaMask = _mm256_cmpeq_epi32(ina, _mm256_setzero_si256());
-	
-		if (rgbmod) {
-			__m256i dstR = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m256i dstG = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i dstB = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i srcR = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m256i srcG = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i srcB = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-
-			dstR = _mm256_slli_epi32(_mm256_mullo_epi16(dstR, _mm256_sub_epi32(_mm256_set1_epi32(255), ina)), BlendBlit::kRModShift - 8);
-			dstG = _mm256_slli_epi32(_mm256_mullo_epi16(dstG, _mm256_sub_epi32(_mm256_set1_epi32(255), ina)), BlendBlit::kGModShift - 8);
-			dstB = _mm256_mullo_epi16(dstB, _mm256_sub_epi32(_mm256_set1_epi32(255), ina));
-			srcR = _mm256_add_epi32(dstR, _mm256_slli_epi32(_mm256_mullo_epi16(_mm256_srli_epi32(_mm256_mullo_epi16(srcR, ina), 8), _mm256_set1_epi32(this->cr)), BlendBlit::kRModShift - 8));
-			srcG = _mm256_add_epi32(dstG, _mm256_slli_epi32(_mm256_mullo_epi16(_mm256_srli_epi32(_mm256_mullo_epi16(srcG, ina), 8), _mm256_set1_epi32(this->cg)), BlendBlit::kGModShift - 8));
-			srcB = _mm256_add_epi32(dstB, _mm256_mullo_epi16(_mm256_srli_epi32(_mm256_mullo_epi16(srcB, ina), 8), _mm256_set1_epi32(this->cb)));
-			src = _mm256_or_si256(_mm256_and_si256(srcB, _mm256_set1_epi32(BlendBlit::kBModMask)), _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(_mm256_and_si256(srcG, _mm256_set1_epi32(BlendBlit::kGModMask)), src);
-			src = _mm256_or_si256(_mm256_and_si256(srcR, _mm256_set1_epi32(BlendBlit::kRModMask)), src);
-		} else {
-			__m256i dstRB = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i srcRB = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i dstG = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i srcG = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-
-			dstRB = _mm256_srli_epi32(_mm256_mullo_epi32(dstRB, _mm256_sub_epi32(_mm256_set1_epi32(255), ina)), 8);
-			dstG = _mm256_srli_epi32(_mm256_mullo_epi16(dstG, _mm256_sub_epi32(_mm256_set1_epi32(255), ina)), 8);
-			srcRB = _mm256_slli_epi32(_mm256_add_epi32(dstRB, _mm256_srli_epi32(_mm256_mullo_epi32(srcRB, ina), 8)), BlendBlit::kBModShift);
-			srcG = _mm256_slli_epi32(_mm256_add_epi32(dstG, _mm256_srli_epi32(_mm256_mullo_epi16(srcG, ina), 8)), BlendBlit::kGModShift);
-			src = _mm256_or_si256(_mm256_and_si256(srcG, _mm256_set1_epi32(BlendBlit::kGModMask)), _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(_mm256_and_si256(srcRB, _mm256_set1_epi32(BlendBlit::kBModMask | BlendBlit::kRModMask)), src);
-		}
+			res = _mm256_srli_epi16(_mm256_add_epi16(dstFactor, _mm256_mullo_epi16(src, inaOpaque)), 8);
 
-		dst = _mm256_and_si256(alphaMask, dst);
-		src = _mm256_andnot_si256(alphaMask, src);
-		return _mm256_or_si256(dst, src);
+		res = avx2_select(_alphaMask, _mm256_set1_epi16(255), res);
+		return avx2_select(_mm256_cmpeq_epi16(ina, _mm256_setzero_si256()), dst, res);
 	}
+
+private:
+	const __m256i _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
 struct MultiplyBlend : public BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod> {
 public:
-	constexpr MultiplyBlend(const uint32 color) : BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod>(color) {}
+	MultiplyBlend(const uint32 color) : BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod>(color),
+		_mod(avx2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(avx2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m256i simd(__m256i src, __m256i dst) const {
-		__m256i ina, alphaMask;
-		if (alphamod) {
-			ina = _mm256_srli_epi32(_mm256_mullo_epi16(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask)), _mm256_set1_epi32(this->ca)), 8);
-			alphaMask = _mm256_cmpeq_epi32(ina, _mm256_setzero_si256());
-		} else {
-			ina = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask));
-			alphaMask = _mm256_set1_epi32(BlendBlit::kAModMask);
-		}
-
-		if (rgbmod) {
-			__m256i srcB = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i srcG = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i srcR = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m256i dstB = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i dstG = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i dstR = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
+		return avx2_blend(*this, src, dst);
+	}
 
-			srcB = _mm256_and_si256(_mm256_slli_epi32(_mm256_mullo_epi32(dstB, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi16(srcB, _mm256_set1_epi32(this->cb)), ina), 16)), BlendBlit::kBModShift - 8), _mm256_set1_epi32(BlendBlit::kBModMask));
-			srcG = _mm256_and_si256(_mm256_slli_epi32(_mm256_mullo_epi32(dstG, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi16(srcG, _mm256_set1_epi32(this->cg)), ina), 16)), BlendBlit::kGModShift - 8), _mm256_set1_epi32(BlendBlit::kGModMask));
-			srcR = _mm256_and_si256(_mm256_slli_epi32(_mm256_mullo_epi32(dstR, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi16(srcR, _mm256_set1_epi32(this->cr)), ina), 16)), BlendBlit::kRModShift - 8), _mm256_set1_epi32(BlendBlit::kRModMask));
+	inline __m256i blend16(__m256i src, __m256i dst) const {
+		__m256i ina = avx2_splatAlpha(src);
+		if (alphamod)
+			ina = _mm256_srli_epi16(_mm256_mullo_epi16(ina, _mm256_set1_epi16(this->ca)), 8);
+		const __m256i inaOpaque = avx2_opaqueAlpha(ina);
 
-			src = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(src, _mm256_or_si256(srcB, _mm256_or_si256(srcG, srcR)));
-		} else {
-			constexpr uint32 rbMask = BlendBlit::kRModMask | BlendBlit::kBModMask;
-			__m256i dstRB = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i srcRB = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i dstG = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i srcG = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-
-			srcG = _mm256_and_si256(_mm256_slli_epi32(_mm256_mullo_epi16(dstG, _mm256_srli_epi32(_mm256_mullo_epi16(srcG, ina), 8)), 8), _mm256_set1_epi32(BlendBlit::kGModMask));
-			srcRB = _mm256_and_si256(_mm256_mullo_epi16(dstRB, _mm256_srli_epi32(_mm256_and_si256(_mm256_mullo_epi32(srcRB, ina), _mm256_set1_epi32(rbMask)), 8)), _mm256_set1_epi32(rbMask));
-			
-			src = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(src, _mm256_or_si256(srcRB, srcG));
-		}
+		__m256i factor;
+		if (rgbmod)
+			factor = _mm256_mulhi_epu16(_mm256_mullo_epi16(src, _mod), inaOpaque);
+		else
+			factor = _mm256_srli_epi16(_mm256_mullo_epi16(src, inaOpaque), 8);
 
-		dst = _mm256_and_si256(alphaMask, dst);
-		src = _mm256_andnot_si256(alphaMask, src);
-		return _mm256_or_si256(dst, src);
+		const __m256i res = avx2_select(_alphaMask, dst, _mm256_srli_epi16(_mm256_mullo_epi16(dst, factor), 8));
+		return avx2_select(_mm256_cmpeq_epi16(ina, _mm256_setzero_si256()), dst, res);
 	}
+
+private:
+	const __m256i _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
@@ -163,80 +171,57 @@ public:
 template<bool rgbmod, bool alphamod>
 struct AdditiveBlend : public BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod> {
 public:
-	constexpr AdditiveBlend(const uint32 color) : BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod>(color) {}
+	AdditiveBlend(const uint32 color) : BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod>(color),
+		_mod(avx2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(avx2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m256i simd(__m256i src, __m256i dst) const {
-		__m256i ina;
-		if (alphamod)
-			ina = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask)), _mm256_set1_epi32(this->ca)), 8);
-		else
-			ina = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask));
-		__m256i alphaMask = _mm256_cmpeq_epi32(ina, _mm256_set1_epi32(0));
-
-		if (rgbmod) {
-			__m256i srcb = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kBModMask));
-			__m256i srcg = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i srcr = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m256i dstb = _mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kBModMask));
-			__m256i dstg = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m256i dstr = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-			srcb = _mm256_and_si256(_mm256_add_epi32(dstb, _mm256_srli_epi32(_mm256_mullo_epi32(srcb, _mm256_mullo_epi32(_mm256_set1_epi32(this->cb), ina)), 16)), _mm256_set1_epi32(BlendBlit::kBModMask));
-			srcg = _mm256_and_si256(_mm256_add_epi32(dstg, _mm256_mullo_epi32(srcg, _mm256_mullo_epi32(_mm256_set1_epi32(this->cg), ina))), _mm256_set1_epi32(BlendBlit::kGModMask));
-			srcr = _mm256_and_si256(_mm256_add_epi32(dstr, _mm256_srli_epi32(_mm256_mullo_epi32(srcr, _mm256_mullo_epi32(_mm256_set1_epi32(this->cr), ina)), BlendBlit::kRModShift - 16)), _mm256_set1_epi32(BlendBlit::kRModMask));
-
-			src = _mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(src, _mm256_or_si256(srcb, _mm256_or_si256(srcg, srcb)));
-		} else if (alphamod) {
-			__m256i srcg = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask));
-			__m256i srcrb = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i dstg = _mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask));
-			__m256i dstrb = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-
-			srcg = _mm256_and_si256(_mm256_add_epi32(dstg, _mm256_srli_epi32(_mm256_mullo_epi32(srcg, ina), 8)), _mm256_set1_epi32(BlendBlit::kGModMask));
-			srcrb = _mm256_and_si256(_mm256_add_epi32(dstrb, _mm256_mullo_epi32(srcrb, ina)), _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask));
-
-			src = _mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(src, _mm256_or_si256(srcrb, srcg));
-		} else {
-			__m256i srcg = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask));
-			__m256i srcrb = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m256i dstg = _mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask));
-			__m256i dstrb = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
+		return avx2_blend(*this, src, dst);
+	}
 
-			srcg = _mm256_and_si256(_mm256_add_epi32(dstg, srcg), _mm256_set1_epi32(BlendBlit::kGModMask));
-			srcrb = _mm256_and_si256(_mm256_slli_epi32(_mm256_add_epi32(dstrb, srcrb), 8), _mm256_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask));
+	inline __m256i blend16(__m256i src, __m256i dst) const {
+		__m256i ina = avx2_splatAlpha(src);
+		if (alphamod)
+			ina = _mm256_srli_epi16(_mm256_mullo_epi16(ina, _mm256_set1_epi16(this->ca)), 8);
+		const __m256i inaOpaque = avx2_opaqueAlpha(ina);
 
-			src = _mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kAModMask));
-			src = _mm256_or_si256(src, _mm256_or_si256(srcrb, srcg));
-		}
+		__m256i addend;
+		if (rgbmod)
+			addend = _mm256_mulhi_epu16(_mm256_mullo_epi16(src, _mod), inaOpaque);
+		else
+			addend = _mm256_srli_epi16(_mm256_mullo_epi16(src, inaOpaque), 8);
 
-		dst = _mm256_and_si256(alphaMask, dst);
-		src = _mm256_andnot_si256(alphaMask, src);
-		return _mm256_or_si256(dst, src);
+		// Transparent pixels add nothing, packing saturates the sum
+		return avx2_select(_alphaMask, dst, _mm256_add_epi16(dst, addend));
 	}
+
+private:
+	const __m256i _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
 struct SubtractiveBlend : public BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod> {
 public:
-	constexpr SubtractiveBlend(const uint32 color) : BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod>(color) {}
+	SubtractiveBlend(const uint32 color) : BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod>(color),
+		_mod(avx2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(avx2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m256i simd(__m256i src, __m256i dst) const {
-		__m256i ina = _mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kAModMask));
-		__m256i srcb = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-		__m256i srcg = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-		__m256i srcr = _mm256_srli_epi32(_mm256_and_si256(src, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-		__m256i dstb = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-		__m256i dstg = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-		__m256i dstr = _mm256_srli_epi32(_mm256_and_si256(dst, _mm256_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-		srcb = _mm256_and_si256(_mm256_slli_epi32(_mm256_max_epi16(_mm256_sub_epi32(dstb, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi32(srcb, _mm256_set1_epi32(this->cb)), _mm256_mullo_epi32(dstb, ina)), 24)), _mm256_set1_epi32(0)), BlendBlit::kBModShift), _mm256_set1_epi32(BlendBlit::kBModMask));
-		srcg = _mm256_and_si256(_mm256_slli_epi32(_mm256_max_epi16(_mm256_sub_epi32(dstg, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi32(srcg, _mm256_set1_epi32(this->cg)), _mm256_mullo_epi32(dstg, ina)), 24)), _mm256_set1_epi32(0)), BlendBlit::kGModShift), _mm256_set1_epi32(BlendBlit::kGModMask));
-		srcr = _mm256_and_si256(_mm256_slli_epi32(_mm256_max_epi16(_mm256_sub_epi32(dstr, _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_mullo_epi32(srcr, _mm256_set1_epi32(this->cr)), _mm256_mullo_epi32(dstr, ina)), 24)), _mm256_set1_epi32(0)), BlendBlit::kRModShift), _mm256_set1_epi32(BlendBlit::kRModMask));
-
-		return _mm256_or_si256(_mm256_set1_epi32(BlendBlit::kAModMask), _mm256_or_si256(srcb, _mm256_or_si256(srcg, srcr)));
+		return avx2_blend(*this, src, dst);
 	}
+
+	inline __m256i blend16(__m256i src, __m256i dst) const {
+		const __m256i inaOpaque = avx2_opaqueAlpha(avx2_splatAlpha(src));
+
+		__m256i subtrahend;
+		if (rgbmod)
+			subtrahend = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_mullo_epi16(src, _mod), _mm256_mullo_epi16(dst, inaOpaque)), 8);
+		else
+			subtrahend = _mm256_mulhi_epu16(_mm256_mullo_epi16(src, dst), inaOpaque);
+
+		return avx2_select(_alphaMask, _mm256_set1_epi16(255), _mm256_sub_epi16(dst, subtrahend));
+	}
+
+private:
+	const __m256i _mod, _alphaMask;
 };
 
 public:
@@ -321,6 +306,42 @@ void BlendBlit::blitAVX2(Args &args, const TSpriteBlendMode &blendMode, const Al
 	blitT<BlendBlitImpl_AVX2>(args, blendMode, alphaType);
 }
 
+void AlphaKernels::applyColorKeyAVX2(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args) {
+	const __m256i rgbMask = _mm256_set1_epi32(args.rgbMask);
+	const __m256i keyPix = _mm256_set1_epi32(args.keyPix);
+	const __m256i newPix = _mm256_set1_epi32(args.newPix);
+	const __m256i alphaMask = _mm256_set1_epi32(args.alphaMask);
+
+	uint x = 0;
+	for (; x + 8 <= w; x += 8) {
+		const __m256i pix = _mm256_loadu_si256((const __m256i *)(src + x));
+		const __m256i other = args.overwriteAlpha ? _mm256_or_si256(pix, alphaMask) : _mm256_loadu_si256((const __m256i *)(dst + x));
+		const __m256i match = _mm256_cmpeq_epi32(_mm256_and_si256(pix, rgbMask), keyPix);
+		_mm256_storeu_si256((__m256i *)(dst + x), _mm256_blendv_epi8(other, newPix, match));
+	}
+	for (; x < w; ++x)
+		dst[x] = colorKeyPixel(src[x], dst[x], args);
+}
+
+void AlphaKernels::setAlphaAVX2(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args) {
+	const __m256i rgbMask = _mm256_set1_epi32(args.rgbMask);
+	const __m256i newAlpha = _mm256_set1_epi32(args.newAlpha);
+	const __m256i alphaMask = _mm256_set1_epi32(args.alphaMask);
+
+	uint x = 0;
+	for (; x + 8 <= w; x += 8) {
+		const __m256i pix = _mm256_loadu_si256((const __m256i *)(src + x));
+		__m256i res = _mm256_or_si256(_mm256_and_si256(pix, rgbMask), newAlpha);
+		if (args.skipTransparent) {
+			const __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(pix, alphaMask), _mm256_setzero_si256());
+			res = _mm256_blendv_epi8(res, pix, transparent);
+		}
+		_mm256_storeu_si256((__m256i *)(dst + x), res);
+	}
+	for (; x < w; ++x)
+		dst[x] = setAlphaPixel(src[x], args);
+}
+
 } // End of namespace Graphics
 
 #if defined(__clang__)
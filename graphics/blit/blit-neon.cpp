@@ -41,106 +41,114 @@
 
 namespace Graphics {
 
+/**
+ * The blend functions widen the pixels to 16 bits per channel, two pixels per
+ * register, so that the results are bit-exact with the generic code.
+ *
+ * The generic code special cases fully opaque pixels. Using 256 instead of 255
+ * as the alpha value of such pixels gives the same results without branches.
+ */
+static FORCEINLINE uint16x8_t neon_splatAlpha(uint16x8_t pix) {
+	return vcombine_u16(vdup_lane_u16(vget_low_u16(pix), BlendBlit::kAIndex), vdup_lane_u16(vget_high_u16(pix), BlendBlit::kAIndex));
+}
+
+static FORCEINLINE uint16x8_t neon_opaqueAlpha(uint16x8_t ina) {
+	return vaddq_u16(ina, vshrq_n_u16(vceqq_u16(ina, vdupq_n_u16(255)), 15));
+}
+
+static FORCEINLINE uint16x8_t neon_mulhi(uint16x8_t a, uint16x8_t b) {
+	return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), vget_low_u16(b)), 16),
+	                    vshrn_n_u32(vmull_u16(vget_high_u16(a), vget_high_u16(b)), 16));
+}
+
+static FORCEINLINE uint16x8_t neon_channelMask(int index) {
+	uint16 lanes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	lanes[index] = lanes[index + 4] = 0xffff;
+	return vld1q_u16(lanes);
+}
+
+static FORCEINLINE uint16x8_t neon_colorMod(byte ca, byte cr, byte cg, byte cb) {
+	uint16 lanes[8];
+	for (int i = 0; i < 8; i += 4) {
+		lanes[i + BlendBlit::kAIndex] = ca;
+		lanes[i + BlendBlit::kRIndex] = cr;
+		lanes[i + BlendBlit::kGIndex] = cg;
+		lanes[i + BlendBlit::kBIndex] = cb;
+	}
+	return vld1q_u16(lanes);
+}
+
+template<class Blend>
+static FORCEINLINE uint32x4_t neon_blend(const Blend &blend, uint32x4_t src, uint32x4_t dst) {
+	const uint8x16_t src8 = vreinterpretq_u8_u32(src);
+	const uint8x16_t dst8 = vreinterpretq_u8_u32(dst);
+	const uint16x8_t lo = blend.blend16(vmovl_u8(vget_low_u8(src8)), vmovl_u8(vget_low_u8(dst8)));
+	const uint16x8_t hi = blend.blend16(vmovl_u8(vget_high_u8(src8)), vmovl_u8(vget_high_u8(dst8)));
+	return vreinterpretq_u32_u8(vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+}
+
 class BlendBlitImpl_NEON : public BlendBlitImpl_Base {
 	friend class BlendBlit;
 
 template<bool rgbmod, bool alphamod>
 struct AlphaBlend : public BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod> {
 public:
-	constexpr AlphaBlend(const uint32 color) : BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod>(color) {}
+	AlphaBlend(const uint32 color) : BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod>(color),
+		_mod(neon_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(neon_channelMask(BlendBlit::kAIndex)) {}
 
 	inline uint32x4_t simd(uint32x4_t src, uint32x4_t dst) const {
-		uint32x4_t ina;
+		return neon_blend(*this, src, dst);
+	}
+
+	inline uint16x8_t blend16(uint16x8_t src, uint16x8_t dst) const {
+		uint16x8_t ina = neon_splatAlpha(src);
 		if (alphamod)
-			ina = vshrq_n_u32(vmulq_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask)), vdupq_n_u32(this->ca)), 8);
+			ina = vshrq_n_u16(vmulq_n_u16(ina, this->ca), 8);
+		const uint16x8_t inaOpaque = neon_opaqueAlpha(ina);
+		const uint16x8_t dstFactor = vmulq_u16(dst, vsubq_u16(vdupq_n_u16(255), ina));
+
+		uint16x8_t res;
+		if (rgbmod)
+			res = vaddq_u16(vshrq_n_u16(dstFactor, 8), neon_mulhi(vmulq_u16(src, _mod), inaOpaque));
 		else
-			ina = vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask));
-		uint32x4_t alphaMask = vceqq_u32(ina, vmovq_n_u32(0));
-
-		if (rgbmod) {
-			uint32x4_t dstR = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask)), 16);
-			uint32x4_t srcR = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask)), 16);
-			uint32x4_t dstG = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask)), 8);
-			uint32x4_t srcG = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask)), 8);
-			uint32x4_t dstB = vandq_u32(dst, vmovq_n_u32(BlendBlit::kBModMask));
-			uint32x4_t srcB = vandq_u32(src, vmovq_n_u32(BlendBlit::kBModMask));
-
-			dstR = vshrq_n_u32(vmulq_u32(dstR, vsubq_u32(vmovq_n_u32(255), ina)), 8);
-			dstG = vshrq_n_u32(vmulq_u32(dstG, vsubq_u32(vmovq_n_u32(255), ina)), 8);
-			dstB = vshrq_n_u32(vmulq_u32(dstB, vsubq_u32(vmovq_n_u32(255), ina)), 8);
-			srcR = vaddq_u32(dstR, vshrq_n_u32(vmulq_u32(vmulq_u32(srcR, ina), vmovq_n_u32(this->cr)), 16));
-			srcG = vaddq_u32(dstG, vshrq_n_u32(vmulq_u32(vmulq_u32(srcG, ina), vmovq_n_u32(this->cg)), 16));
-			srcB = vaddq_u32(dstB, vshrq_n_u32(vmulq_u32(vmulq_u32(srcB, ina), vmovq_n_u32(this->cb)), 16));
-			src = vorrq_u32(vandq_u32(srcB, vmovq_n_u32(BlendBlit::kBModMask)), vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(vandq_u32(vshlq_n_u32(srcG, 8), vmovq_n_u32(BlendBlit::kGModMask)), src);
-			src = vorrq_u32(vandq_u32(vshlq_n_u32(srcR, 16), vmovq_n_u32(BlendBlit::kRModMask)), src);
-		} else {
-			uint32x4_t dstRB = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask)), 8);
-			uint32x4_t srcRB = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask)), 8);
-			uint32x4_t dstG = vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask));
-			uint32x4_t srcG = vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask));
-
-			dstRB = vmulq_u32(dstRB, vsubq_u32(vmovq_n_u32(255), ina));
-			dstG = vshrq_n_u32(vmulq_u32(dstG, vsubq_u32(vmovq_n_u32(255), ina)), 8);
-			srcRB = vaddq_u32(dstRB, vmulq_u32(srcRB, ina));
-			srcG = vaddq_u32(dstG, vshrq_n_u32(vmulq_u32(srcG, ina), 8));
-			src = vorrq_u32(vandq_u32(srcG, vmovq_n_u32(BlendBlit::kGModMask)), vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(vandq_u32(srcRB, vmovq_n_u32(BlendBlit::kBModMask | BlendBlit::kRModMask)), src);
-		}
+			res = vshrq_n_u16(vaddq_u16(dstFactor, vmulq_u16(src, inaOpaque)), 8);
 
-		dst = vandq_u32(alphaMask, dst);
-		src = vandq_u32(vmvnq_u32(alphaMask), src);
-		return vorrq_u32(dst, src);
+		res = vbslq_u16(_alphaMask, vdupq_n_u16(255), res);
+		return vbslq_u16(vceqq_u16(ina, vdupq_n_u16(0)), dst, res);
 	}
+
+private:
+	const uint16x8_t _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
 struct MultiplyBlend : public BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod> {
 public:
-	constexpr MultiplyBlend(const uint32 color) : BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod>(color) {}
+	MultiplyBlend(const uint32 color) : BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod>(color),
+		_mod(neon_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(neon_channelMask(BlendBlit::kAIndex)) {}
 
 	inline uint32x4_t simd(uint32x4_t src, uint32x4_t dst) const {
-		uint32x4_t ina, alphaMask;
-		if (alphamod) {
-			ina = vshrq_n_u32(vmulq_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask)), vdupq_n_u32(this->ca)), 8);
-			alphaMask = vceqq_u32(ina, vmovq_n_u32(0));
-		} else {
-			ina = vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask));
-			alphaMask = vdupq_n_u32(BlendBlit::kAModMask);
-		}
-
-		if (rgbmod) {
-			uint32x4_t srcB = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			uint32x4_t srcG = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			uint32x4_t srcR = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			uint32x4_t dstB = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			uint32x4_t dstG = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			uint32x4_t dstR = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-			srcB = vandq_u32(vshlq_n_u32(vmulq_u32(dstB, vshrq_n_u32(vmulq_u32(vmulq_u32(srcB, vmovq_n_u32(this->cb)), ina), 16)), BlendBlit::kBModShift - 8), vmovq_n_u32(BlendBlit::kBModMask));
-			srcG = vandq_u32(vshlq_n_u32(vmulq_u32(dstG, vshrq_n_u32(vmulq_u32(vmulq_u32(srcG, vmovq_n_u32(this->cg)), ina), 16)), BlendBlit::kGModShift - 8), vmovq_n_u32(BlendBlit::kGModMask));
-			srcR = vandq_u32(vshlq_n_u32(vmulq_u32(dstR, vshrq_n_u32(vmulq_u32(vmulq_u32(srcR, vmovq_n_u32(this->cr)), ina), 16)), BlendBlit::kRModShift - 8), vmovq_n_u32(BlendBlit::kRModMask));
-
-			src = vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(src, vorrq_u32(srcB, vorrq_u32(srcG, srcR)));
-		} else {
-			constexpr uint32 rbMask = BlendBlit::kRModMask | BlendBlit::kBModMask;
-			uint32x4_t srcG = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			uint32x4_t srcRB = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(rbMask)), BlendBlit::kBModShift);
-			uint32x4_t dstG = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			uint32x4_t dstRB = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(rbMask)), BlendBlit::kBModShift);
+		return neon_blend(*this, src, dst);
+	}
 
-			srcG = vandq_u32(vshlq_n_u32(vmulq_u32(dstG, vshrq_n_u32(vmulq_u32(srcG, ina), 8)), 8), vmovq_n_u32(BlendBlit::kGModMask));
-			srcRB = vandq_u32(vreinterpretq_u32_u16(vmulq_u16(vreinterpretq_u16_u32(dstRB), vreinterpretq_u16_u32(vshrq_n_u32(vandq_u32(vmulq_u32(srcRB, ina), vmovq_n_u32(rbMask)), 8)))), vmovq_n_u32(rbMask));
+	inline uint16x8_t blend16(uint16x8_t src, uint16x8_t dst) const {
+		uint16x8_t ina = neon_splatAlpha(src);
+		if (alphamod)
+			ina = vshrq_n_u16(vmulq_n_u16(ina, this->ca), 8);
+		const uint16x8_t inaOpaque = neon_opaqueAlpha(ina);
 
-			src = vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(src, vorrq_u32(srcRB, srcG));
-		}
+		uint16x8_t factor;
+		if (rgbmod)
+			factor = neon_mulhi(vmulq_u16(src, _mod), inaOpaque);
+		else
+			factor = vshrq_n_u16(vmulq_u16(src, inaOpaque), 8);
 
-		dst = vandq_u32(alphaMask, dst);
-		src = vandq_u32(vmvnq_u32(alphaMask), src);
-		return vorrq_u32(dst, src);
+		const uint16x8_t res = vbslq_u16(_alphaMask, dst, vshrq_n_u16(vmulq_u16(dst, factor), 8));
+		return vbslq_u16(vceqq_u16(ina, vdupq_n_u16(0)), dst, res);
 	}
+
+private:
+	const uint16x8_t _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
@@ -169,80 +177,57 @@ public:
 template<bool rgbmod, bool alphamod>
 struct AdditiveBlend : public BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod> {
 public:
-	constexpr AdditiveBlend(const uint32 color) : BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod>(color) {}
+	AdditiveBlend(const uint32 color) : BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod>(color),
+		_mod(neon_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(neon_channelMask(BlendBlit::kAIndex)) {}
 
 	inline uint32x4_t simd(uint32x4_t src, uint32x4_t dst) const {
-		uint32x4_t ina;
-		if (alphamod)
-			ina = vshrq_n_u32(vmulq_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask)), vdupq_n_u32(this->ca)), 8);
-		else
-			ina = vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask));
-		uint32x4_t alphaMask = vceqq_u32(ina, vmovq_n_u32(0));
-
-		if (rgbmod) {
-			uint32x4_t srcb = vandq_u32(src, vmovq_n_u32(BlendBlit::kBModMask));
-			uint32x4_t srcg = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			uint32x4_t srcr = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			uint32x4_t dstb = vandq_u32(dst, vmovq_n_u32(BlendBlit::kBModMask));
-			uint32x4_t dstg = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			uint32x4_t dstr = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-			srcb = vandq_u32(vaddq_u32(dstb, vshrq_n_u32(vmulq_u32(srcb, vmulq_u32(vmovq_n_u32(this->cb), ina)), 16)), vmovq_n_u32(BlendBlit::kBModMask));
-			srcg = vandq_u32(vaddq_u32(dstg, vmulq_u32(srcg, vmulq_u32(vmovq_n_u32(this->cg), ina))), vmovq_n_u32(BlendBlit::kGModMask));
-			srcr = vandq_u32(vaddq_u32(dstr, vshrq_n_u32(vmulq_u32(srcr, vmulq_u32(vmovq_n_u32(this->cr), ina)), BlendBlit::kRModShift - 16)), vmovq_n_u32(BlendBlit::kRModMask));
-
-			src = vandq_u32(dst, vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(src, vorrq_u32(srcb, vorrq_u32(srcg, srcr)));
-		} else if (alphamod) {
-			uint32x4_t srcg = vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask));
-			uint32x4_t srcrb = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			uint32x4_t dstg = vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask));
-			uint32x4_t dstrb = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-
-			srcg = vandq_u32(vaddq_u32(dstg, vshrq_n_u32(vmulq_u32(srcg, ina), 8)), vmovq_n_u32(BlendBlit::kGModMask));
-			srcrb = vandq_u32(vaddq_u32(dstrb, vmulq_u32(srcrb, ina)), vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask));
-
-			src = vandq_u32(dst, vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(src, vorrq_u32(srcrb, srcg));
-		} else {
-			uint32x4_t srcg = vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask));
-			uint32x4_t srcrb = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			uint32x4_t dstg = vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask));
-			uint32x4_t dstrb = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
+		return neon_blend(*this, src, dst);
+	}
 
-			srcg = vandq_u32(vaddq_u32(dstg, srcg), vmovq_n_u32(BlendBlit::kGModMask));
-			srcrb = vandq_u32(vshlq_n_u32(vaddq_u32(dstrb, srcrb), 8), vmovq_n_u32(BlendBlit::kRModMask | BlendBlit::kBModMask));
+	inline uint16x8_t blend16(uint16x8_t src, uint16x8_t dst) const {
+		uint16x8_t ina = neon_splatAlpha(src);
+		if (alphamod)
+			ina = vshrq_n_u16(vmulq_n_u16(ina, this->ca), 8);
+		const uint16x8_t inaOpaque = neon_opaqueAlpha(ina);
 
-			src = vandq_u32(dst, vmovq_n_u32(BlendBlit::kAModMask));
-			src = vorrq_u32(src, vorrq_u32(srcrb, srcg));
-		}
+		uint16x8_t addend;
+		if (rgbmod)
+			addend = neon_mulhi(vmulq_u16(src, _mod), inaOpaque);
+		else
+			addend = vshrq_n_u16(vmulq_u16(src, inaOpaque), 8);
 
-		dst = vandq_u32(alphaMask, dst);
-		src = vandq_u32(vmvnq_u32(alphaMask), src);
-		return vorrq_u32(dst, src);
+		// Transparent pixels add nothing, narrowing saturates the sum
+		return vbslq_u16(_alphaMask, dst, vaddq_u16(dst, addend));
 	}
+
+private:
+	const uint16x8_t _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
 struct SubtractiveBlend : public BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod> {
 public:
-	constexpr SubtractiveBlend(const uint32 color) : BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod>(color) {}
+	SubtractiveBlend(const uint32 color) : BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod>(color),
+		_mod(neon_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(neon_channelMask(BlendBlit::kAIndex)) {}
 
 	inline uint32x4_t simd(uint32x4_t src, uint32x4_t dst) const {
-		uint32x4_t ina = vandq_u32(src, vmovq_n_u32(BlendBlit::kAModMask));
-		uint32x4_t srcb = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-		uint32x4_t srcg = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-		uint32x4_t srcr = vshrq_n_u32(vandq_u32(src, vmovq_n_u32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-		uint32x4_t dstb = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-		uint32x4_t dstg = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-		uint32x4_t dstr = vshrq_n_u32(vandq_u32(dst, vmovq_n_u32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-		srcb = vandq_u32(vshlq_n_u32(vreinterpretq_u32_s32(vmaxq_s32(vsubq_s32(vreinterpretq_s32_u32(dstb), vreinterpretq_s32_u32(vshrq_n_u32(vmulq_u32(vmulq_u32(srcb, vmovq_n_u32(this->cb)), vmulq_u32(dstb, ina)), 24))), vmovq_n_s32(0))), BlendBlit::kBModShift), vmovq_n_u32(BlendBlit::kBModMask));
-		srcg = vandq_u32(vshlq_n_u32(vreinterpretq_u32_s32(vmaxq_s32(vsubq_s32(vreinterpretq_s32_u32(dstg), vreinterpretq_s32_u32(vshrq_n_u32(vmulq_u32(vmulq_u32(srcg, vmovq_n_u32(this->cg)), vmulq_u32(dstg, ina)), 24))), vmovq_n_s32(0))), BlendBlit::kGModShift), vmovq_n_u32(BlendBlit::kGModMask));
-		srcr = vandq_u32(vshlq_n_u32(vreinterpretq_u32_s32(vmaxq_s32(vsubq_s32(vreinterpretq_s32_u32(dstr), vreinterpretq_s32_u32(vshrq_n_u32(vmulq_u32(vmulq_u32(srcr, vmovq_n_u32(this->cr)), vmulq_u32(dstr, ina)), 24))), vmovq_n_s32(0))), BlendBlit::kRModShift), vmovq_n_u32(BlendBlit::kRModMask));
-
-		return vorrq_u32(vmovq_n_u32(BlendBlit::kAModMask), vorrq_u32(srcb, vorrq_u32(srcg, srcr)));
+		return neon_blend(*this, src, dst);
 	}
+
+	inline uint16x8_t blend16(uint16x8_t src, uint16x8_t dst) const {
+		const uint16x8_t inaOpaque = neon_opaqueAlpha(neon_splatAlpha(src));
+
+		uint16x8_t subtrahend;
+		if (rgbmod)
+			subtrahend = vshrq_n_u16(neon_mulhi(vmulq_u16(src, _mod), vmulq_u16(dst, inaOpaque)), 8);
+		else
+			subtrahend = neon_mulhi(vmulq_u16(src, dst), inaOpaque);
+
+		return vbslq_u16(_alphaMask, vdupq_n_u16(255), vsubq_u16(dst, subtrahend));
+	}
+
+private:
+	const uint16x8_t _mod, _alphaMask;
 };
 
 public:
@@ -324,6 +309,40 @@ void BlendBlit::blitNEON(Args &args, const TSpriteBlendMode &blendMode, const Al
 	blitT<BlendBlitImpl_NEON>(args, blendMode, alphaType);
 }
 
+void AlphaKernels::applyColorKeyNEON(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args) {
+	const uint32x4_t rgbMask = vdupq_n_u32(args.rgbMask);
+	const uint32x4_t keyPix = vdupq_n_u32(args.keyPix);
+	const uint32x4_t newPix = vdupq_n_u32(args.newPix);
+	const uint32x4_t alphaMask = vdupq_n_u32(args.alphaMask);
+
+	uint x = 0;
+	for (; x + 4 <= w; x += 4) {
+		const uint32x4_t pix = vld1q_u32(src + x);
+		const uint32x4_t other = args.overwriteAlpha ? vorrq_u32(pix, alphaMask) : vld1q_u32(dst + x);
+		const uint32x4_t match = vceqq_u32(vandq_u32(pix, rgbMask), keyPix);
+		vst1q_u32(dst + x, vbslq_u32(match, newPix, other));
+	}
+	for (; x < w; ++x)
+		dst[x] = colorKeyPixel(src[x], dst[x], args);
+}
+
+void AlphaKernels::setAlphaNEON(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args) {
+	const uint32x4_t rgbMask = vdupq_n_u32(args.rgbMask);
+	const uint32x4_t newAlpha = vdupq_n_u32(args.newAlpha);
+	const uint32x4_t alphaMask = vdupq_n_u32(args.alphaMask);
+
+	uint x = 0;
+	for (; x + 4 <= w; x += 4) {
+		const uint32x4_t pix = vld1q_u32(src + x);
+		uint32x4_t res = vorrq_u32(vandq_u32(pix, rgbMask), newAlpha);
+		if (args.skipTransparent)
+			res = vbslq_u32(vtstq_u32(pix, alphaMask), res, pix);
+		vst1q_u32(dst + x, res);
+	}
+	for (; x < w; ++x)
+		dst[x] = setAlphaPixel(src[x], args);
+}
+
 } // end of namespace Graphics
 
 #if !defined(__aarch64__) && !defined(__ARM_NEON)
@@ -39,10 +39,49 @@
 
 namespace Graphics {
 
-static FORCEINLINE __m128i sse2_mul32(__m128i a, __m128i b) {
-	__m128i even = _mm_shuffle_epi32(_mm_mul_epu32(a, b), _MM_SHUFFLE(0, 0, 2, 0));
-	__m128i odd = _mm_shuffle_epi32(_mm_mul_epu32(_mm_bsrli_si128(a, 4), _mm_bsrli_si128(b, 4)), _MM_SHUFFLE(0, 0, 2, 0));
-	return _mm_unpacklo_epi32(even, odd);
+/**
+ * The blend functions widen the pixels to 16 bits per channel, two pixels per
+ * register, so that the results are bit-exact with the generic code.
+ *
+ * The generic code special cases fully opaque pixels. Using 256 instead of 255
+ * as the alpha value of such pixels gives the same results without branches.
+ */
+static FORCEINLINE __m128i sse2_splatAlpha(__m128i pix) {
+	const int shuf = _MM_SHUFFLE(BlendBlit::kAIndex, BlendBlit::kAIndex, BlendBlit::kAIndex, BlendBlit::kAIndex);
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pix, shuf), shuf);
+}
+
+static FORCEINLINE __m128i sse2_opaqueAlpha(__m128i ina) {
+	return _mm_add_epi16(ina, _mm_srli_epi16(_mm_cmpeq_epi16(ina, _mm_set1_epi16(255)), 15));
+}
+
+static FORCEINLINE __m128i sse2_select(__m128i mask, __m128i a, __m128i b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static FORCEINLINE __m128i sse2_channelMask(int index) {
+	uint16 lanes[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	lanes[index] = lanes[index + 4] = 0xffff;
+	return _mm_loadu_si128((const __m128i *)lanes);
+}
+
+static FORCEINLINE __m128i sse2_colorMod(byte ca, byte cr, byte cg, byte cb) {
+	uint16 lanes[8];
+	for (int i = 0; i < 8; i += 4) {
+		lanes[i + BlendBlit::kAIndex] = ca;
+		lanes[i + BlendBlit::kRIndex] = cr;
+		lanes[i + BlendBlit::kGIndex] = cg;
+		lanes[i + BlendBlit::kBIndex] = cb;
+	}
+	return _mm_loadu_si128((const __m128i *)lanes);
+}
+
+template<class Blend>
+static FORCEINLINE __m128i sse2_blend(const Blend &blend, __m128i src, __m128i dst) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = blend.blend16(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero));
+	const __m128i hi = blend.blend16(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero));
+	return _mm_packus_epi16(lo, hi);
 }
 
 class BlendBlitImpl_SSE2 : public BlendBlitImpl_Base {
@@ -51,100 +90,62 @@ class BlendBlitImpl_SSE2 : public BlendBlitImpl_Base {
 template<bool rgbmod, bool alphamod>
 struct AlphaBlend : public BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod> {
 public:
-	constexpr AlphaBlend(const uint32 color) : BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod>(color) {}
+	AlphaBlend(const uint32 color) : BlendBlitImpl_Base::AlphaBlend<rgbmod, alphamod>(color),
+		_mod(sse2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(sse2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m128i simd(__m128i src, __m128i dst) const {
-		__m128i ina;
+		return sse2_blend(*this, src, dst);
+	}
+
+	inline __m128i blend16(__m128i src, __m128i dst) const {
+		__m128i ina = sse2_splatAlpha(src);
 		if (alphamod)
-			ina = _mm_srli_epi32(_mm_mullo_epi16(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask)), _mm_set1_epi32(this->ca)), 8);
+			ina = _mm_srli_epi16(_mm_mullo_epi16(ina, _mm_set1_epi16(this->ca)), 8);
+		const __m128i inaOpaque = sse2_opaqueAlpha(ina);
+		const __m128i dstFactor = _mm_mullo_epi16(dst, _mm_sub_epi16(_mm_set1_epi16(255), ina));
+
+		__m128i res;
+		if (rgbmod)
+			res = _mm_add_epi16(_mm_srli_epi16(dstFactor, 8), _mm_mulhi_epu16(_mm_mullo_epi16(src, _mod), inaOpaque));
 		else
-			ina = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask));
-		__m128i alphaMask = _mm_cmpeq_epi32(ina, _mm_setzero_si128());
-	
-		if (rgbmod) {
-			__m128i dstR = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m128i dstG = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i dstB = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i srcR = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m128i srcG = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i srcB = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-
-			dstR = _mm_slli_epi32(_mm_mullo_epi16(dstR, _mm_sub_epi32(_mm_set1_epi32(255), ina)), BlendBlit::kRModShift - 8);
-			dstG = _mm_slli_epi32(_mm_mullo_epi16(dstG, _mm_sub_epi32(_mm_set1_epi32(255), ina)), BlendBlit::kGModShift - 8);
-			dstB = _mm_mullo_epi16(dstB, _mm_sub_epi32(_mm_set1_epi32(255), ina));
-			srcR = _mm_add_epi32(dstR, _mm_slli_epi32(_mm_mullo_epi16(_mm_srli_epi32(_mm_mullo_epi16(srcR, ina), 8), _mm_set1_epi32(this->cr)), BlendBlit::kRModShift - 8));
-			srcG = _mm_add_epi32(dstG, _mm_slli_epi32(_mm_mullo_epi16(_mm_srli_epi32(_mm_mullo_epi16(srcG, ina), 8), _mm_set1_epi32(this->cg)), BlendBlit::kGModShift - 8));
-			srcB = _mm_add_epi32(dstB, _mm_mullo_epi16(_mm_srli_epi32(_mm_mullo_epi16(srcB, ina), 8), _mm_set1_epi32(this->cb)));
-			src = _mm_or_si128(_mm_and_si128(srcB, _mm_set1_epi32(BlendBlit::kBModMask)), _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(_mm_and_si128(srcG, _mm_set1_epi32(BlendBlit::kGModMask)), src);
-			src = _mm_or_si128(_mm_and_si128(srcR, _mm_set1_epi32(BlendBlit::kRModMask)), src);
-		} else {
-			__m128i dstRB = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i srcRB = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i dstG = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i srcG = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-
-			dstRB = _mm_srli_epi32(sse2_mul32(dstRB, _mm_sub_epi32(_mm_set1_epi32(255), ina)), 8);
-			dstG = _mm_srli_epi32(_mm_mullo_epi16(dstG, _mm_sub_epi32(_mm_set1_epi32(255), ina)), 8);
-			srcRB = _mm_slli_epi32(_mm_add_epi32(dstRB, _mm_srli_epi32(sse2_mul32(srcRB, ina), 8)), BlendBlit::kBModShift);
-			srcG = _mm_slli_epi32(_mm_add_epi32(dstG, _mm_srli_epi32(_mm_mullo_epi16(srcG, ina), 8)), BlendBlit::kGModShift);
-			src = _mm_or_si128(_mm_and_si128(srcG, _mm_set1_epi32(BlendBlit::kGModMask)), _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(_mm_and_si128(srcRB, _mm_set1_epi32(BlendBlit::kBModMask | BlendBlit::kRModMask)), src);
-		}
+			res = _mm_srli_epi16(_mm_add_epi16(dstFactor, _mm_mullo_epi16(src, inaOpaque)), 8);
 
-		dst = _mm_and_si128(alphaMask, dst);
-		src = _mm_andnot_si128(alphaMask, src);
-		return _mm_or_si128(dst, src);
+		res = sse2_select(_alphaMask, _mm_set1_epi16(255), res);
+		return sse2_select(_mm_cmpeq_epi16(ina, _mm_setzero_si128()), dst, res);
 	}
+
+private:
+	const __m128i _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
 struct MultiplyBlend : public BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod> {
 public:
-	constexpr MultiplyBlend(const uint32 color) : BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod>(color) {}
+	MultiplyBlend(const uint32 color) : BlendBlitImpl_Base::MultiplyBlend<rgbmod, alphamod>(color),
+		_mod(sse2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(sse2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m128i simd(__m128i src, __m128i dst) const {
-		__m128i ina, alphaMask;
-		if (alphamod) {
-			ina = _mm_srli_epi32(_mm_mullo_epi16(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask)), _mm_set1_epi32(this->ca)), 8);
-			alphaMask = _mm_cmpeq_epi32(ina, _mm_setzero_si128());
-		} else {
-			ina = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask));
-			alphaMask = _mm_set1_epi32(BlendBlit::kAModMask);
-		}
-
-		if (rgbmod) {
-			__m128i srcB = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i srcG = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i srcR = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m128i dstB = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i dstG = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i dstR = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
+		return sse2_blend(*this, src, dst);
+	}
 
-			srcB = _mm_and_si128(_mm_slli_epi32(_mm_mullo_epi16(dstB, _mm_srli_epi32(sse2_mul32(_mm_mullo_epi16(srcB, _mm_set1_epi32(this->cb)), ina), 16)), BlendBlit::kBModShift - 8), _mm_set1_epi32(BlendBlit::kBModMask));
-			srcG = _mm_and_si128(_mm_slli_epi32(_mm_mullo_epi16(dstG, _mm_srli_epi32(sse2_mul32(_mm_mullo_epi16(srcG, _mm_set1_epi32(this->cg)), ina), 16)), BlendBlit::kGModShift - 8), _mm_set1_epi32(BlendBlit::kGModMask));
-			srcR = _mm_and_si128(_mm_slli_epi32(_mm_mullo_epi16(dstR, _mm_srli_epi32(sse2_mul32(_mm_mullo_epi16(srcR, _mm_set1_epi32(this->cr)), ina), 16)), BlendBlit::kRModShift - 8), _mm_set1_epi32(BlendBlit::kRModMask));
+	inline __m128i blend16(__m128i src, __m128i dst) const {
+		__m128i ina = sse2_splatAlpha(src);
+		if (alphamod)
+			ina = _mm_srli_epi16(_mm_mullo_epi16(ina, _mm_set1_epi16(this->ca)), 8);
+		const __m128i inaOpaque = sse2_opaqueAlpha(ina);
 
-			src = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(src, _mm_or_si128(srcB, _mm_or_si128(srcG, srcR)));
-		} else {
-			constexpr uint32 rbMask = BlendBlit::kRModMask | BlendBlit::kBModMask;
-			__m128i srcG = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i srcRB = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(rbMask)), BlendBlit::kBModShift);
-			__m128i dstG = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i dstRB = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(rbMask)), BlendBlit::kBModShift);
-
-			srcG = _mm_and_si128(_mm_slli_epi32(_mm_mullo_epi16(dstG, _mm_srli_epi32(_mm_mullo_epi16(srcG, ina), 8)), 8), _mm_set1_epi32(BlendBlit::kGModMask));
-			srcRB = _mm_and_si128(_mm_mullo_epi16(dstRB, _mm_srli_epi32(_mm_and_si128(sse2_mul32(srcRB, ina), _mm_set1_epi32(rbMask)), 8)), _mm_set1_epi32(rbMask));
-			
-			src = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(src, _mm_or_si128(srcRB, srcG));
-		}
+		__m128i factor;
+		if (rgbmod)
+			factor = _mm_mulhi_epu16(_mm_mullo_epi16(src, _mod), inaOpaque);
+		else
+			factor = _mm_srli_epi16(_mm_mullo_epi16(src, inaOpaque), 8);
 
-		dst = _mm_and_si128(alphaMask, dst);
-		src = _mm_andnot_si128(alphaMask, src);
-		return _mm_or_si128(dst, src);
+		const __m128i res = sse2_select(_alphaMask, dst, _mm_srli_epi16(_mm_mullo_epi16(dst, factor), 8));
+		return sse2_select(_mm_cmpeq_epi16(ina, _mm_setzero_si128()), dst, res);
 	}
+
+private:
+	const __m128i _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
@@ -173,80 +174,57 @@ public:
 template<bool rgbmod, bool alphamod>
 struct AdditiveBlend : public BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod> {
 public:
-	constexpr AdditiveBlend(const uint32 color) : BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod>(color) {}
+	AdditiveBlend(const uint32 color) : BlendBlitImpl_Base::AdditiveBlend<rgbmod, alphamod>(color),
+		_mod(sse2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(sse2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m128i simd(__m128i src, __m128i dst) const {
-		__m128i ina;
-		if (alphamod)
-			ina = _mm_srli_epi32(sse2_mul32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask)), _mm_set1_epi32(this->ca)), 8);
-		else
-			ina = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask));
-		__m128i alphaMask = _mm_cmpeq_epi32(ina, _mm_set1_epi32(0));
-
-		if (rgbmod) {
-			__m128i srcb = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kBModMask));
-			__m128i srcg = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i srcr = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-			__m128i dstb = _mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kBModMask));
-			__m128i dstg = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-			__m128i dstr = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-			srcb = _mm_and_si128(_mm_add_epi32(dstb, _mm_srli_epi32(sse2_mul32(srcb, sse2_mul32(_mm_set1_epi32(this->cb), ina)), 16)), _mm_set1_epi32(BlendBlit::kBModMask));
-			srcg = _mm_and_si128(_mm_add_epi32(dstg, sse2_mul32(srcg, sse2_mul32(_mm_set1_epi32(this->cg), ina))), _mm_set1_epi32(BlendBlit::kGModMask));
-			srcr = _mm_and_si128(_mm_add_epi32(dstr, _mm_srli_epi32(sse2_mul32(srcr, sse2_mul32(_mm_set1_epi32(this->cr), ina)), BlendBlit::kRModShift - 16)), _mm_set1_epi32(BlendBlit::kRModMask));
-
-			src = _mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(src, _mm_or_si128(srcb, _mm_or_si128(srcg, srcr)));
-		} else if (alphamod) {
-			__m128i srcg = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask));
-			__m128i srcrb = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i dstg = _mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask));
-			__m128i dstrb = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-
-			srcg = _mm_and_si128(_mm_add_epi32(dstg, _mm_srli_epi32(sse2_mul32(srcg, ina), 8)), _mm_set1_epi32(BlendBlit::kGModMask));
-			srcrb = _mm_and_si128(_mm_add_epi32(dstrb, sse2_mul32(srcrb, ina)), _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask));
-
-			src = _mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(src, _mm_or_si128(srcrb, srcg));
-		} else {
-			__m128i srcg = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask));
-			__m128i srcrb = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
-			__m128i dstg = _mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask));
-			__m128i dstrb = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask)), BlendBlit::kBModShift);
+		return sse2_blend(*this, src, dst);
+	}
 
-			srcg = _mm_and_si128(_mm_add_epi32(dstg, srcg), _mm_set1_epi32(BlendBlit::kGModMask));
-			srcrb = _mm_and_si128(_mm_slli_epi32(_mm_add_epi32(dstrb, srcrb), 8), _mm_set1_epi32(BlendBlit::kRModMask | BlendBlit::kBModMask));
+	inline __m128i blend16(__m128i src, __m128i dst) const {
+		__m128i ina = sse2_splatAlpha(src);
+		if (alphamod)
+			ina = _mm_srli_epi16(_mm_mullo_epi16(ina, _mm_set1_epi16(this->ca)), 8);
+		const __m128i inaOpaque = sse2_opaqueAlpha(ina);
 
-			src = _mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kAModMask));
-			src = _mm_or_si128(src, _mm_or_si128(srcrb, srcg));
-		}
+		__m128i addend;
+		if (rgbmod)
+			addend = _mm_mulhi_epu16(_mm_mullo_epi16(src, _mod), inaOpaque);
+		else
+			addend = _mm_srli_epi16(_mm_mullo_epi16(src, inaOpaque), 8);
 
-		dst = _mm_and_si128(alphaMask, dst);
-		src = _mm_andnot_si128(alphaMask, src);
-		return _mm_or_si128(dst, src);
+		// Transparent pixels add nothing, packing saturates the sum
+		return sse2_select(_alphaMask, dst, _mm_add_epi16(dst, addend));
 	}
+
+private:
+	const __m128i _mod, _alphaMask;
 };
 
 template<bool rgbmod, bool alphamod>
 struct SubtractiveBlend : public BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod> {
 public:
-	constexpr SubtractiveBlend(const uint32 color) : BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod>(color) {}
+	SubtractiveBlend(const uint32 color) : BlendBlitImpl_Base::SubtractiveBlend<rgbmod, alphamod>(color),
+		_mod(sse2_colorMod(this->ca, this->cr, this->cg, this->cb)), _alphaMask(sse2_channelMask(BlendBlit::kAIndex)) {}
 
 	inline __m128i simd(__m128i src, __m128i dst) const {
-		__m128i ina = _mm_and_si128(src, _mm_set1_epi32(BlendBlit::kAModMask));
-		__m128i srcb = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-		__m128i srcg = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-		__m128i srcr = _mm_srli_epi32(_mm_and_si128(src, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-		__m128i dstb = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kBModMask)), BlendBlit::kBModShift);
-		__m128i dstg = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kGModMask)), BlendBlit::kGModShift);
-		__m128i dstr = _mm_srli_epi32(_mm_and_si128(dst, _mm_set1_epi32(BlendBlit::kRModMask)), BlendBlit::kRModShift);
-
-		srcb = _mm_and_si128(_mm_slli_epi32(_mm_max_epi16(_mm_sub_epi32(dstb, _mm_srli_epi32(sse2_mul32(sse2_mul32(srcb, _mm_set1_epi32(this->cb)), sse2_mul32(dstb, ina)), 24)), _mm_set1_epi32(0)), BlendBlit::kBModShift), _mm_set1_epi32(BlendBlit::kBModMask));
-		srcg = _mm_and_si128(_mm_slli_epi32(_mm_max_epi16(_mm_sub_epi32(dstg, _mm_srli_epi32(sse2_mul32(sse2_mul32(srcg, _mm_set1_epi32(this->cg)), sse2_mul32(dstg, ina)), 24)), _mm_set1_epi32(0)), BlendBlit::kGModShift), _mm_set1_epi32(BlendBlit::kGModMask));
-		srcr = _mm_and_si128(_mm_slli_epi32(_mm_max_epi16(_mm_sub_epi32(dstr, _mm_srli_epi32(sse2_mul32(sse2_mul32(srcr, _mm_set1_epi32(this->cr)), sse2_mul32(dstr, ina)), 24)), _mm_set1_epi32(0)), BlendBlit::kRModShift), _mm_set1_epi32(BlendBlit::kRModMask));
-
-		return _mm_or_si128(_mm_set1_epi32(BlendBlit::kAModMask), _mm_or_si128(srcb, _mm_or_si128(srcg, srcr)));
+		return sse2_blend(*this, src, dst);
+	}
+
+	inline __m128i blend16(__m128i src, __m128i dst) const {
+		const __m128i inaOpaque = sse2_opaqueAlpha(sse2_splatAlpha(src));
+
+		__m128i subtrahend;
+		if (rgbmod)
+			subtrahend = _mm_srli_epi16(_mm_mulhi_epu16(_mm_mullo_epi16(src, _mod), _mm_mullo_epi16(dst, inaOpaque)), 8);
+		else
+			subtrahend = _mm_mulhi_epu16(_mm_mullo_epi16(src, dst), inaOpaque);
+
+		return sse2_select(_alphaMask, _mm_set1_epi16(255), _mm_sub_epi16(dst, subtrahend));
 	}
+
+private:
+	const __m128i _mod, _alphaMask;
 };
 
 public:
@@ -326,6 +304,42 @@ void BlendBlit::blitSSE2(Args &args, const TSpriteBlendMode &blendMode, const Al
 	blitT<BlendBlitImpl_SSE2>(args, blendMode, alphaType);
 }
 
+void AlphaKernels::applyColorKeySSE2(uint32 *dst, const uint32 *src, uint w, const ColorKeyArgs &args) {
+	const __m128i rgbMask = _mm_set1_epi32(args.rgbMask);
+	const __m128i keyPix = _mm_set1_epi32(args.keyPix);
+	const __m128i newPix = _mm_set1_epi32(args.newPix);
+	const __m128i alphaMask = _mm_set1_epi32(args.alphaMask);
+
+	uint x = 0;
+	for (; x + 4 <= w; x += 4) {
+		const __m128i pix = _mm_loadu_si128((const __m128i *)(src + x));
+		const __m128i other = args.overwriteAlpha ? _mm_or_si128(pix, alphaMask) : _mm_loadu_si128((const __m128i *)(dst + x));
+		const __m128i match = _mm_cmpeq_epi32(_mm_and_si128(pix, rgbMask), keyPix);
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_or_si128(_mm_and_si128(match, newPix), _mm_andnot_si128(match, other)));
+	}
+	for (; x < w; ++x)
+		dst[x] = colorKeyPixel(src[x], dst[x], args);
+}
+
+void AlphaKernels::setAlphaSSE2(uint32 *dst, const uint32 *src, uint w, const SetAlphaArgs &args) {
+	const __m128i rgbMask = _mm_set1_epi32(args.rgbMask);
+	const __m128i newAlpha = _mm_set1_epi32(args.newAlpha);
+	const __m128i alphaMask = _mm_set1_epi32(args.alphaMask);
+
+	uint x = 0;
+	for (; x + 4 <= w; x += 4) {
+		const __m128i pix = _mm_loadu_si128((const __m128i *)(src + x));
+		__m128i res = _mm_or_si128(_mm_and_si128(pix, rgbMask), newAlpha);
+		if (args.skipTransparent) {
+			const __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(pix, alphaMask), _mm_setzero_si128());
+			res = _mm_or_si128(_mm_and_si128(transparent, pix), _mm_andnot_si128(transparent, res));
+		}
+		_mm_storeu_si128((__m128i *)(dst + x), res);
+	}
+	for (; x < w; ++x)
+		dst[x] = setAlphaPixel(src[x], args);
+}
+
 } // End of namespace Graphics
 
 #if !defined(__x86_64__)
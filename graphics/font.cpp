@@ -23,10 +23,97 @@
 #include "graphics/managed_surface.h"
 
 #include "common/array.h"
+#include "common/hashmap.h"
+#include "common/hash-str.h"
 #include "common/util.h"
 
 namespace Graphics {
 
+namespace {
+
+template<class StringType>
+struct WrapKey {
+	StringType str;
+	int maxWidth;
+	int initWidth;
+	uint32 mode;
+
+	bool operator==(const WrapKey &key) const {
+		return maxWidth == key.maxWidth && initWidth == key.initWidth && mode == key.mode && str == key.str;
+	}
+};
+
+template<class StringType>
+struct WrapKeyHash {
+	uint operator()(const WrapKey<StringType> &key) const {
+		return Common::Hash<StringType>()(key.str) ^ (key.maxWidth * 31 + key.initWidth) ^ (key.mode << 24);
+	}
+};
+
+template<class StringType>
+struct WrappedText {
+	Common::Array<StringType> lines;
+	Common::Array<bool> lineContinuation;
+	int maxLineWidth;
+};
+
+template<class StringType>
+struct StringLayoutCache {
+	// Everything is dropped once this many strings are cached. The text
+	// which is on screen gets measured again on the next frame anyway.
+	static const uint kMaxEntries = 512;
+
+	typedef Common::HashMap<StringType, int> WidthMap;
+	typedef Common::HashMap<WrapKey<StringType>, WrappedText<StringType>, WrapKeyHash<StringType> > WrapMap;
+
+	WidthMap widths;
+	WrapMap wrapped;
+
+	void clear() {
+		widths.clear();
+		wrapped.clear();
+	}
+};
+
+} // End of anonymous namespace
+
+struct Font::LayoutCache {
+	StringLayoutCache<Common::String> strings;
+	StringLayoutCache<Common::U32String> u32Strings;
+};
+
+Font::Font(const Font &font) : _layoutCache(nullptr) {
+	if (font._layoutCache)
+		enableLayoutCache();
+}
+
+Font::~Font() {
+	delete _layoutCache;
+}
+
+Font &Font::operator=(const Font &font) {
+	if (this != &font) {
+		delete _layoutCache;
+		_layoutCache = nullptr;
+
+		if (font._layoutCache)
+			enableLayoutCache();
+	}
+	return *this;
+}
+
+void Font::enableLayoutCache() {
+	if (!_layoutCache)
+		_layoutCache = new LayoutCache();
+}
+
+void Font::clearLayoutCache() const {
+	if (_layoutCache) {
+		_layoutCache->strings.clear();
+		_layoutCache->u32Strings.clear();
+	}
+}
+
 int Font::getFontAscent() const {
 	return -1;
 }
@@ -301,7 +388,8 @@ int wordWrapTextImpl(const Font &font, const StringType &str, int maxWidth, Comm
 						tmpStr.deleteChar(0);
 						// This is not very fast, but it is the simplest way to
 						// assure we do not mess something up because of kerning.
-						tmpWidth = font.getStringWidth(tmpStr);
+						// The fragments are not worth keeping in the layout cache.
+						tmpWidth = getStringWidthImpl(font, tmpStr);
 					}
 
 					if (tmpStr.empty()) {
@@ -333,6 +421,55 @@ int wordWrapTextImpl(const Font &font, const StringType &str, int maxWidth, Comm
 	return wrapper.actualMaxLineWidth;
 }
 
+template<class StringType>
+int getCachedStringWidth(const Font &font, StringLayoutCache<StringType> *cache, const StringType &str) {
+	if (!cache)
+		return getStringWidthImpl(font, str);
+
+	typename StringLayoutCache<StringType>::WidthMap::const_iterator i = cache->widths.find(str);
+	if (i != cache->widths.end())
+		return i->_value;
+
+	if (cache->widths.size() >= StringLayoutCache<StringType>::kMaxEntries)
+		cache->widths.clear();
+
+	const int width = getStringWidthImpl(font, str);
+	cache->widths[str] = width;
+	return width;
+}
+
+template<class StringType>
+int getCachedWordWrap(const Font &font, StringLayoutCache<StringType> *cache, const StringType &str, int maxWidth, Common::Array<StringType> &lines, Common::Array<bool> &lineContinuation, int initWidth, uint32 mode) {
+	// A cached result replaces the output, so it can only be used when
+	// there is nothing to append the new lines to
+	if (!cache || !lines.empty() || !lineContinuation.empty())
+		return wordWrapTextImpl(font, str, maxWidth, lines, lineContinuation, initWidth, mode);
+
+	WrapKey<StringType> key;
+	key.str = str;
+	key.maxWidth = maxWidth;
+	key.initWidth = initWidth;
+	key.mode = mode;
+
+	typename StringLayoutCache<StringType>::WrapMap::const_iterator i = cache->wrapped.find(key);
+	if (i != cache->wrapped.end()) {
+		lines = i->_value.lines;
+		lineContinuation = i->_value.lineContinuation;
+		return i->_value.maxLineWidth;
+	}
+
+	const int maxLineWidth = wordWrapTextImpl(font, str, maxWidth, lines, lineContinuation, initWidth, mode);
+
+	if (cache->wrapped.size() >= StringLayoutCache<StringType>::kMaxEntries)
+		cache->wrapped.clear();
+
+	WrappedText<StringType> &text = cache->wrapped[key];
+	text.lines = lines;
+	text.lineContinuation = lineContinuation;
+	text.maxLineWidth = maxLineWidth;
+	return maxLineWidth;
+}
+
 template<typename StringType>
 StringType handleEllipsis(const Font &font, const StringType &input, int w) {
 	StringType s = input;
@@ -454,11 +591,11 @@ Common::Rect Font::getBoundingBox(const Common::U32String &input, int x, int y,
 }
 
 int Font::getStringWidth(const Common::String &str) const {
-	return getStringWidthImpl(*this, str);
+	return getCachedStringWidth(*this, _layoutCache ? &_layoutCache->strings : nullptr, str);
 }
 
 int Font::getStringWidth(const Common::U32String &str) const {
-	return getStringWidthImpl(*this, str);
+	return getCachedStringWidth(*this, _layoutCache ? &_layoutCache->u32Strings : nullptr, str);
 }
 
 void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const {
@@ -499,16 +636,16 @@ void Font::drawString(ManagedSurface *dst, const Common::U32String &str, int x,
 
 int Font::wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines, int initWidth, uint32 mode) const {
 	Common::Array<bool> dummyLineContinuation;
-	return wordWrapTextImpl(*this, str, maxWidth, lines, dummyLineContinuation, initWidth, mode);
+	return getCachedWordWrap(*this, _layoutCache ? &_layoutCache->strings : nullptr, str, maxWidth, lines, dummyLineContinuation, initWidth, mode);
 }
 
 int Font::wordWrapText(const Common::U32String &str, int maxWidth, Common::Array<Common::U32String> &lines, int initWidth, uint32 mode) const {
 	Common::Array<bool> dummyLineContinuation;
-	return wordWrapTextImpl(*this, str, maxWidth, lines, dummyLineContinuation, initWidth, mode);
+	return getCachedWordWrap(*this, _layoutCache ? &_layoutCache->u32Strings : nullptr, str, maxWidth, lines, dummyLineContinuation, initWidth, mode);
 }
 
 int Font::wordWrapText(const Common::U32String &str, int maxWidth, Common::Array<Common::U32String> &lines, Common::Array<bool> &lineContinuation, int initWidth, uint32 mode) const {
-	return wordWrapTextImpl(*this, str, maxWidth, lines, lineContinuation, initWidth, mode);
+	return getCachedWordWrap(*this, _layoutCache ? &_layoutCache->u32Strings : nullptr, str, maxWidth, lines, lineContinuation, initWidth, mode);
 }
 
 TextAlign convertTextAlignH(TextAlign alignH, bool rtl) {
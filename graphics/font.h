@@ -82,8 +82,11 @@ TextAlign convertTextAlignH(TextAlign alignH, bool rtl);
  */
 class Font {
 public:
-	Font() {}
-	virtual ~Font() {}
+	Font() : _layoutCache(nullptr) {}
+	Font(const Font &font);
+	virtual ~Font();
+
+	Font &operator=(const Font &font);
 
 	/**
 	 * Return the height of the font.
@@ -300,6 +303,22 @@ public:
 	 */
 	void scaleSingleGlyph(Surface *scaleSurface, int *grayScaleMap, int grayScaleMapSize, int width, int height, int xOffset, int yOffset, int grayLevel, int chr, int srcheight, int srcwidth, float scale) const;
 
+protected:
+	/**
+	 * Remember the results of getStringWidth() and wordWrapText(), so that
+	 * text which is laid out every frame only gets measured once.
+	 *
+	 * Only fonts whose character widths and kerning never change after
+	 * loading should enable this, or call clearLayoutCache() when they do.
+	 */
+	void enableLayoutCache();
+
+	/** Forget all cached string widths and wrapped lines. */
+	void clearLayoutCache() const;
+
+private:
+	struct LayoutCache;
+	mutable LayoutCache *_layoutCache;
 };
 /** @} */
 } // End of namespace Graphics
@@ -192,17 +192,29 @@ private:
 	int _ascent, _descent;
 
 	struct Glyph {
-		Surface image;
+		int atlasX, atlasY;
+		int width, height;
 		int xOffset, yOffset;
 		int advance;
 		FT_UInt slot;
 	};
 
 	bool cacheGlyph(Glyph &glyph, uint32 chr) const;
-	typedef Common::HashMap<uint32, Glyph> GlyphCache;
-	mutable GlyphCache _glyphs;
+	void addGlyph(uint32 chr, const Glyph &glyph) const;
+	const Glyph *findGlyph(uint32 chr) const;
+
+	// Indices into _glyphs, or -1 when the font has no glyph for the
+	// character. Latin-1 gets a table since it is looked up all the time.
+	typedef Common::HashMap<uint32, int> GlyphMap;
+	mutable Common::Array<Glyph> _glyphs;
+	mutable int _latin1Glyphs[256];
+	mutable GlyphMap _otherGlyphs;
 	bool _allowLateCaching;
-	void assureCached(uint32 chr) const;
+
+	// The bitmaps of all glyphs, packed in rows from top to bottom
+	mutable Surface _atlas;
+	mutable int _shelfX, _shelfY, _shelfHeight;
+	bool allocateGlyphSpace(int w, int h, Glyph &glyph) const;
 
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
@@ -224,7 +236,9 @@ TTFFont::TTFFont()
 	: _initialized(false), _stream(), _face(), _ttfFile(0), _width(0), _height(0), _ascent(0),
 	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
 	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false),
-	  _disposeAfterUse(DisposeAfterUse::NO) {
+	  _disposeAfterUse(DisposeAfterUse::NO), _shelfX(0), _shelfY(0), _shelfHeight(0) {
+	for (uint i = 0; i < ARRAYSIZE(_latin1Glyphs); ++i)
+		_latin1Glyphs[i] = -1;
 }
 
 TTFFont::~TTFFont() {
@@ -235,11 +249,10 @@ TTFFont::~TTFFont() {
 			delete _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	_atlas.free();
 }
 
 
@@ -360,14 +373,18 @@ bool TTFFont::load(Common::SeekableReadStream *ttfFile, DisposeAfterUse::Flag di
 		_loadFlags |= FT_LOAD_NO_BITMAP;
 	}
 
+	// Room for the Latin-1 glyphs, the atlas grows when more are needed
+	_atlas.create(CLIP(_width * 16, 256, 2048), MAX(_height, 1) * 8, PixelFormat::createFormatCLUT8());
+
 	if (!mapping) {
 		// Allow loading of all unicode characters.
 		_allowLateCaching = true;
 
 		// Load all ISO-8859-1 characters.
 		for (uint i = 0; i < 256; ++i) {
-			if (!cacheGlyph(_glyphs[i], i)) {
-				_glyphs.erase(i);
+			Glyph glyph;
+			if (cacheGlyph(glyph, i)) {
+				addGlyph(i, glyph);
 			}
 		}
 	} else {
@@ -379,16 +396,16 @@ bool TTFFont::load(Common::SeekableReadStream *ttfFile, DisposeAfterUse::Flag di
 			const bool isRequired = (mapping[i] & 0x80000000) != 0;
 			// Check whether loading an important glyph fails and error out if
 			// that is the case.
-			if (!cacheGlyph(_glyphs[i], unicode)) {
-				_glyphs.erase(i);
-				if (isRequired) {
-					g_ttf.closeFont(_face);
+			Glyph glyph;
+			if (cacheGlyph(glyph, unicode)) {
+				addGlyph(i, glyph);
+			} else if (isRequired) {
+				g_ttf.closeFont(_face);
 
-					// Don't delete ttfFile as we return fail
-					_ttfFile = 0;
+				// Don't delete ttfFile as we return fail
+				_ttfFile = 0;
 
-					return false;
-				}
+				return false;
 			}
 		}
 	}
@@ -402,6 +419,8 @@ bool TTFFont::load(Common::SeekableReadStream *ttfFile, DisposeAfterUse::Flag di
 		return false;
 	} else {
 		_initialized = true;
+		// The metrics of a loaded font never change
+		enableLayoutCache();
 		// At this point we get ownership of _ttfFile
 		return true;
 	}
@@ -546,34 +565,30 @@ int TTFFont::getMaxCharWidth() const {
 }
 
 int TTFFont::getCharWidth(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph)
 		return 0;
 	else
-		return glyphEntry->_value.advance;
+		return glyph->advance;
 }
 
 int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 	if (!_hasKerning)
 		return 0;
 
-	assureCached(left);
-	assureCached(right);
-
 	FT_UInt leftGlyph, rightGlyph;
-	GlyphCache::const_iterator glyphEntry;
+	const Glyph *glyph;
 
-	glyphEntry = _glyphs.find(left);
-	if (glyphEntry != _glyphs.end()) {
-		leftGlyph = glyphEntry->_value.slot;
+	glyph = findGlyph(left);
+	if (glyph) {
+		leftGlyph = glyph->slot;
 	} else {
 		return 0;
 	}
 
-	glyphEntry = _glyphs.find(right);
-	if (glyphEntry != _glyphs.end()) {
-		rightGlyph = glyphEntry->_value.slot;
+	glyph = findGlyph(right);
+	if (glyph) {
+		rightGlyph = glyph->slot;
 	} else {
 		return 0;
 	}
@@ -587,15 +602,13 @@ int TTFFont::getKerningOffset(uint32 left, uint32 right) const {
 }
 
 Common::Rect TTFFont::getBoundingBox(uint32 chr) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end()) {
+	const Glyph *glyph = findGlyph(chr);
+	if (!glyph) {
 		return Common::Rect();
 	} else {
-		const int xOffset = glyphEntry->_value.xOffset;
-		const int yOffset = glyphEntry->_value.yOffset;
-		const Graphics::Surface &image = glyphEntry->_value.image;
-		return Common::Rect(xOffset, yOffset, xOffset + image.w, yOffset + image.h);
+		const int xOffset = glyph->xOffset;
+		const int yOffset = glyph->yOffset;
+		return Common::Rect(xOffset, yOffset, xOffset + glyph->width, yOffset + glyph->height);
 	}
 }
 
@@ -667,12 +680,11 @@ void TTFFont::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 col
 
 void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		const uint32 *transparentColor) const {
-	assureCached(chr);
-	GlyphCache::const_iterator glyphEntry = _glyphs.find(chr);
-	if (glyphEntry == _glyphs.end())
+	const Glyph *glyphEntry = findGlyph(chr);
+	if (!glyphEntry)
 		return;
 
-	const Glyph &glyph = glyphEntry->_value;
+	const Glyph &glyph = *glyphEntry;
 
 	x += glyph.xOffset;
 	y += glyph.yOffset;
@@ -682,10 +694,10 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 	if (y > dst->h)
 		return;
 
-	int w = glyph.image.w;
-	int h = glyph.image.h;
+	int w = glyph.width;
+	int h = glyph.height;
 
-	const uint8 *srcPos = (const uint8 *)glyph.image.getPixels();
+	const uint8 *srcPos = (const uint8 *)_atlas.getBasePtr(glyph.atlasX, glyph.atlasY);
 
 	// Make sure we are not drawing outside the screen bounds
 	if (x < 0) {
@@ -701,7 +713,7 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 		return;
 
 	if (y < 0) {
-		srcPos -= y * glyph.image.pitch;
+		srcPos -= y * _atlas.pitch;
 		h += y;
 		y = 0;
 	}
@@ -730,14 +742,14 @@ void TTFFont::drawChar(Surface * dst, uint32 chr, int x, int y, uint32 color,
 			}
 
 			dstPos += dst->pitch;
-			srcPos += glyph.image.pitch;
+			srcPos += _atlas.pitch;
 		}
 	} else if (dst->format.bytesPerPixel == 1) {
-		renderGlyph<uint8>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint8>(dstPos, dst->pitch, srcPos, _atlas.pitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 2) {
-		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint16>(dstPos, dst->pitch, srcPos, _atlas.pitch, w, h, color, dst->format, transparentColor);
 	} else if (dst->format.bytesPerPixel == 4) {
-		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, glyph.image.pitch, w, h, color, dst->format, transparentColor);
+		renderGlyph<uint32>(dstPos, dst->pitch, srcPos, _atlas.pitch, w, h, color, dst->format, transparentColor);
 	}
 }
 
@@ -805,8 +817,14 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		bitmap = &_face->glyph->bitmap;
 	}
 
-
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
+	if (!allocateGlyphSpace(bitmap->width, bitmap->rows, glyph)) {
+#if FAKE_BOLD == 1
+		if (_fakeBold) {
+			FT_Bitmap_Done(_face->glyph->library, &ownBitmap);
+		}
+#endif
+		return false;
+	}
 
 	const uint8 *src = bitmap->buffer;
 	int srcPitch = bitmap->pitch;
@@ -815,12 +833,13 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		srcPitch = -srcPitch;
 	}
 
-	uint8 *dst = (uint8 *)glyph.image.getPixels();
+	uint8 *dst = (uint8 *)_atlas.getBasePtr(glyph.atlasX, glyph.atlasY);
 
 	switch (bitmap->pixel_mode) {
 	case FT_PIXEL_MODE_MONO:
 		for (int y = 0; y < (int)bitmap->rows; ++y) {
 			const uint8 *curSrc = src;
+			uint8 *curDst = dst;
 			uint8 mask = 0;
 
 			for (int x = 0; x < (int)bitmap->width; ++x) {
@@ -828,12 +847,13 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					*curDst = 255;
 
 				mask <<= 1;
-				++dst;
+				++curDst;
 			}
 
+			dst += _atlas.pitch;
 			src += srcPitch;
 		}
 		break;
@@ -841,14 +861,19 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	case FT_PIXEL_MODE_GRAY:
 		for (int y = 0; y < (int)bitmap->rows; ++y) {
 			memcpy(dst, src, bitmap->width);
-			dst += glyph.image.pitch;
+			dst += _atlas.pitch;
 			src += srcPitch;
 		}
 		break;
 
 	default:
+		// The space in the atlas stays blank, this is rare enough
 		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
+#if FAKE_BOLD == 1
+		if (_fakeBold) {
+			FT_Bitmap_Done(_face->glyph->library, &ownBitmap);
+		}
+#endif
 		return false;
 	}
 
@@ -861,15 +886,84 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	return true;
 }
 
-void TTFFont::assureCached(uint32 chr) const {
-	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
-		return;
+bool TTFFont::allocateGlyphSpace(int w, int h, Glyph &glyph) const {
+	glyph.width = w;
+	glyph.height = h;
+
+	if (!w || !h) {
+		glyph.atlasX = glyph.atlasY = 0;
+		return true;
+	}
+
+	// Start a new row below the tallest glyph of the current one
+	if (_shelfX + w > _atlas.w) {
+		_shelfX = 0;
+		_shelfY += _shelfHeight;
+		_shelfHeight = 0;
 	}
 
-	Glyph newGlyph;
-	if (cacheGlyph(newGlyph, chr)) {
-		_glyphs[chr] = newGlyph;
+	if (w > _atlas.w || _shelfY + h > _atlas.h) {
+		const int atlasW = MAX<int>(_atlas.w, w);
+		int atlasH = MAX<int>(_atlas.h, 16);
+		while (_shelfY + h > atlasH)
+			atlasH *= 2;
+		atlasH = MIN<int>(atlasH, 0x7FFF);
+
+		if (_shelfY + h > atlasH) {
+			warning("TTFFont::allocateGlyphSpace: Glyph atlas is full");
+			return false;
+		}
+
+		Surface atlas;
+		atlas.create(atlasW, atlasH, PixelFormat::createFormatCLUT8());
+		if (_atlas.getPixels())
+			atlas.copyRectToSurface(_atlas, 0, 0, Common::Rect(_atlas.w, _atlas.h));
+		_atlas.free();
+		_atlas = atlas;
+	}
+
+	glyph.atlasX = _shelfX;
+	glyph.atlasY = _shelfY;
+
+	_shelfX += w;
+	_shelfHeight = MAX(_shelfHeight, h);
+	return true;
+}
+
+void TTFFont::addGlyph(uint32 chr, const Glyph &glyph) const {
+	_glyphs.push_back(glyph);
+
+	if (chr < ARRAYSIZE(_latin1Glyphs))
+		_latin1Glyphs[chr] = _glyphs.size() - 1;
+	else
+		_otherGlyphs[chr] = _glyphs.size() - 1;
+}
+
+const TTFFont::Glyph *TTFFont::findGlyph(uint32 chr) const {
+	int index;
+	if (chr < ARRAYSIZE(_latin1Glyphs)) {
+		// These were all tried when loading the font
+		index = _latin1Glyphs[chr];
+	} else {
+		GlyphMap::const_iterator glyphEntry = _otherGlyphs.find(chr);
+		if (glyphEntry != _otherGlyphs.end()) {
+			index = glyphEntry->_value;
+		} else if (!_allowLateCaching) {
+			return nullptr;
+		} else {
+			Glyph glyph;
+			if (cacheGlyph(glyph, chr)) {
+				addGlyph(chr, glyph);
+				index = _glyphs.size() - 1;
+			} else {
+				// Remember missing glyphs too, so FreeType is asked only once
+				index = -1;
+				_otherGlyphs[chr] = index;
+			}
+		}
 	}
+
+	return index < 0 ? nullptr : &_glyphs[index];
 }
 
 Font *loadTTFFont(Common::SeekableReadStream *stream, DisposeAfterUse::Flag disposeAfterUse, int size, TTFSizeMode sizeMode, uint xdpi, uint ydpi, TTFRenderMode renderMode, const uint32 *mapping, bool stemDarkening) {
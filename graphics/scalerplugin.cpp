@@ -20,6 +20,9 @@
 
 #include "graphics/scalerplugin.h"
 
+#include "common/system.h"
+#include "common/threadpool.h"
+
 namespace {
 /**
  * Trivial 'scaler' - in fact it doesn't do any scaling but just copies the
@@ -42,6 +45,43 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 }
 } // End of anonymous namespace
 
+/**
+ * Bands shorter than this are not worth handing to another thread, and
+ * neither are rects with fewer source pixels per band than kMinBandPixels.
+ * More than kMaxBands bands would mostly be waiting on memory.
+ */
+enum {
+	kMinBandHeight = 8,
+	kMinBandPixels = 8192,
+	kMaxBands = 4
+};
+
+struct Scaler::BandJob {
+	Scaler *scaler;
+	const uint8 *srcPtr;
+	uint32 srcPitch;
+	uint8 *dstPtr;
+	uint32 dstPitch;
+	int width, height, x, y;
+	uint numBands;
+};
+
+void Scaler::scaleBands(void *data, uint begin, uint end) {
+	const BandJob &job = *(const BandJob *)data;
+
+	// Spread the rows evenly, the first bands take the remainder
+	const int rows = job.height / job.numBands;
+	const int extra = job.height % job.numBands;
+	for (uint index = begin; index < end; ++index) {
+		const int top = index * rows + MIN<int>(index, extra);
+		const int height = rows + (index < (uint)extra ? 1 : 0);
+
+		job.scaler->scaleIntern(job.srcPtr + top * job.srcPitch, job.srcPitch,
+		                        job.dstPtr + top * job.scaler->_factor * job.dstPitch, job.dstPitch,
+		                        job.width, height, job.x, job.y + top);
+	}
+}
+
 void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                           uint32 dstPitch, int width, int height, int x, int y) {
 	if (_factor == 1) {
@@ -52,9 +92,33 @@ void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 		} else {
 			Normal1x<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
 		}
+		return;
+	}
+
+	// Without worker threads the concurrency is 1, and the rect is scaled
+	// as a whole
+	uint numBands = MIN<uint>(g_system->getThreadPool()->getConcurrency(), kMaxBands);
+	numBands = MIN<uint>(numBands, height / kMinBandHeight);
+	numBands = MIN<uint>(numBands, (uint)(width * height) / kMinBandPixels);
+
+	if (numBands > 1) {
+		BandJob job;
+		job.scaler = this;
+		job.srcPtr = srcPtr;
+		job.srcPitch = srcPitch;
+		job.dstPtr = dstPtr;
+		job.dstPitch = dstPitch;
+		job.width = width;
+		job.height = height;
+		job.x = x;
+		job.y = y;
+		job.numBands = numBands;
+		Common::parallelFor(0, numBands, 1, scaleBands, &job);
 	} else {
 		scaleIntern(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
 	}
+
+	finishScale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
 }
 
 SourceScaler::SourceScaler(const Graphics::PixelFormat &format) : Scaler(format), _width(0), _height(0), _oldSrc(NULL), _enable(false) {
@@ -111,6 +175,14 @@ void SourceScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstP
 	            _oldSrc + offset, srcPitch,
 	            width, height,
 	            (uint8 *)_bufferedOutput.getBasePtr(x * _factor, y * _factor), _bufferedOutput.pitch);
+}
+
+void SourceScaler::finishScale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+						 uint32 dstPitch, int width, int height, int x, int y) {
+	// The old source is only updated once all bands are done, as the bands
+	// read the old source rows of their neighbours
+	if (!_enable)
+		return;
 
 	// Update the destination buffer
 	byte *buffer = (byte *)_bufferedOutput.getBasePtr(x * _factor, y * _factor);
@@ -121,6 +193,7 @@ void SourceScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstP
 	}
 
 	// Update old src
+	int offset = (_padding + x) * _format.bytesPerPixel + (_padding + y) * srcPitch;
 	byte *oldSrc = _oldSrc + offset;
 	while (height--) {
 		memcpy(oldSrc, srcPtr, width * _format.bytesPerPixel);
@@ -128,4 +201,3 @@ void SourceScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstP
 		srcPtr += srcPitch;
 	}
 }
-
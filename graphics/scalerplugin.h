@@ -97,12 +97,30 @@ public:
 protected:
 	/**
 	 * @see scale
+	 *
+	 * Large rects are split into horizontal bands which are passed to this
+	 * function concurrently, on the threads of g_system->getThreadPool(). It must thus only write to
+	 * the destination rows of its band, and not modify any scaler state.
+	 * It may read source pixels outside of the band, as long as they are
+	 * within ScalerPluginObject::extraPixels.
 	 */
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) = 0;
 
+	/**
+	 * Called once all bands of a rect were scaled, with the same arguments
+	 * as passed to scale. Scalers which keep state between frames can update
+	 * it here.
+	 */
+	virtual void finishScale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+	                         uint32 dstPitch, int width, int height, int x, int y) {}
+
 	uint _factor;
 	Graphics::PixelFormat _format;
+
+private:
+	struct BandJob;
+	static void scaleBands(void *data, uint begin, uint end);
 };
 
 /**
@@ -127,6 +145,9 @@ protected:
 	virtual void scaleIntern(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                         uint32 dstPitch, int width, int height, int x, int y) final;
 
+	virtual void finishScale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+	                         uint32 dstPitch, int width, int height, int x, int y) final;
+
 	/**
 	 * Scalers must implement this function. It will be called by oldSrcScale.
 	 * If by comparing the src and oldsrc images it is discovered that no change
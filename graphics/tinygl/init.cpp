@@ -370,6 +370,7 @@ void GLContext::deinit() {
 		gl_free(matrix_stack[i]);
 	free_texture(default_texture);
 	endSharedState();
+	disposeTileContexts();
 	gl_free(vertex);
 	delete fb;
 }
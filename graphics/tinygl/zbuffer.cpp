@@ -53,12 +53,26 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_offscreenBuffer.pbuf = _pbuf;
 	_offscreenBuffer.zbuf = _zbuf;
 
+	_ownsBuffers = true;
+
+	_currentTexture = nullptr;
+
+	_enableScissor = false;
+}
+
+FrameBuffer::FrameBuffer(const FrameBuffer *parent) {
+	*this = *parent;
+	_ownsBuffers = false;
+
 	_currentTexture = nullptr;
 
 	_enableScissor = false;
 }
 
 FrameBuffer::~FrameBuffer() {
+	if (!_ownsBuffers)
+		return;
+
 	gl_free(_pbuf);
 	gl_free(_zbuf);
 	if (_sbuf)
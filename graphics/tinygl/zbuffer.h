@@ -105,6 +105,12 @@ struct ZBufferPoint {
 
 struct FrameBuffer {
 	FrameBuffer(int width, int height, const Graphics::PixelFormat &format, bool enableStencilBuffer);
+	/**
+	 * Create a view on the buffers of @p parent with its own rasterization
+	 * state, so that disjoint parts of the buffers can be drawn by several
+	 * threads at once. The buffers stay owned by @p parent.
+	 */
+	explicit FrameBuffer(const FrameBuffer *parent);
 	~FrameBuffer();
 
 	Graphics::PixelFormat getPixelFormat() {
@@ -764,6 +770,7 @@ private:
 
 	uint *_zbuf;
 	byte *_sbuf;
+	bool _ownsBuffers;
 
 	bool _enableStencil;
 	int _textureSize;
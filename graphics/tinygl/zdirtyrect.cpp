@@ -24,6 +24,8 @@
 #include "graphics/tinygl/gl.h"
 
 #include "common/debug.h"
+#include "common/system.h"
+#include "common/threadpool.h"
 
 namespace TinyGL {
 
@@ -105,6 +107,132 @@ void GLContext::disposeDrawCallLists() {
 	_drawCallsQueue.clear();
 }
 
+// Every thread gets a few bands, so that it can take over some of the work
+// when the detailed parts of the scene are concentrated in one of them.
+static const uint kTilesPerThread = 2;
+static const int kMinTileHeight = 16;
+
+struct TiledDrawCalls {
+	const Common::Array<GLContext *> *contexts;
+	const Common::Array<Common::Array<Common::Rect> > *clipRectangles;
+	Common::List<DrawCall *>::const_iterator begin, end;
+};
+
+static void executeTiles(void *data, uint begin, uint end) {
+	const TiledDrawCalls &drawCalls = *(const TiledDrawCalls *)data;
+
+	for (uint i = begin; i < end; i++) {
+		GLContext *c = (*drawCalls.contexts)[i];
+		const Common::Array<Common::Rect> &clipRectangles = (*drawCalls.clipRectangles)[i];
+
+		for (Common::List<DrawCall *>::const_iterator it = drawCalls.begin; it != drawCalls.end; ++it) {
+			const DrawCall *drawCall = *it;
+			for (const auto &rect : clipRectangles) {
+				if (c->_enableDirtyRectangles && !rect.intersects(drawCall->getDirtyRegion()))
+					continue;
+
+				if (drawCall->getType() == DrawCall::DrawCall_Clear) {
+					((const ClearBufferDrawCall *)drawCall)->executeOnTile(c, rect);
+				} else {
+					((const RasterizationDrawCall *)drawCall)->executeOnTile(c, rect);
+				}
+			}
+		}
+	}
+}
+
+static bool canExecuteOnTiles(const DrawCall &drawCall) {
+	switch (drawCall.getType()) {
+	case DrawCall::DrawCall_Clear:
+		return true;
+	case DrawCall::DrawCall_Rasterization:
+		return !((const RasterizationDrawCall &)drawCall).isSelection();
+	default:
+		// Blits work on the global blitting state
+		return false;
+	}
+}
+
+bool GLContext::canExecuteDrawCallsTiled() const {
+	return render_mode == TGL_RENDER && g_system->getThreadPool()->getWorkerCount() > 0;
+}
+
+void GLContext::executeDrawCallsTiled(const Common::List<Common::Rect> &regions) {
+	// The frame buffer is split up into horizontal bands, as the rasterizer
+	// walks the triangles line by line and can skip the lines outside of the
+	// band cheaply. The bands are disjoint, so every tile context can use its
+	// part of the shared z-buffer and stencil buffer on its own.
+	const int width = fb->getPixelBufferWidth();
+	const int height = fb->getPixelBufferHeight();
+	const uint tileCount = CLIP<uint>(height / kMinTileHeight, 1, g_system->getThreadPool()->getConcurrency() * kTilesPerThread);
+
+	if (_tileContexts.size() != tileCount) {
+		disposeTileContexts();
+		for (uint i = 0; i < tileCount; i++) {
+			GLContext *c = new GLContext();
+			c->fb = new FrameBuffer(fb);
+			c->_textureSize = _textureSize;
+			c->vertex_max = POLYGON_MAX_VERTEX;
+			c->vertex = (GLVertex *)gl_malloc(POLYGON_MAX_VERTEX * sizeof(GLVertex));
+			_tileContexts.push_back(c);
+		}
+	}
+
+	Common::Array<Common::Array<Common::Rect> > clipRectangles;
+	clipRectangles.resize(tileCount);
+	for (uint i = 0; i < tileCount; i++) {
+		const Common::Rect band(0, height * i / tileCount, width, height * (i + 1) / tileCount);
+		for (const auto &region : regions) {
+			Common::Rect rect = band.findIntersectingRect(region);
+			if (!rect.isEmpty())
+				clipRectangles[i].push_back(rect);
+		}
+
+		// The state which is not part of the draw calls
+		GLContext *c = _tileContexts[i];
+		c->render_mode = render_mode;
+		c->current_cull_face = current_cull_face;
+		c->vertex_n = vertex_n;
+		c->_enableDirtyRectangles = _enableDirtyRectangles;
+	}
+
+	TiledDrawCalls drawCalls;
+	drawCalls.contexts = &_tileContexts;
+	drawCalls.clipRectangles = &clipRectangles;
+	drawCalls.begin = _drawCallsQueue.begin();
+
+	for (Common::List<DrawCall *>::const_iterator it = _drawCallsQueue.begin(); ; ++it) {
+		const bool last = it == _drawCallsQueue.end();
+		if (!last && canExecuteOnTiles(**it))
+			continue;
+
+		if (drawCalls.begin != it) {
+			drawCalls.end = it;
+			Common::parallelFor(0, tileCount, 1, executeTiles, &drawCalls);
+		}
+		if (last)
+			break;
+
+		// Everything else runs on this thread, after the draw calls before it
+		// are done and before the ones after it are started
+		for (const auto &region : regions) {
+			if (!_enableDirtyRectangles || region.intersects((*it)->getDirtyRegion()))
+				(*it)->execute(region, true);
+		}
+		drawCalls.begin = it;
+		++drawCalls.begin;
+	}
+}
+
+void GLContext::disposeTileContexts() {
+	for (auto &c : _tileContexts) {
+		gl_free(c->vertex);
+		delete c->fb;
+		delete c;
+	}
+	_tileContexts.clear();
+}
+
 static inline void _appendDirtyRectangle(const DrawCall &call, Common::List<DirtyRectangle> &rectangles, int r, int g, int b) {
 	Common::Rect dirty_region = call.getDirtyRegion();
 	if (rectangles.empty() || dirty_region != rectangles.back().rectangle)
@@ -191,12 +319,20 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 		}
 
 		// Execute draw calls.
-		for (auto &drawCall : _drawCallsQueue) {
-			Common::Rect drawCallRegion = drawCall->getDirtyRegion();
+		if (canExecuteDrawCallsTiled()) {
+			Common::List<Common::Rect> regions;
 			for (auto &rect : rectangles) {
-				Common::Rect dirtyRegion = rect.rectangle;
-				if (dirtyRegion.intersects(drawCallRegion)) {
-					drawCall->execute(dirtyRegion, true);
+				regions.push_back(rect.rectangle);
+			}
+			executeDrawCallsTiled(regions);
+		} else {
+			for (auto &drawCall : _drawCallsQueue) {
+				Common::Rect drawCallRegion = drawCall->getDirtyRegion();
+				for (auto &rect : rectangles) {
+					Common::Rect dirtyRegion = rect.rectangle;
+					if (dirtyRegion.intersects(drawCallRegion)) {
+						drawCall->execute(dirtyRegion, true);
+					}
 				}
 			}
 		}
@@ -234,10 +370,20 @@ void GLContext::presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas)
 }
 
 void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
-	dirtyAreas.push_back(Common::Rect(fb->getPixelBufferWidth(), fb->getPixelBufferHeight()));
+	const Common::Rect screen(fb->getPixelBufferWidth(), fb->getPixelBufferHeight());
+	dirtyAreas.push_back(screen);
+
+	if (canExecuteDrawCallsTiled()) {
+		Common::List<Common::Rect> regions;
+		regions.push_back(screen);
+		executeDrawCallsTiled(regions);
+	} else {
+		for (const auto &drawCall : _drawCallsQueue) {
+			drawCall->execute(true);
+		}
+	}
 
 	for (const auto &drawCall : _drawCallsQueue) {
-		drawCall->execute(true);
 		delete drawCall;
 	}
 
@@ -290,7 +436,7 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleFront = c->draw_triangle_front;
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
-	_state = captureState();
+	_state = captureState(c);
 	if (c->_enableDirtyRectangles) {
 		computeDirtyRegion();
 	}
@@ -334,15 +480,53 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 
 	RasterizationDrawCall::RasterizationState backupState;
 	if (restoreState) {
-		backupState = captureState();
+		backupState = captureState(c);
 	}
-	applyState(_state);
+	applyState(c, _state);
 
 	GLVertex *prevVertex = c->vertex;
 	int prevVertexCount = c->vertex_cnt;
 
 	c->vertex = _vertex;
 	c->vertex_cnt = _vertexCount;
+	rasterize(c);
+
+	c->vertex = prevVertex;
+	c->vertex_cnt = prevVertexCount;
+
+	if (restoreState) {
+		applyState(c, backupState);
+	}
+}
+
+void RasterizationDrawCall::executeOnTile(GLContext *c, const Common::Rect &clippingRectangle) const {
+	applyState(c, _state);
+
+	// Some primitives modify the vertices while they are drawn, so every
+	// tile works on a copy of its own
+	if (c->vertex_max < _vertexCount) {
+		gl_free(c->vertex);
+		c->vertex_max = _vertexCount;
+		c->vertex = (GLVertex *)gl_malloc(c->vertex_max * sizeof(GLVertex));
+	}
+	GLVertex *vertex = c->vertex;
+	memcpy(vertex, _vertex, sizeof(GLVertex) * _vertexCount);
+	c->vertex_cnt = _vertexCount;
+
+	c->fb->setScissorRectangle(clippingRectangle);
+	rasterize(c);
+	c->fb->resetScissorRectangle();
+
+	c->vertex = vertex;
+}
+
+bool RasterizationDrawCall::isSelection() const {
+	return
+		_drawTriangleFront == (gl_draw_triangle_func_ptr)GLContext::gl_draw_triangle_select ||
+		_drawTriangleBack == (gl_draw_triangle_func_ptr)GLContext::gl_draw_triangle_select;
+}
+
+void RasterizationDrawCall::rasterize(GLContext *c) const {
 	c->draw_triangle_front = (gl_draw_triangle_func)_drawTriangleFront;
 	c->draw_triangle_back = (gl_draw_triangle_func)_drawTriangleBack;
 
@@ -420,18 +604,10 @@ void RasterizationDrawCall::execute(bool restoreState) const {
 	default:
 		error("glBegin: type %x not handled", c->begin_type);
 	}
-
-	c->vertex = prevVertex;
-	c->vertex_cnt = prevVertexCount;
-
-	if (restoreState) {
-		applyState(backupState);
-	}
 }
 
-RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState() const {
+RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState(GLContext *c) const {
 	RasterizationState state;
-	GLContext *c = gl_get_context();
 	state.enableBlending = c->blending_enabled;
 	state.sfactor = c->source_blending_factor;
 	state.dfactor = c->destination_blending_factor;
@@ -482,8 +658,7 @@ RasterizationDrawCall::RasterizationState RasterizationDrawCall::captureState()
 	return state;
 }
 
-void RasterizationDrawCall::applyState(const RasterizationDrawCall::RasterizationState &state) const {
-	GLContext *c = gl_get_context();
+void RasterizationDrawCall::applyState(GLContext *c, const RasterizationDrawCall::RasterizationState &state) const {
 	c->fb->enableBlending(state.enableBlending);
 	c->fb->setBlendingFactors(state.sfactor, state.dfactor);
 	c->fb->enableAlphaTest(state.alphaTestEnabled);
@@ -701,8 +876,16 @@ void ClearBufferDrawCall::execute(bool restoreState) const {
 }
 
 void ClearBufferDrawCall::execute(const Common::Rect &clippingRectangle, bool restoreState) const {
-	TinyGL::GLContext *c = gl_get_context();
-	Common::Rect clearRect = clippingRectangle.findIntersectingRect(getDirtyRegion());
+	executeOnTile(gl_get_context(), clippingRectangle);
+}
+
+void ClearBufferDrawCall::executeOnTile(GLContext *c, const Common::Rect &clippingRectangle) const {
+	// Without dirty rectangles, the whole buffer is cleared
+	Common::Rect clearRect = clippingRectangle;
+	if (c->_enableDirtyRectangles)
+		clearRect.clip(getDirtyRegion());
+	if (clearRect.isEmpty())
+		return;
 	c->fb->clearRegion(clearRect.left, clearRect.top, clearRect.width(), clearRect.height(),
 	                   _clearZBuffer, _zValue, _clearColorBuffer, _rValue, _gValue, _bValue,
 	                   _clearStencilBuffer, _stencilValue);
@@ -70,6 +70,8 @@ public:
 	bool operator==(const ClearBufferDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	// Execute on one of the tile contexts, see GLContext::executeDrawCallsTiled()
+	void executeOnTile(GLContext *c, const Common::Rect &clippingRectangle) const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -89,6 +91,10 @@ public:
 	bool operator==(const RasterizationDrawCall &other) const;
 	virtual void execute(bool restoreState) const;
 	virtual void execute(const Common::Rect &clippingRectangle, bool restoreState) const;
+	// Execute on one of the tile contexts, see GLContext::executeDrawCallsTiled()
+	void executeOnTile(GLContext *c, const Common::Rect &clippingRectangle) const;
+	// Selection draw calls fill the selection buffer instead of the frame buffer
+	bool isSelection() const;
 
 	void *operator new(size_t size) {
 		return Internal::allocateFrame(size);
@@ -97,6 +103,7 @@ public:
 	void operator delete(void *p) { }
 private:
 	void computeDirtyRegion();
+	void rasterize(GLContext *c) const;
 	typedef void (*gl_draw_triangle_func_ptr)(GLContext *c, TinyGL::GLVertex *p0, TinyGL::GLVertex *p1, TinyGL::GLVertex *p2);
 	int _vertexCount;
 	GLVertex *_vertex;
@@ -152,8 +159,8 @@ private:
 
 	RasterizationState _state;
 
-	RasterizationState captureState() const;
-	void applyState(const RasterizationState &state) const;
+	RasterizationState captureState(GLContext *c) const;
+	void applyState(GLContext *c, const RasterizationState &state) const;
 };
 
 // Encapsulate a blit call: it might execute either a color buffer or z buffer blit.
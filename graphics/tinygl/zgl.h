@@ -467,6 +467,10 @@ struct GLContext {
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
+	// Contexts which replay the draw calls for horizontal bands of the
+	// frame buffer on the thread pool
+	Common::Array<GLContext *> _tileContexts;
+
 	void gl_vertex_transform(GLVertex *v);
 	void gl_calc_fog_factor(GLVertex *v);
 
@@ -524,6 +528,10 @@ public:
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
 
+	bool canExecuteDrawCallsTiled() const;
+	void executeDrawCallsTiled(const Common::List<Common::Rect> &regions);
+	void disposeTileContexts();
+
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
 	GLSpecBuf *specbuf_get_buffer(const int shininess_i, const float shininess);
@@ -446,7 +446,9 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && y < _clipRectangle.top) {
+				// Scanlines above the scissor rectangle only need the edges stepped
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -678,6 +680,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 			nb_lines--;
 			y++;
+
+			// Nothing below the scissor rectangle can be drawn
+			if (kEnableScissor && y >= _clipRectangle.bottom)
+				return;
 		}
 	}
 }
@@ -82,8 +82,12 @@
 // BASIS, AND BROWN UNIVERSITY HAS NO OBLIGATION TO PROVIDE MAINTENANCE,
 // SUPPORT, UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
+#include "common/system.h"
+#include "common/threadpool.h"
+
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -91,6 +95,12 @@ DECLARE_SINGLETON(Graphics::YUVToRGBManager);
 
 namespace Graphics {
 
+/**
+ * Frames are only split up for the thread pool when every part gets at
+ * least this many pixels, smaller parts are not worth waking a thread for.
+ */
+static const uint kMinPixelsPerTask = 32768;
+
 class YUVToRGBLookup {
 public:
 	YUVToRGBLookup(Graphics::PixelFormat format, YUVToRGBManager::LuminanceScale scale);
@@ -198,6 +208,132 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+YUVToRGBKernels::RowFunc YUVToRGBKernels::rowFunc = nullptr;
+bool YUVToRGBKernels::selected = false;
+
+void YUVToRGBKernels::convertRowTail(const Row &row, const Format &format, uint start) {
+	const uint chromaShift = row.halfChroma ? 1 : 0;
+
+	for (uint x = start; x < row.width; x++) {
+		const uint c = x >> chromaShift;
+		const int a = row.a ? row.a[x] : 0xFF;
+
+		if (format.bytesPerPixel == 2)
+			((uint16 *)row.dst)[x] = convertPixel<uint16>(row.y[x], a, row.dR[c], row.dG[c], row.dB[c], format);
+		else
+			((uint32 *)row.dst)[x] = convertPixel<uint32>(row.y[x], a, row.dR[c], row.dG[c], row.dB[c], format);
+	}
+}
+
+void YUVToRGBKernels::convertRowGeneric(const Row &row, const Format &format) {
+	convertRowTail(row, format, 0);
+}
+
+void YUVToRGBKernels::selectImplementation() {
+	// The table based code beats the generic row kernel, so there is
+	// no row kernel unless the CPU has vector instructions
+	rowFunc = nullptr;
+#ifdef SCUMMVM_NEON
+	if (g_system->hasFeature(OSystem::kFeatureCpuNEON))
+		rowFunc = convertRowNEON;
+#endif
+#ifdef SCUMMVM_SSE2
+	if (g_system->hasFeature(OSystem::kFeatureCpuSSE2))
+		rowFunc = convertRowSSE2;
+#endif
+#ifdef SCUMMVM_AVX2
+	if (g_system->hasFeature(OSystem::kFeatureCpuAVX2))
+		rowFunc = convertRowAVX2;
+#endif
+	selected = true;
+}
+
+namespace {
+
+/**
+ * Feeds the row kernels. The chroma parts are looked up for runs of this
+ * many pixels at a time, and kept on the stack.
+ */
+static const uint kRowRunLength = 256;
+
+class YUVRowConverter {
+public:
+	YUVRowConverter(YUVToRGBKernels::RowFunc func, const YUVToRGBLookup *lookup);
+
+	/**
+	 * Convert @p numRows rows of luma, @p yPitch bytes apart, which share
+	 * one row of chroma. The alpha rows have the same pitch as the luma.
+	 */
+	void convert(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, uint width, uint numRows, bool halfChroma) const;
+
+private:
+	YUVToRGBKernels::RowFunc _func;
+	YUVToRGBKernels::Format _format;
+
+	const int16 *_crR, *_crG, *_cbG, *_cbB;
+
+	// The tables point into the clip table, these are the offsets of the
+	// value 0 of every channel in it
+	int _rBase, _gBase, _bBase;
+};
+
+YUVRowConverter::YUVRowConverter(YUVToRGBKernels::RowFunc func, const YUVToRGBLookup *lookup) : _func(func) {
+	const Graphics::PixelFormat &format = lookup->getFormat();
+
+	_format.bytesPerPixel = format.bytesPerPixel;
+	_format.rLoss = format.rLoss;
+	_format.gLoss = format.gLoss;
+	_format.bLoss = format.bLoss;
+	_format.aLoss = format.aLoss;
+	_format.rShift = format.rShift;
+	_format.gShift = format.gShift;
+	_format.bShift = format.bShift;
+	_format.aShift = format.aShift;
+	_format.itu = lookup->getScale() == YUVToRGBManager::kScaleITU;
+
+	_crR = lookup->getColorTable();
+	_crG = _crR + 256;
+	_cbG = _crG + 256;
+	_cbB = _cbG + 256;
+
+	_rBase = _crR[128];
+	_gBase = _crG[128] + _cbG[128];
+	_bBase = _cbB[128];
+}
+
+void YUVRowConverter::convert(byte *dst, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, uint width, uint numRows, bool halfChroma) const {
+	int16 dR[kRowRunLength], dG[kRowRunLength], dB[kRowRunLength];
+	const uint chromaShift = halfChroma ? 1 : 0;
+
+	YUVToRGBKernels::Row row;
+	row.dR = dR;
+	row.dG = dG;
+	row.dB = dB;
+	row.halfChroma = halfChroma;
+
+	for (uint x = 0; x < width; x += kRowRunLength) {
+		const uint length = MIN(kRowRunLength, width - x);
+		const byte *u = uSrc + (x >> chromaShift);
+		const byte *v = vSrc + (x >> chromaShift);
+
+		for (uint i = 0; i < ((length + chromaShift) >> chromaShift); i++) {
+			dR[i] = _crR[v[i]] - _rBase;
+			dG[i] = _crG[v[i]] + _cbG[u[i]] - _gBase;
+			dB[i] = _cbB[u[i]] - _bBase;
+		}
+
+		row.width = length;
+		for (uint i = 0; i < numRows; i++) {
+			row.dst = dst + i * dstPitch + x * _format.bytesPerPixel;
+			row.y = ySrc + i * yPitch + x;
+			row.a = aSrc ? aSrc + i * yPitch + x : nullptr;
+			_func(row, _format);
+		}
+	}
+}
+
+} // End of anonymous namespace
+
 #define PUT_PIXEL(s, d) \
 	L = &clipTable[(s)]; \
 	*((PixelInt *)(d)) = ((L[cr_r] << r_shift) | (L[crb_g] << g_shift) | (L[cb_b] << b_shift) | a_mask)
@@ -246,6 +382,14 @@ void YUVToRGBManager::convert444(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	YUVToRGBKernels::RowFunc rowFunc = YUVToRGBKernels::getRowFunc();
+	if (rowFunc) {
+		YUVRowConverter converter(rowFunc, lookup);
+		for (int h = 0; h < yHeight; h++)
+			converter.convert((byte *)dst->getBasePtr(0, h), dst->pitch, ySrc + h * yPitch, nullptr, yPitch, uSrc + h * uvPitch, vSrc + h * uvPitch, yWidth, 1, false);
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV444ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -303,6 +447,14 @@ void YUVToRGBManager::convert422(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	YUVToRGBKernels::RowFunc rowFunc = YUVToRGBKernels::getRowFunc();
+	if (rowFunc) {
+		YUVRowConverter converter(rowFunc, lookup);
+		for (int h = 0; h < yHeight; h++)
+			converter.convert((byte *)dst->getBasePtr(0, h), dst->pitch, ySrc + h * yPitch, nullptr, yPitch, uSrc + h * uvPitch, vSrc + h * uvPitch, yWidth, 1, true);
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV422ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -363,12 +515,35 @@ void YUVToRGBManager::convert420(Graphics::Surface *dst, YUVToRGBManager::Lumina
 	assert((yHeight & 1) == 0);
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
+	byte *dstPixels = (byte *)dst->getPixels();
+	const int dstPitch = dst->pitch;
+	const bool is16Bit = dst->format.bytesPerPixel == 2;
+	YUVToRGBKernels::RowFunc rowFunc = YUVToRGBKernels::getRowFunc();
+
+	// Pairs of lines share their chroma lines and nothing else, so big
+	// frames are split up into runs of line pairs over the thread pool
+	const uint pairsPerTask = MAX<uint>(1, kMinPixelsPerTask / (2 * yWidth));
+
+	Common::parallelFor(0, yHeight >> 1, pairsPerTask, [&](uint begin, uint end) {
+		byte *dstPtr = dstPixels + 2 * begin * dstPitch;
+		const byte *yPtr = ySrc + 2 * begin * yPitch;
+		const byte *uPtr = uSrc + begin * uvPitch;
+		const byte *vPtr = vSrc + begin * uvPitch;
+		const int height = 2 * (end - begin);
+
+		if (rowFunc) {
+			YUVRowConverter converter(rowFunc, lookup);
+			for (int h = 0; h < height; h += 2)
+				converter.convert(dstPtr + h * dstPitch, dstPitch, yPtr + h * yPitch, nullptr, yPitch, uPtr + (h >> 1) * uvPitch, vPtr + (h >> 1) * uvPitch, yWidth, 2, true);
+			return;
+		}
 
-	// Use a templated function to avoid an if check on every pixel
-	if (dst->format.bytesPerPixel == 2)
-		convertYUV420ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
-	else
-		convertYUV420ToRGB<uint32>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
+		// Use a templated function to avoid an if check on every pixel
+		if (is16Bit)
+			convertYUV420ToRGB<uint16>(dstPtr, dstPitch, lookup, yPtr, uPtr, vPtr, yWidth, height, yPitch, uvPitch);
+		else
+			convertYUV420ToRGB<uint32>(dstPtr, dstPitch, lookup, yPtr, uPtr, vPtr, yWidth, height, yPitch, uvPitch);
+	});
 }
 
 #define PUT_PIXELA(s, a, d) \
@@ -433,6 +608,14 @@ void YUVToRGBManager::convert420Alpha(Graphics::Surface *dst, YUVToRGBManager::L
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	YUVToRGBKernels::RowFunc rowFunc = YUVToRGBKernels::getRowFunc();
+	if (rowFunc) {
+		YUVRowConverter converter(rowFunc, lookup);
+		for (int h = 0; h < yHeight; h += 2)
+			converter.convert((byte *)dst->getBasePtr(0, h), dst->pitch, ySrc + h * yPitch, aSrc + h * yPitch, yPitch, uSrc + (h >> 1) * uvPitch, vSrc + (h >> 1) * uvPitch, yWidth, 2, true);
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUVA420ToRGBA<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, aSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -523,6 +706,34 @@ void YUVToRGBManager::convert410(Graphics::Surface *dst, YUVToRGBManager::Lumina
 
 	const YUVToRGBLookup *lookup = getLookup(dst->format, scale);
 
+	YUVToRGBKernels::RowFunc rowFunc = YUVToRGBKernels::getRowFunc();
+	if (rowFunc) {
+		// Interpolate the chroma of every row like the table based code,
+		// then convert it like 444
+		YUVRowConverter converter(rowFunc, lookup);
+		Common::Array<byte> chroma(yWidth * 2);
+		byte *uRow = chroma.data();
+		byte *vRow = uRow + yWidth;
+
+		for (int h = 0; h < yHeight; h++) {
+			const int yDiff = h & 3;
+			const byte *uQuad = uSrc + (h >> 2) * uvPitch;
+			const byte *vQuad = vSrc + (h >> 2) * uvPitch;
+
+			for (int x = 0; x < yWidth; x++) {
+				const int xDiff = x & 3;
+				const int index = x >> 2;
+				uRow[x] = (uQuad[index] * (4 - xDiff) * (4 - yDiff) + uQuad[index + 1] * xDiff * (4 - yDiff) +
+						uQuad[index + uvPitch] * yDiff * (4 - xDiff) + uQuad[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+				vRow[x] = (vQuad[index] * (4 - xDiff) * (4 - yDiff) + vQuad[index + 1] * xDiff * (4 - yDiff) +
+						vQuad[index + uvPitch] * yDiff * (4 - xDiff) + vQuad[index + uvPitch + 1] * xDiff * yDiff) >> 4;
+			}
+
+			converter.convert((byte *)dst->getBasePtr(0, h), dst->pitch, ySrc + h * yPitch, nullptr, yPitch, uRow, vRow, yWidth, 1, false);
+		}
+		return;
+	}
+
 	// Use a templated function to avoid an if check on every pixel
 	if (dst->format.bytesPerPixel == 2)
 		convertYUV410ToRGB<uint16>((byte *)dst->getPixels(), dst->pitch, lookup, ySrc, uSrc, vSrc, yWidth, yHeight, yPitch, uvPitch);
@@ -0,0 +1,106 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include <immintrin.h>
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+namespace Graphics {
+
+/**
+ * Clip sixteen luma plus chroma sums, see sse2_clip() for the ITU
+ * division.
+ */
+static FORCEINLINE __m256i avx2_clip(__m256i value, bool itu) {
+	if (!itu)
+		return _mm256_min_epi16(_mm256_max_epi16(value, _mm256_setzero_si256()), _mm256_set1_epi16(255));
+
+	value = _mm256_min_epi16(_mm256_max_epi16(value, _mm256_set1_epi16(16)), _mm256_set1_epi16(235));
+	value = _mm256_mullo_epi16(_mm256_sub_epi16(value, _mm256_set1_epi16(16)), _mm256_set1_epi16(255));
+	return _mm256_srli_epi16(_mm256_mulhi_epu16(value, _mm256_set1_epi16(19153)), 6);
+}
+
+static FORCEINLINE __m256i avx2_loadChroma(const int16 *src, uint x, bool halfChroma) {
+	if (!halfChroma)
+		return _mm256_loadu_si256((const __m256i *)(src + x));
+
+	const __m128i chroma = _mm_loadu_si128((const __m128i *)(src + (x >> 1)));
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi16(chroma, chroma)), _mm_unpackhi_epi16(chroma, chroma), 1);
+}
+
+static FORCEINLINE __m256i avx2_packPixels(__m128i r, __m128i g, __m128i b, __m128i a, __m128i rShift, __m128i gShift, __m128i bShift, __m128i aShift) {
+	return _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(r), rShift), _mm256_sll_epi32(_mm256_cvtepu16_epi32(g), gShift)),
+	                       _mm256_or_si256(_mm256_sll_epi32(_mm256_cvtepu16_epi32(b), bShift), _mm256_sll_epi32(_mm256_cvtepu16_epi32(a), aShift)));
+}
+
+void YUVToRGBKernels::convertRowAVX2(const Row &row, const Format &format) {
+	const __m128i rLoss = _mm_cvtsi32_si128(format.rLoss), rShift = _mm_cvtsi32_si128(format.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(format.gLoss), gShift = _mm_cvtsi32_si128(format.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(format.bLoss), bShift = _mm_cvtsi32_si128(format.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(format.aLoss), aShift = _mm_cvtsi32_si128(format.aShift);
+	const __m256i opaque = _mm256_set1_epi16(0xFF >> format.aLoss);
+
+	uint x = 0;
+	for (; x + 16 <= row.width; x += 16) {
+		const __m256i y = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(row.y + x)));
+
+		const __m256i r = _mm256_srl_epi16(avx2_clip(_mm256_add_epi16(y, avx2_loadChroma(row.dR, x, row.halfChroma)), format.itu), rLoss);
+		const __m256i g = _mm256_srl_epi16(avx2_clip(_mm256_add_epi16(y, avx2_loadChroma(row.dG, x, row.halfChroma)), format.itu), gLoss);
+		const __m256i b = _mm256_srl_epi16(avx2_clip(_mm256_add_epi16(y, avx2_loadChroma(row.dB, x, row.halfChroma)), format.itu), bLoss);
+		__m256i a = opaque;
+		if (row.a)
+			a = _mm256_srl_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(row.a + x))), aLoss);
+
+		if (format.bytesPerPixel == 2) {
+			const __m256i pixels = _mm256_or_si256(_mm256_or_si256(_mm256_sll_epi16(r, rShift), _mm256_sll_epi16(g, gShift)),
+			                                       _mm256_or_si256(_mm256_sll_epi16(b, bShift), _mm256_sll_epi16(a, aShift)));
+			_mm256_storeu_si256((__m256i *)(row.dst + x * 2), pixels);
+		} else {
+			const __m256i lo = avx2_packPixels(_mm256_castsi256_si128(r), _mm256_castsi256_si128(g),
+			                                   _mm256_castsi256_si128(b), _mm256_castsi256_si128(a),
+			                                   rShift, gShift, bShift, aShift);
+			const __m256i hi = avx2_packPixels(_mm256_extracti128_si256(r, 1), _mm256_extracti128_si256(g, 1),
+			                                   _mm256_extracti128_si256(b, 1), _mm256_extracti128_si256(a, 1),
+			                                   rShift, gShift, bShift, aShift);
+			_mm256_storeu_si256((__m256i *)(row.dst + x * 4), lo);
+			_mm256_storeu_si256((__m256i *)(row.dst + x * 4 + 32), hi);
+		}
+	}
+
+	convertRowTail(row, format, x);
+}
+
+} // End of namespace Graphics
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,120 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_YUV_TO_RGB_KERNELS_H
+#define GRAPHICS_YUV_TO_RGB_KERNELS_H
+
+#include "common/scummsys.h"
+#include "common/util.h"
+
+class YUVToRGBTestSuite;
+
+namespace Graphics {
+
+/**
+ * Row kernels for YUVToRGBManager.
+ *
+ * The chroma part of each pixel is still looked up in the tables of the
+ * table based code, once per chroma sample, so the rounding stays exactly
+ * the same. The kernels add the luma, clip the result, and pack it into
+ * the destination format in registers. The output is bit-exact with the
+ * table based code for every pixel format.
+ */
+class YUVToRGBKernels {
+public:
+	/** The destination pixel format and the luminance scale. */
+	struct Format {
+		uint bytesPerPixel;
+		byte rLoss, gLoss, bLoss, aLoss;
+		byte rShift, gShift, bShift, aShift;
+		bool itu;
+	};
+
+	/**
+	 * A run of pixels to convert. dR, dG and dB hold the chroma part of
+	 * each pixel, or of each pair of pixels if halfChroma is set.
+	 */
+	struct Row {
+		byte *dst;
+		const byte *y;
+		const byte *a;          ///< Alpha values, or nullptr for opaque pixels
+		const int16 *dR;
+		const int16 *dG;
+		const int16 *dB;
+		uint width;
+		bool halfChroma;
+	};
+
+	typedef void (*RowFunc)(const Row &row, const Format &format);
+
+	/**
+	 * Return the row kernel for this CPU, or nullptr when there is none
+	 * and the table based code is faster.
+	 */
+	static RowFunc getRowFunc() {
+		if (!selected)
+			selectImplementation();
+		return rowFunc;
+	}
+
+	/**
+	 * Clip a luma value plus its chroma part to [0, 255]. Values in ITU
+	 * range are clipped to [16, 235] first and then stretched.
+	 */
+	static inline int clip(int value, bool itu) {
+		if (itu)
+			return (CLIP(value, 16, 235) - 16) * 255 / 219;
+		return CLIP(value, 0, 255);
+	}
+
+	template<typename PixelInt>
+	static inline PixelInt convertPixel(int y, int a, int dR, int dG, int dB, const Format &format) {
+		return (PixelInt)(((clip(y + dR, format.itu) >> format.rLoss) << format.rShift) |
+		                  ((clip(y + dG, format.itu) >> format.gLoss) << format.gShift) |
+		                  ((clip(y + dB, format.itu) >> format.bLoss) << format.bShift) |
+		                  ((a >> format.aLoss) << format.aShift));
+	}
+
+	/** Convert the pixels from @p start on one at a time. */
+	static void convertRowTail(const Row &row, const Format &format, uint start);
+
+private:
+	static void convertRowGeneric(const Row &row, const Format &format);
+#ifdef SCUMMVM_NEON
+	static void convertRowNEON(const Row &row, const Format &format);
+#endif
+#ifdef SCUMMVM_SSE2
+	static void convertRowSSE2(const Row &row, const Format &format);
+#endif
+#ifdef SCUMMVM_AVX2
+	static void convertRowAVX2(const Row &row, const Format &format);
+#endif
+
+	static void selectImplementation();
+
+	static RowFunc rowFunc;
+	static bool selected;
+	friend class ::YUVToRGBTestSuite;
+};
+
+} // End of namespace Graphics
+
+#endif
@@ -0,0 +1,123 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#ifdef SCUMMVM_NEON
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include <arm_neon.h>
+
+#if !defined(__aarch64__) && !defined(__ARM_NEON)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("neon"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("fpu=neon")
+#endif
+
+#endif // !defined(__aarch64__) && !defined(__ARM_NEON)
+
+namespace Graphics {
+
+/**
+ * Clip eight luma plus chroma sums like YUVToRGBKernels::clip(). The ITU
+ * division by 219 is done as a multiplication by 19153 / 2^22, which gives
+ * the exact quotient for every value in [0, 219 * 255].
+ */
+static inline uint16x8_t neon_clip(int16x8_t value, bool itu) {
+	if (!itu)
+		return vreinterpretq_u16_s16(vminq_s16(vmaxq_s16(value, vdupq_n_s16(0)), vdupq_n_s16(255)));
+
+	value = vminq_s16(vmaxq_s16(value, vdupq_n_s16(16)), vdupq_n_s16(235));
+	const uint16x8_t scaled = vmulq_n_u16(vreinterpretq_u16_s16(vsubq_s16(value, vdupq_n_s16(16))), 255);
+	const uint32x4_t lo = vmull_n_u16(vget_low_u16(scaled), 19153);
+	const uint32x4_t hi = vmull_n_u16(vget_high_u16(scaled), 19153);
+	return vshrq_n_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)), 6);
+}
+
+static inline int16x8_t neon_loadChroma(const int16 *src, uint x, bool halfChroma) {
+	if (!halfChroma)
+		return vld1q_s16(src + x);
+
+	const int16x4_t chroma = vld1_s16(src + (x >> 1));
+	const int16x4x2_t pairs = vzip_s16(chroma, chroma);
+	return vcombine_s16(pairs.val[0], pairs.val[1]);
+}
+
+static inline uint32x4_t neon_packPixels(uint16x4_t r, uint16x4_t g, uint16x4_t b, uint16x4_t a, int32x4_t rShift, int32x4_t gShift, int32x4_t bShift, int32x4_t aShift) {
+	return vorrq_u32(vorrq_u32(vshlq_u32(vmovl_u16(r), rShift), vshlq_u32(vmovl_u16(g), gShift)),
+	                 vorrq_u32(vshlq_u32(vmovl_u16(b), bShift), vshlq_u32(vmovl_u16(a), aShift)));
+}
+
+void YUVToRGBKernels::convertRowNEON(const Row &row, const Format &format) {
+	// NEON only shifts left by a vector, so right shifts use negative counts
+	const int16x8_t rLoss = vdupq_n_s16(-format.rLoss), rShift = vdupq_n_s16(format.rShift);
+	const int16x8_t gLoss = vdupq_n_s16(-format.gLoss), gShift = vdupq_n_s16(format.gShift);
+	const int16x8_t bLoss = vdupq_n_s16(-format.bLoss), bShift = vdupq_n_s16(format.bShift);
+	const int16x8_t aLoss = vdupq_n_s16(-format.aLoss), aShift = vdupq_n_s16(format.aShift);
+	const uint16x8_t opaque = vdupq_n_u16(0xFF >> format.aLoss);
+
+	uint x = 0;
+	for (; x + 8 <= row.width; x += 8) {
+		const int16x8_t y = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(row.y + x)));
+
+		const uint16x8_t r = vshlq_u16(neon_clip(vaddq_s16(y, neon_loadChroma(row.dR, x, row.halfChroma)), format.itu), rLoss);
+		const uint16x8_t g = vshlq_u16(neon_clip(vaddq_s16(y, neon_loadChroma(row.dG, x, row.halfChroma)), format.itu), gLoss);
+		const uint16x8_t b = vshlq_u16(neon_clip(vaddq_s16(y, neon_loadChroma(row.dB, x, row.halfChroma)), format.itu), bLoss);
+		uint16x8_t a = opaque;
+		if (row.a)
+			a = vshlq_u16(vmovl_u8(vld1_u8(row.a + x)), aLoss);
+
+		if (format.bytesPerPixel == 2) {
+			const uint16x8_t pixels = vorrq_u16(vorrq_u16(vshlq_u16(r, rShift), vshlq_u16(g, gShift)),
+			                                    vorrq_u16(vshlq_u16(b, bShift), vshlq_u16(a, aShift)));
+			vst1q_u16((uint16 *)(row.dst + x * 2), pixels);
+		} else {
+			const int32x4_t rShift32 = vdupq_n_s32(format.rShift), gShift32 = vdupq_n_s32(format.gShift);
+			const int32x4_t bShift32 = vdupq_n_s32(format.bShift), aShift32 = vdupq_n_s32(format.aShift);
+			vst1q_u32((uint32 *)(row.dst + x * 4),
+			          neon_packPixels(vget_low_u16(r), vget_low_u16(g), vget_low_u16(b), vget_low_u16(a),
+			                          rShift32, gShift32, bShift32, aShift32));
+			vst1q_u32((uint32 *)(row.dst + x * 4 + 16),
+			          neon_packPixels(vget_high_u16(r), vget_high_u16(g), vget_high_u16(b), vget_high_u16(a),
+			                          rShift32, gShift32, bShift32, aShift32));
+		}
+	}
+
+	convertRowTail(row, format, x);
+}
+
+} // End of namespace Graphics
+
+#if !defined(__aarch64__) && !defined(__ARM_NEON)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__aarch64__) && !defined(__ARM_NEON)
+
+#endif // SCUMMVM_NEON
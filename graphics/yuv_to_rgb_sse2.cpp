@@ -0,0 +1,109 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/scummsys.h"
+
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include <emmintrin.h>
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("sse2"))), apply_to=function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("sse2")
+#endif
+
+#endif // !defined(__x86_64__)
+
+namespace Graphics {
+
+/**
+ * Clip eight luma plus chroma sums like YUVToRGBKernels::clip(). The ITU
+ * division by 219 is done as a multiplication by 19153 / 2^22, which gives
+ * the exact quotient for every value in [0, 219 * 255].
+ */
+static FORCEINLINE __m128i sse2_clip(__m128i value, bool itu) {
+	if (!itu)
+		return _mm_min_epi16(_mm_max_epi16(value, _mm_setzero_si128()), _mm_set1_epi16(255));
+
+	value = _mm_min_epi16(_mm_max_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(235));
+	value = _mm_mullo_epi16(_mm_sub_epi16(value, _mm_set1_epi16(16)), _mm_set1_epi16(255));
+	return _mm_srli_epi16(_mm_mulhi_epu16(value, _mm_set1_epi16(19153)), 6);
+}
+
+static FORCEINLINE __m128i sse2_loadChroma(const int16 *src, uint x, bool halfChroma) {
+	if (!halfChroma)
+		return _mm_loadu_si128((const __m128i *)(src + x));
+
+	__m128i chroma = _mm_loadl_epi64((const __m128i *)(src + (x >> 1)));
+	return _mm_unpacklo_epi16(chroma, chroma);
+}
+
+void YUVToRGBKernels::convertRowSSE2(const Row &row, const Format &format) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rLoss = _mm_cvtsi32_si128(format.rLoss), rShift = _mm_cvtsi32_si128(format.rShift);
+	const __m128i gLoss = _mm_cvtsi32_si128(format.gLoss), gShift = _mm_cvtsi32_si128(format.gShift);
+	const __m128i bLoss = _mm_cvtsi32_si128(format.bLoss), bShift = _mm_cvtsi32_si128(format.bShift);
+	const __m128i aLoss = _mm_cvtsi32_si128(format.aLoss), aShift = _mm_cvtsi32_si128(format.aShift);
+	const __m128i opaque = _mm_set1_epi16(0xFF >> format.aLoss);
+
+	uint x = 0;
+	for (; x + 8 <= row.width; x += 8) {
+		const __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row.y + x)), zero);
+
+		const __m128i r = _mm_srl_epi16(sse2_clip(_mm_add_epi16(y, sse2_loadChroma(row.dR, x, row.halfChroma)), format.itu), rLoss);
+		const __m128i g = _mm_srl_epi16(sse2_clip(_mm_add_epi16(y, sse2_loadChroma(row.dG, x, row.halfChroma)), format.itu), gLoss);
+		const __m128i b = _mm_srl_epi16(sse2_clip(_mm_add_epi16(y, sse2_loadChroma(row.dB, x, row.halfChroma)), format.itu), bLoss);
+		__m128i a = opaque;
+		if (row.a)
+			a = _mm_srl_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(row.a + x)), zero), aLoss);
+
+		if (format.bytesPerPixel == 2) {
+			const __m128i pixels = _mm_or_si128(_mm_or_si128(_mm_sll_epi16(r, rShift), _mm_sll_epi16(g, gShift)),
+			                                    _mm_or_si128(_mm_sll_epi16(b, bShift), _mm_sll_epi16(a, aShift)));
+			_mm_storeu_si128((__m128i *)(row.dst + x * 2), pixels);
+		} else {
+			const __m128i lo = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rShift), _mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gShift)),
+			                                _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bShift), _mm_sll_epi32(_mm_unpacklo_epi16(a, zero), aShift)));
+			const __m128i hi = _mm_or_si128(_mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rShift), _mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gShift)),
+			                                _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bShift), _mm_sll_epi32(_mm_unpackhi_epi16(a, zero), aShift)));
+			_mm_storeu_si128((__m128i *)(row.dst + x * 4), lo);
+			_mm_storeu_si128((__m128i *)(row.dst + x * 4 + 16), hi);
+		}
+	}
+
+	convertRowTail(row, format, x);
+}
+
+} // End of namespace Graphics
+
+#if !defined(__x86_64__)
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif // !defined(__x86_64__)
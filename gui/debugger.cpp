@@ -36,6 +36,8 @@
 
 #include "engines/engine.h"
 
+#include "backends/timer/default/default-timer.h"
+
 #include "gui/debugger.h"
 #ifndef USE_TEXT_CONSOLE_FOR_DEBUGGER
 	#include "gui/console.h"
@@ -78,6 +80,7 @@ Debugger::Debugger() {
 	registerCmd("exec",				WRAP_METHOD(Debugger, cmdExecFile));
 
 	registerCmd("debuglevel",		WRAP_METHOD(Debugger, cmdDebugLevel));
+	registerCmd("timers",			WRAP_METHOD(Debugger, cmdTimers));
 	registerCmd("debugflag_list",		WRAP_METHOD(Debugger, cmdDebugFlagsList));
 	registerCmd("debugflag_enable",	WRAP_METHOD(Debugger, cmdDebugFlagEnable));
 	registerCmd("debugflag_disable",	WRAP_METHOD(Debugger, cmdDebugFlagDisable));
@@ -776,6 +779,31 @@ bool Debugger::cmdDebugLevel(int argc, const char **argv) {
 	return true;
 }
 
+bool Debugger::cmdTimers(int argc, const char **argv) {
+	DefaultTimerManager *timerManager = dynamic_cast<DefaultTimerManager *>(g_system->getTimerManager());
+	if (!timerManager) {
+		debugPrintf("Timer statistics are not available on this backend\n");
+		return true;
+	}
+
+	Common::Array<DefaultTimerManager::TimerStats> timers;
+	timerManager->getAllTimerStats(timers);
+
+	debugPrintf("Installed timers (times in microseconds):\n");
+	debugPrintf("-----------------------------------------\n");
+	if (timers.empty()) {
+		debugPrintf("No timers installed\n");
+		return true;
+	}
+	debugPrintf("%-24s %9s %9s %7s %9s %9s\n", "ID", "Interval", "Calls", "Missed", "Max drift", "Avg drift");
+	for (const auto &timer : timers) {
+		const uint32 avgDrift = timer.calls ? (uint32)(timer.totalDrift / timer.calls) : 0;
+		debugPrintf("%-24s %9u %9u %7u %9u %9u\n", timer.id.c_str(), timer.interval, timer.calls,
+			timer.missedDeadlines, timer.maxDrift, avgDrift);
+	}
+	return true;
+}
+
 bool Debugger::cmdDebugFlagsList(int argc, const char **argv) {
 	const Common::DebugManager::DebugChannelList &debugLevels = DebugMan.getDebugChannels();
 
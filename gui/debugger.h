@@ -272,6 +272,7 @@ protected:
 	bool cmdMd5Mac(int argc, const char **argv);
 #endif
 	bool cmdDebugLevel(int argc, const char **argv);
+	bool cmdTimers(int argc, const char **argv);
 	bool cmdDebugFlagsList(int argc, const char **argv);
 	bool cmdDebugFlagEnable(int argc, const char **argv);
 	bool cmdDebugFlagDisable(int argc, const char **argv);
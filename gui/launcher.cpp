@@ -1656,6 +1656,9 @@ void LauncherGrid::build() {
 
 	// Add list with game titles
 	_grid = new GridWidget(this, "LauncherGrid.IconArea");
+	// The grid loads its thumbnails in the background, and needs to be
+	// tickled to show them even when it does not have the focus
+	setTickleWidget(_grid);
 	// Populate the list
 	updateListing();
 
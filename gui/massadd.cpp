@@ -156,7 +156,9 @@ void MassAddDialog::handleCommand(CommandSender *sender, uint32 cmd, uint32 data
 
 		close();
 	} else if (cmd == kCancelCmd) {
-		// User cancelled, so we don't do anything and just leave.
+		// User cancelled, so we don't do anything and just leave. The
+		// files scanned so far still don't need to be read again though.
+		ADCacheMan.saveFilePropertiesCache();
 		_games.clear();
 		close();
 	} else if (cmd == kListSelectionChangedCmd) {
@@ -277,6 +279,9 @@ void MassAddDialog::handleTickle() {
 	Common::U32String buf;
 
 	if (_scanStack.empty()) {
+		// Remember the file properties for the next scan
+		ADCacheMan.saveFilePropertiesCache();
+
 		// Enable the OK button
 		_okButton->setEnabled(true);
 
@@ -351,25 +351,39 @@ void GridItemTray::handleMouseMoved(int x, int y, int button) {
 
 #pragma mark -
 
+// Copy an icon file into memory, so that the icon set is only locked while
+// reading it, and not while decoding it.
+static Common::SeekableReadStream *readIconFile(const Common::String &name) {
+	Common::SeekableReadStream *stream = nullptr;
+	g_gui.lockIconsSet();
+	Common::SeekableReadStream *file = g_gui.getIconsSet().createReadStreamForMember(Common::Path(name));
+	if (file) {
+		stream = file->readStream(file->size());
+		delete file;
+	}
+	g_gui.unlockIconsSet();
+
+	if (!stream)
+		debug(5, "GridWidget: Cannot read file '%s'", name.c_str());
+	return stream;
+}
+
 // Load an image file by String name, provide additional render dimensions for SVG images.
 // TODO: Add BMP support, and add scaling of non-vector images.
 Graphics::ManagedSurface *loadSurfaceFromFile(const Common::String &name, int renderWidth = 0, int renderHeight = 0) {
-	Common::Path path(name);
 	Graphics::ManagedSurface *surf = nullptr;
 	if (name.hasSuffix(".png")) {
 #ifdef USE_PNG
-		const Graphics::Surface *srcSurface = nullptr;
-		Image::PNGDecoder decoder;
-		g_gui.lockIconsSet();
-		if (g_gui.getIconsSet().hasFile(path)) {
-			Common::SeekableReadStream *stream = g_gui.getIconsSet().createReadStreamForMember(path);
+		Common::SeekableReadStream *stream = readIconFile(name);
+		if (stream) {
+			Image::PNGDecoder decoder;
 			if (!decoder.loadStream(*stream)) {
-				g_gui.unlockIconsSet();
+				delete stream;
 				warning("Error decoding PNG");
 				return surf;
 			}
 
-			srcSurface = decoder.getSurface();
+			const Graphics::Surface *srcSurface = decoder.getSurface();
 			delete stream;
 			if (!srcSurface) {
 				warning("Failed to load surface : %s", name.c_str());
@@ -377,32 +391,83 @@ Graphics::ManagedSurface *loadSurfaceFromFile(const Common::String &name, int re
 				surf = new Graphics::ManagedSurface();
 				surf->copyFrom(*srcSurface);
 			}
-		} else {
-			debug(5, "GridWidget: Cannot read file '%s'", name.c_str());
 		}
-		g_gui.unlockIconsSet();
 #else
 		error("No PNG support compiled");
 #endif
 	} else if (name.hasSuffix(".svg")) {
-		g_gui.lockIconsSet();
-		if (g_gui.getIconsSet().hasFile(path)) {
-			Common::SeekableReadStream *stream = g_gui.getIconsSet().createReadStreamForMember(path);
+		Common::SeekableReadStream *stream = readIconFile(name);
+		if (stream) {
 			surf = new Graphics::SVGBitmap(stream, renderWidth, renderHeight);
 			delete stream;
-		} else {
-			debug(5, "GridWidget: Cannot read file '%s'", name.c_str());
 		}
-		g_gui.unlockIconsSet();
 	}
 	return surf;
 }
 
+static bool hasIconFile(const Common::String &name) {
+	g_gui.lockIconsSet();
+	const bool hasFile = g_gui.getIconsSet().hasFile(Common::Path(name));
+	g_gui.unlockIconsSet();
+	return hasFile;
+}
+
 #pragma mark -
 
+enum {
+	kThumbnailCacheSize = 32 * 1024 * 1024,
+	kThumbnailPrefetchRows = 2
+};
+
+struct GridWidget::ThumbnailJob {
+	Common::String thumbPath;	// Where the result goes in _loadedSurfaces
+	Common::String path;		// The file to load, the engine icon if the game has none
+	Common::String enginePath;	// The engine icon, in case the game icon cannot be decoded
+	int width, height;
+	uint32 wanted;				// The last _thumbnailUseCount which asked for it
+	Common::Mutex *mutex;
+
+	// Guarded by mutex
+	bool cancelled;
+	bool finished;
+	bool loaded;
+	const Graphics::ManagedSurface *surface;
+};
+
+void GridWidget::loadThumbnailTask(void *data) {
+	ThumbnailJob *job = (ThumbnailJob *)data;
+	{
+		Common::StackLock lock(*job->mutex);
+		if (job->cancelled) {
+			job->finished = true;
+			return;
+		}
+	}
+
+	const Graphics::ManagedSurface *scSurf = nullptr;
+	Graphics::ManagedSurface *surf = loadSurfaceFromFile(job->path);
+	if (!surf && job->path != job->enginePath)
+		surf = loadSurfaceFromFile(job->enginePath);
+	if (surf) {
+		scSurf = scaleGfx(surf, job->width, job->height, true);
+		if (surf != scSurf) {
+			surf->free();
+			delete surf;
+		}
+	}
+
+	Common::StackLock lock(*job->mutex);
+	job->surface = scSurf;
+	job->loaded = true;
+	job->finished = true;
+}
+
 GridWidget::GridWidget(GuiObject *boss, const Common::String &name)
 	: ContainerWidget(boss, name), CommandSender(boss) {
 
+	// Picks up the thumbnails which were loaded in the background
+	setFlags(WIDGET_WANT_TICKLE);
+
 	_thumbnailHeight = 0;
 	_thumbnailWidth = 0;
 	_flagIconHeight = 0;
@@ -445,13 +510,23 @@ GridWidget::GridWidget(GuiObject *boss, const Common::String &name)
 
 	_selectedEntry = nullptr;
 	_isGridInvalid = true;
+
+	_thumbnailUseCount = 0;
+	_thumbnailCacheSize = 0;
 }
 
 GridWidget::~GridWidget() {
+	cancelThumbnailJobs();
+	_thumbnailTasks.wait();
+	for (uint i = 0; i < _thumbnailJobs.size(); ++i) {
+		delete _thumbnailJobs[i]->surface;
+		delete _thumbnailJobs[i];
+	}
+
 	unloadSurfaces(_platformIcons);
 	unloadSurfaces(_languageIcons);
 	unloadSurfaces(_extraIcons);
-	unloadSurfaces(_loadedSurfaces);
+	unloadThumbnails();
 	delete _disabledIconOverlay;
 	_gridItems.clear();
 	_dataEntryList.clear();
@@ -474,7 +549,8 @@ void GridWidget::unloadSurfaces(Common::HashMap<T, const Graphics::ManagedSurfac
 const Graphics::ManagedSurface *GridWidget::filenameToSurface(const Common::String &name) {
 	if (name.empty())
 		return nullptr;
-	return _loadedSurfaces[name];
+	Common::HashMap<Common::String, const Graphics::ManagedSurface *>::const_iterator i = _loadedSurfaces.find(name);
+	return i != _loadedSurfaces.end() ? i->_value : nullptr;
 }
 
 const Graphics::ManagedSurface *GridWidget::languageToSurface(Common::Language languageCode, Graphics::AlphaType &alphaType) {
@@ -698,50 +774,132 @@ void GridWidget::setGroupHeaderFormat(const Common::U32String &prefix, const Com
 }
 
 void GridWidget::reloadThumbnails() {
+	// Everything which is not asked for again below gets cancelled, and
+	// is the first to go when the cache is full
+	++_thumbnailUseCount;
+
+	// The visible entries come first, then the rows below and above them
+	const int prefetch = kThumbnailPrefetchRows * MAX(_itemsPerRow, 1);
+	const int first = MAX(_firstVisibleItem - prefetch, 0);
+	const int last = MIN(_lastVisibleItem + prefetch, (int)_sortedEntryList.size() - 1);
+	for (int i = _firstVisibleItem; i <= last; ++i)
+		requestThumbnail(_sortedEntryList[i]);
+	for (int i = MIN(_firstVisibleItem, last + 1) - 1; i >= first; --i)
+		requestThumbnail(_sortedEntryList[i]);
+
+	{
+		Common::StackLock lock(_thumbnailMutex);
+		for (uint i = 0; i < _thumbnailJobs.size(); ++i)
+			_thumbnailJobs[i]->cancelled = (_thumbnailJobs[i]->wanted != _thumbnailUseCount);
+	}
+
+	// Without worker threads, everything is loaded by now
+	handleTickle();
+	trimThumbnailCache();
+}
+
+void GridWidget::requestThumbnail(const GridItemInfo *entry) {
+	if (entry->thumbPath.empty())
+		return;
+
+	if (_loadedSurfaces.contains(entry->thumbPath)) {
+		_thumbnailLastUse[entry->thumbPath] = _thumbnailUseCount;
+		return;
+	}
+
 	const int thumbnailWidth = MAX(_thumbnailWidth - 2 * _thumbnailMargin, 0);
 	const int thumbnailHeight = MAX(_thumbnailHeight - 2 * _thumbnailMargin, 0);
-	for (Common::Array<GridItemInfo *>::iterator iter = _visibleEntryList.begin(); iter != _visibleEntryList.end(); ++iter) {
-		GridItemInfo *entry = *iter;
-		if (entry->thumbPath.empty())
-			continue;
+	for (uint i = 0; i < _thumbnailJobs.size(); ++i) {
+		ThumbnailJob *job = _thumbnailJobs[i];
+		if (job->thumbPath == entry->thumbPath && job->width == thumbnailWidth && job->height == thumbnailHeight) {
+			job->wanted = _thumbnailUseCount;
+			return;
+		}
+	}
 
-		if (!_loadedSurfaces.contains(entry->thumbPath)) {
-			_loadedSurfaces[entry->thumbPath] = nullptr;
-			Common::String path = Common::String::format("icons/%s-%s.png", entry->engineid.c_str(), entry->gameid.c_str());
-			Graphics::ManagedSurface *surf = loadSurfaceFromFile(path);
-			if (!surf) {
-				path = Common::String::format("icons/%s.png", entry->engineid.c_str());
-				if (!_loadedSurfaces.contains(path)) {
-					surf = loadSurfaceFromFile(path);
-				} else {
-					const Graphics::ManagedSurface *scSurf = _loadedSurfaces[path];
-					// TODO: Use SharedPtr instead of duplicating the surface
-					Graphics::ManagedSurface *thSurf = new Graphics::ManagedSurface();
-					thSurf->copyFrom(*scSurf);
-					_loadedSurfaces[entry->thumbPath] = thSurf;
-				}
+	Common::String path = entry->thumbPath;
+	const Common::String enginePath = Common::String::format("icons/%s.png", entry->engineid.c_str());
+	if (!hasIconFile(path)) {
+		path = enginePath;
+
+		Common::HashMap<Common::String, const Graphics::ManagedSurface *>::const_iterator i = _loadedSurfaces.find(path);
+		if (i != _loadedSurfaces.end()) {
+			Graphics::ManagedSurface *thSurf = nullptr;
+			if (i->_value) {
+				// TODO: Use SharedPtr instead of duplicating the surface
+				thSurf = new Graphics::ManagedSurface();
+				thSurf->copyFrom(*i->_value);
 			}
+			cacheThumbnail(entry->thumbPath, thSurf, _thumbnailUseCount);
+			return;
+		}
+	}
 
-			if (surf) {
-				const Graphics::ManagedSurface *scSurf(scaleGfx(surf, thumbnailWidth, thumbnailHeight, true));
-				_loadedSurfaces[entry->thumbPath] = scSurf;
+	startThumbnailJob(entry->thumbPath, path, enginePath);
+}
 
-				if (path != entry->thumbPath) {
-					// TODO: Use SharedPtr instead of duplicating the surface
-					Graphics::ManagedSurface *thSurf = new Graphics::ManagedSurface();
-					thSurf->copyFrom(*scSurf);
-					_loadedSurfaces[path] = thSurf;
-				}
+void GridWidget::startThumbnailJob(const Common::String &thumbPath, const Common::String &path, const Common::String &enginePath) {
+	ThumbnailJob *job = new ThumbnailJob();
+	job->thumbPath = thumbPath;
+	job->path = path;
+	job->enginePath = enginePath;
+	job->width = MAX(_thumbnailWidth - 2 * _thumbnailMargin, 0);
+	job->height = MAX(_thumbnailHeight - 2 * _thumbnailMargin, 0);
+	job->wanted = _thumbnailUseCount;
+	job->mutex = &_thumbnailMutex;
+	job->cancelled = false;
+	job->finished = false;
+	job->loaded = false;
+	job->surface = nullptr;
+
+	_thumbnailJobs.push_back(job);
+	_thumbnailTasks.run(loadThumbnailTask, job);
+}
 
-				if (surf != scSurf) {
-					surf->free();
-					delete surf;
-				}
-			}
+void GridWidget::cancelThumbnailJobs() {
+	Common::StackLock lock(_thumbnailMutex);
+	for (uint i = 0; i < _thumbnailJobs.size(); ++i)
+		_thumbnailJobs[i]->cancelled = true;
+}
+
+void GridWidget::cacheThumbnail(const Common::String &path, const Graphics::ManagedSurface *surf, uint32 lastUse) {
+	_loadedSurfaces[path] = surf;
+	_thumbnailLastUse[path] = lastUse;
+	if (surf)
+		_thumbnailCacheSize += surf->pitch * surf->h;
+}
+
+void GridWidget::trimThumbnailCache() {
+	while (_thumbnailCacheSize > kThumbnailCacheSize) {
+		// Unload the thumbnail which was asked for the longest time ago,
+		// but never one of the rows which are shown or prefetched now
+		Common::HashMap<Common::String, uint32>::iterator oldest = _thumbnailLastUse.end();
+		for (Common::HashMap<Common::String, uint32>::iterator i = _thumbnailLastUse.begin(); i != _thumbnailLastUse.end(); ++i) {
+			if (i->_value != _thumbnailUseCount && (oldest == _thumbnailLastUse.end() || i->_value < oldest->_value))
+				oldest = i;
 		}
+
+		if (oldest == _thumbnailLastUse.end())
+			break;
+
+		const Common::String path = oldest->_key;
+		_thumbnailLastUse.erase(oldest);
+
+		const Graphics::ManagedSurface *surf = _loadedSurfaces.getValOrDefault(path);
+		if (surf) {
+			_thumbnailCacheSize -= surf->pitch * surf->h;
+			delete surf;
+		}
+		_loadedSurfaces.erase(path);
 	}
 }
 
+void GridWidget::unloadThumbnails() {
+	unloadSurfaces(_loadedSurfaces);
+	_thumbnailLastUse.clear();
+	_thumbnailCacheSize = 0;
+}
+
 void GridWidget::loadFlagIcons() {
 	const Common::LanguageDescription *l = Common::g_languages;
 	for (; l->code; ++l) {
@@ -929,6 +1087,61 @@ void GridWidget::handleMouseWheel(int x, int y, int direction) {
 	_scrollPos = _scrollBar->_currentPos;
 }
 
+void GridWidget::handleTickle() {
+	const int thumbnailWidth = MAX(_thumbnailWidth - 2 * _thumbnailMargin, 0);
+	const int thumbnailHeight = MAX(_thumbnailHeight - 2 * _thumbnailMargin, 0);
+	bool loadedAny = false;
+
+	for (uint i = 0; i < _thumbnailJobs.size();) {
+		ThumbnailJob *job = _thumbnailJobs[i];
+		bool finished;
+		{
+			Common::StackLock lock(_thumbnailMutex);
+			finished = job->finished;
+		}
+
+		if (!finished) {
+			++i;
+			continue;
+		}
+
+		_thumbnailJobs.remove_at(i);
+
+		if (job->width != thumbnailWidth || job->height != thumbnailHeight || _loadedSurfaces.contains(job->thumbPath)) {
+			// Loaded for an older layout
+			delete job->surface;
+		} else if (!job->loaded) {
+			// It was cancelled before it ran, but it might be back in view
+			if (job->wanted == _thumbnailUseCount)
+				startThumbnailJob(job->thumbPath, job->path, job->enginePath);
+		} else {
+			cacheThumbnail(job->thumbPath, job->surface, job->wanted);
+
+			if (job->surface && job->path != job->thumbPath && !_loadedSurfaces.contains(job->path)) {
+				// Other games of the same engine can use the engine icon
+				// TODO: Use SharedPtr instead of duplicating the surface
+				Graphics::ManagedSurface *thSurf = new Graphics::ManagedSurface();
+				thSurf->copyFrom(*job->surface);
+				cacheThumbnail(job->path, thSurf, job->wanted);
+			}
+
+			for (uint k = 0; k < _gridItems.size(); ++k) {
+				GridItemWidget *item = _gridItems[k];
+				if (item->isVisible() && item->getActiveEntry() && item->getActiveEntry()->thumbPath == job->thumbPath) {
+					item->updateThumb();
+					item->markAsDirty();
+				}
+			}
+			loadedAny = true;
+		}
+
+		delete job;
+	}
+
+	if (loadedAny)
+		trimThumbnailCache();
+}
+
 void GridWidget::handleCommand(CommandSender *sender, uint32 cmd, uint32 data) {
 	// Work in progress
 	switch (cmd) {
@@ -1073,7 +1286,8 @@ void GridWidget::reflowLayout() {
 		unloadSurfaces(_extraIcons);
 		unloadSurfaces(_platformIcons);
 		unloadSurfaces(_languageIcons);
-		unloadSurfaces(_loadedSurfaces);
+		cancelThumbnailJobs();
+		unloadThumbnails();
 		_platformIconsAlpha.clear();
 		_languageIconsAlpha.clear();
 		_extraIconsAlpha.clear();
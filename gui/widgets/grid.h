@@ -24,7 +24,9 @@
 
 #include "gui/dialog.h"
 #include "gui/widgets/scrollbar.h"
+#include "common/mutex.h"
 #include "common/str.h"
+#include "common/threadpool.h"
 
 #include "image/bmp.h"
 #include "image/png.h"
@@ -106,9 +108,29 @@ protected:
 	Common::HashMap<int, Graphics::AlphaType> _languageIconsAlpha;
 	Common::HashMap<int, Graphics::AlphaType> _extraIconsAlpha;
 	Graphics::ManagedSurface *_disabledIconOverlay;
-	// Images are mapped by filename -> surface.
+	// Images are mapped by filename -> surface. A nullptr surface means the
+	// file is missing, thumbnails which are still being loaded have no entry.
 	Common::HashMap<Common::String, const Graphics::ManagedSurface *> _loadedSurfaces;
 
+	// Thumbnails are decoded on the thread pool, only for the visible rows
+	// and a few rows around them. The least recently shown ones are
+	// unloaded once they take up more than kThumbnailCacheSize bytes.
+	struct ThumbnailJob;
+	Common::Array<ThumbnailJob *>				_thumbnailJobs;
+	Common::TaskGroup							_thumbnailTasks;
+	Common::Mutex								_thumbnailMutex;
+	Common::HashMap<Common::String, uint32>		_thumbnailLastUse;
+	uint32										_thumbnailUseCount;
+	uint										_thumbnailCacheSize;
+
+	static void loadThumbnailTask(void *data);
+	void requestThumbnail(const GridItemInfo *entry);
+	void startThumbnailJob(const Common::String &thumbPath, const Common::String &path, const Common::String &enginePath);
+	void cancelThumbnailJobs();
+	void cacheThumbnail(const Common::String &path, const Graphics::ManagedSurface *surf, uint32 lastUse);
+	void trimThumbnailCache();
+	void unloadThumbnails();
+
 	Common::Array<GridItemInfo>			_dataEntryList;
 	Common::Array<GridItemInfo>			_headerEntryList;
 	Common::Array<GridItemInfo *>		_sortedEntryList;
@@ -219,6 +241,7 @@ public:
 
 	void handleMouseWheel(int x, int y, int direction) override;
 	void handleCommand(CommandSender *sender, uint32 cmd, uint32 data) override;
+	void handleTickle() override;
 	void reflowLayout() override;
 
 	bool wantsFocus() override { return true; }
@@ -247,6 +270,7 @@ public:
 	void update();
 	void updateThumb();
 	void setActiveEntry(GridItemInfo &entry);
+	const GridItemInfo *getActiveEntry() const { return _activeEntry; }
 
 	void drawWidget() override;
 
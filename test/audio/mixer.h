@@ -0,0 +1,166 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "audio/audiostream.h"
+#include "audio/mixer_intern.h"
+#include "audio/mixer_kernels.h"
+#include "common/memstream.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+
+class MixerTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		// The null backend cannot answer CPU feature queries
+		Audio::MixerKernels::_mixStereoFunc = Audio::MixerKernels::mixStereoGeneric;
+		Audio::MixerKernels::_dotProductFunc = Audio::MixerKernels::dotProductGeneric;
+	}
+
+	void test_dot_product_matches_generic() {
+		const uint count = 64;
+		int16 samples[count + 1], coeffs[count];
+		for (uint i = 0; i < count + 1; ++i)
+			samples[i] = (int16)((i * 40503) ^ 0x5a5a);
+		for (uint i = 0; i < count; ++i)
+			coeffs[i] = (int16)(i * 1021 - 20000);
+
+		// Also check unaligned input, as the resampler history is not aligned
+		for (uint offset = 0; offset < 2; ++offset) {
+			const int32 expected = Audio::MixerKernels::dotProductGeneric(samples + offset, coeffs, count);
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2)
+				TS_ASSERT_EQUALS(Audio::MixerKernels::dotProductSSE2(samples + offset, coeffs, count), expected);
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8)
+				TS_ASSERT_EQUALS(Audio::MixerKernels::dotProductAVX2(samples + offset, coeffs, count), expected);
+#endif
+#ifdef SCUMMVM_NEON
+			TS_ASSERT_EQUALS(Audio::MixerKernels::dotProductNEON(samples + offset, coeffs, count), expected);
+#endif
+		}
+	}
+
+	void test_kernels_match_generic() {
+		const uint numPairs = 259;
+		int16 src[numPairs * 2], expected[numPairs * 2], actual[numPairs * 2];
+		for (uint i = 0; i < numPairs * 2; ++i)
+			src[i] = (int16)((i * 7919) ^ (i << 11));
+
+		const uint16 volumes[][2] = { { 0, 256 }, { 256, 0 }, { 97, 203 }, { 256, 256 }, { 1, 255 } };
+		for (uint v = 0; v < ARRAYSIZE(volumes); ++v) {
+			for (uint i = 0; i < numPairs * 2; ++i)
+				expected[i] = (int16)(30000 - i * 113);
+			memcpy(actual, expected, sizeof(actual));
+			Audio::MixerKernels::mixStereoGeneric(expected, src, numPairs, volumes[v][0], volumes[v][1]);
+
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2) {
+				int16 tmp[numPairs * 2];
+				memcpy(tmp, actual, sizeof(tmp));
+				Audio::MixerKernels::mixStereoSSE2(tmp, src, numPairs, volumes[v][0], volumes[v][1]);
+				TS_ASSERT_SAME_DATA(tmp, expected, sizeof(tmp));
+			}
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8) {
+				int16 tmp[numPairs * 2];
+				memcpy(tmp, actual, sizeof(tmp));
+				Audio::MixerKernels::mixStereoAVX2(tmp, src, numPairs, volumes[v][0], volumes[v][1]);
+				TS_ASSERT_SAME_DATA(tmp, expected, sizeof(tmp));
+			}
+#endif
+#ifdef SCUMMVM_NEON
+			Audio::MixerKernels::mixStereoNEON(actual, src, numPairs, volumes[v][0], volumes[v][1]);
+			TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+#endif
+		}
+	}
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+	void test_lock_free_output_matches() {
+		Common::install_null_g_system();
+
+		const uint len = 1024 * 4;
+		byte expected[len], actual[len];
+
+		mixSine(false, expected, len);
+		mixSine(true, actual, len);
+		TS_ASSERT_SAME_DATA(actual, expected, len);
+	}
+
+	void test_lock_free_queries() {
+		Common::install_null_g_system();
+
+		Audio::MixerImpl impl(44100);
+		impl.setLockFreeControl(true);
+		impl.setReady(true);
+		Audio::Mixer &mixer = impl;
+
+		Audio::SoundHandle handle;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &handle, createSineStream<int16>(22050, 1, nullptr, false, false), 7);
+
+		// Queries must see the channel before the mixing thread ran
+		TS_ASSERT(mixer.isSoundHandleActive(handle));
+		TS_ASSERT(mixer.isSoundIDActive(7));
+		TS_ASSERT_EQUALS(mixer.getSoundID(handle), 7);
+		TS_ASSERT(mixer.hasActiveChannelOfType(Audio::Mixer::kSFXSoundType));
+		TS_ASSERT(!mixer.hasActiveChannelOfType(Audio::Mixer::kMusicSoundType));
+
+		mixer.setChannelVolume(handle, 42);
+		mixer.setChannelBalance(handle, -17);
+		TS_ASSERT_EQUALS(mixer.getChannelVolume(handle), 42);
+		TS_ASSERT_EQUALS(mixer.getChannelBalance(handle), -17);
+
+		// The sound type settings as well
+		mixer.setVolumeForSoundType(Audio::Mixer::kSFXSoundType, 77);
+		mixer.muteSoundType(Audio::Mixer::kSFXSoundType, true);
+		TS_ASSERT_EQUALS(mixer.getVolumeForSoundType(Audio::Mixer::kSFXSoundType), 77);
+		TS_ASSERT(mixer.isSoundTypeMuted(Audio::Mixer::kSFXSoundType));
+		mixer.muteSoundType(Audio::Mixer::kSFXSoundType, false);
+
+		mixer.setChannelRate(handle, 11025);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 11025u);
+		mixer.resetChannelRate(handle);
+		TS_ASSERT_EQUALS(mixer.getChannelRate(handle), 22050u);
+
+		// Duplicate ids are still rejected
+		Audio::SoundHandle dup;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &dup, createSineStream<int16>(22050, 1, nullptr, false, false), 7);
+		TS_ASSERT(!mixer.isSoundHandleActive(dup));
+
+		mixer.stopHandle(handle);
+		TS_ASSERT(!mixer.isSoundHandleActive(handle));
+		TS_ASSERT(!mixer.isSoundIDActive(7));
+	}
+#endif
+
+private:
+#if NULL_OSYSTEM_IS_AVAILABLE
+	static void mixSine(bool lockFree, byte *out, uint len) {
+		Audio::MixerImpl impl(44100);
+		impl.setLockFreeControl(lockFree);
+		impl.setReady(true);
+		Audio::Mixer &mixer = impl;
+
+		Audio::SoundHandle mono, stereo;
+		mixer.playStream(Audio::Mixer::kSFXSoundType, &mono, createSineStream<int16>(22050, 1, nullptr, false, false), -1, 200, 40);
+		mixer.playStream(Audio::Mixer::kMusicSoundType, &stereo, createSineStream<int16>(32000, 1, nullptr, false, true), -1, 180, -90,
+		                 DisposeAfterUse::YES, false, true);
+		mixer.setVolumeForSoundType(Audio::Mixer::kMusicSoundType, 150);
+
+		const uint quarter = len / 4;
+		impl.mixCallback(out, quarter);
+		mixer.setChannelVolume(mono, 60);
+		mixer.setChannelBalance(stereo, 100);
+		mixer.setVolumeForSoundType(Audio::Mixer::kSFXSoundType, 90);
+		impl.mixCallback(out + quarter, quarter);
+		mixer.muteSoundType(Audio::Mixer::kMusicSoundType, true);
+		impl.mixCallback(out + 2 * quarter, quarter);
+		mixer.muteSoundType(Audio::Mixer::kMusicSoundType, false);
+		mixer.setVolumeForSoundType(Audio::Mixer::kMusicSoundType, 200);
+		impl.mixCallback(out + 3 * quarter, len - 3 * quarter);
+	}
+#endif
+};
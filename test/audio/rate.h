@@ -0,0 +1,138 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/audiostream.h"
+#include "audio/mixer.h"
+#include "audio/mixer_kernels.h"
+#include "audio/rate.h"
+#include "common/memstream.h"
+
+#include "helper.h"
+#include "../null_osystem.h"
+
+class RateConverterTestSuite : public CxxTest::TestSuite {
+public:
+	void setUp() {
+		// Tests run without a backend to answer CPU feature queries
+		Audio::MixerKernels::_mixStereoFunc = Audio::MixerKernels::mixStereoGeneric;
+		Audio::MixerKernels::_dotProductFunc = Audio::MixerKernels::dotProductGeneric;
+	}
+
+	void test_polyphase_length() {
+		// Every input sample should come out, including the filter tail
+		const int outLen = convertSine(11025, 44100, false, false, nullptr, 0);
+		TS_ASSERT_EQUALS(outLen, 44100);
+
+		const int outLenDown = convertSine(48000, 22050, true, true, nullptr, 0);
+		TS_ASSERT_EQUALS(outLenDown, 22050);
+	}
+
+	void test_polyphase_dc() {
+		// A constant signal must pass through unchanged
+		const int inLen = 4000;
+		int16 *in = (int16 *)malloc(inLen * sizeof(int16));
+		for (int i = 0; i < inLen; ++i)
+			in[i] = 12345;
+
+		Audio::AudioStream *stream = Audio::makeRawStream(new Common::MemoryReadStream((const byte *)in, inLen * sizeof(int16), DisposeAfterUse::YES),
+		                                                  22050, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 48000, false, false, false, Audio::kRateConverterPolyphase);
+
+		int16 out[2000];
+		memset(out, 0, sizeof(out));
+		TS_ASSERT_EQUALS(converter->convert(*stream, out, ARRAYSIZE(out), Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume), (int)ARRAYSIZE(out));
+
+		// Skip the filter ramp-in at the start
+		for (uint i = 32; i < ARRAYSIZE(out); ++i)
+			TS_ASSERT_EQUALS(out[i], 12345);
+
+		delete converter;
+		delete stream;
+	}
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+	void test_polyphase_underrun() {
+		// Running out of queued data must not insert silence
+		Common::install_null_g_system();
+		Audio::QueuingAudioStream *stream = Audio::makeQueuingAudioStream(22050, false);
+		Audio::RateConverter *converter = Audio::makeRateConverter(22050, 48000, false, false, false, Audio::kRateConverterPolyphase);
+
+		int16 out[10000];
+		memset(out, 0, sizeof(out));
+		int outLen = 0;
+		for (int chunk = 0; chunk < 3; ++chunk) {
+			int16 *in = (int16 *)malloc(1000 * sizeof(int16));
+			for (int i = 0; i < 1000; ++i)
+				in[i] = 12345;
+			stream->queueBuffer((byte *)in, 1000 * sizeof(int16), DisposeAfterUse::YES, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN);
+
+			// Ask for more than there is, as the mixer does on an underrun
+			outLen += converter->convert(*stream, out + outLen, 2500, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		}
+
+		TS_ASSERT_LESS_THAN(4000, outLen);
+		for (int i = 32; i < outLen; ++i)
+			TS_ASSERT_EQUALS(out[i], 12345);
+
+		// Once the stream ends, the rest of the input comes out
+		stream->finish();
+		outLen += converter->convert(*stream, out + outLen, ARRAYSIZE(out) - outLen, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		TS_ASSERT_LESS_THAN(3000 * 48000 / 22050 - 2, outLen);
+
+		delete converter;
+		delete stream;
+	}
+#endif
+
+	void test_polyphase_sine_amplitude() {
+		// A 1kHz tone well below Nyquist keeps its level and shape
+		int16 out[4000];
+		memset(out, 0, sizeof(out));
+		convertSine(22050, 44100, false, false, out, ARRAYSIZE(out));
+
+		int16 peak = 0;
+		for (uint i = 100; i < ARRAYSIZE(out); ++i)
+			peak = MAX<int16>(peak, ABS(out[i]));
+		TS_ASSERT_LESS_THAN(29000, peak);
+		TS_ASSERT_LESS_THAN(peak, 31000);
+
+		for (uint i = 100; i < ARRAYSIZE(out); ++i) {
+			const double expected = sin(2.0 * M_PI * 1000.0 * i / 44100.0) * 30000.0;
+			TS_ASSERT_LESS_THAN(fabs(out[i] - expected), 400.0);
+		}
+	}
+
+private:
+	/**
+	 * Resample one second of a 1kHz tone. If @p out is null, returns the
+	 * number of output samples until the converter is drained.
+	 */
+	static int convertSine(int inRate, int outRate, bool inStereo, bool outStereo, int16 *out, uint outLen) {
+		const int channels = inStereo ? 2 : 1;
+		int16 *in = (int16 *)malloc(inRate * channels * sizeof(int16));
+		for (int i = 0; i < inRate; ++i) {
+			for (int c = 0; c < channels; ++c)
+				in[i * channels + c] = (int16)(sin(2.0 * M_PI * 1000.0 * i / inRate) * 30000.0);
+		}
+
+		Audio::AudioStream *stream = Audio::makeRawStream(new Common::MemoryReadStream((const byte *)in, inRate * channels * sizeof(int16), DisposeAfterUse::YES),
+		                                                  inRate, Audio::FLAG_16BITS | Audio::FLAG_LITTLE_ENDIAN | (inStereo ? Audio::FLAG_STEREO : 0));
+		Audio::RateConverter *converter = Audio::makeRateConverter(inRate, outRate, inStereo, outStereo, false, Audio::kRateConverterPolyphase);
+
+		int total = 0;
+		if (out) {
+			total = converter->convert(*stream, out, outLen, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+		} else {
+			int16 buffer[512 * 2];
+			while (!stream->endOfData() || converter->needsDraining()) {
+				const int converted = converter->convert(*stream, buffer, 512, Audio::Mixer::kMaxMixerVolume, Audio::Mixer::kMaxMixerVolume);
+				if (converted == 0)
+					break;
+				total += converted;
+			}
+		}
+
+		delete converter;
+		delete stream;
+		return total;
+	}
+};
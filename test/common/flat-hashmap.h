@@ -0,0 +1,299 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/debug.h"
+#include "common/flat-hashmap.h"
+#include "common/hash-str.h"
+#include "common/path.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+#define BENCHMARK_TIME 1
+#else
+#define BENCHMARK_TIME 0
+#endif
+
+class FlatHashMapTestSuite : public CxxTest::TestSuite
+{
+	typedef Common::FlatHashMap<Common::String, Common::String, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> StringMap;
+
+	public:
+	void test_empty_clear() {
+		Common::FlatHashMap<int, int> container;
+		TS_ASSERT(container.empty());
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(!container.empty());
+		container.clear();
+		TS_ASSERT(container.empty());
+
+		StringMap container2;
+		TS_ASSERT(container2.empty());
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(!container2.empty());
+		container2.clear(true);
+		TS_ASSERT(container2.empty());
+		TS_ASSERT(container2.begin() == container2.end());
+	}
+
+	void test_contains() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		TS_ASSERT(container.contains(0));
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.contains(17));
+		TS_ASSERT(!container.contains(-1));
+
+		StringMap container2;
+		container2["foo"] = "bar";
+		container2["quux"] = "blub";
+		TS_ASSERT(container2.contains("foo"));
+		TS_ASSERT(container2.contains("FOO"));
+		TS_ASSERT(container2.contains("quux"));
+		TS_ASSERT(!container2.contains("bar"));
+		TS_ASSERT(!container2.contains("asdf"));
+	}
+
+	void test_add_remove() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		TS_ASSERT(container.contains(1));
+		container.erase(1);
+		TS_ASSERT(!container.contains(1));
+		container[1] = 42;
+		TS_ASSERT(container.contains(1));
+		container.erase(0);
+		TS_ASSERT(!container.empty());
+		container.erase(1);
+		TS_ASSERT(!container.empty());
+		container.erase(2);
+		TS_ASSERT(!container.empty());
+		container.erase(3);
+		TS_ASSERT(!container.empty());
+		container.erase(4);
+		TS_ASSERT(container.empty());
+		container[1] = 33;
+		TS_ASSERT(container.contains(1));
+		TS_ASSERT(!container.empty());
+		container.erase(1);
+		TS_ASSERT(container.empty());
+	}
+
+	void test_lookup() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = -1;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+
+		TS_ASSERT_EQUALS(container[0], 17);
+		TS_ASSERT_EQUALS(container[1], -1);
+		TS_ASSERT_EQUALS(container[2], 45);
+		TS_ASSERT_EQUALS(container[3], 12);
+		TS_ASSERT_EQUALS(container[4], 96);
+
+		int val = 0;
+		TS_ASSERT(container.tryGetVal(2, val));
+		TS_ASSERT_EQUALS(val, 45);
+		TS_ASSERT(!container.tryGetVal(5, val));
+		TS_ASSERT_EQUALS(container.getValOrDefault(5), 0);
+		TS_ASSERT_EQUALS(container.getValOrDefault(5, 7), 7);
+		TS_ASSERT_EQUALS(container.size(), 5u);
+	}
+
+	void test_hash_map_copy() {
+		Common::FlatHashMap<int, int> map1, container2;
+		map1[323] = 32;
+		container2 = map1;
+		TS_ASSERT_EQUALS(container2[323], 32);
+
+		Common::FlatHashMap<int, int> container3(map1);
+		map1[323] = 1;
+		TS_ASSERT_EQUALS(container3[323], 32);
+	}
+
+	void test_collision() {
+		// Keys are chosen so that they end up in the same cluster
+		Common::FlatHashMap<int, int> h;
+		for (int i = 0; i < 12; ++i)
+			h[i * 16] = i;
+		for (int i = 0; i < 12; i += 2)
+			h.erase(i * 16);
+		for (int i = 0; i < 12; ++i) {
+			TS_ASSERT_EQUALS(h.contains(i * 16), (i & 1) != 0);
+			if (i & 1)
+				TS_ASSERT_EQUALS(h[i * 16], i);
+		}
+		TS_ASSERT_EQUALS(h.size(), 6u);
+	}
+
+	void test_iterator() {
+		Common::FlatHashMap<int, int> container;
+		container[0] = 17;
+		container[1] = 33;
+		container[2] = 45;
+		container[3] = 12;
+		container[4] = 96;
+		container.erase(1);
+		container[1] = 42;
+		container.erase(0);
+		container.erase(1);
+
+		int found = 0;
+		Common::FlatHashMap<int, int>::iterator i;
+		for (i = container.begin(); i != container.end(); ++i) {
+			int key = i->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		found = 0;
+		Common::FlatHashMap<int, int>::const_iterator j;
+		for (j = container.begin(); j != container.end(); ++j) {
+			int key = j->_key;
+			TS_ASSERT(key >= 0 && key <= 4);
+			TS_ASSERT(!(found & (1 << key)));
+			found |= 1 << key;
+		}
+		TS_ASSERT(found == 16+8+4);
+
+		TS_ASSERT_EQUALS(container.find(3)->_value, 12);
+		TS_ASSERT(container.find(0) == container.end());
+	}
+
+	void test_erase_while_iterating() {
+		// Nodes are moved back on erasure, which must neither skip nor
+		// revisit any of them
+		Common::FlatHashMap<int, int> container;
+		const int count = 1000;
+		for (int i = 0; i < count; ++i)
+			container[i * 7] = i;
+
+		int visited = 0;
+		for (Common::FlatHashMap<int, int>::iterator i = container.begin(); i != container.end(); ) {
+			visited++;
+			if (i->_value % 3)
+				i = container.erase(i);
+			else
+				++i;
+		}
+		TS_ASSERT_EQUALS(visited, count);
+		TS_ASSERT_EQUALS(container.size(), (uint)(count + 2) / 3);
+		for (int i = 0; i < count; ++i)
+			TS_ASSERT_EQUALS(container.contains(i * 7), i % 3 == 0);
+	}
+
+	void test_iterate_from_find() {
+		// Iterating from a found node visits the nodes after it in the
+		// order of begin(), also when erasing along the way
+		Common::FlatHashMap<int, int> container;
+		const int count = 500;
+		for (int i = 0; i < count; ++i)
+			container[i * 16] = i;
+
+		Common::Array<int> order;
+		for (Common::FlatHashMap<int, int>::const_iterator i = container.begin(); i != container.end(); ++i)
+			order.push_back(i->_key);
+		TS_ASSERT_EQUALS(order.size(), (uint)count);
+
+		const int from = count / 3;
+		uint pos = from;
+		for (Common::FlatHashMap<int, int>::const_iterator i = container.find(order[from]); i != container.end(); ++i, ++pos)
+			TS_ASSERT_EQUALS(i->_key, order[pos]);
+		TS_ASSERT_EQUALS(pos, (uint)count);
+
+		pos = from;
+		for (Common::FlatHashMap<int, int>::iterator i = container.find(order[from]); i != container.end(); ++pos) {
+			TS_ASSERT_EQUALS(i->_key, order[pos]);
+			i = container.erase(i);
+		}
+		TS_ASSERT_EQUALS(pos, (uint)count);
+		TS_ASSERT_EQUALS(container.size(), (uint)from);
+		for (int i = 0; i < from; ++i)
+			TS_ASSERT(container.contains(order[i]));
+	}
+
+	void test_matches_hashmap() {
+		Common::FlatHashMap<uint, uint> flat;
+		Common::HashMap<uint, uint> reference;
+
+		uint seed = 12345;
+		for (int i = 0; i < 20000; ++i) {
+			seed = seed * 1103515245 + 12345;
+			const uint key = (seed >> 8) & 1023;
+			if (seed & 0x10000) {
+				flat.erase(key);
+				reference.erase(key);
+			} else {
+				flat[key] = i;
+				reference[key] = i;
+			}
+		}
+
+		TS_ASSERT_EQUALS(flat.size(), reference.size());
+		for (Common::HashMap<uint, uint>::const_iterator i = reference.begin(); i != reference.end(); ++i)
+			TS_ASSERT_EQUALS(flat.getValOrDefault(i->_key, (uint)-1), i->_value);
+	}
+
+	void test_path_keys() {
+		Common::FlatHashMap<Common::Path, int, Common::Path::IgnoreCase_Hash, Common::Path::IgnoreCase_EqualTo> files;
+		files.reserve(64);
+		files[Common::Path("data/RESOURCE.001")] = 1;
+		files[Common::Path("Resource.Map")] = 2;
+		TS_ASSERT(files.contains(Common::Path("DATA/resource.001")));
+		TS_ASSERT_EQUALS(files[Common::Path("resource.map")], 2);
+		TS_ASSERT(!files.contains(Common::Path("resource.001")));
+	}
+
+	void test_lookup_speed() {
+#if BENCHMARK_TIME
+		Common::install_null_g_system();
+
+#ifdef SLOW_TESTS
+		const int iters = 200;
+#else
+		const int iters = 1;
+#endif
+		const int count = 4096;
+
+		Common::Array<Common::String> keys;
+		for (int i = 0; i < count; ++i)
+			keys.push_back(Common::String::format("Resource%04d.Dat", i * 31));
+
+		uint32 start = g_system->getMillis();
+		int hits = 0;
+		for (int iter = 0; iter < iters; ++iter) {
+			Common::HashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> map;
+			for (int i = 0; i < count; ++i)
+				map[keys[i]] = i;
+			for (int i = 0; i < count * 4; ++i)
+				hits += map.contains(keys[(i * 7) % count]);
+		}
+		const uint32 hashMapTime = g_system->getMillis() - start;
+
+		start = g_system->getMillis();
+		for (int iter = 0; iter < iters; ++iter) {
+			Common::FlatHashMap<Common::String, int, Common::IgnoreCase_Hash, Common::IgnoreCase_EqualTo> map;
+			for (int i = 0; i < count; ++i)
+				map[keys[i]] = i;
+			for (int i = 0; i < count * 4; ++i)
+				hits -= map.contains(keys[(i * 7) % count]);
+		}
+		const uint32 flatTime = g_system->getMillis() - start;
+
+		TS_ASSERT_EQUALS(hits, 0);
+		debug("HashMap insert+lookup time for %d iters (in milliseconds): %u\n", iters, hashMapTime);
+		debug("FlatHashMap insert+lookup time for %d iters (in milliseconds): %u\n", iters, flatTime);
+#endif
+	}
+};
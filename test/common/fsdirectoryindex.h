@@ -0,0 +1,96 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+#include "common/stream.h"
+
+#include "../null_osystem.h"
+
+class FSDirectoryIndexTestSuite : public CxxTest::TestSuite {
+	static bool createFile(const Common::FSNode &dir, const char *name) {
+		Common::ScopedPtr<Common::SeekableWriteStream> stream(dir.getChild(name).createWriteStream());
+		if (!stream)
+			return false;
+
+		stream->writeString(name);
+		return stream->flush() && !stream->err();
+	}
+
+	static bool hasFile(const Common::FSNode &dir, const char *name, bool persistentIndex) {
+		Common::FSDirectory fsDir(dir, 2);
+		fsDir.setPersistentIndex(persistentIndex);
+		return fsDir.hasFile(name);
+	}
+
+	static int countIndexes(const Common::FSNode &configDir) {
+		Common::FSList files;
+		if (!configDir.getChild("fsindex").getChildren(files, Common::FSNode::kListFilesOnly))
+			return 0;
+		return files.size();
+	}
+
+public:
+#if NULL_OSYSTEM_IS_AVAILABLE && TEST_DIRECTORIES_ARE_AVAILABLE
+	void test_index() {
+		Common::install_null_g_system();
+		const Common::String tmp = Common::createTestDirectory();
+		TS_ASSERT(!tmp.empty());
+		if (tmp.empty())
+			return;
+
+		// The indexes are kept next to the configuration file
+		const Common::FSNode configDir(Common::Path(tmp, '/'));
+		ConfMan.loadConfigFile(configDir.getChild("scummvm.ini").getPath(), Common::Path());
+
+		const Common::FSNode game = configDir.getChild("game");
+		const Common::String gamePath = game.getPath().toString('/');
+		TS_ASSERT(game.createDirectory());
+		const Common::FSNode sub = Common::FSNode(game.getPath()).getChild("sub");
+		TS_ASSERT(sub.createDirectory());
+		TS_ASSERT(createFile(game, "a.dat"));
+		TS_ASSERT(createFile(sub, "b.dat"));
+
+		TS_ASSERT(hasFile(game, "a.dat", true));
+		TS_ASSERT(hasFile(game, "sub/b.dat", true));
+		TS_ASSERT_EQUALS(countIndexes(configDir), 1);
+
+		// A file added without changing the time of the directory is not
+		// seen through the index, which shows the listing was reused
+		int64 modificationTime;
+		TS_ASSERT(Common::getTestModificationTime(gamePath, modificationTime));
+		TS_ASSERT(createFile(game, "c.dat"));
+		TS_ASSERT(Common::setTestModificationTime(gamePath, modificationTime));
+		TS_ASSERT(!hasFile(game, "c.dat", true));
+		TS_ASSERT(hasFile(game, "sub/b.dat", true));
+		TS_ASSERT(hasFile(game, "c.dat", false));
+
+		// A change within the same second is enough to list it again
+#if defined(HAS_STAT_MTIM) || defined(HAS_STAT_MTIMESPEC)
+		TS_ASSERT(Common::setTestModificationTime(gamePath, modificationTime + 1000));
+#else
+		TS_ASSERT(Common::setTestModificationTime(gamePath, modificationTime + 1000000000));
+#endif
+		TS_ASSERT(hasFile(game, "c.dat", true));
+		TS_ASSERT(hasFile(game, "sub/b.dat", true));
+
+		// Only the indexes of configured games are kept
+		const Common::FSNode other = configDir.getChild("other");
+		TS_ASSERT(other.createDirectory());
+		TS_ASSERT(createFile(other, "d.dat"));
+		TS_ASSERT(hasFile(other, "d.dat", true));
+		TS_ASSERT_EQUALS(countIndexes(configDir), 2);
+
+		ConfMan.addGameDomain("fsindex-test");
+		ConfMan.set("path", game.getPath().toConfig(), "fsindex-test");
+		Common::FSDirectory::prunePersistentIndexes();
+		TS_ASSERT_EQUALS(countIndexes(configDir), 1);
+
+		ConfMan.removeGameDomain("fsindex-test");
+		Common::FSDirectory::prunePersistentIndexes();
+		TS_ASSERT_EQUALS(countIndexes(configDir), 0);
+
+		Common::removeTestDirectory(tmp);
+	}
+#endif
+};
@@ -0,0 +1,88 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/compression/deflate.h"
+
+class GZipReadStreamTestSuite : public CxxTest::TestSuite {
+	// Big enough for the stream to record a few seek checkpoints
+	static const uint32 kDataSize = 3 * 1024 * 1024 + 123;
+
+	byte *_data;
+	byte *_compressed;
+	uint32 _compressedSize;
+
+	public:
+	void setUp() {
+		// Compressible, but not trivially so, to get many deflate blocks
+		// of different kinds
+		_data = new byte[kDataSize];
+		uint32 seed = 0x12345678;
+		for (uint32 i = 0; i < kDataSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			_data[i] = (byte)((i >> 10) + ((seed >> 24) & 7));
+		}
+
+		Common::MemoryWriteStreamDynamic *memStream = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzStream = Common::wrapCompressedWriteStream(memStream);
+		gzStream->write(_data, kDataSize);
+		gzStream->finalize();
+		_compressed = memStream->getData();
+		_compressedSize = memStream->size();
+		delete gzStream;
+	}
+
+	void tearDown() {
+		delete[] _data;
+		free(_compressed);
+	}
+
+	bool checkRange(Common::SeekableReadStream &stream, uint32 offset, uint32 len) {
+		byte buf[4096];
+		assert(len <= sizeof(buf));
+		if (!stream.seek(offset, SEEK_SET) || stream.pos() != offset)
+			return false;
+		if (stream.read(buf, len) != len)
+			return false;
+		return memcmp(buf, _data + offset, len) == 0;
+	}
+
+	void test_sequential_read() {
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(_compressed, _compressedSize)));
+		TS_ASSERT(stream);
+		TS_ASSERT_EQUALS(stream->size(), kDataSize);
+
+		byte *buf = new byte[kDataSize];
+		TS_ASSERT_EQUALS(stream->read(buf, kDataSize), kDataSize);
+		TS_ASSERT(memcmp(buf, _data, kDataSize) == 0);
+		delete[] buf;
+
+		byte b;
+		TS_ASSERT_EQUALS(stream->read(&b, 1), 0u);
+		TS_ASSERT(stream->eos());
+	}
+
+	void test_seek() {
+		Common::ScopedPtr<Common::SeekableReadStream> stream(Common::wrapCompressedReadStream(
+			new Common::MemoryReadStream(_compressed, _compressedSize)));
+		TS_ASSERT(stream);
+
+		// Forward, then back over checkpoints recorded on the way
+		TS_ASSERT(checkRange(*stream, kDataSize - 1000, 1000));
+		TS_ASSERT(checkRange(*stream, 2 * 1024 * 1024 + 17, 4096));
+		TS_ASSERT(checkRange(*stream, 1024 * 1024 - 5, 4096));
+		TS_ASSERT(checkRange(*stream, 100, 4096));
+		TS_ASSERT(checkRange(*stream, 3 * 1024 * 1024 - 4096, 4096));
+		TS_ASSERT(checkRange(*stream, 1536 * 1024, 4096));
+		TS_ASSERT(checkRange(*stream, 0, 4096));
+
+		// Reading on after a seek continues the stream correctly
+		TS_ASSERT(stream->seek(2500 * 1024, SEEK_SET));
+		byte *buf = new byte[kDataSize];
+		uint32 remaining = kDataSize - 2500 * 1024;
+		TS_ASSERT_EQUALS(stream->read(buf, remaining), remaining);
+		TS_ASSERT(memcmp(buf, _data + 2500 * 1024, remaining) == 0);
+		delete[] buf;
+	}
+};
@@ -0,0 +1,95 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/ptr.h"
+
+#if defined(POSIX) && defined(HAS_MMAP)
+#include "backends/fs/posix/posix-iostream.h"
+#include "backends/fs/posix/posix-mmapstream.h"
+
+// Copied next to the test runner by the test target, and big enough to be mapped
+#define MMAP_TEST_FILE "test/engine-data/encoding.dat"
+#endif
+
+class PosixMmapStreamTestSuite : public CxxTest::TestSuite {
+public:
+#if defined(POSIX) && defined(HAS_MMAP)
+	void test_read() {
+		Common::ScopedPtr<Common::SeekableReadStream> file(PosixIoStream::makeFromPath(MMAP_TEST_FILE, StdioStream::WriteMode_Read));
+		Common::ScopedPtr<PosixMmapStream> mapped(PosixMmapStream::makeFromPath(MMAP_TEST_FILE));
+		TS_ASSERT(file);
+		TS_ASSERT(mapped);
+		if (!file || !mapped)
+			return;
+
+		const int64 size = file->size();
+		TS_ASSERT_LESS_THAN_EQUALS(PosixMmapStream::kMinMappedSize, size);
+		TS_ASSERT_EQUALS(mapped->size(), size);
+
+		byte *expected = new byte[size];
+		byte *actual = new byte[size];
+		TS_ASSERT_EQUALS(file->read(expected, size), (uint32)size);
+
+		// The contents are the same in memory and when read
+		TS_ASSERT(mapped->getDirectData());
+		TS_ASSERT(memcmp(mapped->getDirectData(), expected, size) == 0);
+
+		TS_ASSERT_EQUALS(mapped->read(actual, 1000), 1000u);
+		TS_ASSERT_EQUALS(mapped->read(actual + 1000, size - 1000), (uint32)(size - 1000));
+		TS_ASSERT(!mapped->eos());
+		TS_ASSERT(memcmp(actual, expected, size) == 0);
+
+		// Reading at the end fails and sets eos, like a file
+		TS_ASSERT_EQUALS(mapped->read(actual, 1), 0u);
+		TS_ASSERT(mapped->eos());
+
+		delete[] actual;
+		delete[] expected;
+	}
+
+	void test_seek() {
+		Common::ScopedPtr<PosixMmapStream> mapped(PosixMmapStream::makeFromPath(MMAP_TEST_FILE));
+		TS_ASSERT(mapped);
+		if (!mapped)
+			return;
+
+		const byte *data = mapped->getDirectData();
+		const int64 size = mapped->size();
+
+		TS_ASSERT(mapped->seek(-10, SEEK_END));
+		TS_ASSERT_EQUALS(mapped->pos(), size - 10);
+		TS_ASSERT_EQUALS(mapped->readByte(), data[size - 10]);
+
+		TS_ASSERT(mapped->seek(-5, SEEK_CUR));
+		TS_ASSERT_EQUALS(mapped->pos(), size - 14);
+
+		TS_ASSERT(mapped->seek(100, SEEK_SET));
+		TS_ASSERT_EQUALS(mapped->readByte(), data[100]);
+
+		TS_ASSERT(!mapped->seek(-1, SEEK_SET));
+		TS_ASSERT_EQUALS(mapped->pos(), 101);
+
+		// Reading short of the end returns what is there
+		byte buf[16];
+		TS_ASSERT(mapped->seek(-4, SEEK_END));
+		TS_ASSERT_EQUALS(mapped->read(buf, sizeof(buf)), 4u);
+		TS_ASSERT(mapped->eos());
+		TS_ASSERT(memcmp(buf, data + size - 4, 4) == 0);
+
+		// Seeking clears eos, even past the end where there is nothing to read
+		TS_ASSERT(mapped->seek(100, SEEK_END));
+		TS_ASSERT(!mapped->eos());
+		TS_ASSERT_EQUALS(mapped->read(buf, 1), 0u);
+		TS_ASSERT(mapped->eos());
+
+		// The direct data stays the whole file whatever the position
+		TS_ASSERT_EQUALS(mapped->getDirectData(), data);
+	}
+#endif
+
+	void test_only_files_are_mapped() {
+#if defined(POSIX) && defined(HAS_MMAP)
+		TS_ASSERT(!PosixMmapStream::makeFromPath("test/engine-data"));
+		TS_ASSERT(!PosixMmapStream::makeFromPath("test/engine-data/does-not-exist"));
+#endif
+	}
+};
@@ -0,0 +1,144 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/saves/default/default-saves.h"
+#include "common/config-manager.h"
+#include "common/fs.h"
+#include "common/ptr.h"
+#include "common/savefile.h"
+
+#include "../null_osystem.h"
+
+class SaveFileTestSuite : public CxxTest::TestSuite {
+	static bool writeSave(Common::SaveFileManager &saveMan, const char *name, const Common::String &contents, bool compress = true) {
+		Common::ScopedPtr<Common::OutSaveFile> out(saveMan.openForSaving(name, compress));
+		if (!out)
+			return false;
+
+		out->writeString(contents);
+		out->finalize();
+		return !out->err();
+	}
+
+	static Common::String readSave(Common::SaveFileManager &saveMan, const char *name) {
+		Common::ScopedPtr<Common::InSaveFile> in(saveMan.openForLoading(name));
+		if (!in)
+			return "<missing>";
+		return in->readString();
+	}
+
+	static Common::String makeContents(const char *prefix) {
+		// Large enough to still be written when the engine looks again
+		Common::String contents(prefix);
+		for (int i = 0; i < 20000; ++i)
+			contents += Common::String::format("%d,", i);
+		return contents;
+	}
+
+public:
+#if TEST_WORKER_THREADS_ARE_AVAILABLE && TEST_DIRECTORIES_ARE_AVAILABLE && !defined(DISABLE_DEFAULT_SAVEFILEMANAGER)
+	void test_background_save() {
+		Common::install_null_g_system_with_workers(2);
+		const Common::String tmp = Common::createTestDirectory();
+		TS_ASSERT(!tmp.empty());
+		if (tmp.empty())
+			return;
+		const Common::FSNode saveDir(Common::Path(tmp, '/'));
+		ConfMan.setPath("savepath", saveDir.getPath());
+
+		{
+			DefaultSaveFileManager saveMan;
+			saveMan.setBackgroundSaving(true);
+
+			// Loading waits for the save file to be written
+			const Common::String first = makeContents("first");
+			TS_ASSERT(writeSave(saveMan, "game.sav", first));
+			TS_ASSERT(saveMan.exists("game.sav"));
+			TS_ASSERT_EQUALS(readSave(saveMan, "game.sav"), first);
+
+			// So does saving the same file again
+			const Common::String second = makeContents("second");
+			const Common::String third = makeContents("third");
+			TS_ASSERT(writeSave(saveMan, "game.sav", second));
+			TS_ASSERT(writeSave(saveMan, "game.sav", third));
+			TS_ASSERT(writeSave(saveMan, "raw.sav", second, false));
+			TS_ASSERT(saveMan.checkPendingSaves(true));
+			TS_ASSERT_EQUALS(readSave(saveMan, "game.sav"), third);
+			TS_ASSERT_EQUALS(readSave(saveMan, "raw.sav"), second);
+
+			Common::ScopedPtr<Common::InSaveFile> raw(saveMan.openRawFile("raw.sav"));
+			TS_ASSERT(raw);
+			if (raw)
+				TS_ASSERT_EQUALS(raw->size(), (int64)second.size());
+
+			// No temporary files are left behind
+			TS_ASSERT(!Common::FSNode(saveDir.getChild("game.sav.tmp").getPath()).exists());
+			TS_ASSERT(!Common::FSNode(saveDir.getChild("raw.sav.tmp").getPath()).exists());
+		}
+
+		ConfMan.removeKey("savepath", Common::ConfigManager::kApplicationDomain);
+		Common::removeTestDirectory(tmp);
+	}
+
+	void test_explicit_save() {
+		Common::install_null_g_system_with_workers(2);
+		const Common::String tmp = Common::createTestDirectory();
+		TS_ASSERT(!tmp.empty());
+		if (tmp.empty())
+			return;
+		const Common::FSNode saveDir(Common::Path(tmp, '/'));
+		ConfMan.setPath("savepath", saveDir.getPath());
+
+		{
+			DefaultSaveFileManager saveMan;
+
+			// Without background saving, the file is stored by the time
+			// finalize() returns
+			const Common::String contents = makeContents("explicit");
+			TS_ASSERT(writeSave(saveMan, "game.sav", contents));
+			TS_ASSERT(Common::FSNode(saveDir.getChild("game.sav").getPath()).exists());
+			TS_ASSERT(!Common::FSNode(saveDir.getChild("game.sav.tmp").getPath()).exists());
+			TS_ASSERT_EQUALS(readSave(saveMan, "game.sav"), contents);
+		}
+
+		ConfMan.removeKey("savepath", Common::ConfigManager::kApplicationDomain);
+		Common::removeTestDirectory(tmp);
+	}
+
+	void test_failed_save() {
+		Common::install_null_g_system_with_workers(2);
+		const Common::String tmp = Common::createTestDirectory();
+		TS_ASSERT(!tmp.empty());
+		if (tmp.empty())
+			return;
+		const Common::FSNode saveDir(Common::Path(tmp, '/'));
+		ConfMan.setPath("savepath", saveDir.getPath());
+
+		// A directory in the way of the temporary file keeps the save file
+		// from being created
+		TS_ASSERT(saveDir.getChild("game.sav.tmp").createDirectory());
+
+		{
+			DefaultSaveFileManager saveMan;
+
+			Common::ScopedPtr<Common::OutSaveFile> out(saveMan.openForSaving("game.sav"));
+			TS_ASSERT(!out);
+
+			// Background saves fail right away as well, rather than after
+			// the engine reported success
+			saveMan.setBackgroundSaving(true);
+			out.reset(saveMan.openForSaving("game.sav"));
+			TS_ASSERT(!out);
+
+			TS_ASSERT(saveMan.checkPendingSaves(true));
+			TS_ASSERT(!saveMan.exists("game.sav"));
+
+			// Other save files are still fine
+			TS_ASSERT(writeSave(saveMan, "other.sav", "other"));
+			TS_ASSERT_EQUALS(readSave(saveMan, "other.sav"), "other");
+		}
+
+		ConfMan.removeKey("savepath", Common::ConfigManager::kApplicationDomain);
+		Common::removeTestDirectory(tmp);
+	}
+#endif
+};
@@ -70,4 +70,14 @@ class SeekableSubReadStreamTestSuite : public CxxTest::TestSuite {
 		b = ssrs.readByte();
 		TS_ASSERT_EQUALS(b, 1);
 	}
+
+	void test_direct_data() {
+		byte contents[10] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 };
+		Common::MemoryReadStream ms(contents, 10);
+		TS_ASSERT_EQUALS(ms.getDirectData(), contents);
+
+		Common::SeekableSubReadStream ssrs(&ms, 3, 7);
+		ssrs.readByte();
+		TS_ASSERT_EQUALS(ssrs.getDirectData(), contents + 3);
+	}
 };
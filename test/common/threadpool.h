@@ -0,0 +1,182 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/system.h"
+#include "common/threadpool.h"
+
+#include "../null_osystem.h"
+
+struct RangeRecorder {
+	uint hits[100];
+	uint calls;
+
+	RangeRecorder() : calls(0) {
+		for (uint i = 0; i < 100; ++i)
+			hits[i] = 0;
+	}
+
+	void operator()(uint begin, uint end) {
+		for (uint i = begin; i < end; ++i)
+			hits[i]++;
+		calls++;
+	}
+};
+
+static void addOne(void *data) {
+	(*(int *)data)++;
+}
+
+static void addOneAtomic(void *data) {
+	((Common::Atomic<int> *)data)->fetchAdd(1);
+}
+
+struct SlowTask {
+	Common::Atomic<int> *done;
+	uint delay;
+};
+
+static void runSlowTask(void *data) {
+	SlowTask *task = (SlowTask *)data;
+	g_system->delayMillis(task->delay);
+	task->done->fetchAdd(1);
+}
+
+struct NestedTask {
+	Common::ThreadPool *pool;
+	Common::Atomic<int> *done;
+};
+
+static void runNestedTask(void *data) {
+	NestedTask *task = (NestedTask *)data;
+	Common::TaskGroup group(task->pool);
+	for (int i = 0; i < 8; ++i)
+		group.run(&addOneAtomic, task->done);
+	group.wait();
+}
+
+class ThreadPoolTestSuite : public CxxTest::TestSuite {
+public:
+	void test_no_workers() {
+		Common::ThreadPool pool(nullptr);
+
+		TS_ASSERT_EQUALS(pool.getWorkerCount(), 0U);
+		TS_ASSERT_EQUALS(pool.getConcurrency(), 1U);
+	}
+
+	void test_task_group_runs_inline() {
+		Common::ThreadPool pool(nullptr);
+		Common::TaskGroup group(&pool);
+		int value = 0;
+
+		group.run(&addOne, &value);
+		// Without workers, the task has run already
+		TS_ASSERT_EQUALS(value, 1);
+
+		group.run(&addOne, &value);
+		group.wait();
+		TS_ASSERT_EQUALS(value, 2);
+	}
+
+	void test_parallel_for_covers_range() {
+		Common::ThreadPool pool(nullptr);
+		RangeRecorder recorder;
+		RangeRecorder &ref = recorder;
+
+		Common::parallelFor(10, 90, 7, [&ref](uint begin, uint end) { ref(begin, end); }, &pool);
+
+		for (uint i = 0; i < 100; ++i)
+			TS_ASSERT_EQUALS(recorder.hits[i], (i >= 10 && i < 90) ? 1U : 0U);
+		TS_ASSERT(recorder.calls >= 1);
+	}
+
+	void test_parallel_for_empty_range() {
+		Common::ThreadPool pool(nullptr);
+		RangeRecorder recorder;
+		RangeRecorder &ref = recorder;
+
+		Common::parallelFor(5, 5, 1, [&ref](uint begin, uint end) { ref(begin, end); }, &pool);
+		TS_ASSERT_EQUALS(recorder.calls, 0U);
+	}
+
+#if TEST_WORKER_THREADS_ARE_AVAILABLE
+	void test_workers_started() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+
+		TS_ASSERT_EQUALS(pool.getWorkerCount(), 3U);
+		TS_ASSERT_EQUALS(pool.getConcurrency(), 4U);
+	}
+
+	void test_task_group_with_workers() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		Common::Atomic<int> value(0);
+
+		// More tasks than fit into the queues, so some run inline
+		Common::TaskGroup group(&pool);
+		for (int i = 0; i < 2000; ++i)
+			group.run(&addOneAtomic, &value);
+		group.wait();
+		TS_ASSERT_EQUALS(value.load(), 2000);
+	}
+
+	void test_wait_on_running_tasks() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		Common::Atomic<int> done(0);
+
+		// The waiting thread finds the queues empty while the tasks still
+		// run, and has to sleep until they are done. The group is destroyed
+		// right after, which must not race with the last task.
+		for (int round = 0; round < 20; ++round) {
+			SlowTask tasks[3];
+			Common::TaskGroup group(&pool);
+			for (int i = 0; i < 3; ++i) {
+				tasks[i].done = &done;
+				tasks[i].delay = 5 + i;
+				group.run(&runSlowTask, &tasks[i]);
+			}
+			group.wait();
+			TS_ASSERT_EQUALS(done.load(), (round + 1) * 3);
+		}
+	}
+
+	void test_nested_task_groups() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		Common::Atomic<int> done(0);
+
+		NestedTask tasks[16];
+		{
+			Common::TaskGroup group(&pool);
+			for (int i = 0; i < 16; ++i) {
+				tasks[i].pool = &pool;
+				tasks[i].done = &done;
+				group.run(&runNestedTask, &tasks[i]);
+			}
+		}
+		TS_ASSERT_EQUALS(done.load(), 16 * 8);
+	}
+
+	void test_parallel_for_with_workers() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		Common::Atomic<int> hits[1000];
+		Common::Atomic<int> *ref = hits;
+		for (int i = 0; i < 1000; ++i)
+			hits[i].store(0);
+
+		Common::parallelFor(0, 1000, 3, [ref](uint begin, uint end) {
+			for (uint i = begin; i < end; ++i)
+				ref[i].fetchAdd(1);
+		}, &pool);
+
+		int wrong = 0;
+		for (int i = 0; i < 1000; ++i) {
+			if (hits[i].load() != 1)
+				wrong++;
+		}
+		TS_ASSERT_EQUALS(wrong, 0);
+	}
+#endif
+};
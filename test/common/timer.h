@@ -0,0 +1,125 @@
+#include <cxxtest/TestSuite.h>
+
+#include "backends/timer/default/default-timer.h"
+#include "common/system.h"
+
+#include "../null_osystem.h"
+
+class TimerTestSuite : public CxxTest::TestSuite {
+	struct TimerLog {
+		DefaultTimerManager *manager;
+		Common::String calls;
+		int removeAfter[4];
+		Common::TimerManager::TimerProc removes[4];
+		int counts[4];
+
+		TimerLog(DefaultTimerManager *m) : manager(m) {
+			for (int i = 0; i < 4; ++i) {
+				removeAfter[i] = 0;
+				removes[i] = nullptr;
+				counts[i] = 0;
+			}
+		}
+	};
+
+	static TimerLog *_log;
+
+	// Logs the call, and removes a timer once the callback was called
+	// often enough
+	static void call(int index) {
+		_log->calls += (char)('A' + index);
+		_log->counts[index]++;
+		if (_log->removes[index] && _log->counts[index] == _log->removeAfter[index])
+			_log->manager->removeTimerProc(_log->removes[index]);
+	}
+
+	static void timerA(void *refCon) { call(0); }
+	static void timerB(void *refCon) { call(1); }
+	static void timerC(void *refCon) { call(2); }
+	static void timerD(void *refCon) { call(3); }
+
+public:
+#if NULL_OSYSTEM_IS_AVAILABLE
+	void test_firing_order() {
+		Common::install_null_g_system();
+		DefaultTimerManager manager;
+		TimerLog log(&manager);
+		_log = &log;
+
+		// Due at 4, 8, 12 and 16 ms, and at 7 and 14 ms. Should B be
+		// installed a millisecond later, its first deadline moves to the
+		// same one as the second one of A, and it still goes first as it
+		// has been waiting longer.
+		manager.installTimerProc(&timerA, 4000, nullptr, "A");
+		manager.installTimerProc(&timerB, 7000, nullptr, "B");
+
+		// Timers which fell behind are called once for every deadline
+		g_system->delayMillis(17);
+		manager.handler();
+		TS_ASSERT(log.calls.hasPrefix("ABAABA"));
+
+		DefaultTimerManager::TimerStats stats;
+		TS_ASSERT(manager.getTimerStats(&timerA, stats));
+		TS_ASSERT_EQUALS(stats.id, "A");
+		TS_ASSERT_EQUALS(stats.interval, 4000u);
+		TS_ASSERT_LESS_THAN_EQUALS(4u, stats.calls);
+		TS_ASSERT_LESS_THAN_EQUALS(1u, stats.missedDeadlines);
+
+		Common::Array<DefaultTimerManager::TimerStats> all;
+		manager.getAllTimerStats(all);
+		TS_ASSERT_EQUALS(all.size(), 2u);
+
+		manager.removeTimerProc(&timerA);
+		manager.removeTimerProc(&timerB);
+		TS_ASSERT(!manager.getTimerStats(&timerA, stats));
+		_log = nullptr;
+	}
+
+	void test_remove_in_callback() {
+		Common::install_null_g_system();
+		DefaultTimerManager manager;
+		TimerLog log(&manager);
+		_log = &log;
+
+		// A removes itself on its second call, although more of its
+		// deadlines have passed. B removes C before C is first due, and
+		// D keeps running.
+		log.removes[0] = &timerA;
+		log.removeAfter[0] = 2;
+		log.removes[1] = &timerC;
+		log.removeAfter[1] = 1;
+		manager.installTimerProc(&timerA, 1000, nullptr, "A");
+		manager.installTimerProc(&timerB, 2000, nullptr, "B");
+		manager.installTimerProc(&timerC, 4000, nullptr, "C");
+		manager.installTimerProc(&timerD, 3000, nullptr, "D");
+
+		g_system->delayMillis(10);
+		manager.handler();
+		TS_ASSERT_EQUALS(log.counts[0], 2);
+		TS_ASSERT_LESS_THAN_EQUALS(1, log.counts[1]);
+		TS_ASSERT_EQUALS(log.counts[2], 0);
+		TS_ASSERT_LESS_THAN_EQUALS(1, log.counts[3]);
+
+		DefaultTimerManager::TimerStats stats;
+		TS_ASSERT(!manager.getTimerStats(&timerA, stats));
+		TS_ASSERT(!manager.getTimerStats(&timerC, stats));
+		TS_ASSERT(manager.getTimerStats(&timerD, stats));
+
+		// The removed timers stay removed, and can be installed again
+		const int callsD = log.counts[3];
+		g_system->delayMillis(5);
+		manager.handler();
+		TS_ASSERT_EQUALS(log.counts[0], 2);
+		TS_ASSERT_EQUALS(log.counts[2], 0);
+		TS_ASSERT_LESS_THAN(callsD, log.counts[3]);
+		TS_ASSERT(manager.installTimerProc(&timerC, 4000, nullptr, "C"));
+
+		manager.removeTimerProc(&timerB);
+		manager.removeTimerProc(&timerC);
+		manager.removeTimerProc(&timerD);
+		_log = nullptr;
+	}
+#endif
+};
+
+TimerTestSuite::TimerLog *TimerTestSuite::_log = nullptr;
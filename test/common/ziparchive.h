@@ -0,0 +1,378 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/archive.h"
+#include "common/crc.h"
+#include "common/memstream.h"
+#include "common/ptr.h"
+#include "common/system.h"
+#include "common/threadpool.h"
+#include "common/compression/deflate.h"
+#include "common/compression/unzip.h"
+
+#include "../null_osystem.h"
+
+class ZipArchiveTestSuite : public CxxTest::TestSuite {
+	// Big enough to be read while it is used instead of all at once
+	static const uint32 kLargeSize = 2 * 1024 * 1024 + 77;
+	// Start of a second large member within the data of the first one
+	static const uint32 kOtherOffset = 4097;
+
+	struct Member {
+		Common::String name;
+		const byte *data;
+		uint32 size;
+		bool deflate;
+		bool badCrc;
+	};
+
+	byte *_large;
+	byte _small1[1000];
+	byte _small2[3000];
+
+	public:
+	void setUp() {
+		_large = new byte[kLargeSize];
+		uint32 seed = 0x87654321;
+		for (uint32 i = 0; i < kLargeSize; i++) {
+			seed = seed * 1103515245 + 12345;
+			_large[i] = (byte)((i >> 12) + ((seed >> 24) & 3));
+		}
+		for (uint32 i = 0; i < sizeof(_small1); i++)
+			_small1[i] = (byte)(i % 7);
+		for (uint32 i = 0; i < sizeof(_small2); i++)
+			_small2[i] = (byte)(i % 13 + i / 100);
+	}
+
+	void tearDown() {
+		delete[] _large;
+	}
+
+	// Raw deflate data is the body of a gzip stream
+	static byte *deflate(const byte *data, uint32 size, uint32 &compressedSize) {
+		Common::MemoryWriteStreamDynamic *memStream = new Common::MemoryWriteStreamDynamic(DisposeAfterUse::NO);
+		Common::WriteStream *gzStream = Common::wrapCompressedWriteStream(memStream);
+		gzStream->write(data, size);
+		gzStream->finalize();
+
+		// Skip the gzip header and trailer
+		byte *gzData = memStream->getData();
+		assert(memStream->size() > 18 && gzData[3] == 0);
+		compressedSize = memStream->size() - 18;
+		byte *compressed = new byte[compressedSize];
+		memcpy(compressed, gzData + 10, compressedSize);
+		free(gzData);
+		delete gzStream;
+		return compressed;
+	}
+
+	static Common::SeekableReadStream *makeZip(const Member *members, int count) {
+		Common::MemoryWriteStreamDynamic zip(DisposeAfterUse::NO);
+		Common::MemoryWriteStreamDynamic centralDir(DisposeAfterUse::YES);
+		Common::CRC32 crc32;
+
+		for (int i = 0; i < count; i++) {
+			const Member &member = members[i];
+			uint32 crc = crc32.crcFast(member.data, member.size);
+			if (member.badCrc)
+				crc ^= 1;
+
+			const byte *data = member.data;
+			uint32 dataSize = member.size;
+			byte *compressed = nullptr;
+			if (member.deflate)
+				data = compressed = deflate(member.data, member.size, dataSize);
+
+			const uint32 offset = zip.pos();
+			zip.writeUint32LE(0x04034b50);
+			zip.writeUint16LE(20);
+			zip.writeUint16LE(0);
+			zip.writeUint16LE(member.deflate ? 8 : 0);
+			zip.writeUint32LE(0);
+			zip.writeUint32LE(crc);
+			zip.writeUint32LE(dataSize);
+			zip.writeUint32LE(member.size);
+			zip.writeUint16LE(member.name.size());
+			zip.writeUint16LE(0);
+			zip.writeString(member.name);
+			zip.write(data, dataSize);
+
+			centralDir.writeUint32LE(0x02014b50);
+			centralDir.writeUint16LE(20);
+			centralDir.writeUint16LE(20);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(member.deflate ? 8 : 0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(crc);
+			centralDir.writeUint32LE(dataSize);
+			centralDir.writeUint32LE(member.size);
+			centralDir.writeUint16LE(member.name.size());
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint16LE(0);
+			centralDir.writeUint32LE(0);
+			centralDir.writeUint32LE(offset);
+			centralDir.writeString(member.name);
+
+			delete[] compressed;
+		}
+
+		const uint32 centralDirOffset = zip.pos();
+		zip.write(centralDir.getData(), centralDir.size());
+		zip.writeUint32LE(0x06054b50);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(0);
+		zip.writeUint16LE(count);
+		zip.writeUint16LE(count);
+		zip.writeUint32LE(centralDir.size());
+		zip.writeUint32LE(centralDirOffset);
+		zip.writeUint16LE(0);
+
+		return new Common::MemoryReadStream(zip.getData(), zip.size(), DisposeAfterUse::YES);
+	}
+
+	bool checkRange(Common::SeekableReadStream &stream, const byte *data, uint32 offset, uint32 len) {
+		byte buf[4096];
+		assert(len <= sizeof(buf));
+		if (!stream.seek(offset, SEEK_SET) || stream.pos() != offset)
+			return false;
+		if (stream.read(buf, len) != len)
+			return false;
+		return memcmp(buf, data + offset, len) == 0;
+	}
+
+	bool checkContents(Common::SeekableReadStream *stream, const byte *data, uint32 size) {
+		if (!stream || stream->size() != size)
+			return false;
+
+		byte *buf = new byte[size];
+		const bool ok = stream->read(buf, size) == size && memcmp(buf, data, size) == 0 && !stream->err();
+		delete[] buf;
+		return ok;
+	}
+
+	struct ChunkReader {
+		Common::SeekableReadStream *stream;
+		const byte *data;
+		uint32 size;
+		uint32 pos;
+		bool ok;
+
+		// Read the next chunk in order, without seeking
+		void readChunk(uint32 len) {
+			byte buf[4096];
+			len = MIN(len, MIN<uint32>(sizeof(buf), size - pos));
+			if (stream->read(buf, len) != len || memcmp(buf, data + pos, len) != 0)
+				ok = false;
+			pos += len;
+		}
+
+		// Small reads, so that other threads get plenty of chances to
+		// seek the zipfile stream in between
+		void operator()() {
+			while (ok && pos < size)
+				readChunk(64 + pos % 200);
+		}
+	};
+
+	Common::Archive *makeAlternatingZip() {
+		const Member members[] = {
+			{ "stored.bin", _large, kLargeSize, false, false },
+			{ "other.bin", _large + kOtherOffset, kLargeSize - kOtherOffset, false, false },
+			{ "deflated.bin", _large, kLargeSize, true, false },
+			{ "small.bin", _small1, sizeof(_small1), true, false }
+		};
+		return Common::makeZipArchive(makeZip(members, ARRAYSIZE(members)));
+	}
+
+	// Read from the zipfile stream through the archive itself: its central
+	// directory, and the local header and data of a newly opened member
+	bool checkArchive(Common::Archive &archive) {
+		if (archive.isPathDirectory("small.bin"))
+			return false;
+		Common::ScopedPtr<Common::SeekableReadStream> stream(archive.createReadStreamForMember("stored.bin"));
+		return stream && checkRange(*stream, _large, 123456, 4096);
+	}
+
+#if NULL_OSYSTEM_IS_AVAILABLE
+	void test_large_members() {
+		Common::install_null_g_system();
+		const Member members[] = {
+			{ "stored.bin", _large, kLargeSize, false, false },
+			{ "deflated.bin", _large, kLargeSize, true, false },
+			{ "small.bin", _small1, sizeof(_small1), true, false }
+		};
+		Common::ScopedPtr<Common::Archive> archive(Common::makeZipArchive(makeZip(members, ARRAYSIZE(members))));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> deflated(archive->createReadStreamForMember("deflated.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> small(archive->createReadStreamForMember("small.bin"));
+
+		// The members stay readable once the archive is gone
+		archive.reset();
+
+		TS_ASSERT(checkContents(stored.get(), _large, kLargeSize));
+		TS_ASSERT(checkContents(deflated.get(), _large, kLargeSize));
+		TS_ASSERT(checkContents(small.get(), _small1, sizeof(_small1)));
+
+		for (Common::SeekableReadStream *stream : { stored.get(), deflated.get() }) {
+			TS_ASSERT(checkRange(*stream, _large, kLargeSize - 1000, 1000));
+			TS_ASSERT(checkRange(*stream, _large, 1536 * 1024 + 3, 4096));
+			TS_ASSERT(checkRange(*stream, _large, 10, 4096));
+			TS_ASSERT(!stream->err());
+		}
+	}
+
+	void test_alternating_members() {
+		Common::install_null_g_system();
+		Common::ScopedPtr<Common::Archive> archive(makeAlternatingZip());
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> other(archive->createReadStreamForMember("other.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> deflated(archive->createReadStreamForMember("deflated.bin"));
+		TS_ASSERT(stored && other && deflated);
+		if (!stored || !other || !deflated)
+			return;
+
+		// Each member keeps its own position in the shared zipfile stream,
+		// also when the archive reads other members in between
+		ChunkReader readers[] = {
+			{ stored.get(), _large, kLargeSize, 0, true },
+			{ other.get(), _large + kOtherOffset, kLargeSize - kOtherOffset, 0, true },
+			{ deflated.get(), _large, kLargeSize, 0, true }
+		};
+		for (uint32 i = 0; readers[0].pos < kLargeSize; i++) {
+			for (ChunkReader &reader : readers)
+				reader.readChunk(1000 + (i % 7) * 500);
+			if (i % 100 == 0)
+				TS_ASSERT(checkArchive(*archive));
+		}
+		for (ChunkReader &reader : readers) {
+			reader();
+			TS_ASSERT(reader.ok);
+			TS_ASSERT_EQUALS(reader.pos, reader.size);
+			TS_ASSERT(!reader.stream->err());
+		}
+	}
+
+#if TEST_WORKER_THREADS_ARE_AVAILABLE
+	void test_members_on_threads() {
+		Common::install_null_g_system_with_workers(4);
+		Common::ScopedPtr<Common::Archive> archive(makeAlternatingZip());
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stored(archive->createReadStreamForMember("stored.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> other(archive->createReadStreamForMember("other.bin"));
+		Common::ScopedPtr<Common::SeekableReadStream> deflated(archive->createReadStreamForMember("deflated.bin"));
+		TS_ASSERT(stored && other && deflated);
+		if (!stored || !other || !deflated)
+			return;
+
+		ChunkReader readers[] = {
+			{ stored.get(), _large, kLargeSize, 0, true },
+			{ other.get(), _large + kOtherOffset, kLargeSize - kOtherOffset, 0, true },
+			{ deflated.get(), _large, kLargeSize, 0, true }
+		};
+		Common::TaskGroup group(g_system->getThreadPool());
+		for (ChunkReader &reader : readers)
+			group.run(reader);
+
+		// The archive keeps reading from the zipfile meanwhile
+		for (int i = 0; i < 50; i++)
+			TS_ASSERT(checkArchive(*archive));
+		group.wait();
+
+		for (ChunkReader &reader : readers) {
+			TS_ASSERT(reader.ok);
+			TS_ASSERT_EQUALS(reader.pos, reader.size);
+		}
+	}
+#endif
+
+	void test_crc_mismatch() {
+		Common::install_null_g_system();
+		const Member members[] = {
+			{ "stored.bin", _large, kLargeSize, false, true },
+			{ "deflated.bin", _large, kLargeSize, true, true },
+			{ "small.bin", _small1, sizeof(_small1), true, true }
+		};
+		Common::ScopedPtr<Common::Archive> archive(Common::makeZipArchive(makeZip(members, ARRAYSIZE(members))));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		// Small members are checked when they are opened
+		TS_ASSERT(!archive->createReadStreamForMember("small.bin"));
+
+		// Large members once they have been read to the end. Without seek
+		// checkpoints in zlib, deflated ones are still inflated, and checked,
+		// when they are opened.
+		TS_ASSERT(archive->hasFile("deflated.bin"));
+		for (const char *name : { "stored.bin", "deflated.bin" }) {
+			Common::ScopedPtr<Common::SeekableReadStream> stream(archive->createReadStreamForMember(name));
+			if (!stream) {
+				TS_ASSERT(strcmp(name, "deflated.bin") == 0);
+				continue;
+			}
+
+			byte *buf = new byte[kLargeSize];
+			TS_ASSERT_EQUALS(stream->read(buf, kLargeSize / 2), kLargeSize / 2);
+			TS_ASSERT(!stream->err());
+			TS_ASSERT_EQUALS(stream->read(buf + kLargeSize / 2, kLargeSize), kLargeSize - kLargeSize / 2);
+			TS_ASSERT(stream->err());
+			TS_ASSERT(memcmp(buf, _large, kLargeSize) == 0);
+			delete[] buf;
+		}
+	}
+
+	void test_read_streams_for_members() {
+		Common::install_null_g_system();
+		const Member members[] = {
+			{ "one.bin", _small1, sizeof(_small1), true, false },
+			{ "two.bin", _small2, sizeof(_small2), false, false },
+			{ "three.bin", _small2, sizeof(_small2), true, false },
+			{ "large.bin", _large, kLargeSize, true, false },
+			{ "bad.bin", _small1, sizeof(_small1), true, true }
+		};
+		Common::ScopedPtr<Common::Archive> archive(Common::makeZipArchive(makeZip(members, ARRAYSIZE(members))));
+		TS_ASSERT(archive);
+		if (!archive)
+			return;
+
+		// Cached members are mixed with ones still to be read
+		delete archive->createReadStreamForMember("two.bin");
+
+		Common::Array<Common::Path> paths;
+		paths.push_back("three.bin");
+		paths.push_back("missing.bin");
+		paths.push_back("ONE.BIN");
+		paths.push_back("two.bin");
+		paths.push_back("large.bin");
+		paths.push_back("bad.bin");
+
+		Common::Array<Common::SeekableReadStream *> streams;
+		TS_ASSERT_EQUALS(archive->createReadStreamsForMembers(paths, streams), 4);
+		TS_ASSERT_EQUALS(streams.size(), paths.size());
+		if (streams.size() != paths.size())
+			return;
+
+		TS_ASSERT(checkContents(streams[0], _small2, sizeof(_small2)));
+		TS_ASSERT(!streams[1]);
+		TS_ASSERT(checkContents(streams[2], _small1, sizeof(_small1)));
+		TS_ASSERT(checkContents(streams[3], _small2, sizeof(_small2)));
+		TS_ASSERT(checkContents(streams[4], _large, kLargeSize));
+		TS_ASSERT(!streams[5]);
+
+		for (Common::SeekableReadStream *stream : streams)
+			delete stream;
+	}
+#endif
+};
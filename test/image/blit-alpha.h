@@ -0,0 +1,176 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "graphics/blit.h"
+#include "graphics/blit/blit-alpha.h"
+
+class BlitAlphaTestSuite : public CxxTest::TestSuite {
+public:
+	void test_color_key_kernels() {
+		const uint w = 37;
+		uint32 src[w], expected[w];
+		fillPixels(src, w, 1);
+		Graphics::AlphaKernels::ColorKeyArgs args;
+		args.rgbMask = 0xffffff00;
+		args.keyPix = src[3] & args.rgbMask;
+		args.newPix = 0x12345600;
+		args.alphaMask = 0x000000ff;
+		src[8] = src[33] = src[3];
+
+		for (int overwriteAlpha = 0; overwriteAlpha < 2; ++overwriteAlpha) {
+			args.overwriteAlpha = overwriteAlpha != 0;
+			fillPixels(expected, w, 2);
+			Graphics::AlphaKernels::applyColorKeyGeneric(expected, src, w, args);
+
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2) {
+				uint32 actual[w];
+				fillPixels(actual, w, 2);
+				Graphics::AlphaKernels::applyColorKeySSE2(actual, src, w, args);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8) {
+				uint32 actual[w];
+				fillPixels(actual, w, 2);
+				Graphics::AlphaKernels::applyColorKeyAVX2(actual, src, w, args);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+#ifdef SCUMMVM_NEON
+			{
+				uint32 actual[w];
+				fillPixels(actual, w, 2);
+				Graphics::AlphaKernels::applyColorKeyNEON(actual, src, w, args);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+		}
+	}
+
+	void test_set_alpha_kernels() {
+		const uint w = 37;
+		uint32 src[w], expected[w];
+		fillPixels(src, w, 3);
+		Graphics::AlphaKernels::SetAlphaArgs args;
+		args.rgbMask = 0xffffff00;
+		args.newAlpha = 0x0000007f;
+		args.alphaMask = 0x000000ff;
+
+		for (int skipTransparent = 0; skipTransparent < 2; ++skipTransparent) {
+			args.skipTransparent = skipTransparent != 0;
+			Graphics::AlphaKernels::setAlphaGeneric(expected, src, w, args);
+
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2) {
+				uint32 actual[w];
+				Graphics::AlphaKernels::setAlphaSSE2(actual, src, w, args);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8) {
+				uint32 actual[w];
+				Graphics::AlphaKernels::setAlphaAVX2(actual, src, w, args);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+#ifdef SCUMMVM_NEON
+			{
+				uint32 actual[w];
+				Graphics::AlphaKernels::setAlphaNEON(actual, src, w, args);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+		}
+	}
+
+	void test_blend_blit_kernels() {
+		const uint32 colors[] = { 0xffffffff, 0x80c040ff, 0xffffff7f, 0x80c0407f };
+		const Graphics::BlendBlit::BlitFunc oldFunc = Graphics::BlendBlit::blitFunc;
+
+		for (int blendMode = 0; blendMode < Graphics::NUM_BLEND_MODES; blendMode++) {
+		for (int alphaType = 0; alphaType <= Graphics::ALPHA_FULL; alphaType++) {
+		for (int flipping = 0; flipping <= 3; flipping++) {
+		for (uint color = 0; color < ARRAYSIZE(colors); color++) {
+		for (int scaled = 0; scaled < 2; scaled++) {
+			uint32 expected[kDstW * kDstH];
+			blendBlit(Graphics::BlendBlit::blitGeneric, expected, scaled != 0, colors[color], flipping,
+			          (Graphics::TSpriteBlendMode)blendMode, (Graphics::AlphaType)alphaType);
+
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2) {
+				uint32 actual[kDstW * kDstH];
+				blendBlit(Graphics::BlendBlit::blitSSE2, actual, scaled != 0, colors[color], flipping,
+				          (Graphics::TSpriteBlendMode)blendMode, (Graphics::AlphaType)alphaType);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8) {
+				uint32 actual[kDstW * kDstH];
+				blendBlit(Graphics::BlendBlit::blitAVX2, actual, scaled != 0, colors[color], flipping,
+				          (Graphics::TSpriteBlendMode)blendMode, (Graphics::AlphaType)alphaType);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+#ifdef SCUMMVM_NEON
+			{
+				uint32 actual[kDstW * kDstH];
+				blendBlit(Graphics::BlendBlit::blitNEON, actual, scaled != 0, colors[color], flipping,
+				          (Graphics::TSpriteBlendMode)blendMode, (Graphics::AlphaType)alphaType);
+				TS_ASSERT_SAME_DATA(actual, expected, sizeof(actual));
+			}
+#endif
+		} // scaled
+		} // color
+		} // flipping
+		} // alpha
+		} // blend
+
+		Graphics::BlendBlit::blitFunc = oldFunc;
+	}
+
+private:
+	static const uint kSrcW = 19, kSrcH = 13;
+	static const uint kDstW = 40, kDstH = 28;
+
+	/** Fill with pseudo random pixels, with a good share of fully opaque and transparent ones. */
+	static void fillPixels(uint32 *pixels, uint count, uint32 seed) {
+		for (uint i = 0; i < count; ++i) {
+			seed = seed * 1103515245 + 12345;
+			uint32 pix = seed ^ (seed >> 13) * 2654435761u;
+			switch ((seed >> 16) % 3) {
+			case 0:
+				pix &= 0xffffff00;
+				break;
+			case 1:
+				pix |= 0x000000ff;
+				break;
+			default:
+				break;
+			}
+			pixels[i] = pix;
+		}
+	}
+
+	static void blendBlit(Graphics::BlendBlit::BlitFunc func, uint32 *dst, bool scaled, uint32 color, int flipping,
+	                      Graphics::TSpriteBlendMode blendMode, Graphics::AlphaType alphaType) {
+		uint32 src[kSrcW * kSrcH];
+		fillPixels(src, kSrcW * kSrcH, 4);
+		fillPixels(dst, kDstW * kDstH, 5);
+
+		Graphics::BlendBlit::blitFunc = func;
+		if (scaled) {
+			const uint w = kDstW - 3, h = kDstH - 3;
+			Graphics::BlendBlit::blit((byte *)dst, (const byte *)src, kDstW * 4, kSrcW * 4, 1, 2, w, h,
+			                          Graphics::BlendBlit::getScaleFactor(kSrcW, w), Graphics::BlendBlit::getScaleFactor(kSrcH, h),
+			                          0, 0, color, flipping, blendMode, alphaType);
+		} else {
+			Graphics::BlendBlit::blit((byte *)dst, (const byte *)src, kDstW * 4, kSrcW * 4, 3, 2, kSrcW, kSrcH,
+			                          Graphics::BlendBlit::SCALE_THRESHOLD, Graphics::BlendBlit::SCALE_THRESHOLD,
+			                          0, 0, color, flipping, blendMode, alphaType);
+		}
+	}
+};
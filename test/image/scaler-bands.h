@@ -0,0 +1,86 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "graphics/scalerplugin.h"
+#include "graphics/scaler/edge.h"
+#include "graphics/scaler/hq.h"
+
+#include "../null_osystem.h"
+
+class ScalerBandsTestSuite : public CxxTest::TestSuite {
+public:
+#if TEST_WORKER_THREADS_ARE_AVAILABLE
+	void test_hq_bands() {
+		const Graphics::PixelFormat format(2, 5, 6, 5, 0, 11, 5, 0, 0);
+		for (uint factor = 2; factor <= 3; ++factor) {
+			HQScaler serial(format), banded(format);
+			checkBands(&serial, &banded, format, factor, false);
+		}
+	}
+
+	void test_edge_bands() {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		for (uint factor = 2; factor <= 3; ++factor) {
+			// The lookup tables make these too large for the stack
+			EdgeScaler *serial = new EdgeScaler(format);
+			EdgeScaler *banded = new EdgeScaler(format);
+			checkBands(serial, banded, format, factor, true);
+			delete serial;
+			delete banded;
+		}
+	}
+#endif
+
+private:
+	static const int kWidth = 256, kHeight = 160, kPadding = 4;
+
+	static void checkBands(Scaler *serial, Scaler *banded, const Graphics::PixelFormat &format, uint factor, bool useOldSource) {
+		const int bpp = format.bytesPerPixel;
+		const int srcPitch = (kWidth + kPadding * 2) * bpp;
+		const int dstPitch = kWidth * factor * bpp;
+		const int srcSize = (kHeight + kPadding * 2) * srcPitch;
+		const int dstSize = kHeight * factor * dstPitch;
+		byte *src = new byte[srcSize]();
+		byte *expected = new byte[dstSize]();
+		byte *actual = new byte[dstSize]();
+
+		// The scalers split large rects over the threads of g_system
+		Common::install_null_g_system();
+		OSystem *serialSystem = g_system;
+		Common::install_null_g_system_with_workers(4);
+		OSystem *bandedSystem = g_system;
+
+		serial->setFactor(factor);
+		banded->setFactor(factor);
+		if (useOldSource) {
+			serial->enableSource(true);
+			banded->enableSource(true);
+			serial->setSource(src, srcPitch, kWidth, kHeight, kPadding);
+			banded->setSource(src, srcPitch, kWidth, kHeight, kPadding);
+		}
+
+		uint32 seed = 1;
+		for (int frame = 0; frame < 3; ++frame) {
+			// Change a few pixels between frames, to exercise the old source
+			for (int i = 0; i < srcSize; ++i) {
+				seed = seed * 1103515245 + 12345;
+				if (frame == 0 || (seed >> 16) % 40 == 0)
+					src[i] = (seed >> 24) & 0xe0;
+			}
+
+			const int x = frame * 3, y = frame * 5;
+			const int w = kWidth - x * 2, h = kHeight - y * 2;
+			const byte *srcPtr = src + (kPadding + y) * srcPitch + (kPadding + x) * bpp;
+			const int dstOffset = y * factor * dstPitch + x * factor * bpp;
+			g_system = serialSystem;
+			serial->scale(srcPtr, srcPitch, expected + dstOffset, dstPitch, w, h, x, y);
+			g_system = bandedSystem;
+			banded->scale(srcPtr, srcPitch, actual + dstOffset, dstPitch, w, h, x, y);
+			TS_ASSERT_SAME_DATA(actual, expected, dstSize);
+		}
+
+		delete[] src;
+		delete[] expected;
+		delete[] actual;
+	}
+};
@@ -0,0 +1,108 @@
+#include <cxxtest/TestSuite.h>
+#include "test/instrset_detect.h"
+
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+#include "graphics/yuv_to_rgb_kernels.h"
+
+#include "../null_osystem.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+public:
+	void test_row_kernels() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		// The 4:2:0 conversion splits the frame up on the thread pool
+		Common::install_null_g_system();
+
+		const Graphics::PixelFormat formats[] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(2, 5, 5, 5, 1, 10, 5, 0, 15),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+		const Graphics::YUVToRGBKernels::RowFunc oldFunc = Graphics::YUVToRGBKernels::rowFunc;
+		const bool oldSelected = Graphics::YUVToRGBKernels::selected;
+
+		for (uint format = 0; format < ARRAYSIZE(formats); format++) {
+		for (int scale = 0; scale < 2; scale++) {
+		for (int mode = 0; mode < kNumModes; mode++) {
+			const YUVToRGBManager::LuminanceScale luminanceScale = scale ? YUVToRGBManager::kScaleITU : YUVToRGBManager::kScaleFull;
+
+			Graphics::Surface expected;
+			convert(expected, nullptr, formats[format], luminanceScale, mode);
+
+			checkKernel(expected, Graphics::YUVToRGBKernels::convertRowGeneric, formats[format], luminanceScale, mode);
+#ifdef SCUMMVM_SSE2
+			if (instrset_detect() >= 2)
+				checkKernel(expected, Graphics::YUVToRGBKernels::convertRowSSE2, formats[format], luminanceScale, mode);
+#endif
+#ifdef SCUMMVM_AVX2
+			if (instrset_detect() >= 8)
+				checkKernel(expected, Graphics::YUVToRGBKernels::convertRowAVX2, formats[format], luminanceScale, mode);
+#endif
+#ifdef SCUMMVM_NEON
+			checkKernel(expected, Graphics::YUVToRGBKernels::convertRowNEON, formats[format], luminanceScale, mode);
+#endif
+
+			expected.free();
+		}
+		}
+		}
+
+		Graphics::YUVToRGBKernels::rowFunc = oldFunc;
+		Graphics::YUVToRGBKernels::selected = oldSelected;
+#endif
+	}
+
+private:
+	typedef Graphics::YUVToRGBManager YUVToRGBManager;
+
+	// Not a multiple of any vector width, so the tails get converted too
+	static const int kWidth = 100, kHeight = 12, kPitch = 112;
+	static const int kNumModes = 5;
+
+	static void fillPlane(byte *plane, int size, uint32 seed) {
+		for (int i = 0; i < size; i++) {
+			seed = seed * 1103515245 + 12345;
+			plane[i] = seed >> 16;
+		}
+	}
+
+	/** Convert a noise frame in @p mode, with the table code if @p func is nullptr. */
+	static void convert(Graphics::Surface &dst, Graphics::YUVToRGBKernels::RowFunc func, const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale, int mode) {
+		byte y[kPitch * kHeight], u[kPitch * kHeight], v[kPitch * kHeight], a[kPitch * kHeight];
+		fillPlane(y, sizeof(y), 1);
+		fillPlane(u, sizeof(u), 2);
+		fillPlane(v, sizeof(v), 3);
+		fillPlane(a, sizeof(a), 4);
+
+		Graphics::YUVToRGBKernels::rowFunc = func;
+		Graphics::YUVToRGBKernels::selected = true;
+
+		dst.create(kWidth, kHeight, format);
+		switch (mode) {
+		case 0:
+			YUVToRGBMan.convert444(&dst, scale, y, u, v, kWidth, kHeight, kPitch, kPitch);
+			break;
+		case 1:
+			YUVToRGBMan.convert422(&dst, scale, y, u, v, kWidth, kHeight, kPitch, kPitch);
+			break;
+		case 2:
+			YUVToRGBMan.convert420(&dst, scale, y, u, v, kWidth, kHeight, kPitch, kPitch);
+			break;
+		case 3:
+			YUVToRGBMan.convert420Alpha(&dst, scale, y, u, v, a, kWidth, kHeight, kPitch, kPitch);
+			break;
+		default:
+			YUVToRGBMan.convert410(&dst, scale, y, u, v, kWidth, kHeight, kPitch, kPitch);
+			break;
+		}
+	}
+
+	static void checkKernel(const Graphics::Surface &expected, Graphics::YUVToRGBKernels::RowFunc func, const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale, int mode) {
+		Graphics::Surface actual;
+		convert(actual, func, format, scale, mode);
+		TS_ASSERT_SAME_DATA(actual.getPixels(), expected.getPixels(), expected.pitch * expected.h);
+		actual.free();
+	}
+};
@@ -1,22 +1,212 @@
 #define FORBIDDEN_SYMBOL_EXCEPTION_abort
+#define FORBIDDEN_SYMBOL_EXCEPTION_unlink
 
 #define USE_NULL_DRIVER 1
 #define NULL_DRIVER_USE_FOR_TEST 1
-#include "null_osystem.h"
+
+#ifdef POSIX
+#include <fcntl.h>
+#include <ftw.h>
+#include <sys/stat.h>
+#endif
+
 #include "../backends/platform/null/null.cpp"
+#include "null_osystem.h"
+
+#ifdef POSIX
+#include "../backends/mutex/pthread/pthread-mutex.cpp"
+#include "../common/str.h"
+#include "../common/threadpool.h"
+
+#include <pthread.h>
+
+/**
+ * A counting semaphore, built from a mutex and a condition variable, as
+ * unnamed POSIX semaphores are not available everywhere.
+ */
+class TestSemaphore {
+public:
+	TestSemaphore() : _count(0) {
+		pthread_mutex_init(&_mutex, nullptr);
+		pthread_cond_init(&_cond, nullptr);
+	}
+
+	~TestSemaphore() {
+		pthread_cond_destroy(&_cond);
+		pthread_mutex_destroy(&_mutex);
+	}
+
+	void wait() {
+		pthread_mutex_lock(&_mutex);
+		while (_count == 0)
+			pthread_cond_wait(&_cond, &_mutex);
+		_count--;
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	void post(uint count) {
+		pthread_mutex_lock(&_mutex);
+		_count += count;
+		pthread_cond_broadcast(&_cond);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+private:
+	pthread_mutex_t _mutex;
+	pthread_cond_t _cond;
+	uint _count;
+};
+
+class TestWorkerThreads final : public Common::WorkerThreadsInternal {
+public:
+	TestWorkerThreads(uint cpuCount) : _cpuCount(cpuCount), _proc(nullptr), _data(nullptr) {}
+
+	~TestWorkerThreads() override {
+		join();
+	}
+
+	uint getCPUCount() const override {
+		return _cpuCount;
+	}
+
+	uint start(WorkerProc proc, void *data, uint count) override {
+		_proc = proc;
+		_data = data;
+
+		_threads.resize(count);
+		_starts.resize(count);
+		for (uint i = 0; i < count; ++i) {
+			_starts[i]._owner = this;
+			_starts[i]._index = i;
+		}
+
+		uint started = 0;
+		for (uint i = 0; i < count; ++i) {
+			if (pthread_create(&_threads[started], nullptr, threadMain, &_starts[i]) != 0)
+				break;
+			started++;
+		}
+		_threads.resize(started);
+		return started;
+	}
+
+	void join() override {
+		for (uint i = 0; i < _threads.size(); ++i)
+			pthread_join(_threads[i], nullptr);
+		_threads.clear();
+	}
+
+	void sleep() override {
+		_wake.wait();
+	}
+
+	void wake(uint count) override {
+		_wake.post(count);
+	}
+
+	void sleepWaiter() override {
+		_wakeWaiter.wait();
+	}
+
+	void wakeWaiters(uint count) override {
+		_wakeWaiter.post(count);
+	}
+
+private:
+	struct StartInfo {
+		TestWorkerThreads *_owner;
+		uint _index;
+	};
+
+	static void *threadMain(void *arg) {
+		const StartInfo *info = (const StartInfo *)arg;
+		info->_owner->_proc(info->_owner->_data, info->_index);
+		return nullptr;
+	}
+
+	uint _cpuCount;
+	Common::Array<pthread_t> _threads;
+	Common::Array<StartInfo> _starts;
+	TestSemaphore _wake;
+	TestSemaphore _wakeWaiter;
+	WorkerProc _proc;
+	void *_data;
+};
+
+Common::WorkerThreadsInternal *Common::createTestWorkerThreads(unsigned int cpuCount) {
+	return new TestWorkerThreads(cpuCount);
+}
+
+class OSystem_NULL_Workers final : public OSystem_NULL {
+public:
+	OSystem_NULL_Workers(bool silenceLogs, uint cpuCount) : OSystem_NULL(silenceLogs), _cpuCount(cpuCount) {}
+
+	Common::WorkerThreadsInternal *createWorkerThreads() override {
+		return new TestWorkerThreads(_cpuCount);
+	}
+
+private:
+	uint _cpuCount;
+};
+
+Common::String Common::createTestDirectory() {
+	char path[] = "scummvm-test-XXXXXX";
+	if (!mkdtemp(path))
+		return Common::String();
+	return path;
+}
+
+static int removeTestDirectoryEntry(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+	return type == FTW_DP ? rmdir(path) : unlink(path);
+}
+
+void Common::removeTestDirectory(const Common::String &path) {
+	// Depth first, so that the directories are empty when they are removed
+	nftw(path.c_str(), removeTestDirectoryEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+bool Common::getTestModificationTime(const Common::String &path, int64 &time) {
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0)
+		return false;
+
+#if defined(HAS_STAT_MTIM)
+	time = (int64)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#elif defined(HAS_STAT_MTIMESPEC)
+	time = (int64)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+	time = (int64)st.st_mtime * 1000000000;
+#endif
+	return true;
+}
+
+bool Common::setTestModificationTime(const Common::String &path, int64 time) {
+	struct timespec times[2];
+	times[0].tv_sec = time / 1000000000;
+	times[0].tv_nsec = time % 1000000000;
+	times[1] = times[0];
+	return utimensat(AT_FDCWD, path.c_str(), times, 0) == 0;
+}
+#endif
 
 //#define DISPLAY_ERROR_MESSAGES
 
-void Common::install_null_g_system() {
 #ifdef DISPLAY_ERROR_MESSAGES
-	const bool silenceLogs = false;
+static const bool silenceLogs = false;
 #else
-	const bool silenceLogs = true;
+static const bool silenceLogs = true;
 #endif
 
+void Common::install_null_g_system() {
 	g_system = OSystem_NULL_create(silenceLogs);
 }
 
+#ifdef POSIX
+void Common::install_null_g_system_with_workers(unsigned int cpuCount) {
+	g_system = new OSystem_NULL_Workers(silenceLogs, cpuCount);
+}
+#endif
+
 void OSystem_NULL::quit() {
 	abort();
 }
@@ -41,3 +231,13 @@ void BaseBackend::fillScreen(const Common::Rect &r, uint32 col) {
 void EventsBaseBackend::initBackend() {
 	BaseBackend::initBackend();
 }
+
+// The save file manager, for the save file tests. Cloud saves would pull in
+// the whole cloud code, so they are left out.
+#undef USE_CLOUD
+#undef USE_LIBCURL
+#include "../backends/saves/savefile.cpp"
+#include "../backends/saves/default/default-saves.cpp"
+
+// The timer manager, for the timer tests
+#include "../backends/timer/default/default-timer.cpp"
@@ -1,11 +1,52 @@
 #ifndef TEST_NULL_OSYSTEM
 #define TEST_NULL_OSYSTEM 1
 namespace Common {
+class String;
+
 #if defined(POSIX) || defined(WIN32)
 void install_null_g_system();
 #define NULL_OSYSTEM_IS_AVAILABLE 1
 #else
 #define NULL_OSYSTEM_IS_AVAILABLE 0
 #endif
+
+#if defined(POSIX)
+class WorkerThreadsInternal;
+
+/**
+ * Create real threads for a ThreadPool, as if the host had @p cpuCount
+ * cores.
+ */
+WorkerThreadsInternal *createTestWorkerThreads(unsigned int cpuCount);
+
+/**
+ * Like install_null_g_system(), but g_system->getThreadPool() runs on real
+ * threads, as if the host had @p cpuCount cores.
+ */
+void install_null_g_system_with_workers(unsigned int cpuCount);
+#define TEST_WORKER_THREADS_ARE_AVAILABLE 1
+#else
+#define TEST_WORKER_THREADS_ARE_AVAILABLE 0
+#endif
+
+#if defined(POSIX)
+/**
+ * Create an empty directory in the current one, and return its path, or an
+ * empty string if that failed.
+ */
+String createTestDirectory();
+
+/** Remove a directory created by createTestDirectory(), with its contents. */
+void removeTestDirectory(const String &path);
+
+/** Get the modification time of a file or directory, in nanoseconds. */
+bool getTestModificationTime(const String &path, int64 &time);
+
+/** Set the modification time of a file or directory, in nanoseconds. */
+bool setTestModificationTime(const String &path, int64 time);
+#define TEST_DIRECTORIES_ARE_AVAILABLE 1
+#else
+#define TEST_DIRECTORIES_ARE_AVAILABLE 0
+#endif
 }
 #endif
@@ -0,0 +1,241 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/atomic.h"
+#include "common/system.h"
+#include "common/threadpool.h"
+#include "graphics/surface.h"
+#include "video/video_decoder.h"
+
+#include "../null_osystem.h"
+
+/**
+ * A video of numbered frames: every pixel of a frame is its number, and
+ * every tenth frame changes the first palette entry to its number.
+ */
+class NumberedFramesDecoder : public Video::VideoDecoder {
+public:
+	static const int kFrameCount = 30;
+
+	~NumberedFramesDecoder() override {
+		close();
+	}
+
+	bool loadStream(Common::SeekableReadStream *stream) override {
+		close();
+		_track = new NumberedFramesTrack();
+		addTrack(_track);
+		return true;
+	}
+
+	/** How many frames were decoded, whether they were returned or not. */
+	int getDecodedFrames() const { return _track->_decoded.load(); }
+
+private:
+	class NumberedFramesTrack : public FixedRateVideoTrack {
+	public:
+		NumberedFramesTrack() : _decoded(0), _curFrame(-1), _dirtyPalette(false) {
+			_surface.create(4, 4, Graphics::PixelFormat::createFormatCLUT8());
+			memset(_palette, 0, sizeof(_palette));
+		}
+		~NumberedFramesTrack() override {
+			_surface.free();
+		}
+
+		uint16 getWidth() const override { return _surface.w; }
+		uint16 getHeight() const override { return _surface.h; }
+		Graphics::PixelFormat getPixelFormat() const override { return _surface.format; }
+		int getCurFrame() const override { return _curFrame; }
+		int getFrameCount() const override { return kFrameCount; }
+
+		const Graphics::Surface *decodeNextFrame() override {
+			_curFrame++;
+			_surface.fillRect(Common::Rect(_surface.w, _surface.h), _curFrame);
+			_dirtyPalette = (_curFrame % 10) == 0;
+			if (_dirtyPalette)
+				_palette[0] = _curFrame;
+			_decoded.fetchAdd(1);
+			return &_surface;
+		}
+
+		const byte *getPalette() const override { return _palette; }
+		bool hasDirtyPalette() const override { return _dirtyPalette; }
+
+		bool isSeekable() const override { return true; }
+		bool seek(const Audio::Timestamp &time) override {
+			_curFrame = getFrameAtTime(time) - 1;
+			return true;
+		}
+
+		Common::Atomic<int> _decoded;
+
+	protected:
+		Common::Rational getFrameRate() const override { return 10; }
+
+	private:
+		Graphics::Surface _surface;
+		int _curFrame;
+		byte _palette[256 * 3];
+		bool _dirtyPalette;
+	};
+
+	NumberedFramesTrack *_track;
+};
+
+class VideoDecoderTestSuite : public CxxTest::TestSuite {
+	// Checks that the next frame is the given one, with the palette of
+	// the frame
+	static bool checkNextFrame(NumberedFramesDecoder &decoder, int frame) {
+		const Graphics::Surface *surface = decoder.decodeNextFrame();
+		if (!surface || *(const byte *)surface->getBasePtr(3, 3) != frame)
+			return false;
+		if (decoder.getCurFrame() != frame)
+			return false;
+
+		if ((frame % 10) == 0) {
+			if (!decoder.hasDirtyPalette())
+				return false;
+			if (decoder.getPalette()[0] != frame)
+				return false;
+		}
+		return true;
+	}
+
+	// Waits until the worker has decoded the given number of frames
+	static bool waitForDecodedFrames(NumberedFramesDecoder &decoder, int frames) {
+		for (int i = 0; i < 2000 && decoder.getDecodedFrames() < frames; ++i)
+			g_system->delayMillis(1);
+		return decoder.getDecodedFrames() == frames;
+	}
+
+public:
+#if TEST_WORKER_THREADS_ARE_AVAILABLE
+	void test_decode_ahead() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		NumberedFramesDecoder decoder;
+		decoder.setDecodeAhead(4, &pool);
+		TS_ASSERT(decoder.loadStream(nullptr));
+
+		for (int frame = 0; frame < NumberedFramesDecoder::kFrameCount; ++frame) {
+			TS_ASSERT(!decoder.endOfVideo());
+			TS_ASSERT(checkNextFrame(decoder, frame));
+		}
+		TS_ASSERT(decoder.endOfVideo());
+		TS_ASSERT_EQUALS(decoder.getDecodedFrames(), (int)NumberedFramesDecoder::kFrameCount);
+	}
+
+	void test_palette() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		NumberedFramesDecoder decoder;
+		TS_ASSERT(decoder.loadStream(nullptr));
+
+		for (int frame = 0; frame < 9; ++frame)
+			TS_ASSERT(checkNextFrame(decoder, frame));
+
+		// The palette stays the one of the frame returned last, while the
+		// worker already decodes the frame which changes it
+		decoder.setDecodeAhead(4, &pool);
+		TS_ASSERT(checkNextFrame(decoder, 9));
+		TS_ASSERT(waitForDecodedFrames(decoder, 14));
+		TS_ASSERT_EQUALS(decoder.getPalette()[0], 0);
+
+		for (int frame = 10; frame < NumberedFramesDecoder::kFrameCount; ++frame) {
+			TS_ASSERT(checkNextFrame(decoder, frame));
+			TS_ASSERT_EQUALS(decoder.getPalette()[0], (frame / 10) * 10);
+		}
+	}
+
+	void test_queue_limit() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		NumberedFramesDecoder decoder;
+		decoder.setDecodeAhead(4, &pool);
+		TS_ASSERT(decoder.loadStream(nullptr));
+
+		// The queue fills up behind the frame which was returned, and
+		// not further
+		TS_ASSERT(checkNextFrame(decoder, 0));
+		TS_ASSERT(waitForDecodedFrames(decoder, 5));
+		g_system->delayMillis(20);
+		TS_ASSERT_EQUALS(decoder.getDecodedFrames(), 5);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 0);
+
+		// Turning it off still returns the queued frames
+		decoder.setDecodeAhead(0);
+		for (int frame = 1; frame < NumberedFramesDecoder::kFrameCount; ++frame)
+			TS_ASSERT(checkNextFrame(decoder, frame));
+		TS_ASSERT(decoder.endOfVideo());
+	}
+
+	void test_seek() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		NumberedFramesDecoder decoder;
+		decoder.setDecodeAhead(4, &pool);
+		TS_ASSERT(decoder.loadStream(nullptr));
+
+		for (int frame = 0; frame < 5; ++frame)
+			TS_ASSERT(checkNextFrame(decoder, frame));
+
+		// The queued frames are dropped
+		TS_ASSERT(decoder.seek(Audio::Timestamp(2000, 1000)));
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 19);
+		TS_ASSERT(checkNextFrame(decoder, 20));
+		TS_ASSERT(checkNextFrame(decoder, 21));
+
+		// Back to before the frames decoded so far
+		TS_ASSERT(decoder.seekToFrame(3));
+		for (int frame = 3; frame < NumberedFramesDecoder::kFrameCount; ++frame)
+			TS_ASSERT(checkNextFrame(decoder, frame));
+
+		TS_ASSERT(decoder.rewind());
+		TS_ASSERT(checkNextFrame(decoder, 0));
+	}
+
+	void test_pause() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(4));
+		NumberedFramesDecoder decoder;
+		decoder.setDecodeAhead(4, &pool);
+		TS_ASSERT(decoder.loadStream(nullptr));
+		decoder.start();
+
+		TS_ASSERT(checkNextFrame(decoder, 0));
+		TS_ASSERT(checkNextFrame(decoder, 1));
+
+		// Pausing waits for the worker, which does not start again until
+		// the next frame is requested
+		decoder.pauseVideo(true);
+		const int decoded = decoder.getDecodedFrames();
+		TS_ASSERT_LESS_THAN_EQUALS(2, decoded);
+		TS_ASSERT_LESS_THAN_EQUALS(decoded, 6);
+		decoder.setVolume(100);
+		decoder.setBalance(-10);
+		g_system->delayMillis(20);
+		TS_ASSERT_EQUALS(decoder.getDecodedFrames(), decoded);
+		TS_ASSERT_EQUALS(decoder.getCurFrame(), 1);
+		decoder.pauseVideo(false);
+
+		for (int frame = 2; frame < NumberedFramesDecoder::kFrameCount; ++frame)
+			TS_ASSERT(checkNextFrame(decoder, frame));
+		TS_ASSERT(decoder.endOfVideo());
+		decoder.stop();
+	}
+
+	void test_no_workers() {
+		Common::install_null_g_system();
+		Common::ThreadPool pool(Common::createTestWorkerThreads(1));
+		NumberedFramesDecoder decoder;
+		decoder.setDecodeAhead(4, &pool);
+		TS_ASSERT(decoder.loadStream(nullptr));
+
+		// The frames are decoded when they are needed, as without it
+		for (int frame = 0; frame < NumberedFramesDecoder::kFrameCount; ++frame) {
+			TS_ASSERT(checkNextFrame(decoder, frame));
+			TS_ASSERT_EQUALS(decoder.getDecodedFrames(), frame + 1);
+		}
+		TS_ASSERT(decoder.endOfVideo());
+	}
+#endif
+};
@@ -36,6 +36,7 @@
 #include "common/bitstream.h"
 #include "common/compression/huffman.h"
 #include "common/system.h"
+#include "common/threadpool.h"
 
 #include "graphics/yuv_to_rgb.h"
 #include "graphics/surface.h"
@@ -63,6 +64,7 @@ namespace Video {
 
 BinkDecoder::BinkDecoder() {
 	_bink = 0;
+	_threadedDecoding = g_system->getThreadPool()->getWorkerCount() > 0;
 }
 
 BinkDecoder::~BinkDecoder() {
@@ -200,18 +202,57 @@ void BinkDecoder::readNextPacket() {
 		}
 	}
 
-	uint32 videoPacketStart = _bink->pos();
-	uint32 videoPacketEnd   = _bink->pos() + frameSize;
+	// The packet is already there if the frame was decoded ahead
+	if (!frame.bits) {
+		if (_threadedDecoding) {
+			// The next packet gets read before this one is decoded
+			frame.bits = new Common::BitStream32LELSB(_bink->readStream(frameSize), DisposeAfterUse::YES);
+		} else {
+			uint32 videoPacketStart = _bink->pos();
+			uint32 videoPacketEnd   = _bink->pos() + frameSize;
 
-	frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
-			videoPacketStart, videoPacketEnd), DisposeAfterUse::YES);
+			frame.bits = new Common::BitStream32LELSB(new Common::SeekableSubReadStream(_bink,
+					videoPacketStart, videoPacketEnd), DisposeAfterUse::YES);
+		}
+	}
+
+	VideoFrame *nextFrame = nullptr;
+	if (_threadedDecoding && videoTrack->getCurFrame() + 2 < videoTrack->getFrameCount()) {
+		nextFrame = &_frames[videoTrack->getCurFrame() + 2];
+		readVideoPacket(*nextFrame);
+	}
 
-	videoTrack->decodePacket(frame);
+	videoTrack->decodePacket(frame, nextFrame);
 
 	delete frame.bits;
 	frame.bits = 0;
 }
 
+void BinkDecoder::readVideoPacket(VideoFrame &frame) {
+	if (!_bink->seek(frame.offset))
+		error("Bad bink seek");
+
+	uint32 frameSize = frame.size;
+
+	// Skip the audio packets
+	for (uint32 i = 0; i < _audioTracks.size(); i++) {
+		uint32 audioPacketLength = _bink->readUint32LE();
+
+		frameSize -= 4;
+
+		if (frameSize < audioPacketLength)
+			error("Audio packet too big for the frame");
+
+		if (audioPacketLength >= 4) {
+			_bink->skip(audioPacketLength);
+
+			frameSize -= audioPacketLength;
+		}
+	}
+
+	frame.bits = new Common::BitStream32LELSB(_bink->readStream(frameSize), DisposeAfterUse::YES);
+}
+
 VideoDecoder::AudioTrack *BinkDecoder::getAudioTrack(int index) {
 	// Bink audio track indexes are relative to the first audio track
 	Track *track = getTrack(index + 1);
@@ -243,7 +284,8 @@ BinkDecoder::AudioInfo::~AudioInfo() {
 }
 
 BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, uint32 frameCount, const Common::Rational &frameRate, bool swapPlanes, bool hasAlpha, uint32 id) :
-		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id), _surface(nullptr) {
+		_frameCount(frameCount), _frameRate(frameRate), _swapPlanes(swapPlanes), _hasAlpha(hasAlpha), _id(id), _surface(nullptr),
+		_decodeGroup(new Common::TaskGroup()), _aheadFrame(nullptr) {
 	_curFrame = -1;
 
 	for (int i = 0; i < 16; i++)
@@ -310,6 +352,9 @@ BinkDecoder::BinkVideoTrack::BinkVideoTrack(uint32 width, uint32 height, uint32
 }
 
 BinkDecoder::BinkVideoTrack::~BinkVideoTrack() {
+	cancelDecodeAhead();
+	delete _decodeGroup;
+
 	for (int i = 0; i < 4; i++) {
 		delete[] _curPlanes[i]; _curPlanes[i] = 0;
 		delete[] _oldPlanes[i]; _oldPlanes[i] = 0;
@@ -431,6 +476,7 @@ bool BinkDecoder::BinkVideoTrack::rewind() {
 		return false;
 	}
 
+	cancelDecodeAhead();
 	_curFrame = -1;
 
 	// Re-initialize the video with solid green
@@ -446,8 +492,35 @@ bool BinkDecoder::BinkVideoTrack::rewind() {
 	return true;
 }
 
-void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
-	assert(frame.bits);
+void BinkDecoder::BinkVideoTrack::setCurFrame(uint32 frame) {
+	cancelDecodeAhead();
+	_curFrame = frame;
+}
+
+void BinkDecoder::BinkVideoTrack::cancelDecodeAhead() {
+	if (!_aheadFrame)
+		return;
+
+	_decodeGroup->wait();
+
+	delete _aheadFrame->bits;
+	_aheadFrame->bits = 0;
+	_aheadFrame = nullptr;
+}
+
+void BinkDecoder::BinkVideoTrack::decodeAheadTask(void *data) {
+	BinkVideoTrack *track = (BinkVideoTrack *)data;
+	track->decodePlanes(*track->_aheadFrame);
+}
+
+void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame, VideoFrame *next) {
+	if (_aheadFrame == &frame) {
+		_decodeGroup->wait();
+		_aheadFrame = nullptr;
+	} else {
+		cancelDecodeAhead();
+		decodePlanes(frame);
+	}
 
 	if (!_surface) {
 		_surface = new Graphics::Surface();
@@ -459,6 +532,36 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		_surface->w = _width;
 	}
 
+	// Swap the planes with the reference planes
+	for (int i = 0; i < 4; i++)
+		SWAP(_curPlanes[i], _oldPlanes[i]);
+
+	_curFrame++;
+
+	// Decoding the next frame only reads the reference planes, so it can
+	// run while they are converted
+	if (next) {
+		_aheadFrame = next;
+		_decodeGroup->run(decodeAheadTask, this);
+	}
+
+	// Convert the YUV data we have to our format
+	// The width used here is the surface-width, and not the video-width
+	// to allow for odd-sized videos.
+	if (_hasAlpha) {
+		assert(_oldPlanes[0] && _oldPlanes[1] && _oldPlanes[2] && _oldPlanes[3]);
+		YUVToRGBMan.convert420Alpha(_surface, Graphics::YUVToRGBManager::kScaleITU, _oldPlanes[0], _oldPlanes[1], _oldPlanes[2], _oldPlanes[3],
+				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
+	} else {
+		assert(_oldPlanes[0] && _oldPlanes[1] && _oldPlanes[2]);
+		YUVToRGBMan.convert420(_surface, Graphics::YUVToRGBManager::kScaleITU, _oldPlanes[0], _oldPlanes[1], _oldPlanes[2],
+				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
+	}
+}
+
+void BinkDecoder::BinkVideoTrack::decodePlanes(VideoFrame &frame) {
+	assert(frame.bits);
+
 	if (_hasAlpha) {
 		if (_id == kBIKiID)
 			frame.bits->skip(32);
@@ -477,25 +580,6 @@ void BinkDecoder::BinkVideoTrack::decodePacket(VideoFrame &frame) {
 		if (frame.bits->pos() >= frame.bits->size())
 			break;
 	}
-
-	// Convert the YUV data we have to our format
-	// The width used here is the surface-width, and not the video-width
-	// to allow for odd-sized videos.
-	if (_hasAlpha) {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2] && _curPlanes[3]);
-		YUVToRGBMan.convert420Alpha(_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2], _curPlanes[3],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	} else {
-		assert(_curPlanes[0] && _curPlanes[1] && _curPlanes[2]);
-		YUVToRGBMan.convert420(_surface, Graphics::YUVToRGBManager::kScaleITU, _curPlanes[0], _curPlanes[1], _curPlanes[2],
-				_surfaceWidth, _surfaceHeight, _yBlockWidth * 8, _uvBlockWidth * 8);
-	}
-
-	// And swap the planes with the reference planes
-	for (int i = 0; i < 4; i++)
-		SWAP(_curPlanes[i], _oldPlanes[i]);
-
-	_curFrame++;
 }
 
 void BinkDecoder::BinkVideoTrack::decodePlane(VideoFrame &video, int planeIdx, bool isChroma) {
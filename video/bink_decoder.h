@@ -45,6 +45,7 @@ class QueuingAudioStream;
 
 namespace Common {
 class SeekableReadStream;
+class TaskGroup;
 template <class BITSTREAM>
 class Huffman;
 }
@@ -76,6 +77,13 @@ public:
 
 	Common::Rational getFrameRate();
 
+	/**
+	 * Decode every frame ahead on the thread pool, while the previous one
+	 * is converted to RGB. This is on by default if the pool has worker
+	 * threads.
+	 */
+	void setThreadedDecoding(bool enable) { _threadedDecoding = enable; }
+
 protected:
 	void readNextPacket();
 	bool supportsAudioTrackSwitching() const { return true; }
@@ -166,10 +174,17 @@ private:
 		bool isSeekable() const  override{ return true; }
 		bool seek(const Audio::Timestamp &time) override { return true; }
 		bool rewind() override;
-		void setCurFrame(uint32 frame) { _curFrame = frame; }
+		void setCurFrame(uint32 frame);
+
+		/**
+		 * Decode a video packet. If @p next is given, it is decoded on the
+		 * thread pool while this frame is converted to RGB, and the call
+		 * for it only has to wait for that.
+		 */
+		void decodePacket(VideoFrame &frame, VideoFrame *next = nullptr);
 
-		/** Decode a video packet. */
-		void decodePacket(VideoFrame &frame);
+		/** Wait for the frame which is decoded ahead, and drop it. */
+		void cancelDecodeAhead();
 
 		Common::Rational getFrameRate() const override { return _frameRate; }
 
@@ -281,6 +296,13 @@ private:
 		byte *_curPlanes[4]; ///< The 4 color planes, YUVA, current frame.
 		byte *_oldPlanes[4]; ///< The 4 color planes, YUVA, last frame.
 
+		Common::TaskGroup *_decodeGroup; ///< Decodes the next frame ahead.
+		VideoFrame *_aheadFrame;         ///< The frame decoded ahead, or nullptr.
+
+		/** Decode the planes of a frame into the current planes. */
+		void decodePlanes(VideoFrame &video);
+		static void decodeAheadTask(void *data);
+
 		/** Initialize the bundles. */
 		void initBundles();
 		/** Deinitialize the bundles. */
@@ -379,10 +401,15 @@ private:
 
 	Common::SeekableReadStream *_bink;
 
+	bool _threadedDecoding;
+
 	Common::Array<AudioInfo> _audioTracks; ///< All audio tracks.
 	Common::Array<VideoFrame> _frames;      ///< All video frames.
 
 	void initAudioTrack(AudioInfo &audio);
+
+	/** Read the video part of a packet into memory. */
+	void readVideoPacket(VideoFrame &frame);
 };
 
 } // End of namespace Video
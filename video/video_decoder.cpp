@@ -26,10 +26,120 @@
 
 #include "common/rational.h"
 #include "common/file.h"
+#include "common/mutex.h"
 #include "common/system.h"
+#include "common/threadpool.h"
+
+#include "graphics/surface.h"
 
 namespace Video {
 
+/** A frame which was decoded ahead, and the state after decoding it. */
+struct VideoDecoder::QueuedFrame {
+	Graphics::Surface surface;
+	bool hasSurface;
+	byte palette[256 * 3];
+	bool dirtyPalette;
+
+	uint32 startTime;           ///< The start time of the frame
+	int curFrame;               ///< getCurFrame() after the frame
+	Audio::Timestamp frameTime; ///< The time of the frame in its track
+};
+
+/**
+ * The frames are decoded by a task on the thread pool, which fills the
+ * queue and then finishes. Only the task touches the tracks while it is
+ * running, and the main thread only when it is not.
+ */
+struct VideoDecoder::DecodeAheadState {
+	DecodeAheadState(Common::ThreadPool *pool) : group(pool), limit(0), first(0), count(0), busy(false), stop(false),
+		pendingTime(0), suspended(0), curFrame(-1), frameTime(0, 1000) {
+		for (uint i = 0; i < ARRAYSIZE(frames); i++)
+			frames[i].hasSurface = false;
+	}
+
+	~DecodeAheadState() {
+		for (uint i = 0; i < ARRAYSIZE(frames); i++)
+			frames[i].surface.free();
+	}
+
+	Common::TaskGroup group;
+	Common::Mutex mutex;
+	Common::Mutex packetMutex;  ///< Held by the task in readNextPacket(), which feeds the audio tracks
+
+	// The frame after the queued ones is the one which was returned last,
+	// it must stay valid until the next one is returned
+	QueuedFrame frames[kMaxDecodeAheadFrames + 1];
+	uint limit;
+
+	// Guarded by the mutex
+	uint first, count;
+	bool busy;                  ///< The task is running
+	bool stop;                  ///< The task should finish after the current frame
+	uint32 pendingTime;         ///< The start time of the frame the task decodes
+
+	// Main thread only
+	byte palette[256 * 3];      ///< The palette returned by getPalette()
+	uint suspended;
+	int curFrame;               ///< getCurFrame() of the frame returned last
+	Audio::Timestamp frameTime; ///< The time of the frame returned last
+};
+
+/**
+ * Keeps the decode-ahead task away from the tracks during its lifetime,
+ * and optionally drops the queued frames, e.g. because the tracks are
+ * repositioned anyway.
+ */
+class VideoDecoder::SuspendDecodeAhead {
+public:
+	SuspendDecodeAhead(VideoDecoder *decoder, bool flush = false) : _state(decoder->_decodeAhead) {
+		if (!_state)
+			return;
+
+		_state->suspended++;
+		{
+			Common::StackLock lock(_state->mutex);
+			_state->stop = true;
+		}
+		_state->group.wait();
+
+		Common::StackLock lock(_state->mutex);
+		_state->stop = false;
+		if (flush) {
+			_state->first = 0;
+			_state->count = 0;
+		}
+	}
+
+	~SuspendDecodeAhead() {
+		if (_state)
+			_state->suspended--;
+	}
+
+private:
+	DecodeAheadState *_state;
+};
+
+/**
+ * Keeps the decode-ahead task from feeding the audio tracks during its
+ * lifetime, so that the main thread can look at them.
+ */
+class VideoDecoder::LockAudioTracks {
+public:
+	LockAudioTracks(const VideoDecoder *decoder) : _state(decoder->_decodeAhead) {
+		if (_state)
+			_state->packetMutex.lock();
+	}
+
+	~LockAudioTracks() {
+		if (_state)
+			_state->packetMutex.unlock();
+	}
+
+private:
+	DecodeAheadState *_state;
+};
+
 VideoDecoder::VideoDecoder() {
 	_startTime = 0;
 	_dirtyPalette = false;
@@ -48,9 +158,16 @@ VideoDecoder::VideoDecoder() {
 	_canSetDither = true;
 	_canSetDefaultFormat = true;
 	_videoCodecAccuracy = Image::CodecAccuracy::Default;
+	_decodeAhead = nullptr;
+}
+
+VideoDecoder::~VideoDecoder() {
+	delete _decodeAhead;
 }
 
 void VideoDecoder::close() {
+	SuspendDecodeAhead suspend(this, true);
+
 	if (isPlaying())
 		stop();
 
@@ -133,6 +250,8 @@ void VideoDecoder::pauseVideo(bool pause) {
 		return;
 	}
 
+	SuspendDecodeAhead suspend(this);
+
 	if (_pauseLevel == 1 && pause) {
 		_pauseStartTime = g_system->getMillis(); // Store the starting time from pausing to keep it for later
 
@@ -152,6 +271,8 @@ void VideoDecoder::resetPauseStartTime() {
 }
 
 void VideoDecoder::setVolume(byte volume) {
+	SuspendDecodeAhead suspend(this);
+
 	_audioVolume = volume;
 
 	for (auto &track : _tracks)
@@ -160,6 +281,8 @@ void VideoDecoder::setVolume(byte volume) {
 }
 
 void VideoDecoder::setBalance(int8 balance) {
+	SuspendDecodeAhead suspend(this);
+
 	_audioBalance = balance;
 
 	for (auto &track : _tracks)
@@ -172,6 +295,8 @@ Audio::Mixer::SoundType VideoDecoder::getSoundType() const {
 }
 
 void VideoDecoder::setSoundType(Audio::Mixer::SoundType soundType) {
+	SuspendDecodeAhead suspend(this);
+
 	_soundType = soundType;
 
 	for (auto &track : _tracks)
@@ -212,6 +337,12 @@ const Graphics::Surface *VideoDecoder::decodeNextFrame() {
 	_canSetDither = false;
 	_canSetDefaultFormat = false;
 
+	// If nothing could be decoded ahead, e.g. because the video is played
+	// in reverse, the frame is decoded here as usual
+	const Graphics::Surface *queuedFrame;
+	if (_decodeAhead && !_decodeAhead->suspended && decodeQueuedFrame(queuedFrame))
+		return queuedFrame;
+
 	readNextPacket();
 
 	// If we have no next video track at this point, there shouldn't be
@@ -237,6 +368,12 @@ bool VideoDecoder::setReverse(bool reverse) {
 	if (reverse && hasAudio())
 		return false;
 
+	SuspendDecodeAhead suspend(this);
+
+	// The queued frames go forward, and the tracks are past them
+	if (reverse && isDecodingAhead())
+		return false;
+
 	// Attempt to make sure all the tracks are in the requested direction
 	for (auto &track : _tracks) {
 		if (track->getTrackType() == Track::kTrackTypeVideo && ((VideoTrack *)track)->isReversed() != reverse) {
@@ -257,6 +394,13 @@ const byte *VideoDecoder::getPalette() {
 }
 
 int VideoDecoder::getCurFrame() const {
+	if (isDecodingAhead())
+		return _decodeAhead->curFrame;
+
+	return getTracksCurFrame();
+}
+
+int VideoDecoder::getTracksCurFrame() const {
 	int32 frame = -1;
 
 	for (const auto &track : _tracks)
@@ -284,6 +428,7 @@ uint32 VideoDecoder::getTime() const {
 		return MAX<int>((_playbackRate * (_pauseStartTime - _startTime)).toInt(), 0);
 
 	if (useAudioSync()) {
+		LockAudioTracks lock(this);
 		for (const auto &track : _tracks) {
 			if (track->getTrackType() == Track::kTrackTypeAudio && !track->endOfTrack()) {
 				uint32 time = (((const AudioTrack *)track)->getRunningTime() * _playbackRate).toInt();
@@ -298,13 +443,24 @@ uint32 VideoDecoder::getTime() const {
 }
 
 uint32 VideoDecoder::getTimeToNextFrame() const {
-	if (endOfVideo() || _needsUpdate || !_nextVideoTrack)
+	if (endOfVideo() || _needsUpdate)
 		return 0;
 
+	// Frames are only decoded ahead when playing forward
+	uint32 nextFrameStartTime;
+	bool reversed = false;
+
+	if (!getQueuedFrameTime(nextFrameStartTime)) {
+		if (!_nextVideoTrack)
+			return 0;
+
+		nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
+		reversed = _nextVideoTrack->isReversed();
+	}
+
 	uint32 currentTime = getTime();
-	uint32 nextFrameStartTime = _nextVideoTrack->getNextFrameStartTime();
 
-	if (_nextVideoTrack->isReversed()) {
+	if (reversed) {
 		// For reversed videos, we need to handle the time difference the opposite way.
 		if (nextFrameStartTime >= currentTime)
 			return 0;
@@ -320,7 +476,20 @@ uint32 VideoDecoder::getTimeToNextFrame() const {
 }
 
 bool VideoDecoder::endOfVideo() const {
+	uint32 queuedTime;
+	const bool queued = getQueuedFrameTime(queuedTime);
+
+	// Without queued frames the task is not running, and only this thread
+	// starts it, so the video tracks can be used
+	LockAudioTracks lock(this);
 	for (const auto &track : _tracks) {
+		// The video tracks are ahead of what was shown
+		if (queued && track->getTrackType() == Track::kTrackTypeVideo) {
+			if (!isPlaying() || !_endTimeSet || queuedTime < (uint)_endTime.msecs())
+				return false;
+			continue;
+		}
+
 		bool videoEndTimeReached = _endTimeSet && track->getTrackType() == Track::kTrackTypeVideo && ((const VideoTrack *)track)->getNextFrameStartTime() >= (uint)_endTime.msecs();
 		bool endReached = track->endOfTrack() || (isPlaying() && videoEndTimeReached);
 		if (!endReached)
@@ -345,6 +514,8 @@ bool VideoDecoder::rewind() {
 	if (!isRewindable())
 		return false;
 
+	SuspendDecodeAhead suspend(this, true);
+
 	// Stop all tracks so they can be rewound
 	if (isPlaying())
 		stopAudio();
@@ -379,6 +550,8 @@ bool VideoDecoder::seek(const Audio::Timestamp &time) {
 	if (!isSeekable())
 		return false;
 
+	SuspendDecodeAhead suspend(this, true);
+
 	// Stop all tracks so they can be seek'ed
 	if (isPlaying())
 		stopAudio();
@@ -445,6 +618,8 @@ void VideoDecoder::stop() {
 	if (!isPlaying())
 		return;
 
+	SuspendDecodeAhead suspend(this);
+
 	// Stop audio here so we don't have it affect getTime()
 	stopAudio();
 
@@ -477,6 +652,8 @@ void VideoDecoder::setRate(const Common::Rational &rate) {
 		return;
 	}
 
+	SuspendDecodeAhead suspend(this);
+
 	Common::Rational targetRate = rate;
 
 	if (hasAudio()) {
@@ -575,6 +752,8 @@ bool VideoDecoder::setOutputPixelFormats(const Common::List<Graphics::PixelForma
 }
 
 void VideoDecoder::setVideoCodecAccuracy(Image::CodecAccuracy accuracy) {
+	SuspendDecodeAhead suspend(this);
+
 	_videoCodecAccuracy = accuracy;
 
 	for (Track *track : _tracks) {
@@ -848,6 +1027,8 @@ bool VideoDecoder::addStreamTrack(Audio::SeekableAudioStream *stream) {
 	if (!isVideoLoaded())
 		return false;
 
+	SuspendDecodeAhead suspend(this);
+
 	StreamFileAudioTrack *track = new StreamFileAudioTrack(stream, getSoundType());
 	addTrack(track, true);
 	return true;
@@ -858,6 +1039,8 @@ bool VideoDecoder::addStreamFileTrack(const Common::Path &baseName) {
 	if (!isVideoLoaded())
 		return false;
 
+	SuspendDecodeAhead suspend(this);
+
 	StreamFileAudioTrack *track = new StreamFileAudioTrack(getSoundType());
 
 	bool result = track->loadFromFile(baseName);
@@ -882,6 +1065,8 @@ bool VideoDecoder::setAudioTrack(int index) {
 	if (_mainAudioTrack == audioTrack)
 		return true;
 
+	SuspendDecodeAhead suspend(this);
+
 	_mainAudioTrack->setMute(true);
 	audioTrack->setMute(false);
 	_mainAudioTrack = audioTrack;
@@ -899,6 +1084,8 @@ uint VideoDecoder::getAudioTrackCount() const {
 }
 
 void VideoDecoder::setEndTime(const Audio::Timestamp &endTime) {
+	SuspendDecodeAhead suspend(this);
+
 	Audio::Timestamp startTime = 0;
 
 	if (isPlaying()) {
@@ -947,7 +1134,10 @@ void VideoDecoder::setEndFrame(uint frame) {
 }
 
 void VideoDecoder::resetStartTime() {
-	if (_nextVideoTrack) {
+	if (isDecodingAhead()) {
+		if (isPlaying())
+			_startTime = g_system->getMillis() - (_decodeAhead->frameTime.msecs() / _playbackRate).toInt();
+	} else if (_nextVideoTrack) {
 		Audio::Timestamp curTime = _nextVideoTrack->getFrameTime(_nextVideoTrack->getCurFrame());
 		if (isPlaying()) {
 			_startTime = g_system->getMillis() - (curTime.msecs() / _playbackRate).toInt();
@@ -1032,6 +1222,10 @@ bool VideoDecoder::hasFramesLeft() const {
 	// This is similar to endOfVideo(), except it doesn't take Audio into account (and returns true if not the end of the video)
 	// This is only used for needsUpdate() atm so that setEndTime() works properly
 	// And unlike endOfVideoTracks(), this takes into account _endTime
+	uint32 queuedTime;
+	if (getQueuedFrameTime(queuedTime))
+		return !isPlaying() || !_endTimeSet || queuedTime < (uint)_endTime.msecs();
+
 	for (const auto &track : _tracks) {
 		if (track->getTrackType() != Track::kTrackTypeVideo)
 			continue;
@@ -1072,4 +1266,201 @@ void VideoDecoder::eraseTrack(Track *track) {
 	}
 }
 
+void VideoDecoder::setDecodeAhead(uint frames, Common::ThreadPool *pool) {
+	frames = MIN(frames, kMaxDecodeAheadFrames);
+
+	if (!_decodeAhead) {
+		if (frames == 0)
+			return;
+
+		_decodeAhead = new DecodeAheadState(pool);
+	}
+
+	SuspendDecodeAhead suspend(this);
+	_decodeAhead->limit = frames;
+}
+
+void VideoDecoder::decodeAheadTask(void *data) {
+	VideoDecoder *decoder = (VideoDecoder *)data;
+	DecodeAheadState &state = *decoder->_decodeAhead;
+
+	for (;;) {
+		QueuedFrame *frame;
+		{
+			Common::StackLock lock(state.mutex);
+			frame = &state.frames[(state.first + state.count) % ARRAYSIZE(state.frames)];
+		}
+
+		decoder->decodeFrameAhead(*frame);
+
+		uint32 nextTime;
+		const bool more = decoder->canDecodeAhead(nextTime);
+
+		Common::StackLock lock(state.mutex);
+		frame->startTime = state.pendingTime;
+		state.count++;
+
+		if (!more || state.stop || state.count >= state.limit) {
+			state.busy = false;
+			return;
+		}
+
+		state.pendingTime = nextTime;
+	}
+}
+
+void VideoDecoder::decodeFrameAhead(QueuedFrame &frame) {
+	// Like decodeNextFrame(), but the results are kept in the frame
+	{
+		Common::StackLock lock(_decodeAhead->packetMutex);
+		readNextPacket();
+	}
+
+	frame.hasSurface = false;
+	frame.dirtyPalette = false;
+
+	if (_nextVideoTrack) {
+		const Graphics::Surface *surface = _nextVideoTrack->decodeNextFrame();
+
+		if (surface) {
+			if (frame.surface.w != surface->w || frame.surface.h != surface->h || frame.surface.format != surface->format)
+				frame.surface.copyFrom(*surface);
+			else
+				frame.surface.copyRectToSurface(*surface, 0, 0, Common::Rect(surface->w, surface->h));
+			frame.hasSurface = true;
+		}
+
+		if (_nextVideoTrack->hasDirtyPalette()) {
+			memcpy(frame.palette, _nextVideoTrack->getPalette(), sizeof(frame.palette));
+			frame.dirtyPalette = true;
+		}
+
+		frame.frameTime = _nextVideoTrack->getFrameTime(_nextVideoTrack->getCurFrame());
+
+		findNextVideoTrack();
+	}
+
+	frame.curFrame = getTracksCurFrame();
+}
+
+bool VideoDecoder::canDecodeAhead(uint32 &startTime) const {
+	if (!_nextVideoTrack || _nextVideoTrack->endOfTrack() || _nextVideoTrack->isReversed())
+		return false;
+
+	startTime = _nextVideoTrack->getNextFrameStartTime();
+
+	// Stop at the end time, like endOfVideo() does
+	return !isPlaying() || !_endTimeSet || startTime < (uint)_endTime.msecs();
+}
+
+void VideoDecoder::startDecodeAhead() {
+	DecodeAheadState &state = *_decodeAhead;
+
+	if (state.suspended || state.group.getPool()->getWorkerCount() == 0)
+		return;
+
+	{
+		Common::StackLock lock(state.mutex);
+		if (state.busy || state.count >= state.limit)
+			return;
+	}
+
+	// The task is not running, so the tracks can be used here
+	uint32 startTime;
+	if (!canDecodeAhead(startTime))
+		return;
+
+	// The task may change the palette of the tracks, while the one of the
+	// frame returned last is still in use
+	if (_palette && _palette != state.palette) {
+		memcpy(state.palette, _palette, sizeof(state.palette));
+		_palette = state.palette;
+	}
+
+	{
+		Common::StackLock lock(state.mutex);
+		state.busy = true;
+		state.pendingTime = startTime;
+	}
+
+	state.group.run(decodeAheadTask, this);
+}
+
+bool VideoDecoder::decodeQueuedFrame(const Graphics::Surface *&surface) {
+	DecodeAheadState &state = *_decodeAhead;
+
+	startDecodeAhead();
+
+	bool waitForTask;
+	{
+		Common::StackLock lock(state.mutex);
+		waitForTask = state.count == 0 && state.busy;
+		state.stop = waitForTask;
+	}
+
+	// The task is decoding the frame which is needed now
+	if (waitForTask) {
+		state.group.wait();
+
+		Common::StackLock lock(state.mutex);
+		state.stop = false;
+	}
+
+	QueuedFrame *frame;
+	{
+		Common::StackLock lock(state.mutex);
+		if (state.count == 0)
+			return false;
+
+		frame = &state.frames[state.first];
+		state.first = (state.first + 1) % ARRAYSIZE(state.frames);
+		state.count--;
+	}
+
+	state.curFrame = frame->curFrame;
+	state.frameTime = frame->frameTime;
+
+	if (frame->dirtyPalette) {
+		// The palette of the track may already be the one of a later frame
+		memcpy(state.palette, frame->palette, sizeof(state.palette));
+		_palette = state.palette;
+		_dirtyPalette = true;
+	}
+
+	// Refill the queue while the caller shows this frame
+	startDecodeAhead();
+
+	surface = frame->hasSurface ? &frame->surface : nullptr;
+	return true;
+}
+
+bool VideoDecoder::isDecodingAhead() const {
+	if (!_decodeAhead)
+		return false;
+
+	Common::StackLock lock(_decodeAhead->mutex);
+	return _decodeAhead->count > 0 || _decodeAhead->busy;
+}
+
+bool VideoDecoder::getQueuedFrameTime(uint32 &startTime) const {
+	if (!_decodeAhead)
+		return false;
+
+	Common::StackLock lock(_decodeAhead->mutex);
+
+	if (_decodeAhead->count > 0) {
+		const QueuedFrame &frame = _decodeAhead->frames[_decodeAhead->first];
+		startTime = frame.startTime;
+		return true;
+	}
+
+	if (_decodeAhead->busy) {
+		startTime = _decodeAhead->pendingTime;
+		return true;
+	}
+
+	// The tracks are where the caller is
+	return false;
+}
+
 } // End of namespace Video
@@ -39,6 +39,7 @@ class SeekableAudioStream;
 
 namespace Common {
 class SeekableReadStream;
+class ThreadPool;
 }
 
 namespace Graphics {
@@ -53,7 +54,7 @@ namespace Video {
 class VideoDecoder {
 public:
 	VideoDecoder();
-	virtual ~VideoDecoder() {}
+	virtual ~VideoDecoder();
 
 	/////////////////////////////////////////
 	// Opening/Closing a Video
@@ -424,6 +425,35 @@ public:
 	 */
 	virtual void setVideoCodecAccuracy(Image::CodecAccuracy accuracy);
 
+	/** The most frames setDecodeAhead() accepts. */
+	static const uint kMaxDecodeAheadFrames = 8;
+
+	/**
+	 * Decode up to @p frames frames ahead on the thread pool, so that
+	 * decodeNextFrame() usually only has to return a frame which is
+	 * already there, and a slow frame does not hold up the caller.
+	 *
+	 * This is off by default. While frames are decoded ahead, the decoder
+	 * must only be used through the VideoDecoder interface. Reversed
+	 * playback is not decoded ahead.
+	 *
+	 * The video stream is read on the thread pool, so it must not be
+	 * read by anything else at the same time. Only enable this for a
+	 * stream which is self-contained, e.g. one opened with Common::File.
+	 * A substream of a file which is used for other resources as well,
+	 * like SCI resource volumes, Gob STK archives or streamed ZIP members,
+	 * shares the file position with the other readers and must not be
+	 * decoded ahead.
+	 *
+	 * @param frames The number of frames to queue, 0 turns it off. Frames
+	 *               which are queued already are still returned.
+	 * @param pool   The pool to decode on, g_system->getThreadPool() if
+	 *               nullptr. Only the pool of the first call is used.
+	 * @note The decoding starts with the first call to decodeNextFrame(),
+	 *       so the output format can still be set before that.
+	 */
+	void setDecodeAhead(uint frames, Common::ThreadPool *pool = nullptr);
+
 	/////////////////////////////////////////
 	// Audio Control
 	/////////////////////////////////////////
@@ -1031,6 +1061,23 @@ protected:
 	Image::CodecAccuracy _videoCodecAccuracy;
 
 private:
+	// Decode-ahead support, see setDecodeAhead()
+	struct DecodeAheadState;
+	struct QueuedFrame;
+	class SuspendDecodeAhead;
+	class LockAudioTracks;
+
+	DecodeAheadState *_decodeAhead;
+
+	static void decodeAheadTask(void *data);
+	void decodeFrameAhead(QueuedFrame &frame);
+	bool canDecodeAhead(uint32 &startTime) const;
+	void startDecodeAhead();
+	bool decodeQueuedFrame(const Graphics::Surface *&surface);
+	bool isDecodingAhead() const;
+	bool getQueuedFrameTime(uint32 &startTime) const;
+	int getTracksCurFrame() const;
+
 	uint32 _pauseLevel;
 	uint32 _pauseStartTime;
 	byte _audioVolume;